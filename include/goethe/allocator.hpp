@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Include the header that defines GOETHE_API
+#include "goethe/dialog.hpp"
+
+namespace goethe {
+
+// Host allocation callbacks. allocate returns memory of at least `size`
+// bytes aligned to `alignment` (a power of two), or nullptr on failure;
+// deallocate gets back the same pointer, size and alignment. Both may be
+// called from any thread.
+struct AllocatorHooks {
+    void* (*allocate)(std::size_t size, std::size_t alignment, void* user_data) = nullptr;
+    void (*deallocate)(void* pointer, std::size_t size, std::size_t alignment, void* user_data) = nullptr;
+    void* user_data = nullptr;
+};
+
+// Routes the library's own allocations through the hooks: pooled buffers,
+// zstd contexts, coroutine frames and internal containers, keys included.
+// Public value types (Dialogue and friends, BatchResult, WorldState) keep
+// std::allocator, as does ZDICT dictionary training, which has no custom
+// allocator entry point. Default-constructed hooks restore
+// global operator new. Memory is always returned to the hooks it came from,
+// so the hooks must stay callable until that memory is gone; idle pooled
+// buffers are released by BufferPool::trim(). Throws std::invalid_argument
+// when only one of the two callbacks is set.
+GOETHE_API void set_allocator(const AllocatorHooks& hooks);
+GOETHE_API AllocatorHooks get_allocator();
+
+// Resource over the hooks installed now. Resources are never destroyed, so
+// containers may outlive later set_allocator() calls. Throws std::bad_alloc
+// when the hook returns nullptr.
+GOETHE_API std::pmr::memory_resource* memory_resource();
+
+// Hash and equality over any string type, so string-keyed pmr maps can be
+// searched with a std::string or string_view without copying the key
+struct StringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view text) const noexcept {
+        return std::hash<std::string_view>{}(text);
+    }
+};
+
+struct StringEqual {
+    using is_transparent = void;
+    bool operator()(std::string_view lhs, std::string_view rhs) const noexcept {
+        return lhs == rhs;
+    }
+};
+
+// String-keyed map whose keys come from the same resource as its nodes
+template <typename T>
+using PmrStringMap = std::pmr::unordered_map<std::pmr::string, T, StringHash, StringEqual>;
+
+} // namespace goethe
@@ -4,10 +4,12 @@
 #include <string>
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 
 // Include the header that defines GOETHE_API
 #include "goethe/dialog.hpp"
+#include "goethe/buffer.hpp"
 #include "goethe/statistics.hpp"
 
 namespace goethe {
@@ -15,6 +17,9 @@ namespace goethe {
 // Forward declaration for compression options
 struct CompressionOptions;
 
+// Stable number of a backend, stored in envelopes (see envelope.hpp)
+using BackendId = std::uint8_t;
+
 // Exception for compression errors
 class GOETHE_API CompressionError : public std::runtime_error {
 public:
@@ -35,6 +40,21 @@ public:
     virtual std::vector<uint8_t> compress(const std::string& data);
     virtual std::vector<uint8_t> decompress_to_string(const uint8_t* data, std::size_t size);
 
+    // Writing into caller-provided memory, used by the batch API. The sizes
+    // are nullopt when the backend cannot tell in advance, and the defaults
+    // copy from compress()/decompress().
+    virtual std::optional<std::size_t> compress_bound(std::size_t size) const;
+    virtual std::optional<std::size_t> decompressed_size(const uint8_t* data, std::size_t size) const;
+    virtual std::size_t compress_into(const uint8_t* data, std::size_t size, uint8_t* output, std::size_t capacity);
+    virtual std::size_t decompress_into(const uint8_t* data, std::size_t size, uint8_t* output, std::size_t capacity);
+
+    // Pooled-buffer versions. The defaults write into a pooled buffer when
+    // the output size is known in advance and copy from compress()/
+    // decompress() otherwise; backends whose output is their input return
+    // the input slice itself.
+    virtual BufferSlice compress_buffer(const BufferSlice& input);
+    virtual BufferSlice decompress_buffer(const BufferSlice& input);
+
     // Metadata methods
     virtual std::string name() const = 0;
     virtual std::string version() const = 0;
@@ -53,15 +73,23 @@ public:
     virtual bool is_statistics_enabled() const;
     virtual BackendStats get_statistics() const;
     virtual void reset_statistics();
+    
+    // Compress/decompress while recording statistics, optionally under a content tag
+    std::vector<uint8_t> compress_with_statistics(const uint8_t* data, std::size_t size,
+                                                  StatsTag tag = NO_STATS_TAG);
+    std::vector<uint8_t> decompress_with_statistics(const uint8_t* data, std::size_t size,
+                                                    StatsTag tag = NO_STATS_TAG);
+    std::size_t compress_into_with_statistics(const uint8_t* data, std::size_t size, uint8_t* output,
+                                              std::size_t capacity, StatsTag tag = NO_STATS_TAG);
+    std::size_t decompress_into_with_statistics(const uint8_t* data, std::size_t size, uint8_t* output,
+                                                std::size_t capacity, StatsTag tag = NO_STATS_TAG);
+    BufferSlice compress_with_statistics(const BufferSlice& input, StatsTag tag = NO_STATS_TAG);
+    BufferSlice decompress_with_statistics(const BufferSlice& input, StatsTag tag = NO_STATS_TAG);
 
 protected:
     // Helper method for validation
     void validate_input(const uint8_t* data, std::size_t size) const;
     
-    // Statistics tracking helpers
-    std::vector<uint8_t> compress_with_statistics(const uint8_t* data, std::size_t size);
-    std::vector<uint8_t> decompress_with_statistics(const uint8_t* data, std::size_t size);
-    
     // Statistics state
     bool statistics_enabled_ = true;
 };
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Include the header that defines GOETHE_API
+#include "goethe/dialog.hpp"
+#include "goethe/statistics.hpp"
+
+namespace goethe {
+
+struct BufferBlock;
+
+// Reference-counted bytes from BufferPool. Copies share the bytes, and the
+// block goes back to the pool when the last Buffer or BufferSlice over it
+// is gone. Fill a buffer before sharing it: writes are seen by every copy.
+class GOETHE_API Buffer {
+public:
+    Buffer() = default;
+    explicit Buffer(std::size_t size); // Uninitialized bytes
+    static Buffer copy_of(std::span<const uint8_t> bytes);
+
+    Buffer(const Buffer& other) noexcept;
+    Buffer& operator=(const Buffer& other) noexcept;
+    Buffer(Buffer&& other) noexcept;
+    Buffer& operator=(Buffer&& other) noexcept;
+    ~Buffer();
+
+    uint8_t* data() {
+        return data_;
+    }
+    const uint8_t* data() const {
+        return data_;
+    }
+    std::size_t size() const {
+        return size_;
+    }
+    std::size_t capacity() const {
+        return capacity_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    // Within the capacity only the size changes. Growing past it moves this
+    // handle to a larger block; other copies keep the old one.
+    void resize(std::size_t size);
+
+    std::size_t use_count() const;
+
+private:
+    friend class BufferSlice;
+    void release() noexcept;
+
+    BufferBlock* block_ = nullptr;
+    uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+// A read-only range of a Buffer that keeps the buffer alive. Slicing and
+// copying never copy bytes.
+class GOETHE_API BufferSlice {
+public:
+    BufferSlice() = default;
+    BufferSlice(Buffer buffer); // The whole buffer
+    BufferSlice(Buffer buffer, std::size_t offset, std::size_t size); // Throws std::out_of_range
+
+    const uint8_t* data() const {
+        return buffer_.data() + offset_;
+    }
+    std::size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+    std::span<const uint8_t> span() const {
+        return {data(), size_};
+    }
+    std::string_view view() const {
+        return {reinterpret_cast<const char*>(data()), size_};
+    }
+
+    BufferSlice slice(std::size_t offset, std::size_t size) const; // Throws std::out_of_range
+
+    // Allocated bytes after the end of the slice. Readers that load whole
+    // SIMD words may read this far past size().
+    std::size_t tail_capacity() const {
+        return buffer_.capacity() - offset_ - size_;
+    }
+
+    const Buffer& buffer() const {
+        return buffer_;
+    }
+
+private:
+    Buffer buffer_;
+    std::size_t offset_ = 0;
+    std::size_t size_ = 0;
+};
+
+// Recycles buffer blocks in power-of-two size classes from 256 bytes to
+// 16 MiB; larger blocks come from and go back to memory_resource(). Idle
+// blocks are kept up to the retained limit and reported under
+// MemoryCategory::CACHE. Blocks from earlier allocator hooks are not reused;
+// an acquire of their size class frees them.
+class GOETHE_API BufferPool {
+public:
+    struct Stats {
+        std::uint64_t allocated = 0; // Blocks taken from the heap
+        std::uint64_t reused = 0;    // Blocks taken from the free lists
+        std::size_t idle_bytes = 0;  // Held in the free lists
+    };
+
+    static constexpr std::size_t kMinBlock = std::size_t{1} << 8;
+    static constexpr std::size_t kMaxBlock = std::size_t{1} << 24;
+
+    static BufferPool& instance();
+
+    void set_retained_limit(std::size_t bytes); // Default 64 MiB
+    std::size_t get_retained_limit() const;
+    void trim(); // Frees every idle block
+    Stats get_stats() const;
+
+private:
+    friend class Buffer;
+    static constexpr std::size_t kClasses = 17;
+
+    BufferPool();
+    ~BufferPool();
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    BufferBlock* acquire(std::size_t size);
+    void recycle(BufferBlock* block) noexcept;
+
+    mutable std::mutex mutex_;
+    std::array<std::vector<BufferBlock*>, kClasses> free_;
+    std::size_t retained_limit_ = std::size_t{64} << 20;
+    Stats stats_;
+    MemoryAccount memory_;
+};
+
+// Reads a whole file, or the rest of a stream, into a pooled buffer with at
+// least `padding` bytes of capacity past the end. Throw std::runtime_error
+// when the file cannot be read.
+GOETHE_API Buffer read_file(const std::filesystem::path& path, std::size_t padding = 0);
+GOETHE_API Buffer read_stream(std::istream& input, std::size_t padding = 0);
+
+} // namespace goethe
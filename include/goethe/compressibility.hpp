@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Include the header that defines GOETHE_API
+#include "goethe/dialog.hpp"
+
+namespace goethe {
+
+// Inputs shorter than this are always worth a try; their samples say too
+// little, and compressing them is cheap anyway
+constexpr std::size_t kMinEstimateSize = 1024;
+
+// What a quick look at a sample of the input says about compressing it
+struct CompressibilityEstimate {
+    std::size_t sampled = 0;  // Bytes examined; 0 for inputs below kMinEstimateSize
+    double entropy = 0.0;     // Order-0 entropy of the sample, bits per byte
+    double match_ratio = 0.0; // Share of sampled positions repeating an earlier 4-byte sequence
+    bool compressible = true; // False when a backend would gain next to nothing
+};
+
+// Looks at up to 16 blocks of 512 bytes spread over the input: a byte
+// histogram for the entropy and a hash table of 4-byte sequences for the
+// matches an LZ compressor would find. Already-compressed media and
+// encrypted payloads come out near 8 bits per byte with no matches; both
+// must be the case for the input to count as incompressible.
+GOETHE_API CompressibilityEstimate estimate_compressibility(std::span<const std::uint8_t> data);
+
+} // namespace goethe
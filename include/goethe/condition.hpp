@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "goethe/allocator.hpp"
+#include "goethe/cpu_dispatch.hpp"
+// Include the header that defines GOETHE_API
+#include "goethe/dialog.hpp"
+
+namespace goethe {
+
+// Flags and variables read by conditions and written by effects
+class GOETHE_API WorldState {
+public:
+    enum class KeyKind : std::uint8_t { FLAG, VAR };
+
+    // Called after a watched flag or variable actually changes
+    using ChangeListener = std::function<void(KeyKind kind, const std::string& name)>;
+
+    WorldState() = default;
+    WorldState(const WorldState& other); // Copies values, not listeners
+    WorldState& operator=(const WorldState&) = delete;
+
+    void set_flag(const std::string& name, bool value = true);
+    bool has_flag(const std::string& name) const;
+
+    void set_var(const std::string& name, std::string value);
+    void erase_var(const std::string& name);
+    const std::string* get_var(const std::string& name) const; // nullptr when unset
+
+    // Listeners hear only the keys they watch, so a change costs one lookup
+    // plus a call per interested listener. add_listener returns the token
+    // for watch and remove_listener. A callback may add, watch and remove
+    // listeners, itself included; one removed during a change is not called
+    // again, and one added or watching the key only hears the next change.
+    std::size_t add_listener(ChangeListener listener);
+    void watch(std::size_t token, KeyKind kind, const std::string& name);
+    void remove_listener(std::size_t token);
+
+private:
+    struct Listener {
+        ChangeListener callback;
+        std::vector<std::pair<KeyKind, std::string>> watched;
+        bool removed = false; // Erased once no callback is running
+    };
+
+    void notify(KeyKind kind, const std::string& name);
+
+    std::unordered_set<std::string> flags_;
+    std::unordered_map<std::string, std::string> vars_;
+    std::unordered_map<std::size_t, Listener> listeners_;
+    std::unordered_map<std::string, std::unordered_set<std::size_t>> flag_watchers_;
+    std::unordered_map<std::string, std::unordered_set<std::size_t>> var_watchers_;
+    std::size_t next_listener_ = 0;
+    int notifying_ = 0;                // Nesting depth of notify()
+    std::vector<std::size_t> removed_; // Removed while notifying
+};
+
+// Evaluates a condition tree against the world. FLAG holds when the flag is
+// set; VAR holds when the variable equals the value, or is set at all when
+// the value is empty. Types the readers do not produce yet evaluate false.
+GOETHE_API bool evaluate(const Condition& condition, const WorldState& world);
+
+// Applies SET_FLAG and SET_VAR to the world and returns true; other effects
+// are left to the host and return false
+GOETHE_API bool apply(const Effect& effect, WorldState& world);
+
+// A condition flattened into postfix order, together with the world keys it
+// reads. Evaluates like evaluate() without walking the tree.
+class GOETHE_API CompiledCondition {
+public:
+    struct Key {
+        WorldState::KeyKind kind;
+        std::string name;
+    };
+
+    struct Op {
+        enum class Code : std::uint8_t {
+            FLAG,       // Push whether flag keys[key] is set
+            VAR_SET,    // Push whether variable keys[key] exists
+            VAR_EQUALS, // Push whether variable keys[key] equals value
+            ALL,        // Pop arity results, push their conjunction
+            ANY,        // Pop arity results, push their disjunction
+            NOT,        // Negate the top result
+            FALSE       // Push false (unsupported condition types)
+        };
+        Code code;
+        std::uint32_t key = 0;
+        std::uint32_t arity = 0;
+        std::string value;
+    };
+
+    explicit CompiledCondition(const Condition& condition);
+
+    bool evaluate(const WorldState& world) const;
+
+    const std::vector<Key>& keys() const {
+        return keys_;
+    }
+    const std::vector<Op>& ops() const {
+        return ops_;
+    }
+
+private:
+    void compile(const Condition& condition);
+    std::uint32_t key_index(WorldState::KeyKind kind, const std::string& name);
+
+    std::vector<Key> keys_; // Distinct keys, in first-use order
+    std::vector<Op> ops_;
+};
+
+// World state for many actors, stored by column: one bit per actor for each
+// flag and one interned value id per actor for each variable. Columns are
+// padded to whole batches of 256 actors and come from memory_resource().
+class GOETHE_API WorldStateBlock {
+public:
+    static constexpr std::uint32_t kUnset = 0; // Value id of an unset variable
+
+    explicit WorldStateBlock(std::size_t actors);
+
+    std::size_t size() const {
+        return actors_;
+    }
+    std::size_t padded_size() const {
+        return padded_;
+    }
+
+    // Each throws std::out_of_range for an actor not below size()
+    void set_flag(std::size_t actor, const std::string& name, bool value = true);
+    bool has_flag(std::size_t actor, const std::string& name) const;
+    void set_var(std::size_t actor, const std::string& name, const std::string& value);
+    void erase_var(std::size_t actor, const std::string& name);
+    const std::pmr::string* get_var(std::size_t actor, const std::string& name) const;
+
+    // Column access for batch kernels; nullptr for keys never written
+    const std::uint64_t* flag_column(const std::string& name) const;
+    const std::uint32_t* var_column(const std::string& name) const;
+    // Id of a stored value, or nullopt when no actor ever held it
+    std::optional<std::uint32_t> value_id(const std::string& value) const;
+
+private:
+    std::size_t actors_;
+    std::size_t padded_;
+    PmrStringMap<std::pmr::vector<std::uint64_t>> flags_;
+    PmrStringMap<std::pmr::vector<std::uint32_t>> vars_;
+    PmrStringMap<std::uint32_t> value_ids_;
+    std::pmr::vector<const std::pmr::string*> values_; // By id - 1
+};
+
+// Evaluates one compiled condition for every actor in the block. Bit i of
+// word i / 64 of the result is actor i; bits past size() are clear. Runs
+// the kernel for the active CPU tier.
+GOETHE_API std::vector<std::uint64_t> evaluate_batch(const CompiledCondition& condition,
+                                                     const WorldStateBlock& block);
+GOETHE_API CpuTier batch_tier(); // Tier of the batch kernel in use
+
+// Caches condition results for one world. Each compiled condition is listed
+// under the keys it reads, and a change to a key only marks those
+// conditions dirty; clean results are returned without evaluating. The
+// world must outlive the cache.
+class GOETHE_API ConditionCache {
+public:
+    using Id = std::size_t;
+
+    explicit ConditionCache(WorldState& world);
+    ~ConditionCache();
+    ConditionCache(const ConditionCache&) = delete;
+    ConditionCache& operator=(const ConditionCache&) = delete;
+
+    // Compiles a condition on first sight. Conditions are identified by
+    // address, so they must outlive the cache (e.g. owned by a Dialogue).
+    Id intern(const Condition& condition);
+
+    bool evaluate(Id id);
+    bool is_dirty(Id id) const {
+        return entries_[id].dirty;
+    }
+
+    std::size_t size() const {
+        return entries_.size();
+    }
+    std::uint64_t evaluations() const {
+        return evaluations_; // Cache misses since construction
+    }
+
+private:
+    struct Entry {
+        CompiledCondition compiled;
+        bool dirty = true;
+        bool value = false;
+    };
+
+    void invalidate(WorldState::KeyKind kind, const std::string& name);
+
+    WorldState& world_;
+    std::size_t listener_;
+    std::pmr::vector<Entry> entries_;
+    std::pmr::unordered_map<const Condition*, Id> ids_;
+    PmrStringMap<std::pmr::vector<Id>> flag_dependents_;
+    PmrStringMap<std::pmr::vector<Id>> var_dependents_;
+    std::uint64_t evaluations_ = 0;
+};
+
+} // namespace goethe
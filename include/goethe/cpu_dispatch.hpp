@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Include the header that defines GOETHE_API
+#include "goethe/dialog.hpp"
+
+namespace goethe {
+
+// Instruction set tiers SIMD kernels are built for, lowest first. SSE42 also
+// implies SSSE3; AVX512 means AVX-512 F and BW.
+enum class CpuTier : std::uint8_t { SCALAR, SSE42, AVX2, AVX512 };
+constexpr std::size_t kCpuTierCount = 4;
+
+// Best tier the CPU and operating system support, detected on first use
+GOETHE_API CpuTier detected_cpu_tier();
+
+// Tier kernels run at: the detected tier, capped by limit_cpu_tier()
+GOETHE_API CpuTier active_cpu_tier();
+
+// Caps the tier of every kernel from their next call on and returns the
+// previous cap. Meant for tests and benchmarks; CpuTier::AVX512 lifts it.
+GOETHE_API CpuTier limit_cpu_tier(CpuTier limit);
+
+GOETHE_API const char* to_string(CpuTier tier);
+
+// Caps the tier for its lifetime
+class ScopedCpuTierLimit {
+public:
+    explicit ScopedCpuTierLimit(CpuTier limit) : previous_(limit_cpu_tier(limit)) {}
+    ~ScopedCpuTierLimit() {
+        limit_cpu_tier(previous_);
+    }
+    ScopedCpuTierLimit(const ScopedCpuTierLimit&) = delete;
+    ScopedCpuTierLimit& operator=(const ScopedCpuTierLimit&) = delete;
+
+private:
+    CpuTier previous_;
+};
+
+// One kernel built for several tiers. Each table entry holds the best
+// implementation at or below that tier, so a call costs one tier lookup and
+// an indirect call, and a build without a tier's kernels still runs.
+template <typename Fn>
+class CpuDispatch {
+public:
+    // implementations[tier] is the kernel for that tier, or nullptr when
+    // there is none; the SCALAR entry must be set
+    constexpr explicit CpuDispatch(const std::array<Fn*, kCpuTierCount>& implementations) {
+        for (std::size_t tier = 0; tier < kCpuTierCount; ++tier) {
+            const bool own = implementations[tier] != nullptr || tier == 0;
+            table_[tier] = own ? implementations[tier] : table_[tier - 1];
+            tiers_[tier] = own ? static_cast<CpuTier>(tier) : tiers_[tier - 1];
+        }
+    }
+
+    Fn* get() const {
+        return table_[static_cast<std::size_t>(active_cpu_tier())];
+    }
+
+    // Tier of the implementation get() returns
+    CpuTier tier() const {
+        return tiers_[static_cast<std::size_t>(active_cpu_tier())];
+    }
+
+private:
+    std::array<Fn*, kCpuTierCount> table_{};
+    std::array<CpuTier, kCpuTierCount> tiers_{};
+};
+
+} // namespace goethe
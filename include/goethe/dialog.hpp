@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <optional>
@@ -25,6 +26,7 @@ using yaml = YAML::Node;
 namespace goethe {
 
 // Forward declarations
+class BufferSlice;
 class DialogueRunner;
 class IDialoguePort;
 
@@ -200,9 +202,20 @@ struct DialogueEvent {
 };
 
 // Core functions
+// Reads YAML or JSON. JSON documents are recognised by their leading '{' and
+// take the simdjson path when it is available.
 GOETHE_API Dialogue read_dialogue(std::istream& input);
+// Reads a document in place, e.g. straight from a decompressed buffer
+GOETHE_API Dialogue read_dialogue(const BufferSlice& document);
+// Reads a JSON dialogue with the same mapping as the YAML reader
+GOETHE_API Dialogue read_dialogue_json(std::string_view json);
+GOETHE_API Dialogue read_dialogue_json(std::istream& input);
 GOETHE_API void write_dialogue(std::ostream& output, const Dialogue& dialogue);
 
+// Approximate bytes held by a dialogue, including heap storage of its strings,
+// containers and map nodes. Allocator headers and padding are not counted.
+GOETHE_API std::size_t estimate_memory_usage(const Dialogue& dialogue);
+
 // YAML conversion helpers
 void from_yaml(const YAML::Node& node, Line& line);
 YAML::Node to_yaml(const Line& line);
@@ -210,7 +223,7 @@ void from_yaml(const YAML::Node& node, Choice& choice);
 YAML::Node to_yaml(const Choice& choice);
 void from_yaml(const YAML::Node& node, Node& node_obj);
 YAML::Node to_yaml(const Node& node_obj);
-void from_yaml(const YAML::Node& node, Dialogue& dialogue);
-YAML::Node to_yaml(const Dialogue& dialogue);
+GOETHE_API void from_yaml(const YAML::Node& node, Dialogue& dialogue);
+GOETHE_API YAML::Node to_yaml(const Dialogue& dialogue);
 
 } // namespace goethe
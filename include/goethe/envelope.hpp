@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "goethe/backend.hpp"
+#include "goethe/cpu_dispatch.hpp"
+
+namespace goethe {
+
+// Self-describing compressed payload. The header is, in order:
+//   magic      4 bytes  E7 'G' 'T' 'H'
+//   version    1 byte   kEnvelopeVersion
+//   flags      1 byte   kEnvelopeChecksum, or 0
+//   backend    1 byte   BackendId of the backend that wrote the payload
+//   size       LEB128   original size, 1 to 10 bytes
+//   checksum   4 bytes  CRC-32C of the original, little endian; with the flag
+// followed by the backend's output.
+constexpr std::array<std::uint8_t, 4> kEnvelopeMagic = {0xE7, 'G', 'T', 'H'};
+constexpr std::uint8_t kEnvelopeVersion = 1;
+constexpr std::uint8_t kEnvelopeChecksum = 0x01;
+constexpr std::size_t kMaxEnvelopeHeader = 4 + 1 + 1 + 1 + 10 + 4;
+
+// The null backend, for payloads stored as they are
+constexpr BackendId kRawBackendId = 0;
+
+// Most original bytes a reader accepts per payload byte when the backend
+// cannot tell the size from its own framing. zstd's best case, an RLE
+// block of 4 bytes per 128 KiB, stays within it.
+constexpr std::uint64_t kMaxEnvelopeRatio = 32768;
+
+struct EnvelopeHeader {
+    BackendId backend = 0;
+    std::uint64_t original_size = 0;
+    std::optional<std::uint32_t> checksum;
+    std::size_t size = 0; // Header bytes before the payload
+};
+
+// Writes the header to `output`, which holds kMaxEnvelopeHeader bytes, and
+// returns its size
+GOETHE_API std::size_t write_envelope_header(const EnvelopeHeader& header, std::uint8_t* output);
+
+// nullopt when the data does not start with the magic. Throws
+// CompressionError for a header that does but is truncated or malformed.
+GOETHE_API std::optional<EnvelopeHeader> read_envelope_header(std::span<const std::uint8_t> data);
+
+// CRC-32C (Castagnoli), continuing from `crc` for data read in pieces. Uses
+// the SSE4.2 crc32 instruction when the active CPU tier has it.
+GOETHE_API std::uint32_t crc32c(std::span<const std::uint8_t> data, std::uint32_t crc = 0);
+GOETHE_API CpuTier crc32c_tier(); // Tier of the implementation in use
+
+} // namespace goethe
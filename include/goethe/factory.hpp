@@ -2,6 +2,7 @@
 
 #include "backend.hpp"
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <functional>
@@ -11,16 +12,26 @@ namespace goethe {
 class GOETHE_API CompressionFactory {
 public:
     using BackendCreator = std::function<std::unique_ptr<CompressionBackend>()>;
+    // Reports whether a backend can be created without constructing one
+    using AvailabilityProbe = std::function<bool()>;
     
     // Singleton pattern for global access
     static CompressionFactory& instance();
     
-    // Register a backend type
-    void register_backend(const std::string& name, BackendCreator creator);
+    // Register a backend type. Without a probe, availability checks construct
+    // a throwaway backend and ask it. Only backends with an ID can write
+    // envelopes; IDs are stored with the data, so they are never reused.
+    void register_backend(const std::string& name, BackendCreator creator, AvailabilityProbe probe = nullptr,
+                          std::optional<BackendId> id = std::nullopt);
     
     // Create a backend by name
     std::unique_ptr<CompressionBackend> create_backend(const std::string& name);
     
+    // Envelope IDs. create_backend_by_id throws CompressionError for an
+    // unknown ID.
+    std::optional<BackendId> get_backend_id(const std::string& name) const;
+    std::unique_ptr<CompressionBackend> create_backend_by_id(BackendId id);
+    
     // Get available backend names
     std::vector<std::string> get_available_backends() const;
     
@@ -36,7 +47,16 @@ private:
     CompressionFactory(const CompressionFactory&) = delete;
     CompressionFactory& operator=(const CompressionFactory&) = delete;
     
-    std::unordered_map<std::string, BackendCreator> backends_;
+    struct BackendEntry {
+        BackendCreator creator;
+        AvailabilityProbe probe;
+        std::optional<BackendId> id;
+    };
+    
+    static bool probe_backend(const BackendEntry& entry);
+    
+    std::unordered_map<std::string, BackendEntry> backends_;
+    std::unordered_map<BackendId, std::string> names_by_id_;
     
     // Priority order for auto-selection
     static const std::vector<std::string> backend_priority_;
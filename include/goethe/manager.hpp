@@ -2,30 +2,143 @@
 
 #include "backend.hpp"
 #include "statistics.hpp"
+#include "thread_pool.hpp"
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <unordered_map>
 
 namespace goethe {
 
-class GOETHE_API CompressionManager {
+// Outputs of a batch call, stored back to back in one arena. Buffer i is
+// data[offsets[i], offsets[i + 1]).
+struct BatchResult {
+    std::vector<uint8_t> data;
+    std::vector<std::size_t> offsets; // One more entry than there are buffers
+
+    std::size_t size() const {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+    std::span<const uint8_t> operator[](std::size_t index) const {
+        return {data.data() + offsets[index], offsets[index + 1] - offsets[index]};
+    }
+};
+
+// Runs a task later on some thread. Hosts set one on the manager to route
+// asynchronous compression into their own job system.
+using Executor = std::function<void(std::function<void()>)>;
+
+// Returned by co_compress/co_decompress. Awaiting it hands the work to the
+// executor; the coroutine resumes on the thread that ran it.
+class GOETHE_API CompressionAwaitable {
 public:
-    // Singleton pattern
-    static CompressionManager& instance();
+    bool await_ready() const noexcept {
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> handle);
+    std::vector<uint8_t> await_resume();
+
+private:
+    friend class CompressionContext;
+    CompressionAwaitable(Executor executor, std::function<std::vector<uint8_t>()> work)
+        : executor_(std::move(executor)), work_(std::move(work)) {}
+
+    Executor executor_;
+    std::function<std::vector<uint8_t>()> work_;
+    std::vector<uint8_t> result_;
+    std::exception_ptr error_;
+};
+
+// One compression setup: a backend with its level and options (dictionary
+// included), and the backends it keeps for batch and asynchronous work.
+// Subsystems that want settings of their own create a context rather than
+// share CompressionManager::instance(). Creating one allocates nothing;
+// the backend comes with initialize() and the pools on first use. Contexts
+// share only the backend registry and the statistics manager, so each may
+// be used from its own thread, though one context is not for concurrent use.
+class GOETHE_API CompressionContext {
+public:
+    CompressionContext();
+    explicit CompressionContext(const std::string& backend_name); // Initialized
+    ~CompressionContext();
+    CompressionContext(const CompressionContext&) = delete;
+    CompressionContext& operator=(const CompressionContext&) = delete;
     
     // Initialize with specific backend or auto-select
     void initialize(const std::string& backend_name = "");
     
-    // High-level compression/decompression methods
-    std::vector<uint8_t> compress(const uint8_t* data, std::size_t size);
-    std::vector<uint8_t> decompress(const uint8_t* data, std::size_t size);
+    // High-level compression/decompression methods. The optional tag (see
+    // intern_tag) breaks statistics down by content category.
+    std::vector<uint8_t> compress(const uint8_t* data, std::size_t size, StatsTag tag = NO_STATS_TAG);
+    std::vector<uint8_t> decompress(const uint8_t* data, std::size_t size, StatsTag tag = NO_STATS_TAG);
     
     // Convenience overloads
-    std::vector<uint8_t> compress(const std::vector<uint8_t>& data);
-    std::vector<uint8_t> decompress(const std::vector<uint8_t>& data);
-    std::vector<uint8_t> compress(const std::string& data);
+    std::vector<uint8_t> compress(const std::vector<uint8_t>& data, StatsTag tag = NO_STATS_TAG);
+    std::vector<uint8_t> decompress(const std::vector<uint8_t>& data, StatsTag tag = NO_STATS_TAG);
+    std::vector<uint8_t> compress(const std::string& data, StatsTag tag = NO_STATS_TAG);
     std::string decompress_to_string(const uint8_t* data, std::size_t size);
     std::string decompress_to_string(const std::vector<uint8_t>& data);
     
+    // Pooled-buffer overloads. Results are written straight into pooled
+    // buffers, and with the null backend they share the input's bytes.
+    BufferSlice compress(const BufferSlice& data, StatsTag tag = NO_STATS_TAG);
+    BufferSlice decompress(const BufferSlice& data, StatsTag tag = NO_STATS_TAG);
+    
+    // Self-describing payloads (see envelope.hpp). The header names the
+    // backend and the original size, so decompress_envelope reads payloads
+    // from any registered backend, whatever this context is set to, into
+    // one allocation of the right size. `checksum` adds a CRC-32C of the
+    // input, verified on decompression. Throws CompressionError for data
+    // without an envelope.
+    std::vector<uint8_t> compress_envelope(const uint8_t* data, std::size_t size, bool checksum = false,
+                                           StatsTag tag = NO_STATS_TAG);
+    std::vector<uint8_t> decompress_envelope(const uint8_t* data, std::size_t size, StatsTag tag = NO_STATS_TAG);
+    BufferSlice compress_envelope(const BufferSlice& data, bool checksum = false, StatsTag tag = NO_STATS_TAG);
+    BufferSlice decompress_envelope(const BufferSlice& data, StatsTag tag = NO_STATS_TAG);
+    
+    // Before writing an envelope, estimate whether the input compresses (see
+    // compressibility.hpp) and store it raw, with the null backend, when it
+    // does not. Skips are recorded against this context's backend with the
+    // time it would have taken, judged by its envelope compressions so far;
+    // until the backend has written one, skips are counted but not priced.
+    // On by default; only envelopes can tell readers the data is raw.
+    void set_skip_incompressible(bool skip);
+    bool get_skip_incompressible() const;
+    
+    // Batch methods for many small buffers. Outputs share one arena, the
+    // work is spread over a thread pool with a backend per thread, and
+    // statistics are recorded once for the whole batch. If any buffer fails
+    // the whole batch throws.
+    BatchResult compress_batch(std::span<const std::span<const uint8_t>> inputs, StatsTag tag = NO_STATS_TAG);
+    BatchResult decompress_batch(std::span<const std::span<const uint8_t>> inputs, StatsTag tag = NO_STATS_TAG);
+    BatchResult compress_batch(const std::vector<std::vector<uint8_t>>& inputs, StatsTag tag = NO_STATS_TAG);
+    BatchResult decompress_batch(const std::vector<std::vector<uint8_t>>& inputs, StatsTag tag = NO_STATS_TAG);
+    
+    // Pool threads that help the calling thread with batches; 0 keeps
+    // batches on the calling thread
+    void set_batch_threads(std::size_t threads);
+    std::size_t get_batch_threads() const;
+    
+    // Asynchronous methods. The data is moved into the job, which runs on
+    // the executor with the backend configuration current at the call, and
+    // errors surface from the future or the co_await. Jobs do not refer
+    // back to the context, so it may be destroyed while they are queued.
+    std::future<std::vector<uint8_t>> compress_async(std::vector<uint8_t> data, StatsTag tag = NO_STATS_TAG);
+    std::future<std::vector<uint8_t>> decompress_async(std::vector<uint8_t> data, StatsTag tag = NO_STATS_TAG);
+    CompressionAwaitable co_compress(std::vector<uint8_t> data, StatsTag tag = NO_STATS_TAG);
+    CompressionAwaitable co_decompress(std::vector<uint8_t> data, StatsTag tag = NO_STATS_TAG);
+    
+    // Executor for the asynchronous methods; an empty one selects the
+    // context's own thread pool, started on first use
+    void set_executor(Executor executor);
+    
     // Configuration
     void set_compression_level(int level);
     int get_compression_level() const;
@@ -40,27 +153,74 @@ public:
     // Switch backends
     void switch_backend(const std::string& backend_name);
     
-    // Statistics methods
+    // Statistics methods. enable_statistics turns recording on or off for
+    // this context only; the StatisticsManager switch still applies on top.
     void enable_statistics(bool enable = true);
     bool is_statistics_enabled() const;
     BackendStats get_statistics() const;
     BackendStats get_global_statistics() const;
+    WindowStats get_window_statistics(StatsWindow window) const;
+    StatsTag intern_tag(const std::string& name);
+    BackendStats get_tag_statistics(StatsTag tag) const;
     void reset_statistics();
     void reset_global_statistics();
     std::string export_statistics_json() const;
     std::string export_statistics_csv() const;
+    std::string export_statistics_openmetrics() const;
 
 private:
-    CompressionManager() = default;
-    ~CompressionManager() = default;
-    CompressionManager(const CompressionManager&) = delete;
-    CompressionManager& operator=(const CompressionManager&) = delete;
+    struct AsyncBackends;
+    
+    BatchResult run_batch(std::span<const std::span<const uint8_t>> inputs, bool compressing, StatsTag tag);
+    std::function<std::vector<uint8_t>()> make_async_job(std::vector<uint8_t> data, bool compressing, StatsTag tag);
+    Executor current_executor();
+    std::unique_ptr<CompressionBackend> copy_backend() const;
+    void invalidate_backend_copies();
+    CompressionBackend& envelope_backend(BackendId id);
+    CompressionBackend& envelope_writer(const uint8_t* data, std::size_t size, StatsTag tag);
+    void record_envelope_cost(std::size_t size, Duration duration);
     
     std::unique_ptr<CompressionBackend> backend_;
     bool initialized_ = false;
+    bool statistics_enabled_ = true; // Copied to backend_ and its copies
+    
+    // Backends for envelopes written by a backend other than backend_
+    std::unordered_map<BackendId, std::unique_ptr<CompressionBackend>> envelope_backends_;
+    
+    // Incompressible input: whether to look for it, and backend_'s recent
+    // cost per byte of writing envelopes, to price the skipped work; unset
+    // until it has written one
+    bool skip_incompressible_ = true;
+    std::optional<double> envelope_ns_per_byte_;
+    
+    // Batch state: the pool starts on first use, and each participating
+    // thread gets its own backend configured like backend_
+    std::size_t batch_threads_ = ThreadPool::default_thread_count();
+    std::unique_ptr<ThreadPool> batch_pool_;
+    std::vector<std::unique_ptr<CompressionBackend>> batch_backends_;
+    
+    // Async state. Jobs share the idle backends of the configuration they
+    // were created with; a configuration change starts a new set, and the
+    // old one goes with its last job.
+    std::mutex async_mutex_;
+    Executor executor_;
+    std::shared_ptr<AsyncBackends> async_backends_;
+    std::unique_ptr<ThreadPool> async_pool_; // Last, so queued jobs finish before the rest goes
+};
+
+// The process-wide default context
+class GOETHE_API CompressionManager : public CompressionContext {
+public:
+    // Singleton pattern
+    static CompressionManager& instance();
+
+private:
+    CompressionManager() = default;
+    ~CompressionManager() = default;
 };
 
-// Global convenience functions
+// Global convenience functions. Both work on raw backend output; envelopes
+// go through compress_envelope/decompress_envelope.
 GOETHE_API std::vector<uint8_t> compress_data(const uint8_t* data, std::size_t size, const std::string& backend = "");
 GOETHE_API std::vector<uint8_t> decompress_data(const uint8_t* data, std::size_t size, const std::string& backend = "");
 
@@ -13,6 +13,21 @@ public:
     std::vector<uint8_t> compress(const uint8_t* data, std::size_t size) override;
     std::vector<uint8_t> decompress(const uint8_t* data, std::size_t size) override;
 
+    // Output is the input, so sizes are always known
+    std::optional<std::size_t> compress_bound(std::size_t size) const override {
+        return size;
+    }
+    std::optional<std::size_t> decompressed_size(const uint8_t* data, std::size_t size) const override {
+        (void)data;
+        return size;
+    }
+    std::size_t compress_into(const uint8_t* data, std::size_t size, uint8_t* output, std::size_t capacity) override;
+    std::size_t decompress_into(const uint8_t* data, std::size_t size, uint8_t* output, std::size_t capacity) override;
+
+    // Output shares the input's bytes
+    BufferSlice compress_buffer(const BufferSlice& input) override;
+    BufferSlice decompress_buffer(const BufferSlice& input) override;
+
     // Metadata
     std::string name() const override {
         return "null";
@@ -39,6 +54,9 @@ public:
     CompressionOptions get_options() const override {
         return CompressionOptions{};
     }
+
+private:
+    void check_plausible(const uint8_t* data, std::size_t size) const;
 };
 
 } // namespace goethe
@@ -4,7 +4,8 @@
 
 namespace goethe {
 
-// Register all available compression backends with the factory
+// Register all available compression backends with the factory. Only the
+// first call does any work, so it is cheap to call before each use.
 GOETHE_API void register_compression_backends();
 
 } // namespace goethe
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "goethe/condition.hpp"
+
+namespace goethe {
+
+// What a runner shows after entering a node
+struct DialogueStep {
+    struct ChoiceView {
+        const Choice* choice = nullptr;
+        bool enabled = true; // False when gated; still listed if it has disabledText
+    };
+
+    DialogueState state = DialogueState::IDLE; // RUNNING, WAITING_CHOICE or COMPLETED
+    const Node* node = nullptr;                // nullptr once completed
+    const Line* line = nullptr;                // Single line, or the picked variant
+    std::vector<ChoiceView> choices;
+    std::vector<const Effect*> host_effects;   // Effects apply() left to the host, in order
+};
+
+class DialogueRunner;
+
+// Awaitable returned by DialogueRunner::next and choose. It completes
+// without suspending unless the runner has to wait for an auto-advance
+// timer or for the port to accept the node; DialogueRunner::tick resumes it.
+class GOETHE_API DialogueStepAwaitable {
+public:
+    DialogueStepAwaitable(const DialogueStepAwaitable&) = delete;
+    DialogueStepAwaitable& operator=(const DialogueStepAwaitable&) = delete;
+    ~DialogueStepAwaitable();
+
+    bool await_ready() const noexcept {
+        return ready_;
+    }
+    void await_suspend(std::coroutine_handle<> handle);
+    DialogueStep await_resume();
+
+private:
+    friend class DialogueRunner;
+    DialogueStepAwaitable(DialogueRunner& runner, bool ready) : runner_(&runner), ready_(ready) {}
+
+    DialogueRunner* runner_;
+    bool ready_;
+    std::coroutine_handle<> handle_;
+};
+
+// Steps through one dialogue. Nodes without choices continue with the next
+// node in file order, after autoAdvanceMs when set; choosing "$END" or
+// leaving the last node completes the dialogue. Not thread-safe; run many
+// conversations as many runners.
+class GOETHE_API DialogueRunner {
+public:
+    DialogueRunner(const Dialogue& dialogue, WorldState& world, IDialoguePort* port = nullptr,
+                   std::uint32_t seed = 0);
+    DialogueRunner(const DialogueRunner&) = delete;
+    DialogueRunner& operator=(const DialogueRunner&) = delete;
+    ~DialogueRunner();
+
+    // Enters the start node, or leaves a node without choices. Throws
+    // std::logic_error while a choice is expected or another step is pending.
+    DialogueStepAwaitable next();
+    // Takes an enabled choice of the current node; throws std::invalid_argument
+    // for unknown or gated ids
+    DialogueStepAwaitable choose(const std::string& choice_id);
+
+    // Advances the runner clock and resumes a script waiting on it
+    void tick(int elapsed_ms);
+
+    DialogueState state() const {
+        return step_.state;
+    }
+    const DialogueStep& current_step() const {
+        return step_;
+    }
+    bool is_waiting() const {
+        return waiting_ != nullptr || wait_ != Wait::NONE;
+    }
+    DialogueSnapshot snapshot() const;
+
+    // Re-checks the current node's choices after world changes and presents
+    // the node again if availability changed. Returns false, without
+    // evaluating anything, when no condition the choices read has changed.
+    bool refresh();
+
+    // Condition results, invalidated per world key
+    const ConditionCache& conditions() const {
+        return conditions_;
+    }
+
+private:
+    friend class DialogueStepAwaitable;
+    enum class Wait { NONE, TIMER, PRESENT };
+
+    void check_idle_operation() const;
+    bool pump();
+    void enter_node(std::size_t index);
+    void leave_node();
+    void complete();
+    void run_effects(const std::vector<Effect>& effects);
+    bool holds(const std::optional<Condition>& condition);
+    std::vector<DialogueStep::ChoiceView> offered_choices(const Node& node);
+    const Line* pick_line(const Node& node);
+    bool present();
+
+    const Dialogue& dialogue_;
+    WorldState& world_;
+    IDialoguePort* port_;
+    std::mt19937 rng_;
+    std::unordered_map<std::string, std::size_t> node_index_;
+    ConditionCache conditions_;
+    std::vector<ConditionCache::Id> choice_conditions_; // Current node's, for refresh
+
+    DialogueStep step_;
+    std::size_t node_ = 0;
+    std::int64_t now_ms_ = 0;
+    std::int64_t entered_at_ms_ = 0;
+    Wait wait_ = Wait::NONE;
+    DialogueStepAwaitable* waiting_ = nullptr; // Suspended awaitable, resumed by tick
+
+    std::unordered_set<const Choice*> chosen_once_;
+    std::unordered_map<const Choice*, std::int64_t> cooldown_until_ms_;
+};
+
+// Recycles coroutine frames per thread in 64-byte size classes, so starting
+// a script usually reuses the frame of one that finished
+class GOETHE_API CoroutineFramePool {
+public:
+    struct Stats {
+        std::uint64_t allocated = 0; // Frames taken from the heap
+        std::uint64_t reused = 0;    // Frames taken from the free lists
+    };
+
+    static void* allocate(std::size_t size);
+    static void deallocate(void* frame, std::size_t size) noexcept;
+    static Stats thread_stats(); // Calling thread only
+};
+
+// Return type for host scripts that co_await a DialogueRunner. The script
+// runs eagerly up to its first suspension and is then resumed by tick. An
+// exception escaping the script is kept for rethrow_if_failed. Destroying a
+// suspended script detaches it from its runner.
+class GOETHE_API DialogueScript {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+
+        DialogueScript get_return_object() {
+            return DialogueScript(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            error = std::current_exception();
+        }
+
+        static void* operator new(std::size_t size) {
+            return CoroutineFramePool::allocate(size);
+        }
+        static void operator delete(void* frame, std::size_t size) noexcept {
+            CoroutineFramePool::deallocate(frame, size);
+        }
+    };
+
+    DialogueScript(DialogueScript&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    DialogueScript& operator=(DialogueScript&& other) noexcept;
+    DialogueScript(const DialogueScript&) = delete;
+    DialogueScript& operator=(const DialogueScript&) = delete;
+    ~DialogueScript();
+
+    bool done() const {
+        return !handle_ || handle_.done();
+    }
+    void rethrow_if_failed() const;
+
+private:
+    explicit DialogueScript(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+} // namespace goethe
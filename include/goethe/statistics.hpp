@@ -1,9 +1,13 @@
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 #include <atomic>
@@ -26,6 +30,7 @@ struct OperationStats {
     Duration duration{};              // Operation duration
     bool success = false;             // Whether operation succeeded
     std::string error_message;       // Error message if failed
+    std::size_t operation_count = 1; // Buffers covered; batches record once for all
     
     // Calculated metrics
     double compression_ratio() const;     // output_size / input_size (0.0 = perfect compression)
@@ -57,11 +62,27 @@ struct BackendStats {
     std::atomic<std::uint64_t> total_compression_time_ns{0};
     std::atomic<std::uint64_t> total_decompression_time_ns{0};
     
+    // Compressions skipped because the input looked incompressible (see
+    // compressibility.hpp), and the time they would have taken
+    std::atomic<std::uint64_t> skipped_compressions{0};
+    std::atomic<std::uint64_t> skipped_input_size{0};
+    std::atomic<std::uint64_t> saved_compression_time_ns{0};
+    
+    // Latency histograms. Bucket i counts operations that took at most
+    // latency_bucket_bounds_ns[i]; the extra last bucket counts the rest.
+    static constexpr std::array<std::uint64_t, 22> latency_bucket_bounds_ns = {
+        1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000, 250'000, 500'000,
+        1'000'000, 2'500'000, 5'000'000, 10'000'000, 25'000'000, 50'000'000, 100'000'000,
+        250'000'000, 500'000'000, 1'000'000'000, 2'500'000'000, 5'000'000'000, 10'000'000'000};
+    static constexpr std::size_t latency_bucket_count = latency_bucket_bounds_ns.size() + 1;
+    std::array<std::atomic<std::uint64_t>, latency_bucket_count> compression_latency_buckets{};
+    std::array<std::atomic<std::uint64_t>, latency_bucket_count> decompression_latency_buckets{};
+    
     // Constructors
     BackendStats() = default;
-    BackendStats(const BackendStats& other);
+    GOETHE_API BackendStats(const BackendStats& other);
     BackendStats(BackendStats&& other) = default;
-    BackendStats& operator=(const BackendStats& other);
+    GOETHE_API BackendStats& operator=(const BackendStats& other);
     BackendStats& operator=(BackendStats&& other) = default;
     
     // Performance metrics
@@ -75,8 +96,96 @@ struct BackendStats {
     GOETHE_API void reset();
 };
 
-// Global statistics manager
-class StatisticsManager {
+// Rolling window lengths tracked for every backend
+enum class StatsWindow {
+    ONE_SECOND,
+    TEN_SECONDS,
+    ONE_MINUTE
+};
+
+// Activity within a rolling window. Rates are per wall-clock second.
+struct WindowStats {
+    StatsWindow window = StatsWindow::ONE_SECOND;
+    double elapsed_seconds = 0.0;    // Time actually covered, shorter right after startup or reset
+    std::uint64_t compressions = 0;
+    std::uint64_t decompressions = 0;
+    std::uint64_t failed_operations = 0;
+    std::uint64_t compression_input_size = 0;
+    std::uint64_t compressed_size = 0;
+    std::uint64_t decompressed_size = 0;
+    
+    GOETHE_API double operations_per_second() const;
+    GOETHE_API double compression_throughput_mbps() const;
+    GOETHE_API double decompression_throughput_mbps() const;
+    GOETHE_API double compression_ratio() const;   // compressed_size / compression_input_size
+    GOETHE_API double error_rate() const;          // Percentage of failed operations
+};
+
+// 1 s, 10 s and 60 s windows, each a ring of ten time buckets. Recording is
+// lock-free: the first writer to reach a stale bucket claims it with a CAS
+// on its epoch and clears it. An operation recorded by another thread during
+// that instant can be lost, which is acceptable for monitoring.
+class GOETHE_API RollingWindows {
+public:
+    static constexpr std::size_t bucket_count = 10;
+    
+    RollingWindows();
+    
+    void record_compression(const OperationStats& stats, std::uint64_t now_ns);
+    void record_decompression(const OperationStats& stats, std::uint64_t now_ns);
+    WindowStats get(StatsWindow window, std::uint64_t now_ns) const;
+    void reset(std::uint64_t now_ns);
+    
+    static std::uint64_t now_ns(); // Steady clock
+    
+private:
+    struct Bucket {
+        std::atomic<std::uint64_t> epoch{0}; // Bucket period index plus one; zero means unused
+        std::atomic<std::uint64_t> compressions{0};
+        std::atomic<std::uint64_t> decompressions{0};
+        std::atomic<std::uint64_t> failed_operations{0};
+        std::atomic<std::uint64_t> compression_input_size{0};
+        std::atomic<std::uint64_t> compressed_size{0};
+        std::atomic<std::uint64_t> decompressed_size{0};
+    };
+    using Ring = std::array<Bucket, bucket_count>;
+    
+    static std::uint64_t bucket_width_ns(StatsWindow window);
+    static Bucket* claim(Ring& ring, std::uint64_t width_ns, std::uint64_t now_ns);
+    
+    std::array<Ring, 3> rings_;
+    std::atomic<std::uint64_t> start_ns_{0};
+};
+
+// Interned content category for statistics, such as "dialogue", "voice" or
+// "save". Statistics are kept per backend and, within each, per tag.
+using StatsTag = std::uint16_t;
+inline constexpr StatsTag NO_STATS_TAG = 0;
+inline constexpr std::size_t MAX_STATS_TAGS = 64; // Including NO_STATS_TAG
+
+// What a tracked block of memory belongs to
+enum class MemoryCategory {
+    DIALOGUE,            // Loaded Dialogue graphs
+    COMPRESSION_CONTEXT, // Compressor/decompressor state such as zstd contexts
+    DICTIONARY,          // Compression dictionaries
+    CACHE,
+    PACKAGE              // Mapped or loaded package data
+};
+
+GOETHE_API const char* memory_category_name(MemoryCategory category);
+
+// One tracked object in a memory breakdown
+struct MemoryUsage {
+    MemoryCategory category = MemoryCategory::CACHE;
+    std::string name;
+    std::size_t bytes = 0;
+};
+
+class MemoryAccount;
+
+// Global statistics manager. Recording is lock-free once a backend has been
+// seen; the mutex only guards registering new backends and tags.
+class GOETHE_API StatisticsManager {
 public:
     // Singleton pattern
     static StatisticsManager& instance();
@@ -85,11 +194,19 @@ public:
     void enable_statistics(bool enable = true);
     bool is_statistics_enabled() const;
     
+    // Tags. Interning the same name returns the same tag; throws
+    // std::runtime_error once MAX_STATS_TAGS names are in use.
+    StatsTag intern_tag(const std::string& name);
+    std::string get_tag_name(StatsTag tag) const;
+    
     // Record operations
     void record_compression(const std::string& backend_name, const std::string& backend_version,
-                          const OperationStats& stats);
+                          const OperationStats& stats, StatsTag tag = NO_STATS_TAG);
     void record_decompression(const std::string& backend_name, const std::string& backend_version,
-                            const OperationStats& stats);
+                            const OperationStats& stats, StatsTag tag = NO_STATS_TAG);
+    // Input the backend was spared, and an estimate of its time for it
+    void record_skipped_compression(const std::string& backend_name, const std::string& backend_version,
+                                    std::size_t input_size, Duration saved, StatsTag tag = NO_STATS_TAG);
     
     // Get statistics
     BackendStats get_backend_stats(const std::string& backend_name) const;
@@ -98,6 +215,19 @@ public:
     // Get global statistics
     BackendStats get_global_stats() const;
     
+    // Per-tag statistics; backend_name and backend_version are those of the backend
+    BackendStats get_tag_stats(const std::string& backend_name, StatsTag tag) const;
+    BackendStats get_global_tag_stats(StatsTag tag) const;
+    
+    // Rolling window statistics
+    WindowStats get_window_stats(const std::string& backend_name, StatsWindow window) const;
+    WindowStats get_global_window_stats(StatsWindow window) const;
+    
+    // Memory gauges, fed by MemoryAccount. Totals are live bytes, not peaks.
+    std::size_t get_memory_usage(MemoryCategory category) const;
+    std::size_t get_total_memory_usage() const;
+    std::vector<MemoryUsage> get_memory_breakdown() const; // Largest first
+    
     // Reset statistics
     void reset_backend_stats(const std::string& backend_name);
     void reset_all_stats();
@@ -105,6 +235,7 @@ public:
     // Export statistics
     std::string export_json() const;
     std::string export_csv() const;
+    std::string export_openmetrics() const; // OpenMetrics text format, as scraped by Prometheus
     
     // Utility methods for timing
     class Timer {
@@ -127,15 +258,103 @@ public:
     };
 
 private:
-    StatisticsManager() = default;
+    friend class MemoryAccount;
+    
+    StatisticsManager();
     ~StatisticsManager() = default;
     StatisticsManager(const StatisticsManager&) = delete;
     StatisticsManager& operator=(const StatisticsManager&) = delete;
     
+    struct BackendSlot {
+        BackendStats stats;
+        RollingWindows windows;
+        // Allocated on a tag's first use and published with a CAS
+        std::array<std::atomic<BackendStats*>, MAX_STATS_TAGS> tags{};
+        
+        BackendSlot() = default;
+        ~BackendSlot();
+        BackendSlot(const BackendSlot&) = delete;
+        BackendSlot& operator=(const BackendSlot&) = delete;
+        
+        BackendStats& tag_stats(StatsTag tag);
+        void reset(std::uint64_t now_ns);
+    };
+    
+    struct SlotSnapshot {
+        BackendStats stats;
+        std::vector<std::pair<std::string, BackendStats>> tags; // By tag name, in tag order
+    };
+    
+    BackendSlot& backend_slot(const std::string& backend_name, const std::string& backend_version);
+    const BackendSlot* find_slot(const std::string& backend_name) const;
+    SlotSnapshot snapshot_slot(const BackendSlot& slot, const std::vector<std::string>& tag_names) const;
+    std::vector<SlotSnapshot> snapshot_backends() const;
+    SlotSnapshot snapshot_global() const;
+    
+    mutable std::mutex mutex_;
+    std::atomic<bool> enabled_{true};
+    // Entries are never erased, so slot pointers stay valid for recording threads
+    std::unordered_map<std::string, std::unique_ptr<BackendSlot>> backend_stats_;
+    BackendSlot global_;
+    std::vector<std::string> tag_names_; // Indexed by tag; guarded by mutex_
+    
+    struct MemoryEntry {
+        MemoryCategory category;
+        std::string name;
+        std::atomic<std::size_t> bytes{0};
+    };
+    
+    MemoryEntry* add_memory_entry(MemoryCategory category, const std::string& name, std::size_t bytes);
+    void remove_memory_entry(MemoryEntry* entry);
+    
+    mutable std::mutex memory_mutex_;
+    std::vector<std::unique_ptr<MemoryEntry>> memory_entries_;
+};
+
+// Registers a block of memory with StatisticsManager for as long as the
+// account lives. Owners call update() when their footprint changes; updates
+// are a single atomic store.
+class GOETHE_API MemoryAccount {
+public:
+    MemoryAccount() = default;
+    MemoryAccount(MemoryCategory category, const std::string& name, std::size_t bytes = 0);
+    ~MemoryAccount();
+    MemoryAccount(const MemoryAccount&) = delete;
+    MemoryAccount& operator=(const MemoryAccount&) = delete;
+    MemoryAccount(MemoryAccount&& other) noexcept;
+    MemoryAccount& operator=(MemoryAccount&& other) noexcept;
+    
+    void update(std::size_t bytes);
+    std::size_t bytes() const;
+    bool is_registered() const { return entry_ != nullptr; }
+    
+private:
+    StatisticsManager::MemoryEntry* entry_ = nullptr;
+};
+
+// Rewrites a file with export_openmetrics() on an interval, for the
+// node_exporter textfile collector or anything else that scrapes files.
+// Each write goes through a temporary file and a rename, so readers never
+// see a partial export.
+class GOETHE_API OpenMetricsFileSink {
+public:
+    OpenMetricsFileSink(std::string path, std::chrono::milliseconds interval);
+    ~OpenMetricsFileSink();
+    OpenMetricsFileSink(const OpenMetricsFileSink&) = delete;
+    OpenMetricsFileSink& operator=(const OpenMetricsFileSink&) = delete;
+    
+    void start();
+    void stop(); // Writes a final export before returning
+    bool is_running() const;
+    bool write_now();
+    
+private:
+    std::string path_;
+    std::chrono::milliseconds interval_;
+    std::thread thread_;
     mutable std::mutex mutex_;
-    bool enabled_ = true;
-    std::unordered_map<std::string, BackendStats> backend_stats_;
-    BackendStats global_stats_;
+    std::condition_variable wake_;
+    bool running_ = false;
 };
 
 // Convenience functions
@@ -160,7 +379,8 @@ inline OperationStats create_operation_stats(std::size_t input_size, std::size_t
 // RAII wrapper for automatic statistics recording
 class StatisticsScope {
 public:
-    StatisticsScope(const std::string& backend_name, const std::string& backend_version, bool is_compression);
+    StatisticsScope(const std::string& backend_name, const std::string& backend_version, bool is_compression,
+                    StatsTag tag = NO_STATS_TAG);
     ~StatisticsScope();
     
     void set_sizes(std::size_t input_size, std::size_t output_size);
@@ -170,6 +390,7 @@ private:
     std::string backend_name_;
     std::string backend_version_;
     bool is_compression_;
+    StatsTag tag_;
     StatisticsManager::Timer timer_;
     std::size_t input_size_ = 0;
     std::size_t output_size_ = 0;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Include the header that defines GOETHE_API
+#include "goethe/dialog.hpp"
+
+namespace goethe {
+
+// Fixed set of worker threads running queued tasks in FIFO order. Backs the
+// batch compression API; tasks should not throw.
+class GOETHE_API ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads = default_thread_count());
+    ~ThreadPool(); // Runs the tasks still queued, then joins
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // One thread per core, minus the caller that joins in parallel_for
+    static std::size_t default_thread_count();
+
+    std::size_t size() const {
+        return workers_.size();
+    }
+
+    void submit(std::function<void()> task);
+
+    // Calls body(slot, index) for every index in [0, count). The calling
+    // thread takes part, together with up to max_helpers pool threads, and
+    // returns once all indices are done. Slots are in [0, helpers] and
+    // unique among participants running at the same time, so they can pick
+    // per-thread state. The first exception thrown by body is rethrown here
+    // after the remaining indices are skipped.
+    using IndexedTask = std::function<void(std::size_t slot, std::size_t index)>;
+    void parallel_for(std::size_t count, const IndexedTask& body,
+                      std::size_t max_helpers = std::numeric_limits<std::size_t>::max());
+
+private:
+    void run_worker();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool stopping_ = false;
+};
+
+} // namespace goethe
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Include the header that defines GOETHE_API
+#include "goethe/dialog.hpp"
+
+namespace goethe {
+
+// A completed span. Names and categories must be string literals (or
+// otherwise outlive the tracer) so recording never allocates.
+struct TraceEvent {
+    const char* name = nullptr;
+    const char* category = nullptr;
+    std::uint64_t start_ns = 0;    // Steady clock, nanoseconds
+    std::uint64_t duration_ns = 0;
+};
+
+// Events recorded by one thread, oldest first
+struct TraceThread {
+    std::uint32_t thread_id = 0;   // Tracer-assigned, stable for the thread's lifetime
+    std::string thread_name;
+    std::uint64_t dropped_events = 0; // Overwritten because the ring buffer was full
+    std::vector<TraceEvent> events;
+};
+
+struct TraceSnapshot {
+    std::vector<TraceThread> threads;
+
+    GOETHE_API std::size_t event_count() const;
+};
+
+// Records spans into per-thread ring buffers. Disabled by default; when
+// disabled a TraceScope costs one relaxed atomic load.
+class GOETHE_API TraceManager {
+public:
+    // Singleton pattern
+    static TraceManager& instance();
+
+    // Enable/disable tracing
+    void enable_tracing(bool enable = true);
+    bool is_tracing_enabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Ring buffer size per thread; discards buffered events
+    void set_buffer_capacity(std::size_t events_per_thread);
+    std::size_t get_buffer_capacity() const;
+
+    // Name the calling thread in exported traces
+    void set_thread_name(const std::string& name);
+
+    // Record a span on the calling thread
+    void record(const char* name, const char* category, std::uint64_t start_ns, std::uint64_t end_ns);
+
+    // Copy all buffered events without stopping recording
+    TraceSnapshot snapshot() const;
+    void clear();
+
+    // Export formats
+    std::string export_chrome_json() const;
+    std::string export_perfetto() const; // Serialized perfetto.protos.Trace
+    static std::string export_chrome_json(const TraceSnapshot& snapshot);
+    static std::string export_perfetto(const TraceSnapshot& snapshot);
+
+    // Current time on the tracer clock
+    static std::uint64_t now_ns();
+
+private:
+    struct ThreadBuffer;
+
+    TraceManager() = default;
+    ~TraceManager() = default;
+    TraceManager(const TraceManager&) = delete;
+    TraceManager& operator=(const TraceManager&) = delete;
+
+    ThreadBuffer& local_buffer();
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<std::size_t> capacity_{16384};
+    mutable std::mutex registry_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    std::uint32_t next_thread_id_ = 1;
+};
+
+// RAII span, recorded when the scope exits if tracing was enabled on entry
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category)
+        : name_(name), category_(category),
+          start_ns_(TraceManager::instance().is_tracing_enabled() ? TraceManager::now_ns() : 0),
+          active_(start_ns_ != 0) {}
+
+    ~TraceScope() {
+        if (active_) {
+            TraceManager::instance().record(name_, category_, start_ns_, TraceManager::now_ns());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    std::uint64_t start_ns_;
+    bool active_;
+};
+
+} // namespace goethe
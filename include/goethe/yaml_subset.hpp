@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "goethe/cpu_dispatch.hpp"
+#include "goethe/dialog.hpp"
+
+namespace goethe {
+
+// Offsets of the bytes the GOETHE YAML subset treats as structural: line
+// breaks, tabs, ':', '#', quotes, backslashes, ',' and flow brackets.
+// Scans 64 bytes per step at the active CPU tier. Replaces the contents of
+// positions.
+GOETHE_API void index_yaml_structure(std::string_view text, std::pmr::vector<std::uint32_t>& positions);
+GOETHE_API CpuTier yaml_scan_tier(); // Tier of the scanner in use
+
+// Reads a dialogue written in the subset of YAML that GOETHE files use: block
+// maps and sequences, flow maps and sequences, and single-line plain and
+// quoted scalars. Returns nullopt, without throwing, for anything else
+// (anchors, tags, block or multi-line scalars, several documents, values
+// that might not convert the way yaml-cpp converts them, and every error),
+// so the caller can hand the document to yaml-cpp. A returned dialogue is
+// the same as from_yaml(YAML::Load(yaml)) would give.
+GOETHE_API std::optional<Dialogue> read_dialogue_subset(std::string_view yaml);
+
+} // namespace goethe
@@ -20,12 +20,21 @@ public:
     std::vector<uint8_t> compress(const uint8_t* data, std::size_t size) override;
     std::vector<uint8_t> decompress(const uint8_t* data, std::size_t size) override;
 
+    // Caller-provided output; decompressed_size reads the frame header
+    std::optional<std::size_t> compress_bound(std::size_t size) const override;
+    std::optional<std::size_t> decompressed_size(const uint8_t* data, std::size_t size) const override;
+    std::size_t compress_into(const uint8_t* data, std::size_t size, uint8_t* output, std::size_t capacity) override;
+    std::size_t decompress_into(const uint8_t* data, std::size_t size, uint8_t* output, std::size_t capacity) override;
+
     // Metadata
     std::string name() const override {
         return "zstd";
     }
     std::string version() const override;
     bool is_available() const override;
+    
+    // Whether zstd was compiled in; creates nothing
+    GOETHE_API static bool is_library_available();
 
     // Compression level (1-22 for zstd)
     void set_compression_level(int level) override;
@@ -44,12 +53,24 @@ public:
     void set_strategy(int strategy);
     void set_dictionary(const std::vector<uint8_t>& dictionary);
     void clear_dictionary();
+    
+    // Train a dictionary from sample payloads (ZDICT). Needs a few dozen
+    // samples totalling many times max_size; throws CompressionError otherwise.
+    GOETHE_API static std::vector<uint8_t> train_dictionary(const std::vector<std::vector<uint8_t>>& samples,
+                                                            std::size_t max_size = 112640);
 
 private:
-    // Zstd contexts
+    // Zstd contexts, created on first compress/decompress
 #ifdef GOETHE_ZSTD_AVAILABLE
     ZSTD_CCtx_s* cctx_;
     ZSTD_DCtx_s* dctx_;
+    
+    // Memory reported to StatisticsManager, registered with the contexts
+    MemoryAccount context_memory_;
+    MemoryAccount dictionary_memory_;
+    
+    ZSTD_CCtx_s* compression_context();
+    ZSTD_DCtx_s* decompression_context();
 #endif
     
     // Configuration
@@ -57,9 +78,9 @@ private:
     CompressionOptions options_;
     
     // Helper methods
-    void initialize_contexts();
     void update_compression_context();
     void update_decompression_context();
+    void update_memory_usage();
     
     // Error handling
     static void check_zstd_error(size_t result, const std::string& operation);
@@ -0,0 +1,211 @@
+#include "bench_corpus.hpp"
+#include "benchmarks.hpp"
+#include "goethe/factory.hpp"
+#include "goethe/manager.hpp"
+#include "goethe/register_backends.hpp"
+#include <benchmark/benchmark.h>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace goethe::bench {
+
+namespace {
+
+const std::vector<int64_t> kPayloadSizes = {1 << 10, 1 << 16, 1 << 20};
+
+// Payloads are expensive to build at 1 MiB, so each size is generated once
+const std::vector<uint8_t>& payload(std::size_t size) {
+    static std::map<std::size_t, std::vector<uint8_t>> cache;
+    auto it = cache.find(size);
+    if (it == cache.end()) {
+        it = cache.emplace(size, make_payload(size)).first;
+    }
+    return it->second;
+}
+
+std::unique_ptr<CompressionBackend> make_backend(const std::string& name, int level) {
+    auto backend = CompressionFactory::instance().create_backend(name);
+    backend->set_compression_level(level);
+    return backend;
+}
+
+void compress_benchmark(benchmark::State& state, const std::string& backend_name) {
+    auto backend = make_backend(backend_name, static_cast<int>(state.range(0)));
+    const auto& data = payload(static_cast<std::size_t>(state.range(1)));
+    std::size_t compressed_size = 0;
+
+    for (auto _ : state) {
+        auto compressed = backend->compress(data.data(), data.size());
+        compressed_size = compressed.size();
+        benchmark::DoNotOptimize(compressed.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(data.size()));
+    state.counters["ratio"] = static_cast<double>(compressed_size) / static_cast<double>(data.size());
+}
+
+void decompress_benchmark(benchmark::State& state, const std::string& backend_name) {
+    auto backend = make_backend(backend_name, static_cast<int>(state.range(0)));
+    const auto& data = payload(static_cast<std::size_t>(state.range(1)));
+    const auto compressed = backend->compress(data.data(), data.size());
+
+    for (auto _ : state) {
+        auto decompressed = backend->decompress(compressed.data(), compressed.size());
+        benchmark::DoNotOptimize(decompressed.data());
+    }
+    // Throughput is reported against the decompressed size, like BackendStats
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(data.size()));
+    state.counters["ratio"] = static_cast<double>(compressed.size()) / static_cast<double>(data.size());
+}
+
+// Many small entries, the shape of a package full of dialogue lines
+std::vector<std::vector<uint8_t>> small_entries(std::size_t count, std::size_t size) {
+    const auto& data = payload(static_cast<std::size_t>(kPayloadSizes.back()));
+    std::vector<std::vector<uint8_t>> entries;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto offset = (i * size) % (data.size() - size);
+        entries.emplace_back(data.begin() + offset, data.begin() + offset + size);
+    }
+    return entries;
+}
+
+constexpr std::size_t kBatchEntries = 256;
+constexpr std::size_t kBatchEntrySize = 1 << 10;
+
+void compress_loop_benchmark(benchmark::State& state, const std::string& backend_name) {
+    auto& manager = CompressionManager::instance();
+    manager.initialize(backend_name);
+    const auto entries = small_entries(kBatchEntries, kBatchEntrySize);
+
+    for (auto _ : state) {
+        for (const auto& entry : entries) {
+            auto compressed = manager.compress(entry);
+            benchmark::DoNotOptimize(compressed.data());
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kBatchEntries * kBatchEntrySize));
+}
+
+void compress_batch_benchmark(benchmark::State& state, const std::string& backend_name) {
+    auto& manager = CompressionManager::instance();
+    manager.initialize(backend_name);
+    const auto entries = small_entries(kBatchEntries, kBatchEntrySize);
+
+    for (auto _ : state) {
+        auto compressed = manager.compress_batch(entries);
+        benchmark::DoNotOptimize(compressed.data.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kBatchEntries * kBatchEntrySize));
+}
+
+void decompress_batch_benchmark(benchmark::State& state, const std::string& backend_name) {
+    auto& manager = CompressionManager::instance();
+    manager.initialize(backend_name);
+    const auto compressed = manager.compress_batch(small_entries(kBatchEntries, kBatchEntrySize));
+    std::vector<std::span<const uint8_t>> inputs;
+    for (std::size_t i = 0; i < compressed.size(); ++i) {
+        inputs.push_back(compressed[i]);
+    }
+
+    for (auto _ : state) {
+        auto decompressed = manager.decompress_batch(inputs);
+        benchmark::DoNotOptimize(decompressed.data.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kBatchEntries * kBatchEntrySize));
+}
+
+// Loading a packed dialogue: decompress, then parse. The copy path goes
+// through vectors, a string and a stream; the buffer path parses the pooled
+// decompression output in place.
+constexpr int kPackedNodes = 200;
+
+void load_packed_copy_benchmark(benchmark::State& state, const std::string& backend_name) {
+    auto& manager = CompressionManager::instance();
+    manager.initialize(backend_name);
+    const auto document = make_dialogue_yaml(kPackedNodes);
+    const auto packed = manager.compress(document);
+
+    for (auto _ : state) {
+        std::istringstream input(manager.decompress_to_string(packed));
+        auto dialogue = read_dialogue(input);
+        benchmark::DoNotOptimize(dialogue.nodes.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(document.size()));
+}
+
+void load_packed_buffer_benchmark(benchmark::State& state, const std::string& backend_name) {
+    auto& manager = CompressionManager::instance();
+    manager.initialize(backend_name);
+    const auto document = make_dialogue_yaml(kPackedNodes);
+    const BufferSlice packed = manager.compress(
+        Buffer::copy_of(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(document.data()), document.size())));
+
+    for (auto _ : state) {
+        auto dialogue = read_dialogue(manager.decompress(packed));
+        benchmark::DoNotOptimize(dialogue.nodes.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(document.size()));
+}
+
+// Already-compressed media: an envelope either pays for a futile
+// compression or only for the estimate that skips it
+void envelope_incompressible_benchmark(benchmark::State& state, const std::string& backend_name) {
+    CompressionContext context(backend_name);
+    context.set_compression_level(static_cast<int>(state.range(0)));
+    context.set_skip_incompressible(state.range(1) != 0);
+    std::vector<uint8_t> media(1 << 20);
+    std::mt19937 rng(1);
+    for (auto& byte : media) {
+        byte = static_cast<uint8_t>(rng());
+    }
+
+    for (auto _ : state) {
+        auto packed = context.compress_envelope(media.data(), media.size());
+        benchmark::DoNotOptimize(packed.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(media.size()));
+}
+
+} // namespace
+
+void register_compression_benchmarks() {
+    register_compression_backends();
+
+    // Levels worth tracking per backend; backends without levels get a single run
+    const std::map<std::string, std::vector<int64_t>> backend_levels = {
+        {"null", {0}},
+        {"zstd", {1, 3, 6, 9, 19}},
+    };
+
+    for (const auto& [name, levels] : backend_levels) {
+        if (!CompressionFactory::instance().is_backend_available(name)) {
+            continue; // Not built into this library
+        }
+
+        benchmark::RegisterBenchmark(("BM_Compress/" + name).c_str(), compress_benchmark, name)
+            ->ArgsProduct({levels, kPayloadSizes})
+            ->ArgNames({"level", "size"});
+        benchmark::RegisterBenchmark(("BM_Decompress/" + name).c_str(), decompress_benchmark, name)
+            ->ArgsProduct({levels, kPayloadSizes})
+            ->ArgNames({"level", "size"});
+
+        // 256 x 1 KiB entries, one call each versus one batch
+        benchmark::RegisterBenchmark(("BM_CompressLoop/" + name).c_str(), compress_loop_benchmark, name);
+        benchmark::RegisterBenchmark(("BM_CompressBatch/" + name).c_str(), compress_batch_benchmark, name);
+        benchmark::RegisterBenchmark(("BM_DecompressBatch/" + name).c_str(), decompress_batch_benchmark, name);
+
+        benchmark::RegisterBenchmark(("BM_LoadPackedCopy/" + name).c_str(), load_packed_copy_benchmark, name);
+        benchmark::RegisterBenchmark(("BM_LoadPackedBuffer/" + name).c_str(), load_packed_buffer_benchmark, name);
+
+        if (name != "null") {
+            benchmark::RegisterBenchmark(("BM_EnvelopeIncompressible/" + name).c_str(),
+                                         envelope_incompressible_benchmark, name)
+                ->ArgsProduct({{levels.front(), levels.back()}, {0, 1}})
+                ->ArgNames({"level", "skip"});
+        }
+    }
+}
+
+} // namespace goethe::bench
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "corpus_generator.hpp"
+#include "goethe/dialog.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace goethe::bench {
+
+// Corpus shapes shared by all benchmarks. Changing them changes what every
+// benchmark measures, so stored baselines must be regenerated afterwards.
+inline corpus::CorpusOptions dialogue_options(int node_count, int condition_depth = 2) {
+    corpus::CorpusOptions options;
+    options.node_count = node_count;
+    options.condition_depth = condition_depth;
+    return options;
+}
+
+inline Dialogue make_dialogue(int node_count, int condition_depth = 2) {
+    return corpus::generate_dialogue(dialogue_options(node_count, condition_depth), "bench_dialogue");
+}
+
+inline std::string make_dialogue_yaml(int node_count, int condition_depth = 2) {
+    return corpus::generate_dialogue_yaml(dialogue_options(node_count, condition_depth), "bench_dialogue");
+}
+
+inline std::string make_dialogue_json(int node_count, int condition_depth = 2) {
+    return corpus::generate_dialogue_json(dialogue_options(node_count, condition_depth), "bench_dialogue");
+}
+
+// Every choice and variant gated, to isolate the cost of condition trees
+inline std::string make_condition_heavy_yaml(int node_count, int condition_depth) {
+    auto options = dialogue_options(node_count, condition_depth);
+    options.condition_probability = 1.0;
+    return corpus::generate_dialogue_yaml(options, "bench_conditions");
+}
+
+// Exactly `size` bytes of dialogue YAML, which is what Goethe actually
+// compresses in packages and saves
+inline std::vector<uint8_t> make_payload(std::size_t size) {
+    return corpus::generate_payload(corpus::CorpusOptions{}, size);
+}
+
+} // namespace goethe::bench
@@ -0,0 +1,284 @@
+#include "bench_corpus.hpp"
+#include "goethe/cpu_dispatch.hpp"
+#include "goethe/dialog.hpp"
+#include "goethe/runner.hpp"
+#include "goethe/yaml_subset.hpp"
+#include <benchmark/benchmark.h>
+#include <yaml-cpp/yaml.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void BM_ReadDialogue(benchmark::State& state) {
+    const std::string yaml = goethe::bench::make_dialogue_yaml(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        std::istringstream stream(yaml);
+        auto dialogue = goethe::read_dialogue(stream);
+        benchmark::DoNotOptimize(dialogue);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(yaml.size()));
+}
+BENCHMARK(BM_ReadDialogue)->ArgName("nodes")->RangeMultiplier(4)->Range(16, 1024);
+
+// The same dialogues through yaml-cpp, the path read_dialogue falls back to
+// when the subset reader declines
+void BM_ReadDialogueYamlCpp(benchmark::State& state) {
+    const std::string yaml = goethe::bench::make_dialogue_yaml(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        goethe::Dialogue dialogue;
+        goethe::from_yaml(YAML::Load(yaml), dialogue);
+        benchmark::DoNotOptimize(dialogue);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(yaml.size()));
+}
+BENCHMARK(BM_ReadDialogueYamlCpp)->ArgName("nodes")->RangeMultiplier(4)->Range(16, 1024);
+
+// The structural index alone, once per CPU tier (0 scalar, 1 SSE4.2,
+// 2 AVX2, 3 AVX-512). The label names the scanner that ran.
+void BM_IndexYamlStructure(benchmark::State& state) {
+    const std::string yaml = goethe::bench::make_dialogue_yaml(1024);
+    const auto tier = static_cast<goethe::CpuTier>(state.range(0));
+    if (tier > goethe::detected_cpu_tier()) {
+        state.SkipWithError("CPU lacks this tier");
+        return;
+    }
+    goethe::ScopedCpuTierLimit limit(tier);
+
+    std::pmr::vector<std::uint32_t> positions;
+    for (auto _ : state) {
+        goethe::index_yaml_structure(yaml, positions);
+        benchmark::DoNotOptimize(positions.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(yaml.size()));
+    state.SetLabel(goethe::to_string(goethe::yaml_scan_tier()));
+}
+BENCHMARK(BM_IndexYamlStructure)->ArgName("tier")->DenseRange(0, 3);
+
+// The same dialogues as BM_ReadDialogue, serialized as JSON
+void BM_ReadDialogueJson(benchmark::State& state) {
+    const std::string json = goethe::bench::make_dialogue_json(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        auto dialogue = goethe::read_dialogue_json(json);
+        benchmark::DoNotOptimize(dialogue);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(json.size()));
+}
+BENCHMARK(BM_ReadDialogueJson)->ArgName("nodes")->RangeMultiplier(4)->Range(16, 1024);
+
+// JSON through read_dialogue: format detection plus buffering the stream
+void BM_ReadDialogueJsonDetected(benchmark::State& state) {
+    const std::string json = goethe::bench::make_dialogue_json(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        std::istringstream stream(json);
+        auto dialogue = goethe::read_dialogue(stream);
+        benchmark::DoNotOptimize(dialogue);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(json.size()));
+}
+BENCHMARK(BM_ReadDialogueJsonDetected)->ArgName("nodes")->RangeMultiplier(4)->Range(16, 1024);
+
+// No condition evaluator exists yet, so this measures the cost conditions add
+// to loading: parsing and building nested Condition trees of growing depth.
+void BM_ReadDialogueConditions(benchmark::State& state) {
+    const std::string yaml = goethe::bench::make_condition_heavy_yaml(256, static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        std::istringstream stream(yaml);
+        auto dialogue = goethe::read_dialogue(stream);
+        benchmark::DoNotOptimize(dialogue);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(yaml.size()));
+}
+BENCHMARK(BM_ReadDialogueConditions)->ArgName("depth")->DenseRange(1, 4);
+
+void BM_WriteDialogue(benchmark::State& state) {
+    const auto dialogue = goethe::bench::make_dialogue(static_cast<int>(state.range(0)));
+    std::size_t bytes = 0;
+
+    for (auto _ : state) {
+        std::ostringstream stream;
+        goethe::write_dialogue(stream, dialogue);
+        bytes = stream.str().size();
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_WriteDialogue)->ArgName("nodes")->RangeMultiplier(4)->Range(16, 1024);
+
+// The previous write path: build a YAML::Node tree with to_yaml, then stream
+// it. Produces the same bytes as BM_WriteDialogue, kept for comparison.
+void BM_WriteDialogueNodeTree(benchmark::State& state) {
+    const auto dialogue = goethe::bench::make_dialogue(static_cast<int>(state.range(0)));
+    std::size_t bytes = 0;
+
+    for (auto _ : state) {
+        std::ostringstream stream;
+        stream << goethe::to_yaml(dialogue);
+        bytes = stream.str().size();
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_WriteDialogueNodeTree)->ArgName("nodes")->RangeMultiplier(4)->Range(16, 1024);
+
+// Takes the first enabled choice until the dialogue ends, for at most 32 steps
+goethe::DialogueScript play_first_choices(goethe::DialogueRunner& runner) {
+    auto step = co_await runner.next();
+    for (int steps = 0; steps < 32 && step.state != goethe::DialogueState::COMPLETED; ++steps) {
+        const goethe::Choice* pick = nullptr;
+        for (const auto& view : step.choices) {
+            if (view.enabled) {
+                pick = view.choice;
+                break;
+            }
+        }
+        step = pick ? co_await runner.choose(pick->id) : co_await runner.next();
+    }
+}
+
+// Many conversations driven as coroutines and ticked like a server frame loop
+void BM_RunDialogueScripts(benchmark::State& state) {
+    const auto dialogue = goethe::bench::make_dialogue(64);
+    const auto conversations = static_cast<std::size_t>(state.range(0));
+    goethe::WorldState world;
+
+    for (auto _ : state) {
+        std::vector<std::unique_ptr<goethe::DialogueRunner>> runners;
+        std::vector<goethe::DialogueScript> scripts;
+        runners.reserve(conversations);
+        scripts.reserve(conversations);
+        for (std::size_t i = 0; i < conversations; ++i) {
+            runners.push_back(std::make_unique<goethe::DialogueRunner>(dialogue, world, nullptr,
+                                                                       static_cast<std::uint32_t>(i)));
+            scripts.push_back(play_first_choices(*runners.back()));
+        }
+        for (int frame = 0; frame < 64; ++frame) {
+            for (auto& runner : runners) {
+                runner->tick(16);
+            }
+        }
+        benchmark::DoNotOptimize(scripts.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * conversations));
+}
+BENCHMARK(BM_RunDialogueScripts)->ArgName("conversations")->RangeMultiplier(8)->Range(8, 4096);
+
+// A HUD-style node with gated choices re-checked every frame while an
+// unrelated variable changes. Argument 0 re-evaluates every condition tree,
+// argument 1 uses DialogueRunner::refresh.
+goethe::Dialogue make_hud_dialogue(int choices) {
+    goethe::Dialogue dialogue;
+    dialogue.id = "hud";
+    goethe::Node hub;
+    hub.id = "hub";
+    for (int i = 0; i < choices; ++i) {
+        goethe::Choice choice;
+        choice.id = "choice_" + std::to_string(i);
+        choice.to = "hub";
+        goethe::Condition flag{goethe::Condition::Type::FLAG, "unlocked_" + std::to_string(i), std::string{}, {}};
+        goethe::Condition var{goethe::Condition::Type::VAR, "rank", std::string("captain"), {}};
+        choice.conditions = goethe::Condition{goethe::Condition::Type::ANY, "", std::string{}, {flag, var}};
+        hub.choices.push_back(std::move(choice));
+    }
+    dialogue.nodes.push_back(std::move(hub));
+    return dialogue;
+}
+
+void BM_RecheckChoices(benchmark::State& state) {
+    const auto dialogue = make_hud_dialogue(16);
+    goethe::WorldState world;
+    world.set_flag("unlocked_3");
+    goethe::DialogueRunner runner(dialogue, world);
+    runner.next();
+    const bool use_refresh = state.range(0) != 0;
+    int frame = 0;
+
+    for (auto _ : state) {
+        world.set_var("clock", std::to_string(frame++ & 7));
+        if (use_refresh) {
+            benchmark::DoNotOptimize(runner.refresh());
+        } else {
+            int enabled = 0;
+            for (const auto& choice : dialogue.nodes[0].choices) {
+                enabled += goethe::evaluate(*choice.conditions, world);
+            }
+            benchmark::DoNotOptimize(enabled);
+        }
+    }
+}
+BENCHMARK(BM_RecheckChoices)->ArgName("refresh")->Arg(0)->Arg(1);
+
+// One gate, (quest_done AND NOT hostile) OR rank == "captain", checked for a
+// crowd of actors
+goethe::Condition make_crowd_condition() {
+    using Type = goethe::Condition::Type;
+    goethe::Condition done{Type::FLAG, "quest_done", std::string{}, {}};
+    goethe::Condition hostile{Type::FLAG, "hostile", std::string{}, {}};
+    goethe::Condition calm{Type::NOT, "", std::string{}, {hostile}};
+    goethe::Condition rank{Type::VAR, "rank", std::string("captain"), {}};
+    goethe::Condition both{Type::ALL, "", std::string{}, {done, calm}};
+    return goethe::Condition{Type::ANY, "", std::string{}, {both, rank}};
+}
+
+const char* crowd_rank(std::size_t actor) {
+    static const char* const ranks[] = {"recruit", "sergeant", "captain"};
+    return ranks[actor % 3];
+}
+
+// Batch evaluation over a WorldStateBlock, once per CPU tier as in
+// BM_IndexYamlStructure
+void BM_EvaluateBatch(benchmark::State& state) {
+    const auto actors = static_cast<std::size_t>(state.range(0));
+    const goethe::CompiledCondition condition(make_crowd_condition());
+    goethe::WorldStateBlock block(actors);
+    for (std::size_t i = 0; i < actors; ++i) {
+        block.set_flag(i, "quest_done", i % 2 == 0);
+        block.set_flag(i, "hostile", i % 5 == 0);
+        block.set_var(i, "rank", crowd_rank(i));
+    }
+    const auto tier = static_cast<goethe::CpuTier>(state.range(1));
+    if (tier > goethe::detected_cpu_tier()) {
+        state.SkipWithError("CPU lacks this tier");
+        return;
+    }
+    goethe::ScopedCpuTierLimit limit(tier);
+
+    for (auto _ : state) {
+        auto bits = goethe::evaluate_batch(condition, block);
+        benchmark::DoNotOptimize(bits.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * actors));
+    state.SetLabel(goethe::to_string(goethe::batch_tier()));
+}
+BENCHMARK(BM_EvaluateBatch)->ArgNames({"actors", "tier"})->ArgsProduct({{1024, 8192, 65536}, {0, 1, 2, 3}});
+
+// The same crowd as one WorldState per actor, evaluated one at a time
+void BM_EvaluatePerActor(benchmark::State& state) {
+    const auto actors = static_cast<std::size_t>(state.range(0));
+    const goethe::CompiledCondition condition(make_crowd_condition());
+    std::vector<goethe::WorldState> worlds(actors);
+    for (std::size_t i = 0; i < actors; ++i) {
+        worlds[i].set_flag("quest_done", i % 2 == 0);
+        worlds[i].set_flag("hostile", i % 5 == 0);
+        worlds[i].set_var("rank", crowd_rank(i));
+    }
+
+    for (auto _ : state) {
+        std::size_t passed = 0;
+        for (const auto& world : worlds) {
+            passed += condition.evaluate(world);
+        }
+        benchmark::DoNotOptimize(passed);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * actors));
+}
+BENCHMARK(BM_EvaluatePerActor)->ArgName("actors")->Arg(1024)->Arg(8192)->Arg(65536);
+
+} // namespace
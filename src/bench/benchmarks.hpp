@@ -0,0 +1,9 @@
+#pragma once
+
+namespace goethe::bench {
+
+// Benchmarks that depend on runtime state (e.g. which compression backends
+// are available) are registered from main instead of with BENCHMARK().
+void register_compression_benchmarks();
+
+} // namespace goethe::bench
@@ -0,0 +1,18 @@
+#include "benchmarks.hpp"
+#include <benchmark/benchmark.h>
+
+int main(int argc, char** argv) {
+    goethe::bench::register_compression_benchmarks();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    // Recorded in the JSON context so results can be tracked per release
+    benchmark::AddCustomContext("goethe_version", GOETHE_VERSION);
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
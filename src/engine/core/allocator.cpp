@@ -0,0 +1,89 @@
+#include "goethe/allocator.hpp"
+#include <atomic>
+#include <forward_list>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+namespace goethe {
+
+namespace {
+
+// Calls one set of hooks, or operator new when they are empty
+class HookResource : public std::pmr::memory_resource {
+public:
+    constexpr explicit HookResource(const AllocatorHooks& hooks) : hooks_(hooks) {}
+
+    const AllocatorHooks& hooks() const {
+        return hooks_;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (hooks_.allocate == nullptr) {
+            return ::operator new(bytes, std::align_val_t{alignment});
+        }
+        void* pointer = hooks_.allocate(bytes, alignment, hooks_.user_data);
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override {
+        if (hooks_.deallocate == nullptr) {
+            ::operator delete(pointer, bytes, std::align_val_t{alignment});
+        } else {
+            hooks_.deallocate(pointer, bytes, alignment, hooks_.user_data);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    AllocatorHooks hooks_;
+};
+
+// Constant-initialized, so allocations during static initialization work,
+// and never destroyed, so frees during static destruction do too
+union DefaultResource {
+    constexpr DefaultResource() : resource(AllocatorHooks{}) {}
+    ~DefaultResource() {}
+    HookResource resource;
+};
+
+constinit DefaultResource default_resource;
+constinit std::atomic<HookResource*> current{&default_resource.resource};
+
+// Every resource ever installed, since memory from any of them may still be
+// live. Never destroyed, like the default.
+std::mutex installed_mutex;
+std::forward_list<HookResource>& installed() {
+    static auto* resources = new std::forward_list<HookResource>;
+    return *resources;
+}
+
+} // anonymous namespace
+
+void set_allocator(const AllocatorHooks& hooks) {
+    if ((hooks.allocate == nullptr) != (hooks.deallocate == nullptr)) {
+        throw std::invalid_argument("Allocator hooks need both allocate and deallocate");
+    }
+    if (hooks.allocate == nullptr) {
+        current.store(&default_resource.resource, std::memory_order_release);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(installed_mutex);
+    current.store(&installed().emplace_front(hooks), std::memory_order_release);
+}
+
+AllocatorHooks get_allocator() {
+    return current.load(std::memory_order_acquire)->hooks();
+}
+
+std::pmr::memory_resource* memory_resource() {
+    return current.load(std::memory_order_acquire);
+}
+
+} // namespace goethe
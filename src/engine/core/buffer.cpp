@@ -0,0 +1,316 @@
+#include "goethe/buffer.hpp"
+#include "goethe/allocator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace goethe {
+
+// Header of a pooled allocation; the bytes follow it
+struct alignas(64) BufferBlock {
+    std::atomic<std::size_t> refs{1};
+    std::size_t capacity = 0;
+    std::size_t size_class = 0; // kClasses for blocks outside the pool
+    std::pmr::memory_resource* resource = nullptr; // Allocated from
+
+    uint8_t* bytes() {
+        return reinterpret_cast<uint8_t*>(this + 1);
+    }
+};
+
+namespace {
+
+BufferBlock* new_block(std::size_t capacity, std::size_t size_class, std::pmr::memory_resource* resource) {
+    void* memory = resource->allocate(sizeof(BufferBlock) + capacity, alignof(BufferBlock));
+    auto* block = new (memory) BufferBlock;
+    block->capacity = capacity;
+    block->size_class = size_class;
+    block->resource = resource;
+    return block;
+}
+
+void delete_block(BufferBlock* block) noexcept {
+    std::pmr::memory_resource* resource = block->resource;
+    const std::size_t bytes = sizeof(BufferBlock) + block->capacity;
+    block->~BufferBlock();
+    resource->deallocate(block, bytes, alignof(BufferBlock));
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Buffer
+// ============================================================================
+
+Buffer::Buffer(std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    block_ = BufferPool::instance().acquire(size);
+    data_ = block_->bytes();
+    size_ = size;
+    capacity_ = block_->capacity;
+}
+
+Buffer Buffer::copy_of(std::span<const uint8_t> bytes) {
+    Buffer buffer(bytes.size());
+    if (!bytes.empty()) {
+        std::memcpy(buffer.data(), bytes.data(), bytes.size());
+    }
+    return buffer;
+}
+
+Buffer::Buffer(const Buffer& other) noexcept
+    : block_(other.block_), data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+    if (block_ != nullptr) {
+        block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Buffer& Buffer::operator=(const Buffer& other) noexcept {
+    if (this != &other) {
+        Buffer copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+Buffer::Buffer(Buffer&& other) noexcept
+    : block_(std::exchange(other.block_, nullptr)), data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)), capacity_(std::exchange(other.capacity_, 0)) {}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        block_ = std::exchange(other.block_, nullptr);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+    }
+    return *this;
+}
+
+Buffer::~Buffer() {
+    release();
+}
+
+void Buffer::release() noexcept {
+    if (block_ != nullptr && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        BufferPool::instance().recycle(block_);
+    }
+    block_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+}
+
+void Buffer::resize(std::size_t size) {
+    if (size > capacity_) {
+        Buffer larger(std::max(size, capacity_ * 2));
+        if (size_ > 0) {
+            std::memcpy(larger.data(), data_, size_);
+        }
+        *this = std::move(larger);
+    }
+    size_ = size;
+}
+
+std::size_t Buffer::use_count() const {
+    return block_ == nullptr ? 0 : block_->refs.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Buffer Slice
+// ============================================================================
+
+BufferSlice::BufferSlice(Buffer buffer) : buffer_(std::move(buffer)), size_(buffer_.size()) {}
+
+BufferSlice::BufferSlice(Buffer buffer, std::size_t offset, std::size_t size)
+    : buffer_(std::move(buffer)), offset_(offset), size_(size) {
+    if (offset > buffer_.size() || size > buffer_.size() - offset) {
+        throw std::out_of_range("Buffer slice out of range");
+    }
+}
+
+BufferSlice BufferSlice::slice(std::size_t offset, std::size_t size) const {
+    if (offset > size_ || size > size_ - offset) {
+        throw std::out_of_range("Buffer slice out of range");
+    }
+    BufferSlice result;
+    result.buffer_ = buffer_;
+    result.offset_ = offset_ + offset;
+    result.size_ = size;
+    return result;
+}
+
+// ============================================================================
+// Buffer Pool
+// ============================================================================
+
+namespace {
+
+// Smallest class holding size bytes, for sizes up to kMaxBlock
+std::size_t size_class_of(std::size_t size) {
+    const std::size_t rounded = std::bit_ceil(std::max(size, BufferPool::kMinBlock));
+    return static_cast<std::size_t>(std::countr_zero(rounded) - std::countr_zero(BufferPool::kMinBlock));
+}
+
+} // anonymous namespace
+
+BufferPool& BufferPool::instance() {
+    static BufferPool instance;
+    return instance;
+}
+
+BufferPool::BufferPool() : memory_(MemoryCategory::CACHE, "buffer_pool") {}
+
+BufferPool::~BufferPool() {
+    trim();
+}
+
+BufferBlock* BufferPool::acquire(std::size_t size) {
+    const std::size_t size_class = size > kMaxBlock ? kClasses : size_class_of(size);
+    std::pmr::memory_resource* resource = memory_resource();
+    BufferBlock* block = nullptr;
+    std::vector<BufferBlock*> stale;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size_class < kClasses) {
+            auto& blocks = free_[size_class];
+            // Blocks from earlier allocator hooks are never handed out again;
+            // the first acquire that meets one releases all of the class's
+            if (!blocks.empty() && blocks.back()->resource != resource) {
+                const auto first_stale = std::partition(blocks.begin(), blocks.end(), [resource](BufferBlock* idle) {
+                    return idle->resource == resource;
+                });
+                stale.assign(first_stale, blocks.end());
+                blocks.erase(first_stale, blocks.end());
+                for (BufferBlock* idle : stale) {
+                    stats_.idle_bytes -= idle->capacity;
+                }
+            }
+            if (!blocks.empty()) {
+                block = blocks.back();
+                blocks.pop_back();
+                stats_.idle_bytes -= block->capacity;
+                ++stats_.reused;
+            }
+            if (block != nullptr || !stale.empty()) {
+                memory_.update(stats_.idle_bytes);
+            }
+        }
+        if (block == nullptr) {
+            ++stats_.allocated;
+        }
+    }
+    for (BufferBlock* idle : stale) {
+        delete_block(idle);
+    }
+    if (block != nullptr) {
+        block->refs.store(1, std::memory_order_relaxed);
+        return block;
+    }
+    const std::size_t capacity = size_class < kClasses ? kMinBlock << size_class : size;
+    return new_block(capacity, size_class, resource);
+}
+
+void BufferPool::recycle(BufferBlock* block) noexcept {
+    if (block->size_class < kClasses && block->resource == memory_resource()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stats_.idle_bytes + block->capacity <= retained_limit_) {
+            try {
+                free_[block->size_class].push_back(block);
+            } catch (const std::bad_alloc&) {
+                delete_block(block);
+                return;
+            }
+            stats_.idle_bytes += block->capacity;
+            memory_.update(stats_.idle_bytes);
+            return;
+        }
+    }
+    delete_block(block);
+}
+
+void BufferPool::set_retained_limit(std::size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retained_limit_ = bytes;
+        if (stats_.idle_bytes <= bytes) {
+            return;
+        }
+    }
+    trim();
+}
+
+std::size_t BufferPool::get_retained_limit() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retained_limit_;
+}
+
+void BufferPool::trim() {
+    std::array<std::vector<BufferBlock*>, kClasses> idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle.swap(free_);
+        stats_.idle_bytes = 0;
+        memory_.update(0);
+    }
+    for (auto& blocks : idle) {
+        for (BufferBlock* block : blocks) {
+            delete_block(block);
+        }
+    }
+}
+
+BufferPool::Stats BufferPool::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+Buffer read_file(const std::filesystem::path& path, std::size_t padding) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + path.string());
+    }
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        return read_stream(file, padding); // Not a regular file; read to the end
+    }
+    Buffer buffer(static_cast<std::size_t>(size) + padding);
+    if (size > 0 && !file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size))) {
+        throw std::runtime_error("Cannot read file: " + path.string());
+    }
+    buffer.resize(static_cast<std::size_t>(size));
+    return buffer;
+}
+
+Buffer read_stream(std::istream& input, std::size_t padding) {
+    constexpr std::size_t kChunk = 16384;
+    Buffer buffer(kChunk + padding);
+    std::size_t size = 0;
+    for (;;) {
+        const std::size_t room = buffer.size() - padding - size;
+        input.read(reinterpret_cast<char*>(buffer.data()) + size, static_cast<std::streamsize>(room));
+        size += static_cast<std::size_t>(input.gcount());
+        if (!input) {
+            break;
+        }
+        buffer.resize(buffer.size() * 2);
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+} // namespace goethe
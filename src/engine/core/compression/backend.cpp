@@ -1,4 +1,5 @@
 #include "goethe/backend.hpp"
+#include "goethe/trace.hpp"
 #include <cstring>
 
 namespace goethe {
@@ -29,6 +30,60 @@ std::vector<uint8_t> CompressionBackend::decompress_to_string(const uint8_t* dat
     return decompressed;
 }
 
+std::optional<std::size_t> CompressionBackend::compress_bound(std::size_t) const {
+    return std::nullopt;
+}
+
+std::optional<std::size_t> CompressionBackend::decompressed_size(const uint8_t*, std::size_t) const {
+    return std::nullopt;
+}
+
+std::size_t CompressionBackend::compress_into(const uint8_t* data, std::size_t size, uint8_t* output,
+                                              std::size_t capacity) {
+    auto compressed = compress(data, size);
+    if (compressed.size() > capacity) {
+        throw CompressionError("Output buffer too small for compressed data");
+    }
+    std::memcpy(output, compressed.data(), compressed.size());
+    return compressed.size();
+}
+
+std::size_t CompressionBackend::decompress_into(const uint8_t* data, std::size_t size, uint8_t* output,
+                                                std::size_t capacity) {
+    auto decompressed = decompress(data, size);
+    if (decompressed.size() > capacity) {
+        throw CompressionError("Output buffer too small for decompressed data");
+    }
+    std::memcpy(output, decompressed.data(), decompressed.size());
+    return decompressed.size();
+}
+
+BufferSlice CompressionBackend::compress_buffer(const BufferSlice& input) {
+    if (input.empty()) {
+        return {};
+    }
+    if (auto bound = compress_bound(input.size())) {
+        Buffer output(*bound);
+        output.resize(compress_into(input.data(), input.size(), output.data(), output.size()));
+        return output;
+    }
+    return Buffer::copy_of(compress(input.data(), input.size()));
+}
+
+BufferSlice CompressionBackend::decompress_buffer(const BufferSlice& input) {
+    if (input.empty()) {
+        return {};
+    }
+    if (auto size = decompressed_size(input.data(), input.size())) {
+        Buffer output(*size);
+        if (decompress_into(input.data(), input.size(), output.data(), output.size()) != *size) {
+            throw CompressionError("Decompressed size mismatch");
+        }
+        return output;
+    }
+    return Buffer::copy_of(decompress(input.data(), input.size()));
+}
+
 void CompressionBackend::validate_input(const uint8_t* data, std::size_t size) const {
     if (data == nullptr && size > 0) {
         throw CompressionError("Data pointer is null but size is non-zero");
@@ -52,40 +107,72 @@ void CompressionBackend::reset_statistics() {
     StatisticsManager::instance().reset_backend_stats(name());
 }
 
-std::vector<uint8_t> CompressionBackend::compress_with_statistics(const uint8_t* data, std::size_t size) {
-    if (!statistics_enabled_) {
-        return compress(data, size);
-    }
+namespace {
 
-    StatisticsScope scope(name(), version(), true);
-    try {
-        auto result = compress(data, size);
-        scope.set_sizes(size, result.size());
-        scope.set_success(true);
-        return result;
-    } catch (const std::exception& e) {
-        scope.set_sizes(size, 0);
-        scope.set_success(false, e.what());
-        throw;
-    }
+std::size_t output_size(const std::vector<uint8_t>& output) {
+    return output.size();
+}
+std::size_t output_size(const BufferSlice& output) {
+    return output.size();
+}
+std::size_t output_size(std::size_t written) {
+    return written;
 }
 
-std::vector<uint8_t> CompressionBackend::decompress_with_statistics(const uint8_t* data, std::size_t size) {
-    if (!statistics_enabled_) {
-        return decompress(data, size);
+// Runs one operation, recording it when statistics are enabled
+template <typename Operation>
+auto with_statistics(CompressionBackend& backend, bool enabled, bool compressing, std::size_t input_size,
+                     StatsTag tag, Operation&& operation) {
+    TraceScope trace(compressing ? "compress" : "decompress", "compression");
+    if (!enabled) {
+        return operation();
     }
 
-    StatisticsScope scope(name(), version(), false);
+    StatisticsScope scope(backend.name(), backend.version(), compressing, tag);
     try {
-        auto result = decompress(data, size);
-        scope.set_sizes(size, result.size());
+        auto result = operation();
+        scope.set_sizes(input_size, output_size(result));
         scope.set_success(true);
         return result;
     } catch (const std::exception& e) {
-        scope.set_sizes(size, 0);
+        scope.set_sizes(input_size, 0);
         scope.set_success(false, e.what());
         throw;
     }
 }
 
+} // anonymous namespace
+
+std::vector<uint8_t> CompressionBackend::compress_with_statistics(const uint8_t* data, std::size_t size,
+                                                               StatsTag tag) {
+    return with_statistics(*this, statistics_enabled_, true, size, tag, [&] { return compress(data, size); });
+}
+
+std::vector<uint8_t> CompressionBackend::decompress_with_statistics(const uint8_t* data, std::size_t size,
+                                                                 StatsTag tag) {
+    return with_statistics(*this, statistics_enabled_, false, size, tag, [&] { return decompress(data, size); });
+}
+
+std::size_t CompressionBackend::compress_into_with_statistics(const uint8_t* data, std::size_t size, uint8_t* output,
+                                                             std::size_t capacity, StatsTag tag) {
+    return with_statistics(*this, statistics_enabled_, true, size, tag,
+                           [&] { return compress_into(data, size, output, capacity); });
+}
+
+std::size_t CompressionBackend::decompress_into_with_statistics(const uint8_t* data, std::size_t size, uint8_t* output,
+                                                               std::size_t capacity, StatsTag tag) {
+    return with_statistics(*this, statistics_enabled_, false, size, tag,
+                           [&] { return decompress_into(data, size, output, capacity); });
+}
+
+BufferSlice CompressionBackend::compress_with_statistics(const BufferSlice& input, StatsTag tag) {
+    return with_statistics(*this, statistics_enabled_, true, input.size(), tag,
+                           [&] { return compress_buffer(input); });
+}
+
+BufferSlice CompressionBackend::decompress_with_statistics(const BufferSlice& input, StatsTag tag) {
+    return with_statistics(*this, statistics_enabled_, false, input.size(), tag,
+                           [&] { return decompress_buffer(input); });
+}
+
 } // namespace goethe
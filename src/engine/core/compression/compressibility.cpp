@@ -0,0 +1,100 @@
+#include "goethe/compressibility.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+namespace goethe {
+
+namespace {
+
+constexpr std::size_t kSampleBlocks = 16;
+constexpr std::size_t kSampleBlockSize = 512;
+constexpr std::size_t kSampleSize = kSampleBlocks * kSampleBlockSize;
+constexpr int kMatchHashBits = 12;
+
+// Above this entropy, entropy coding alone saves less than about 6%
+constexpr double kMaxUsefulEntropy = 7.5;
+// Repeats in this share of positions give an LZ stage something to do
+constexpr double kMinUsefulMatches = 0.02;
+
+double sample_entropy(std::span<const std::uint8_t> sample) {
+    // Four histograms, so consecutive equal bytes do not wait on each other
+    std::array<std::array<std::uint32_t, 256>, 4> counts{};
+    std::size_t i = 0;
+    for (; i + 4 <= sample.size(); i += 4) {
+        ++counts[0][sample[i]];
+        ++counts[1][sample[i + 1]];
+        ++counts[2][sample[i + 2]];
+        ++counts[3][sample[i + 3]];
+    }
+    for (; i < sample.size(); ++i) {
+        ++counts[0][sample[i]];
+    }
+
+    const auto total = static_cast<double>(sample.size());
+    double entropy = 0.0;
+    std::size_t symbols = 0;
+    for (std::size_t byte = 0; byte < 256; ++byte) {
+        const std::uint32_t count = counts[0][byte] + counts[1][byte] + counts[2][byte] + counts[3][byte];
+        if (count != 0) {
+            const double p = static_cast<double>(count) / total;
+            entropy -= p * std::log2(p);
+            ++symbols;
+        }
+    }
+    // Miller-Madow correction: a sample this small makes random data look
+    // a little less random than it is
+    entropy += static_cast<double>(symbols - 1) / (2.0 * total * std::numbers::ln2);
+    return std::min(entropy, 8.0);
+}
+
+double sample_match_ratio(std::span<const std::uint8_t> sample) {
+    if (sample.size() < 4) {
+        return 0.0;
+    }
+    // Last position plus one of each hashed 4-byte sequence
+    std::array<std::uint16_t, std::size_t{1} << kMatchHashBits> table{};
+    std::size_t matches = 0;
+    for (std::size_t pos = 0; pos + 4 <= sample.size(); ++pos) {
+        std::uint32_t word;
+        std::memcpy(&word, sample.data() + pos, sizeof(word));
+        const std::uint32_t hash = (word * 2654435761u) >> (32 - kMatchHashBits);
+        if (const std::uint16_t previous = table[hash]; previous != 0) {
+            std::uint32_t earlier;
+            std::memcpy(&earlier, sample.data() + previous - 1, sizeof(earlier));
+            matches += earlier == word ? 1 : 0;
+        }
+        table[hash] = static_cast<std::uint16_t>(pos + 1);
+    }
+    return static_cast<double>(matches) / static_cast<double>(sample.size() - 3);
+}
+
+} // anonymous namespace
+
+CompressibilityEstimate estimate_compressibility(std::span<const std::uint8_t> data) {
+    CompressibilityEstimate estimate;
+    if (data.size() < kMinEstimateSize) {
+        return estimate;
+    }
+
+    // Small inputs are read whole, larger ones as evenly spaced blocks
+    std::array<std::uint8_t, kSampleSize> blocks;
+    std::span<const std::uint8_t> sample = data;
+    if (data.size() > kSampleSize) {
+        const std::size_t stride = (data.size() - kSampleBlockSize) / (kSampleBlocks - 1);
+        for (std::size_t block = 0; block < kSampleBlocks; ++block) {
+            std::memcpy(blocks.data() + block * kSampleBlockSize, data.data() + block * stride, kSampleBlockSize);
+        }
+        sample = blocks;
+    }
+
+    estimate.sampled = sample.size();
+    estimate.entropy = sample_entropy(sample);
+    estimate.match_ratio = sample_match_ratio(sample);
+    estimate.compressible = estimate.entropy < kMaxUsefulEntropy || estimate.match_ratio >= kMinUsefulMatches;
+    return estimate;
+}
+
+} // namespace goethe
@@ -0,0 +1,151 @@
+#include "goethe/envelope.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GOETHE_CRC32C_SIMD 1
+#endif
+
+namespace goethe {
+
+// ============================================================================
+// CRC-32C
+// ============================================================================
+
+namespace {
+
+constexpr std::uint32_t kCastagnoli = 0x82F63B78; // Reflected polynomial
+
+constexpr std::array<std::uint32_t, 256> make_crc32c_table() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) != 0 ? kCastagnoli : 0);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto kCrc32cTable = make_crc32c_table();
+
+std::uint32_t crc32c_scalar(const std::uint8_t* data, std::size_t size, std::uint32_t crc) {
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = kCrc32cTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef GOETHE_CRC32C_SIMD
+__attribute__((target("sse4.2"))) std::uint32_t crc32c_sse42(const std::uint8_t* data, std::size_t size,
+                                                             std::uint32_t crc) {
+    std::size_t i = 0;
+#if defined(__x86_64__)
+    std::uint64_t wide = crc;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = static_cast<std::uint32_t>(wide);
+#endif
+    for (; i + 4 <= size; i += 4) {
+        std::uint32_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; i < size; ++i) {
+        crc = _mm_crc32_u8(crc, data[i]);
+    }
+    return crc;
+}
+#endif
+
+using Crc32cKernel = std::uint32_t(const std::uint8_t*, std::size_t, std::uint32_t);
+
+#ifdef GOETHE_CRC32C_SIMD
+constexpr CpuDispatch<Crc32cKernel> crc32c_kernel({crc32c_scalar, crc32c_sse42, nullptr, nullptr});
+#else
+constexpr CpuDispatch<Crc32cKernel> crc32c_kernel({crc32c_scalar, nullptr, nullptr, nullptr});
+#endif
+
+} // anonymous namespace
+
+std::uint32_t crc32c(std::span<const std::uint8_t> data, std::uint32_t crc) {
+    return ~crc32c_kernel.get()(data.data(), data.size(), ~crc);
+}
+
+CpuTier crc32c_tier() {
+    return crc32c_kernel.tier();
+}
+
+// ============================================================================
+// Header
+// ============================================================================
+
+std::size_t write_envelope_header(const EnvelopeHeader& header, std::uint8_t* output) {
+    std::uint8_t* out = std::copy(kEnvelopeMagic.begin(), kEnvelopeMagic.end(), output);
+    *out++ = kEnvelopeVersion;
+    *out++ = header.checksum ? kEnvelopeChecksum : 0;
+    *out++ = header.backend;
+    std::uint64_t size = header.original_size;
+    do {
+        const auto low = static_cast<std::uint8_t>(size & 0x7F);
+        size >>= 7;
+        *out++ = size != 0 ? (low | 0x80) : low;
+    } while (size != 0);
+    if (header.checksum) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            *out++ = static_cast<std::uint8_t>(*header.checksum >> shift);
+        }
+    }
+    return static_cast<std::size_t>(out - output);
+}
+
+std::optional<EnvelopeHeader> read_envelope_header(std::span<const std::uint8_t> data) {
+    if (data.size() < kEnvelopeMagic.size() || !std::equal(kEnvelopeMagic.begin(), kEnvelopeMagic.end(), data.begin())) {
+        return std::nullopt;
+    }
+    std::size_t pos = kEnvelopeMagic.size();
+    auto next = [&]() -> std::uint8_t {
+        if (pos >= data.size()) {
+            throw CompressionError("Truncated envelope header");
+        }
+        return data[pos++];
+    };
+
+    if (const std::uint8_t version = next(); version != kEnvelopeVersion) {
+        throw CompressionError("Unsupported envelope version: " + std::to_string(version));
+    }
+    const std::uint8_t flags = next();
+    if ((flags & ~kEnvelopeChecksum) != 0) {
+        throw CompressionError("Unknown envelope flags");
+    }
+
+    EnvelopeHeader header;
+    header.backend = next();
+    for (int shift = 0;; shift += 7) {
+        const std::uint8_t byte = next();
+        if (shift == 63 && byte > 1) {
+            throw CompressionError("Envelope size overflows 64 bits");
+        }
+        header.original_size |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    if ((flags & kEnvelopeChecksum) != 0) {
+        std::uint32_t checksum = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            checksum |= static_cast<std::uint32_t>(next()) << shift;
+        }
+        header.checksum = checksum;
+    }
+    header.size = pos;
+    return header;
+}
+
+} // namespace goethe
@@ -1,6 +1,7 @@
 #include "goethe/factory.hpp"
 #include <algorithm>
 #include <stdexcept>
+#include <string>
 
 namespace goethe {
 
@@ -17,8 +18,26 @@ CompressionFactory& CompressionFactory::instance() {
     return instance;
 }
 
-void CompressionFactory::register_backend(const std::string& name, BackendCreator creator) {
-    backends_[name] = std::move(creator);
+void CompressionFactory::register_backend(const std::string& name, BackendCreator creator, AvailabilityProbe probe,
+                                          std::optional<BackendId> id) {
+    if (id) {
+        auto [it, inserted] = names_by_id_.try_emplace(*id, name);
+        if (!inserted && it->second != name) {
+            throw CompressionError("Backend ID " + std::to_string(*id) + " already belongs to " + it->second);
+        }
+    }
+    backends_[name] = BackendEntry{std::move(creator), std::move(probe), id};
+}
+
+bool CompressionFactory::probe_backend(const BackendEntry& entry) {
+    if (entry.probe) {
+        return entry.probe();
+    }
+    try {
+        return entry.creator()->is_available();
+    } catch (const CompressionError&) {
+        return false;
+    }
 }
 
 std::unique_ptr<CompressionBackend> CompressionFactory::create_backend(const std::string& name) {
@@ -26,8 +45,11 @@ std::unique_ptr<CompressionBackend> CompressionFactory::create_backend(const std
     if (it == backends_.end()) {
         throw CompressionError("Unknown compression backend: " + name);
     }
+    if (it->second.probe && !it->second.probe()) {
+        throw CompressionError("Compression backend '" + name + "' is not available");
+    }
 
-    auto backend = it->second();
+    auto backend = it->second.creator();
     if (!backend->is_available()) {
         throw CompressionError("Compression backend '" + name + "' is not available");
     }
@@ -35,14 +57,27 @@ std::unique_ptr<CompressionBackend> CompressionFactory::create_backend(const std
     return backend;
 }
 
+std::optional<BackendId> CompressionFactory::get_backend_id(const std::string& name) const {
+    auto it = backends_.find(name);
+    return it == backends_.end() ? std::nullopt : it->second.id;
+}
+
+std::unique_ptr<CompressionBackend> CompressionFactory::create_backend_by_id(BackendId id) {
+    auto it = names_by_id_.find(id);
+    if (it == names_by_id_.end()) {
+        throw CompressionError("Unknown compression backend ID: " + std::to_string(id));
+    }
+    return create_backend(it->second);
+}
+
 std::vector<std::string> CompressionFactory::get_available_backends() const {
     std::vector<std::string> available;
-    for (const auto& [name, creator] : backends_) {
-        auto backend = creator();
-        if (backend->is_available()) {
+    for (const auto& [name, entry] : backends_) {
+        if (probe_backend(entry)) {
             available.push_back(name);
         }
     }
+    std::sort(available.begin(), available.end());
     return available;
 }
 
@@ -63,9 +98,7 @@ bool CompressionFactory::is_backend_available(const std::string& name) const {
     if (it == backends_.end()) {
         return false;
     }
-
-    auto backend = it->second();
-    return backend->is_available();
+    return probe_backend(it->second);
 }
 
 // Convenience functions
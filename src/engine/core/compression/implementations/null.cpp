@@ -22,7 +22,52 @@ std::vector<uint8_t> NullCompressionBackend::decompress(const uint8_t* data, std
     if (size == 0) {
         return {};
     }
+    check_plausible(data, size);
 
+    // Simply copy the data without decompression
+    std::vector<uint8_t> result(size);
+    std::memcpy(result.data(), data, size);
+    return result;
+}
+
+std::size_t NullCompressionBackend::compress_into(const uint8_t* data, std::size_t size, uint8_t* output,
+                                                  std::size_t capacity) {
+    validate_input(data, size);
+    if (size > capacity) {
+        throw CompressionError("Output buffer too small for compressed data");
+    }
+    if (size > 0) {
+        std::memcpy(output, data, size);
+    }
+    return size;
+}
+
+std::size_t NullCompressionBackend::decompress_into(const uint8_t* data, std::size_t size, uint8_t* output,
+                                                    std::size_t capacity) {
+    validate_input(data, size);
+    if (size == 0) {
+        return 0;
+    }
+    check_plausible(data, size);
+    if (size > capacity) {
+        throw CompressionError("Output buffer too small for decompressed data");
+    }
+    std::memcpy(output, data, size);
+    return size;
+}
+
+BufferSlice NullCompressionBackend::compress_buffer(const BufferSlice& input) {
+    return input;
+}
+
+BufferSlice NullCompressionBackend::decompress_buffer(const BufferSlice& input) {
+    if (!input.empty()) {
+        check_plausible(input.data(), input.size());
+    }
+    return input;
+}
+
+void NullCompressionBackend::check_plausible(const uint8_t* data, std::size_t size) const {
     // For null backend, validate that the data looks reasonable
     // This is a simple validation - if all bytes are the same value, it might be invalid
     if (size > 1) {
@@ -40,11 +85,6 @@ std::vector<uint8_t> NullCompressionBackend::decompress(const uint8_t* data, std
             throw CompressionError("Null backend detected potentially invalid data");
         }
     }
-
-    // Simply copy the data without decompression
-    std::vector<uint8_t> result(size);
-    std::memcpy(result.data(), data, size);
-    return result;
 }
 
 } // namespace goethe
@@ -1,20 +1,58 @@
 #include "goethe/zstd.hpp"
+#include "goethe/allocator.hpp"
 
 #ifdef GOETHE_ZSTD_AVAILABLE
+#define ZSTD_STATIC_LINKING_ONLY // ZSTD_customMem and the _advanced constructors
 #include <zstd.h>
+#include <zdict.h>
 #endif
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace goethe {
 
+#ifdef GOETHE_ZSTD_AVAILABLE
+namespace {
+
+// zstd frees without a size, so each allocation starts with a header that
+// holds it. The opaque pointer is the resource current at context creation.
+constexpr std::size_t kZstdHeader = alignof(std::max_align_t);
+
+void* zstd_allocate(void* opaque, size_t size) {
+    try {
+        auto* memory = static_cast<unsigned char*>(
+            static_cast<std::pmr::memory_resource*>(opaque)->allocate(size + kZstdHeader, kZstdHeader));
+        std::memcpy(memory, &size, sizeof(size));
+        return memory + kZstdHeader;
+    } catch (...) {
+        return nullptr; // zstd reports the failure
+    }
+}
+
+void zstd_free(void* opaque, void* address) {
+    if (address == nullptr) {
+        return;
+    }
+    auto* memory = static_cast<unsigned char*>(address) - kZstdHeader;
+    size_t size;
+    std::memcpy(&size, memory, sizeof(size));
+    static_cast<std::pmr::memory_resource*>(opaque)->deallocate(memory, size + kZstdHeader, kZstdHeader);
+}
+
+ZSTD_customMem custom_memory() {
+    return {zstd_allocate, zstd_free, memory_resource()};
+}
+
+} // anonymous namespace
+#endif
+
 ZstdCompressionBackend::ZstdCompressionBackend()
     : compression_level_(6), options_() {
 #ifdef GOETHE_ZSTD_AVAILABLE
     cctx_ = nullptr;
     dctx_ = nullptr;
 #endif
-    initialize_contexts();
 }
 
 ZstdCompressionBackend::~ZstdCompressionBackend() {
@@ -30,28 +68,29 @@ ZstdCompressionBackend::~ZstdCompressionBackend() {
 #endif
 }
 
-void ZstdCompressionBackend::initialize_contexts() {
 #ifdef GOETHE_ZSTD_AVAILABLE
-    // Create compression context
-    cctx_ = ZSTD_createCCtx();
+ZSTD_CCtx_s* ZstdCompressionBackend::compression_context() {
     if (!cctx_) {
-        throw CompressionError("Failed to create ZSTD compression context");
+        cctx_ = ZSTD_createCCtx_advanced(custom_memory());
+        if (!cctx_) {
+            throw CompressionError("Failed to create ZSTD compression context");
+        }
+        update_compression_context();
     }
-    
-    // Create decompression context
-    dctx_ = ZSTD_createDCtx();
+    return cctx_;
+}
+
+ZSTD_DCtx_s* ZstdCompressionBackend::decompression_context() {
     if (!dctx_) {
-        ZSTD_freeCCtx(cctx_);
-        cctx_ = nullptr;
-        throw CompressionError("Failed to create ZSTD decompression context");
+        dctx_ = ZSTD_createDCtx_advanced(custom_memory());
+        if (!dctx_) {
+            throw CompressionError("Failed to create ZSTD decompression context");
+        }
+        update_decompression_context();
     }
-    
-    // Set initial compression level
-    update_compression_context();
-#else
-    throw CompressionError("ZSTD library not available");
-#endif
+    return dctx_;
 }
+#endif
 
 std::vector<uint8_t> ZstdCompressionBackend::compress(const uint8_t* data, std::size_t size) {
 #ifdef GOETHE_ZSTD_AVAILABLE
@@ -61,19 +100,9 @@ std::vector<uint8_t> ZstdCompressionBackend::compress(const uint8_t* data, std::
         return {};
     }
     
-    // Get compressed size bound
-    const size_t compressed_bound = ZSTD_compressBound(size);
-    std::vector<uint8_t> compressed(compressed_bound);
-    
-    // Compress the data
-    const size_t compressed_size = ZSTD_compressCCtx(cctx_, compressed.data(),
-                                                    compressed_bound, data, size,
-                                                    compression_level_);
-    
-    check_zstd_error(compressed_size, "compression");
-    
-    // Resize to actual compressed size
-    compressed.resize(compressed_size);
+    // Compress into a buffer of the worst-case size, then trim
+    std::vector<uint8_t> compressed(ZSTD_compressBound(size));
+    compressed.resize(compress_into(data, size, compressed.data(), compressed.size()));
     return compressed;
 #else
     throw CompressionError("ZSTD library not available");
@@ -89,28 +118,93 @@ std::vector<uint8_t> ZstdCompressionBackend::decompress(const uint8_t* data, std
     }
     
     // Get decompressed size
-    const size_t decompressed_size = ZSTD_getFrameContentSize(data, size);
-    if (decompressed_size == ZSTD_CONTENTSIZE_ERROR) {
+    const auto decompressed_size = this->decompressed_size(data, size);
+    if (!decompressed_size) {
+        throw CompressionError("Unknown decompressed size");
+    }
+    
+    std::vector<uint8_t> decompressed(*decompressed_size);
+    const size_t actual_size = decompress_into(data, size, decompressed.data(), decompressed.size());
+    if (actual_size != *decompressed_size) {
+        throw CompressionError("Decompressed size mismatch");
+    }
+    
+    return decompressed;
+#else
+    throw CompressionError("ZSTD library not available");
+#endif
+}
+
+std::optional<std::size_t> ZstdCompressionBackend::compress_bound(std::size_t size) const {
+#ifdef GOETHE_ZSTD_AVAILABLE
+    return ZSTD_compressBound(size);
+#else
+    (void)size;
+    return std::nullopt;
+#endif
+}
+
+std::optional<std::size_t> ZstdCompressionBackend::decompressed_size(const uint8_t* data, std::size_t size) const {
+#ifdef GOETHE_ZSTD_AVAILABLE
+    const unsigned long long content_size = ZSTD_getFrameContentSize(data, size);
+    if (content_size == ZSTD_CONTENTSIZE_ERROR) {
         throw CompressionError("Invalid ZSTD frame");
     }
-    if (decompressed_size == ZSTD_CONTENTSIZE_UNKNOWN) {
-        throw CompressionError("Unknown decompressed size");
+    if (content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+        return std::nullopt;
     }
+    return static_cast<std::size_t>(content_size);
+#else
+    (void)data;
+    (void)size;
+    return std::nullopt;
+#endif
+}
+
+std::size_t ZstdCompressionBackend::compress_into(const uint8_t* data, std::size_t size, uint8_t* output,
+                                                  std::size_t capacity) {
+#ifdef GOETHE_ZSTD_AVAILABLE
+    validate_input(data, size);
     
-    std::vector<uint8_t> decompressed(decompressed_size);
+    if (size == 0) {
+        return 0;
+    }
     
-    // Decompress the data
-    const size_t actual_size = ZSTD_decompressDCtx(dctx_, decompressed.data(),
-                                                  decompressed_size, data, size);
+    // ZSTD_compress2 honours the parameters and dictionary set on the
+    // context; ZSTD_compressCCtx would only apply the level.
+    const size_t compressed_size = ZSTD_compress2(compression_context(), output, capacity, data, size);
     
-    check_zstd_error(actual_size, "decompression");
+    check_zstd_error(compressed_size, "compression");
+    update_memory_usage(); // Workspaces are sized on first use and on level changes
+    return compressed_size;
+#else
+    (void)data;
+    (void)size;
+    (void)output;
+    (void)capacity;
+    throw CompressionError("ZSTD library not available");
+#endif
+}
+
+std::size_t ZstdCompressionBackend::decompress_into(const uint8_t* data, std::size_t size, uint8_t* output,
+                                                    std::size_t capacity) {
+#ifdef GOETHE_ZSTD_AVAILABLE
+    validate_input(data, size);
     
-    if (actual_size != decompressed_size) {
-        throw CompressionError("Decompressed size mismatch");
+    if (size == 0) {
+        return 0;
     }
     
-    return decompressed;
+    const size_t actual_size = ZSTD_decompressDCtx(decompression_context(), output, capacity, data, size);
+    
+    check_zstd_error(actual_size, "decompression");
+    update_memory_usage();
+    return actual_size;
 #else
+    (void)data;
+    (void)size;
+    (void)output;
+    (void)capacity;
     throw CompressionError("ZSTD library not available");
 #endif
 }
@@ -126,8 +220,12 @@ std::string ZstdCompressionBackend::version() const {
 }
 
 bool ZstdCompressionBackend::is_available() const {
+    return is_library_available();
+}
+
+bool ZstdCompressionBackend::is_library_available() {
 #ifdef GOETHE_ZSTD_AVAILABLE
-    return cctx_ != nullptr && dctx_ != nullptr;
+    return true;
 #else
     return false;
 #endif
@@ -139,6 +237,7 @@ void ZstdCompressionBackend::set_compression_level(int level) {
         throw CompressionError("Invalid compression level: " + std::to_string(level));
     }
     compression_level_ = level;
+    options_.level = level;
     update_compression_context();
 #else
     throw CompressionError("ZSTD library not available");
@@ -147,9 +246,14 @@ void ZstdCompressionBackend::set_compression_level(int level) {
 
 void ZstdCompressionBackend::set_options(const CompressionOptions& options) {
 #ifdef GOETHE_ZSTD_AVAILABLE
+    if (options.level < ZSTD_minCLevel() || options.level > ZSTD_maxCLevel()) {
+        throw CompressionError("Invalid compression level: " + std::to_string(options.level));
+    }
     options_ = options;
+    compression_level_ = options.level;
     update_compression_context();
     update_decompression_context();
+    update_memory_usage();
 #else
     throw CompressionError("ZSTD library not available");
 #endif
@@ -185,6 +289,7 @@ void ZstdCompressionBackend::set_dictionary(const std::vector<uint8_t>& dictiona
     options_.dictionary_mode = !dictionary.empty();
     update_compression_context();
     update_decompression_context();
+    update_memory_usage();
 #else
     throw CompressionError("ZSTD library not available");
 #endif
@@ -196,7 +301,34 @@ void ZstdCompressionBackend::clear_dictionary() {
     options_.dictionary_mode = false;
     update_compression_context();
     update_decompression_context();
+    update_memory_usage();
+#else
+    throw CompressionError("ZSTD library not available");
+#endif
+}
+
+std::vector<uint8_t> ZstdCompressionBackend::train_dictionary(const std::vector<std::vector<uint8_t>>& samples,
+                                                              std::size_t max_size) {
+#ifdef GOETHE_ZSTD_AVAILABLE
+    std::vector<uint8_t> buffer;
+    std::vector<size_t> sample_sizes;
+    sample_sizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        buffer.insert(buffer.end(), sample.begin(), sample.end());
+        sample_sizes.push_back(sample.size());
+    }
+    
+    std::vector<uint8_t> dictionary(max_size);
+    const size_t dictionary_size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), buffer.data(),
+                                                         sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+    if (ZDICT_isError(dictionary_size)) {
+        throw CompressionError(std::string("ZSTD dictionary training failed: ") + ZDICT_getErrorName(dictionary_size));
+    }
+    dictionary.resize(dictionary_size);
+    return dictionary;
 #else
+    (void)samples;
+    (void)max_size;
     throw CompressionError("ZSTD library not available");
 #endif
 }
@@ -205,6 +337,9 @@ void ZstdCompressionBackend::update_compression_context() {
 #ifdef GOETHE_ZSTD_AVAILABLE
     if (!cctx_) return;
     
+    // Start from defaults so options that were switched off do not linger
+    ZSTD_CCtx_reset(cctx_, ZSTD_reset_parameters);
+    
     // Set compression level
     ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, compression_level_);
     
@@ -229,6 +364,8 @@ void ZstdCompressionBackend::update_decompression_context() {
 #ifdef GOETHE_ZSTD_AVAILABLE
     if (!dctx_) return;
     
+    ZSTD_DCtx_reset(dctx_, ZSTD_reset_parameters);
+    
     // Set dictionary if available
     if (options_.dictionary_mode && !options_.dictionary.empty()) {
         ZSTD_DCtx_loadDictionary(dctx_, options_.dictionary.data(), options_.dictionary.size());
@@ -236,6 +373,24 @@ void ZstdCompressionBackend::update_decompression_context() {
 #endif
 }
 
+void ZstdCompressionBackend::update_memory_usage() {
+#ifdef GOETHE_ZSTD_AVAILABLE
+    // Dictionaries loaded into the contexts are included in their sizes.
+    // Accounts are registered once there is something to report.
+    const std::size_t context_bytes = ZSTD_sizeof_CCtx(cctx_) + ZSTD_sizeof_DCtx(dctx_);
+    if (context_bytes > 0 && !context_memory_.is_registered()) {
+        context_memory_ = MemoryAccount(MemoryCategory::COMPRESSION_CONTEXT, name());
+    }
+    context_memory_.update(context_bytes);
+    
+    const std::size_t dictionary_bytes = options_.dictionary.capacity();
+    if (dictionary_bytes > 0 && !dictionary_memory_.is_registered()) {
+        dictionary_memory_ = MemoryAccount(MemoryCategory::DICTIONARY, name());
+    }
+    dictionary_memory_.update(dictionary_bytes);
+#endif
+}
+
 void ZstdCompressionBackend::check_zstd_error(size_t result, const std::string& operation) {
 #ifdef GOETHE_ZSTD_AVAILABLE
     if (ZSTD_isError(result)) {
@@ -1,16 +1,37 @@
 #include "goethe/manager.hpp"
+#include "goethe/compressibility.hpp"
+#include "goethe/envelope.hpp"
 #include "goethe/factory.hpp"
 #include "goethe/register_backends.hpp"
+#include "goethe/trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
 
 namespace goethe {
 
+// Idle backends of one configuration, borrowed by asynchronous jobs
+struct CompressionContext::AsyncBackends {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<CompressionBackend>> idle;
+};
+
+CompressionContext::CompressionContext() = default;
+
+CompressionContext::CompressionContext(const std::string& backend_name) {
+    initialize(backend_name);
+}
+
+CompressionContext::~CompressionContext() = default;
+
 CompressionManager& CompressionManager::instance() {
     static CompressionManager instance;
     return instance;
 }
 
-void CompressionManager::initialize(const std::string& backend_name) {
+void CompressionContext::initialize(const std::string& backend_name) {
     // Register all available backends
     register_compression_backends();
 
@@ -20,108 +41,623 @@ void CompressionManager::initialize(const std::string& backend_name) {
     } else {
         backend_ = CompressionFactory::instance().create_backend(backend_name);
     }
+    backend_->enable_statistics(statistics_enabled_);
+    invalidate_backend_copies();
 
     initialized_ = true;
 }
 
-std::vector<uint8_t> CompressionManager::compress(const uint8_t* data, std::size_t size) {
+std::vector<uint8_t> CompressionContext::compress(const uint8_t* data, std::size_t size, StatsTag tag) {
     if (!initialized_) {
-        throw CompressionError("CompressionManager not initialized");
+        throw CompressionError("CompressionContext not initialized");
     }
-    return backend_->compress(data, size);
+    return backend_->compress_with_statistics(data, size, tag);
 }
 
-std::vector<uint8_t> CompressionManager::decompress(const uint8_t* data, std::size_t size) {
+std::vector<uint8_t> CompressionContext::decompress(const uint8_t* data, std::size_t size, StatsTag tag) {
     if (!initialized_) {
-        throw CompressionError("CompressionManager not initialized");
+        throw CompressionError("CompressionContext not initialized");
     }
-    return backend_->decompress(data, size);
+    return backend_->decompress_with_statistics(data, size, tag);
 }
 
-std::vector<uint8_t> CompressionManager::compress(const std::vector<uint8_t>& data) {
+std::vector<uint8_t> CompressionContext::compress(const std::vector<uint8_t>& data, StatsTag tag) {
     if (data.empty()) {
         return {};
     }
-    return compress(data.data(), data.size());
+    return compress(data.data(), data.size(), tag);
 }
 
-std::vector<uint8_t> CompressionManager::decompress(const std::vector<uint8_t>& data) {
+std::vector<uint8_t> CompressionContext::decompress(const std::vector<uint8_t>& data, StatsTag tag) {
     if (data.empty()) {
         return {};
     }
-    return decompress(data.data(), data.size());
+    return decompress(data.data(), data.size(), tag);
 }
 
-std::vector<uint8_t> CompressionManager::compress(const std::string& data) {
+std::vector<uint8_t> CompressionContext::compress(const std::string& data, StatsTag tag) {
     if (data.empty()) {
         return {};
     }
-    return compress(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    return compress(reinterpret_cast<const uint8_t*>(data.data()), data.size(), tag);
 }
 
-std::string CompressionManager::decompress_to_string(const uint8_t* data, std::size_t size) {
+std::string CompressionContext::decompress_to_string(const uint8_t* data, std::size_t size) {
     auto decompressed = decompress(data, size);
     return std::string(reinterpret_cast<const char*>(decompressed.data()), decompressed.size());
 }
 
-std::string CompressionManager::decompress_to_string(const std::vector<uint8_t>& data) {
+std::string CompressionContext::decompress_to_string(const std::vector<uint8_t>& data) {
     auto decompressed = decompress(data);
     return std::string(reinterpret_cast<const char*>(decompressed.data()), decompressed.size());
 }
 
-void CompressionManager::set_compression_level(int level) {
+BufferSlice CompressionContext::compress(const BufferSlice& data, StatsTag tag) {
+    if (data.empty()) {
+        return {};
+    }
+    if (!initialized_) {
+        throw CompressionError("CompressionContext not initialized");
+    }
+    return backend_->compress_with_statistics(data, tag);
+}
+
+BufferSlice CompressionContext::decompress(const BufferSlice& data, StatsTag tag) {
+    if (data.empty()) {
+        return {};
+    }
     if (!initialized_) {
-        throw CompressionError("CompressionManager not initialized");
+        throw CompressionError("CompressionContext not initialized");
+    }
+    return backend_->decompress_with_statistics(data, tag);
+}
+
+namespace {
+
+// Header followed by the payload, in one allocation when the backend can
+// bound its output. Output is std::vector<uint8_t> or Buffer.
+template <typename Output>
+Output write_envelope(CompressionBackend& backend, bool checksum, const uint8_t* data, std::size_t size,
+                      StatsTag tag) {
+    EnvelopeHeader header;
+    const auto id = CompressionFactory::instance().get_backend_id(backend.name());
+    if (!id) {
+        throw CompressionError("Compression backend '" + backend.name() + "' has no envelope ID");
+    }
+    header.backend = *id;
+    header.original_size = size;
+    if (checksum) {
+        header.checksum = crc32c({data, size});
+    }
+
+    if (auto bound = backend.compress_bound(size)) {
+        Output output(kMaxEnvelopeHeader + *bound);
+        const std::size_t header_size = write_envelope_header(header, output.data());
+        output.resize(header_size + backend.compress_into_with_statistics(data, size, output.data() + header_size,
+                                                                          *bound, tag));
+        return output;
+    }
+    const auto payload = backend.compress_with_statistics(data, size, tag);
+    Output output(kMaxEnvelopeHeader + payload.size());
+    const std::size_t header_size = write_envelope_header(header, output.data());
+    if (!payload.empty()) {
+        std::memcpy(output.data() + header_size, payload.data(), payload.size());
+    }
+    output.resize(header_size + payload.size());
+    return output;
+}
+
+EnvelopeHeader require_envelope(const uint8_t* data, std::size_t size) {
+    auto header = read_envelope_header({data, size});
+    if (!header) {
+        throw CompressionError("Data is not a compression envelope");
+    }
+    if (header->original_size > std::numeric_limits<std::size_t>::max()) {
+        throw CompressionError("Envelope too large for this platform");
+    }
+    return *header;
+}
+
+// The header is as untrusted as the payload, so its size is checked against
+// the payload before an output of that size is allocated
+void check_envelope_size(const EnvelopeHeader& header, const CompressionBackend& backend, const uint8_t* payload,
+                         std::size_t payload_size) {
+    if (header.backend == kRawBackendId) {
+        if (payload_size != header.original_size) {
+            throw CompressionError("Envelope size does not match its payload");
+        }
+        return;
+    }
+    if (auto size = backend.decompressed_size(payload, payload_size)) {
+        if (*size != header.original_size) {
+            throw CompressionError("Envelope size does not match its payload");
+        }
+        return;
+    }
+    if (header.original_size > std::uint64_t{payload_size} * kMaxEnvelopeRatio) {
+        throw CompressionError("Envelope size too large for its payload");
+    }
+}
+
+void verify_envelope(const EnvelopeHeader& header, const uint8_t* data, std::size_t size) {
+    if (size != header.original_size) {
+        throw CompressionError("Decompressed size mismatch");
+    }
+    if (header.checksum && crc32c({data, size}) != *header.checksum) {
+        throw CompressionError("Envelope checksum mismatch");
+    }
+}
+
+} // anonymous namespace
+
+std::vector<uint8_t> CompressionContext::compress_envelope(const uint8_t* data, std::size_t size, bool checksum,
+                                                           StatsTag tag) {
+    if (!initialized_) {
+        throw CompressionError("CompressionContext not initialized");
+    }
+    auto& backend = envelope_writer(data, size, tag);
+    const auto start = std::chrono::steady_clock::now();
+    auto output = write_envelope<std::vector<uint8_t>>(backend, checksum, data, size, tag);
+    if (&backend == backend_.get()) {
+        record_envelope_cost(size, std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - start));
+    }
+    return output;
+}
+
+BufferSlice CompressionContext::compress_envelope(const BufferSlice& data, bool checksum, StatsTag tag) {
+    if (!initialized_) {
+        throw CompressionError("CompressionContext not initialized");
+    }
+    auto& backend = envelope_writer(data.data(), data.size(), tag);
+    const auto start = std::chrono::steady_clock::now();
+    Buffer output = write_envelope<Buffer>(backend, checksum, data.data(), data.size(), tag);
+    if (&backend == backend_.get()) {
+        record_envelope_cost(data.size(),
+                             std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - start));
+    }
+    return output;
+}
+
+std::vector<uint8_t> CompressionContext::decompress_envelope(const uint8_t* data, std::size_t size, StatsTag tag) {
+    if (!initialized_) {
+        throw CompressionError("CompressionContext not initialized");
+    }
+    const EnvelopeHeader header = require_envelope(data, size);
+    auto& backend = envelope_backend(header.backend);
+    check_envelope_size(header, backend, data + header.size, size - header.size);
+    std::vector<uint8_t> output(static_cast<std::size_t>(header.original_size));
+    std::size_t written = 0;
+    if (!output.empty()) {
+        written = backend.decompress_into_with_statistics(data + header.size, size - header.size, output.data(),
+                                                          output.size(), tag);
+    }
+    verify_envelope(header, output.data(), written);
+    return output;
+}
+
+BufferSlice CompressionContext::decompress_envelope(const BufferSlice& data, StatsTag tag) {
+    if (!initialized_) {
+        throw CompressionError("CompressionContext not initialized");
+    }
+    const EnvelopeHeader header = require_envelope(data.data(), data.size());
+    const BufferSlice payload = data.slice(header.size, data.size() - header.size);
+    auto& backend = envelope_backend(header.backend);
+    check_envelope_size(header, backend, payload.data(), payload.size());
+    BufferSlice output;
+    if (header.original_size > 0) {
+        if (backend.decompressed_size(payload.data(), payload.size())) {
+            output = backend.decompress_with_statistics(payload, tag); // Sized by the backend, or shared
+        } else {
+            Buffer buffer(static_cast<std::size_t>(header.original_size));
+            buffer.resize(backend.decompress_into_with_statistics(payload.data(), payload.size(), buffer.data(),
+                                                                  buffer.size(), tag));
+            output = std::move(buffer);
+        }
+    }
+    verify_envelope(header, output.data(), output.size());
+    return output;
+}
+
+CompressionBackend& CompressionContext::envelope_backend(BackendId id) {
+    if (CompressionFactory::instance().get_backend_id(backend_->name()) == id) {
+        return *backend_;
+    }
+    auto& backend = envelope_backends_[id];
+    if (!backend) {
+        backend = CompressionFactory::instance().create_backend_by_id(id);
+        backend->enable_statistics(statistics_enabled_);
+    }
+    return *backend;
+}
+
+// backend_, or the null backend for input not worth compressing
+CompressionBackend& CompressionContext::envelope_writer(const uint8_t* data, std::size_t size, StatsTag tag) {
+    if (!skip_incompressible_ || size < kMinEstimateSize ||
+        CompressionFactory::instance().get_backend_id(backend_->name()) == kRawBackendId) {
+        return *backend_;
+    }
+    if (estimate_compressibility({data, size}).compressible) {
+        return *backend_;
+    }
+    if (statistics_enabled_) {
+        // Nothing saved is claimed before there is a cost to go by
+        const Duration saved(envelope_ns_per_byte_
+                                 ? static_cast<Duration::rep>(*envelope_ns_per_byte_ * static_cast<double>(size))
+                                 : 0);
+        StatisticsManager::instance().record_skipped_compression(backend_->name(), backend_->version(), size, saved,
+                                                                 tag);
+    }
+    return envelope_backend(kRawBackendId);
+}
+
+void CompressionContext::record_envelope_cost(std::size_t size, Duration duration) {
+    if (size < kMinEstimateSize) {
+        return; // Mostly fixed overhead
+    }
+    // Seeded by the first measurement, then a moving average, so changes in
+    // content show through
+    const double ns_per_byte = static_cast<double>(duration.count()) / static_cast<double>(size);
+    envelope_ns_per_byte_ =
+        envelope_ns_per_byte_ ? *envelope_ns_per_byte_ + (ns_per_byte - *envelope_ns_per_byte_) / 8 : ns_per_byte;
+}
+
+void CompressionContext::set_skip_incompressible(bool skip) {
+    skip_incompressible_ = skip;
+}
+
+bool CompressionContext::get_skip_incompressible() const {
+    return skip_incompressible_;
+}
+
+BatchResult CompressionContext::compress_batch(std::span<const std::span<const uint8_t>> inputs, StatsTag tag) {
+    return run_batch(inputs, true, tag);
+}
+
+BatchResult CompressionContext::decompress_batch(std::span<const std::span<const uint8_t>> inputs, StatsTag tag) {
+    return run_batch(inputs, false, tag);
+}
+
+BatchResult CompressionContext::compress_batch(const std::vector<std::vector<uint8_t>>& inputs, StatsTag tag) {
+    std::vector<std::span<const uint8_t>> spans(inputs.begin(), inputs.end());
+    return run_batch(spans, true, tag);
+}
+
+BatchResult CompressionContext::decompress_batch(const std::vector<std::vector<uint8_t>>& inputs, StatsTag tag) {
+    std::vector<std::span<const uint8_t>> spans(inputs.begin(), inputs.end());
+    return run_batch(spans, false, tag);
+}
+
+void CompressionContext::set_batch_threads(std::size_t threads) {
+    if (threads != batch_threads_) {
+        batch_threads_ = threads;
+        batch_pool_.reset();
+    }
+}
+
+std::size_t CompressionContext::get_batch_threads() const {
+    return batch_threads_;
+}
+
+namespace {
+
+// Below this much work per helper thread, waking it costs more than it saves
+constexpr std::size_t kBatchBytesPerThread = 64 * 1024;
+
+} // anonymous namespace
+
+BatchResult CompressionContext::run_batch(std::span<const std::span<const uint8_t>> inputs, bool compressing,
+                                          StatsTag tag) {
+    if (!initialized_) {
+        throw CompressionError("CompressionContext not initialized");
+    }
+    TraceScope trace(compressing ? "compress_batch" : "decompress_batch", "compression");
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t count = inputs.size();
+    
+    std::size_t input_size = 0;
+    for (const auto& input : inputs) {
+        input_size += input.size();
+    }
+    
+    BatchResult result;
+    result.offsets.assign(count + 1, 0);
+    try {
+        // Output slots: worst case when compressing, exact when decompressing.
+        // Without sizes for every buffer each one gets its own vector instead.
+        std::vector<std::size_t> capacity(count, 0);
+        bool sized = true;
+        std::size_t total_capacity = 0;
+        for (std::size_t i = 0; i < count && sized; ++i) {
+            if (inputs[i].empty()) continue;
+            auto bound = compressing ? backend_->compress_bound(inputs[i].size())
+                                     : backend_->decompressed_size(inputs[i].data(), inputs[i].size());
+            sized = bound.has_value();
+            capacity[i] = bound.value_or(0);
+            total_capacity += capacity[i];
+        }
+        
+        std::size_t helpers = 0;
+        if (batch_threads_ > 0 && count > 1) {
+            helpers = std::min(batch_threads_, (input_size + total_capacity) / kBatchBytesPerThread);
+            if (helpers > 0 && !batch_pool_) {
+                batch_pool_ = std::make_unique<ThreadPool>(batch_threads_);
+            }
+        }
+        helpers = std::min(helpers, count - 1);
+        while (batch_backends_.size() <= helpers) {
+            batch_backends_.push_back(copy_backend());
+        }
+        
+        auto for_each_input = [&](const ThreadPool::IndexedTask& body) {
+            if (helpers == 0) {
+                for (std::size_t i = 0; i < count; ++i) body(0, i);
+            } else {
+                batch_pool_->parallel_for(count, body, helpers);
+            }
+        };
+        
+        if (sized) {
+            std::vector<std::size_t> start_offset(count, 0);
+            for (std::size_t i = 1; i < count; ++i) {
+                start_offset[i] = start_offset[i - 1] + capacity[i - 1];
+            }
+            result.data.resize(total_capacity);
+            std::vector<std::size_t> written(count, 0);
+            for_each_input([&](std::size_t slot, std::size_t i) {
+                if (inputs[i].empty()) return;
+                auto& backend = *batch_backends_[slot];
+                uint8_t* output = result.data.data() + start_offset[i];
+                written[i] = compressing
+                    ? backend.compress_into(inputs[i].data(), inputs[i].size(), output, capacity[i])
+                    : backend.decompress_into(inputs[i].data(), inputs[i].size(), output, capacity[i]);
+                if (!compressing && written[i] != capacity[i]) {
+                    throw CompressionError("Decompressed size mismatch");
+                }
+            });
+            
+            // Close the gaps left by worst-case compression slots
+            std::size_t end = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (start_offset[i] != end && written[i] > 0) {
+                    std::memmove(result.data.data() + end, result.data.data() + start_offset[i], written[i]);
+                }
+                result.offsets[i] = end;
+                end += written[i];
+            }
+            result.offsets[count] = end;
+            result.data.resize(end);
+            if (compressing) {
+                result.data.shrink_to_fit();
+            }
+        } else {
+            std::vector<std::vector<uint8_t>> outputs(count);
+            for_each_input([&](std::size_t slot, std::size_t i) {
+                if (inputs[i].empty()) return;
+                auto& backend = *batch_backends_[slot];
+                outputs[i] = compressing ? backend.compress(inputs[i].data(), inputs[i].size())
+                                         : backend.decompress(inputs[i].data(), inputs[i].size());
+            });
+            for (std::size_t i = 0; i < count; ++i) {
+                result.offsets[i + 1] = result.offsets[i] + outputs[i].size();
+            }
+            result.data.reserve(result.offsets[count]);
+            for (const auto& output : outputs) {
+                result.data.insert(result.data.end(), output.begin(), output.end());
+            }
+        }
+    } catch (const std::exception& e) {
+        if (statistics_enabled_ && count > 0) {
+            OperationStats stats;
+            stats.input_size = input_size;
+            stats.duration = std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - start);
+            stats.success = false;
+            stats.error_message = e.what();
+            stats.operation_count = count;
+            compressing ? StatisticsManager::instance().record_compression(backend_->name(), backend_->version(), stats, tag)
+                        : StatisticsManager::instance().record_decompression(backend_->name(), backend_->version(), stats, tag);
+        }
+        throw;
+    }
+    
+    if (statistics_enabled_ && count > 0) {
+        OperationStats stats;
+        stats.input_size = input_size;
+        stats.output_size = result.data.size();
+        stats.duration = std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - start);
+        stats.success = true;
+        stats.operation_count = count;
+        auto& statistics = StatisticsManager::instance();
+        if (compressing) {
+            statistics.record_compression(backend_->name(), backend_->version(), stats, tag);
+        } else {
+            statistics.record_decompression(backend_->name(), backend_->version(), stats, tag);
+        }
+    }
+    return result;
+}
+
+std::future<std::vector<uint8_t>> CompressionContext::compress_async(std::vector<uint8_t> data, StatsTag tag) {
+    auto task = std::make_shared<std::packaged_task<std::vector<uint8_t>()>>(make_async_job(std::move(data), true, tag));
+    auto future = task->get_future();
+    current_executor()([task] { (*task)(); });
+    return future;
+}
+
+std::future<std::vector<uint8_t>> CompressionContext::decompress_async(std::vector<uint8_t> data, StatsTag tag) {
+    auto task = std::make_shared<std::packaged_task<std::vector<uint8_t>()>>(make_async_job(std::move(data), false, tag));
+    auto future = task->get_future();
+    current_executor()([task] { (*task)(); });
+    return future;
+}
+
+CompressionAwaitable CompressionContext::co_compress(std::vector<uint8_t> data, StatsTag tag) {
+    return CompressionAwaitable(current_executor(), make_async_job(std::move(data), true, tag));
+}
+
+CompressionAwaitable CompressionContext::co_decompress(std::vector<uint8_t> data, StatsTag tag) {
+    return CompressionAwaitable(current_executor(), make_async_job(std::move(data), false, tag));
+}
+
+void CompressionContext::set_executor(Executor executor) {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    executor_ = std::move(executor);
+}
+
+Executor CompressionContext::current_executor() {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    if (executor_) {
+        return executor_;
+    }
+    if (!async_pool_) {
+        async_pool_ = std::make_unique<ThreadPool>();
+    }
+    return [pool = async_pool_.get()](std::function<void()> task) { pool->submit(std::move(task)); };
+}
+
+std::function<std::vector<uint8_t>()> CompressionContext::make_async_job(std::vector<uint8_t> data, bool compressing,
+                                                                         StatsTag tag) {
+    if (!initialized_) {
+        throw CompressionError("CompressionContext not initialized");
+    }
+    std::shared_ptr<AsyncBackends> backends;
+    {
+        std::lock_guard<std::mutex> lock(async_mutex_);
+        if (!async_backends_) {
+            async_backends_ = std::make_shared<AsyncBackends>();
+        }
+        backends = async_backends_;
+    }
+    // The job must not touch the context, which the caller may reconfigure
+    // or destroy while it is queued
+    return [backends = std::move(backends), data = std::move(data), compressing, tag, name = backend_->name(),
+            options = backend_->get_options(), statistics = statistics_enabled_]() {
+        if (data.empty()) {
+            return std::vector<uint8_t>{};
+        }
+        std::unique_ptr<CompressionBackend> backend;
+        {
+            std::lock_guard<std::mutex> lock(backends->mutex);
+            if (!backends->idle.empty()) {
+                backend = std::move(backends->idle.back());
+                backends->idle.pop_back();
+            }
+        }
+        if (!backend) {
+            backend = CompressionFactory::instance().create_backend(name);
+            backend->set_options(options);
+            backend->enable_statistics(statistics);
+        }
+        
+        auto give_back = [&] {
+            std::lock_guard<std::mutex> lock(backends->mutex);
+            backends->idle.push_back(std::move(backend));
+        };
+        std::vector<uint8_t> result;
+        try {
+            result = compressing ? backend->compress_with_statistics(data.data(), data.size(), tag)
+                                 : backend->decompress_with_statistics(data.data(), data.size(), tag);
+        } catch (...) {
+            give_back();
+            throw;
+        }
+        give_back();
+        return result;
+    };
+}
+
+std::unique_ptr<CompressionBackend> CompressionContext::copy_backend() const {
+    auto backend = CompressionFactory::instance().create_backend(backend_->name());
+    backend->set_options(backend_->get_options());
+    backend->enable_statistics(statistics_enabled_);
+    return backend;
+}
+
+void CompressionContext::invalidate_backend_copies() {
+    batch_backends_.clear();
+    envelope_backends_.clear();
+    envelope_ns_per_byte_.reset();
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    async_backends_.reset();
+}
+
+void CompressionAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    // An inline executor resumes the coroutine, and so destroys this
+    // awaitable, before returning
+    auto executor = std::move(executor_);
+    executor([this, handle] {
+        try {
+            result_ = work_();
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        handle.resume();
+    });
+}
+
+std::vector<uint8_t> CompressionAwaitable::await_resume() {
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    return std::move(result_);
+}
+
+void CompressionContext::set_compression_level(int level) {
+    if (!initialized_) {
+        throw CompressionError("CompressionContext not initialized");
     }
     backend_->set_compression_level(level);
+    invalidate_backend_copies();
 }
 
-int CompressionManager::get_compression_level() const {
+int CompressionContext::get_compression_level() const {
     if (!initialized_) {
-        throw CompressionError("CompressionManager not initialized");
+        throw CompressionError("CompressionContext not initialized");
     }
     return backend_->get_compression_level();
 }
 
-void CompressionManager::set_options(const CompressionOptions& options) {
+void CompressionContext::set_options(const CompressionOptions& options) {
     if (!initialized_) {
-        throw CompressionError("CompressionManager not initialized");
+        throw CompressionError("CompressionContext not initialized");
     }
     backend_->set_options(options);
+    invalidate_backend_copies();
 }
 
-CompressionOptions CompressionManager::get_options() const {
+CompressionOptions CompressionContext::get_options() const {
     if (!initialized_) {
-        throw CompressionError("CompressionManager not initialized");
+        throw CompressionError("CompressionContext not initialized");
     }
     return backend_->get_options();
 }
 
-std::string CompressionManager::get_backend_name() const {
+std::string CompressionContext::get_backend_name() const {
     if (!initialized_) {
         return "uninitialized";
     }
     return backend_->name();
 }
 
-std::string CompressionManager::get_backend_version() const {
+std::string CompressionContext::get_backend_version() const {
     if (!initialized_) {
         return "unknown";
     }
     return backend_->version();
 }
 
-bool CompressionManager::is_initialized() const {
+bool CompressionContext::is_initialized() const {
     return initialized_;
 }
 
-void CompressionManager::switch_backend(const std::string& backend_name) {
+void CompressionContext::switch_backend(const std::string& backend_name) {
     // Register backends if not already done
     register_compression_backends();
 
     try {
         // Try to create new backend
         backend_ = CompressionFactory::instance().create_backend(backend_name);
+        backend_->enable_statistics(statistics_enabled_);
+        invalidate_backend_copies();
         initialized_ = true;
     } catch (const CompressionError&) {
         // If backend creation fails, keep the current backend
@@ -130,46 +666,71 @@ void CompressionManager::switch_backend(const std::string& backend_name) {
 }
 
 // Statistics methods
-void CompressionManager::enable_statistics(bool enable) {
+// Only this context's recording; StatisticsManager::enable_statistics
+// switches all of it off
+void CompressionContext::enable_statistics(bool enable) {
+    statistics_enabled_ = enable;
     if (initialized_) {
         backend_->enable_statistics(enable);
+        invalidate_backend_copies();
     }
-    StatisticsManager::instance().enable_statistics(enable);
 }
 
-bool CompressionManager::is_statistics_enabled() const {
-    return StatisticsManager::instance().is_statistics_enabled();
+bool CompressionContext::is_statistics_enabled() const {
+    return statistics_enabled_;
 }
 
-BackendStats CompressionManager::get_statistics() const {
+BackendStats CompressionContext::get_statistics() const {
     if (!initialized_) {
         return BackendStats{};
     }
     return backend_->get_statistics();
 }
 
-BackendStats CompressionManager::get_global_statistics() const {
+BackendStats CompressionContext::get_global_statistics() const {
     return StatisticsManager::instance().get_global_stats();
 }
 
-void CompressionManager::reset_statistics() {
+WindowStats CompressionContext::get_window_statistics(StatsWindow window) const {
+    if (!initialized_) {
+        return WindowStats{};
+    }
+    return StatisticsManager::instance().get_window_stats(backend_->name(), window);
+}
+
+StatsTag CompressionContext::intern_tag(const std::string& name) {
+    return StatisticsManager::instance().intern_tag(name);
+}
+
+BackendStats CompressionContext::get_tag_statistics(StatsTag tag) const {
+    if (!initialized_) {
+        return BackendStats{};
+    }
+    return StatisticsManager::instance().get_tag_stats(backend_->name(), tag);
+}
+
+void CompressionContext::reset_statistics() {
     if (initialized_) {
         backend_->reset_statistics();
     }
 }
 
-void CompressionManager::reset_global_statistics() {
+void CompressionContext::reset_global_statistics() {
     StatisticsManager::instance().reset_all_stats();
 }
 
-std::string CompressionManager::export_statistics_json() const {
+std::string CompressionContext::export_statistics_json() const {
     return StatisticsManager::instance().export_json();
 }
 
-std::string CompressionManager::export_statistics_csv() const {
+std::string CompressionContext::export_statistics_csv() const {
     return StatisticsManager::instance().export_csv();
 }
 
+std::string CompressionContext::export_statistics_openmetrics() const {
+    return StatisticsManager::instance().export_openmetrics();
+}
+
 // Global convenience functions
 std::vector<uint8_t> compress_data(const uint8_t* data, std::size_t size, const std::string& backend) {
     auto& manager = CompressionManager::instance();
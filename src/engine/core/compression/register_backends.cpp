@@ -1,21 +1,31 @@
 #include "goethe/register_backends.hpp"
+#include "goethe/envelope.hpp"
 #include "goethe/factory.hpp"
 #include "goethe/null.hpp"
 #include "goethe/zstd.hpp"
+#include <mutex>
 
 namespace goethe {
 
 void register_compression_backends() {
-    auto& factory = CompressionFactory::instance();
+    // Registration happens once per process; later calls are a flag check
+    static std::once_flag registered;
+    std::call_once(registered, [] {
+        auto& factory = CompressionFactory::instance();
 
-    // Register null backend (always available)
-    factory.register_backend("null", []() {
-        return std::make_unique<NullCompressionBackend>();
-    });
+        // Envelope IDs are part of the stored format: append new ones, never
+        // renumber
+
+        // Register null backend (always available)
+        factory.register_backend("null", []() {
+            return std::make_unique<NullCompressionBackend>();
+        }, []() { return true; }, kRawBackendId);
 
-    // Register zstd backend (if available)
-    factory.register_backend("zstd", []() {
-        return std::make_unique<ZstdCompressionBackend>();
+        // Register zstd backend (if available). The probe answers from the
+        // build configuration, so checks never allocate zstd contexts.
+        factory.register_backend("zstd", []() {
+            return std::make_unique<ZstdCompressionBackend>();
+        }, &ZstdCompressionBackend::is_library_available, BackendId{1});
     });
 }
 
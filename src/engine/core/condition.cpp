@@ -0,0 +1,657 @@
+#include "goethe/condition.hpp"
+#include "goethe/cpu_dispatch.hpp"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GOETHE_BATCH_AVX2 1
+#endif
+
+namespace goethe {
+
+// ============================================================================
+// World State
+// ============================================================================
+
+WorldState::WorldState(const WorldState& other) : flags_(other.flags_), vars_(other.vars_) {}
+
+void WorldState::set_flag(const std::string& name, bool value) {
+    const bool changed = value ? flags_.insert(name).second : flags_.erase(name) != 0;
+    if (changed) {
+        notify(KeyKind::FLAG, name);
+    }
+}
+
+bool WorldState::has_flag(const std::string& name) const {
+    return flags_.count(name) != 0;
+}
+
+void WorldState::set_var(const std::string& name, std::string value) {
+    auto [it, inserted] = vars_.try_emplace(name);
+    if (!inserted && it->second == value) {
+        return;
+    }
+    it->second = std::move(value);
+    notify(KeyKind::VAR, name);
+}
+
+void WorldState::erase_var(const std::string& name) {
+    if (vars_.erase(name) != 0) {
+        notify(KeyKind::VAR, name);
+    }
+}
+
+const std::string* WorldState::get_var(const std::string& name) const {
+    auto it = vars_.find(name);
+    return it == vars_.end() ? nullptr : &it->second;
+}
+
+std::size_t WorldState::add_listener(ChangeListener listener) {
+    listeners_[next_listener_].callback = std::move(listener);
+    return next_listener_++;
+}
+
+void WorldState::watch(std::size_t token, KeyKind kind, const std::string& name) {
+    auto& listener = listeners_.at(token);
+    if (listener.removed) {
+        return;
+    }
+    auto& watchers = (kind == KeyKind::FLAG ? flag_watchers_ : var_watchers_)[name];
+    if (watchers.insert(token).second) {
+        listener.watched.emplace_back(kind, name);
+    }
+}
+
+void WorldState::remove_listener(std::size_t token) {
+    auto listener = listeners_.find(token);
+    if (listener == listeners_.end() || listener->second.removed) {
+        return;
+    }
+    for (const auto& [kind, name] : listener->second.watched) {
+        auto& index = kind == KeyKind::FLAG ? flag_watchers_ : var_watchers_;
+        auto watchers = index.find(name);
+        watchers->second.erase(token);
+        if (watchers->second.empty()) {
+            index.erase(watchers);
+        }
+    }
+    listener->second.watched.clear();
+    if (notifying_ > 0) {
+        // Its callback may be the one running
+        listener->second.removed = true;
+        removed_.push_back(token);
+        return;
+    }
+    listeners_.erase(listener);
+}
+
+void WorldState::notify(KeyKind kind, const std::string& name) {
+    const auto& index = kind == KeyKind::FLAG ? flag_watchers_ : var_watchers_;
+    auto watchers = index.find(name);
+    if (watchers == index.end()) {
+        return;
+    }
+    // Callbacks may change the watcher sets, so they run off a copy
+    const std::vector<std::size_t> tokens(watchers->second.begin(), watchers->second.end());
+    struct Dispatch {
+        WorldState& world;
+        explicit Dispatch(WorldState& world) : world(world) {
+            ++world.notifying_;
+        }
+        ~Dispatch() {
+            if (--world.notifying_ == 0) {
+                for (std::size_t token : world.removed_) {
+                    world.listeners_.erase(token);
+                }
+                world.removed_.clear();
+            }
+        }
+    } dispatch(*this);
+    for (std::size_t token : tokens) {
+        auto listener = listeners_.find(token);
+        if (listener != listeners_.end() && !listener->second.removed) {
+            listener->second.callback(kind, name);
+        }
+    }
+}
+
+namespace {
+
+// Variables are stored as text, so typed values compare by their YAML spelling
+std::string value_text(const std::variant<std::string, int, float, bool>& value) {
+    return std::visit([](const auto& v) -> std::string {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>) {
+            return v;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return v ? "true" : "false";
+        } else if constexpr (std::is_same_v<T, int>) {
+            return std::to_string(v);
+        } else {
+            std::ostringstream out;
+            out << v;
+            return out.str();
+        }
+    }, value);
+}
+
+} // anonymous namespace
+
+bool evaluate(const Condition& condition, const WorldState& world) {
+    switch (condition.type) {
+        case Condition::Type::ALL:
+            return std::all_of(condition.children.begin(), condition.children.end(),
+                               [&](const Condition& child) { return evaluate(child, world); });
+        case Condition::Type::ANY:
+            return std::any_of(condition.children.begin(), condition.children.end(),
+                               [&](const Condition& child) { return evaluate(child, world); });
+        case Condition::Type::NOT:
+            return !condition.children.empty() && !evaluate(condition.children.front(), world);
+        case Condition::Type::FLAG:
+            return world.has_flag(condition.key);
+        case Condition::Type::VAR: {
+            const std::string* current = world.get_var(condition.key);
+            if (current == nullptr) {
+                return false;
+            }
+            const std::string expected = value_text(condition.value);
+            return expected.empty() || *current == expected;
+        }
+        default:
+            return false;
+    }
+}
+
+bool apply(const Effect& effect, WorldState& world) {
+    switch (effect.type) {
+        case Effect::Type::SET_FLAG: {
+            // The old setFlag form carries no value and means "set"
+            const std::string value = value_text(effect.value);
+            world.set_flag(effect.target, value != "false" && value != "0");
+            return true;
+        }
+        case Effect::Type::SET_VAR:
+            world.set_var(effect.target, value_text(effect.value));
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ============================================================================
+// Compiled Conditions
+// ============================================================================
+
+CompiledCondition::CompiledCondition(const Condition& condition) {
+    compile(condition);
+}
+
+void CompiledCondition::compile(const Condition& condition) {
+    Op op;
+    switch (condition.type) {
+        case Condition::Type::ALL:
+        case Condition::Type::ANY:
+            for (const auto& child : condition.children) {
+                compile(child);
+            }
+            op.code = condition.type == Condition::Type::ALL ? Op::Code::ALL : Op::Code::ANY;
+            op.arity = static_cast<std::uint32_t>(condition.children.size());
+            break;
+        case Condition::Type::NOT:
+            if (condition.children.empty()) {
+                op.code = Op::Code::FALSE; // Matches evaluate() for a malformed NOT
+                break;
+            }
+            compile(condition.children.front());
+            op.code = Op::Code::NOT;
+            break;
+        case Condition::Type::FLAG:
+            op.code = Op::Code::FLAG;
+            op.key = key_index(WorldState::KeyKind::FLAG, condition.key);
+            break;
+        case Condition::Type::VAR:
+            op.value = value_text(condition.value);
+            op.code = op.value.empty() ? Op::Code::VAR_SET : Op::Code::VAR_EQUALS;
+            op.key = key_index(WorldState::KeyKind::VAR, condition.key);
+            break;
+        default:
+            op.code = Op::Code::FALSE;
+            break;
+    }
+    ops_.push_back(std::move(op));
+}
+
+std::uint32_t CompiledCondition::key_index(WorldState::KeyKind kind, const std::string& name) {
+    for (std::size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i].kind == kind && keys_[i].name == name) {
+            return static_cast<std::uint32_t>(i);
+        }
+    }
+    keys_.push_back({kind, name});
+    return static_cast<std::uint32_t>(keys_.size() - 1);
+}
+
+bool CompiledCondition::evaluate(const WorldState& world) const {
+    // Conditions are small; deeper programs spill to the heap
+    std::array<bool, 64> inline_stack{};
+    bool* stack = inline_stack.data();
+    std::unique_ptr<bool[]> spilled;
+    if (ops_.size() > inline_stack.size()) {
+        spilled = std::make_unique<bool[]>(ops_.size());
+        stack = spilled.get();
+    }
+
+    std::size_t top = 0;
+    for (const auto& op : ops_) {
+        switch (op.code) {
+            case Op::Code::FLAG:
+                stack[top++] = world.has_flag(keys_[op.key].name);
+                break;
+            case Op::Code::VAR_SET:
+                stack[top++] = world.get_var(keys_[op.key].name) != nullptr;
+                break;
+            case Op::Code::VAR_EQUALS: {
+                const std::string* current = world.get_var(keys_[op.key].name);
+                stack[top++] = current != nullptr && *current == op.value;
+                break;
+            }
+            case Op::Code::ALL:
+            case Op::Code::ANY: {
+                const bool all = op.code == Op::Code::ALL;
+                bool result = all;
+                for (std::uint32_t i = 0; i < op.arity; ++i) {
+                    result = all ? result && stack[top - 1 - i] : result || stack[top - 1 - i];
+                }
+                top -= op.arity;
+                stack[top++] = result;
+                break;
+            }
+            case Op::Code::NOT:
+                stack[top - 1] = !stack[top - 1];
+                break;
+            case Op::Code::FALSE:
+                stack[top++] = false;
+                break;
+        }
+    }
+    return stack[0];
+}
+
+// ============================================================================
+// Condition Cache
+// ============================================================================
+
+ConditionCache::ConditionCache(WorldState& world)
+    : world_(world),
+      listener_(world.add_listener([this](WorldState::KeyKind kind, const std::string& name) {
+          invalidate(kind, name);
+      })),
+      entries_(memory_resource()), ids_(memory_resource()), flag_dependents_(memory_resource()),
+      var_dependents_(memory_resource()) {}
+
+ConditionCache::~ConditionCache() {
+    world_.remove_listener(listener_);
+}
+
+ConditionCache::Id ConditionCache::intern(const Condition& condition) {
+    auto [it, inserted] = ids_.try_emplace(&condition, entries_.size());
+    if (!inserted) {
+        return it->second;
+    }
+    entries_.push_back({CompiledCondition(condition)});
+    for (const auto& key : entries_.back().compiled.keys()) {
+        auto& dependents = key.kind == WorldState::KeyKind::FLAG ? flag_dependents_ : var_dependents_;
+        auto entry = dependents.find(key.name);
+        if (entry == dependents.end()) {
+            entry = dependents.try_emplace(std::pmr::string(key.name, dependents.get_allocator())).first;
+            world_.watch(listener_, key.kind, key.name);
+        }
+        entry->second.push_back(it->second);
+    }
+    return it->second;
+}
+
+bool ConditionCache::evaluate(Id id) {
+    Entry& entry = entries_[id];
+    if (entry.dirty) {
+        entry.value = entry.compiled.evaluate(world_);
+        entry.dirty = false;
+        ++evaluations_;
+    }
+    return entry.value;
+}
+
+void ConditionCache::invalidate(WorldState::KeyKind kind, const std::string& name) {
+    const auto& dependents = kind == WorldState::KeyKind::FLAG ? flag_dependents_ : var_dependents_;
+    auto it = dependents.find(name);
+    if (it == dependents.end()) {
+        return;
+    }
+    for (Id id : it->second) {
+        entries_[id].dirty = true;
+    }
+}
+
+// ============================================================================
+// Batch Evaluation
+// ============================================================================
+
+namespace {
+
+// Actors per kernel step: four 64-bit words, one AVX2 register
+constexpr std::size_t kBatchActors = 256;
+constexpr std::size_t kBatchWords = kBatchActors / 64;
+
+// Padding actors exist only to fill the last batch; writing them would leak
+// into the kernels' words
+void check_actor(std::size_t actor, std::size_t actors) {
+    if (actor >= actors) {
+        throw std::out_of_range("Actor out of range");
+    }
+}
+
+// The column for name, added empty on first sight; only then is the key
+// copied, into the map's resource
+template <typename Column>
+Column& column_for(PmrStringMap<Column>& columns, const std::string& name) {
+    auto it = columns.find(name);
+    if (it == columns.end()) {
+        it = columns.try_emplace(std::pmr::string(name, columns.get_allocator())).first;
+    }
+    return it->second;
+}
+
+} // anonymous namespace
+
+WorldStateBlock::WorldStateBlock(std::size_t actors)
+    : actors_(actors), padded_((actors + kBatchActors - 1) / kBatchActors * kBatchActors),
+      flags_(memory_resource()), vars_(memory_resource()), value_ids_(memory_resource()), values_(memory_resource()) {}
+
+void WorldStateBlock::set_flag(std::size_t actor, const std::string& name, bool value) {
+    check_actor(actor, actors_);
+    auto& column = column_for(flags_, name);
+    if (column.empty()) {
+        column.resize(padded_ / 64);
+    }
+    const std::uint64_t bit = std::uint64_t{1} << (actor % 64);
+    column[actor / 64] = value ? column[actor / 64] | bit : column[actor / 64] & ~bit;
+}
+
+bool WorldStateBlock::has_flag(std::size_t actor, const std::string& name) const {
+    check_actor(actor, actors_);
+    const std::uint64_t* column = flag_column(name);
+    return column != nullptr && (column[actor / 64] >> (actor % 64) & 1) != 0;
+}
+
+void WorldStateBlock::set_var(std::size_t actor, const std::string& name, const std::string& value) {
+    check_actor(actor, actors_);
+    auto id = value_ids_.find(value);
+    if (id == value_ids_.end()) {
+        id = value_ids_
+                 .try_emplace(std::pmr::string(value, value_ids_.get_allocator()),
+                              static_cast<std::uint32_t>(values_.size() + 1))
+                 .first;
+        values_.push_back(&id->first);
+    }
+    auto& column = column_for(vars_, name);
+    if (column.empty()) {
+        column.resize(padded_, kUnset);
+    }
+    column[actor] = id->second;
+}
+
+void WorldStateBlock::erase_var(std::size_t actor, const std::string& name) {
+    check_actor(actor, actors_);
+    auto it = vars_.find(name);
+    if (it != vars_.end()) {
+        it->second[actor] = kUnset;
+    }
+}
+
+const std::pmr::string* WorldStateBlock::get_var(std::size_t actor, const std::string& name) const {
+    check_actor(actor, actors_);
+    const std::uint32_t* column = var_column(name);
+    if (column == nullptr || column[actor] == kUnset) {
+        return nullptr;
+    }
+    return values_[column[actor] - 1];
+}
+
+const std::uint64_t* WorldStateBlock::flag_column(const std::string& name) const {
+    auto it = flags_.find(name);
+    return it == flags_.end() ? nullptr : it->second.data();
+}
+
+const std::uint32_t* WorldStateBlock::var_column(const std::string& name) const {
+    auto it = vars_.find(name);
+    return it == vars_.end() ? nullptr : it->second.data();
+}
+
+std::optional<std::uint32_t> WorldStateBlock::value_id(const std::string& value) const {
+    auto it = value_ids_.find(value);
+    if (it == value_ids_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+namespace {
+
+// A compiled op with its columns resolved against one block. Leaves that
+// read keys the block never stored become FALSE.
+struct BatchOp {
+    CompiledCondition::Op::Code code;
+    std::uint32_t arity = 0;
+    const std::uint64_t* flags = nullptr;
+    const std::uint32_t* ids = nullptr;
+    std::uint32_t id = 0;
+};
+
+using Code = CompiledCondition::Op::Code;
+
+std::vector<BatchOp> resolve(const CompiledCondition& condition, const WorldStateBlock& block,
+                             std::size_t& max_depth) {
+    std::vector<BatchOp> ops;
+    ops.reserve(condition.ops().size());
+    std::size_t depth = 0;
+    max_depth = 0;
+    for (const auto& op : condition.ops()) {
+        BatchOp resolved{op.code, op.arity};
+        switch (op.code) {
+            case Code::FLAG:
+                resolved.flags = block.flag_column(condition.keys()[op.key].name);
+                break;
+            case Code::VAR_SET:
+                resolved.ids = block.var_column(condition.keys()[op.key].name);
+                break;
+            case Code::VAR_EQUALS:
+                resolved.ids = block.var_column(condition.keys()[op.key].name);
+                if (auto id = block.value_id(op.value)) {
+                    resolved.id = *id;
+                } else {
+                    resolved.ids = nullptr;
+                }
+                break;
+            default:
+                break;
+        }
+        if ((op.code == Code::FLAG && resolved.flags == nullptr) ||
+            ((op.code == Code::VAR_SET || op.code == Code::VAR_EQUALS) && resolved.ids == nullptr)) {
+            resolved.code = Code::FALSE;
+        }
+        if (op.code == Code::ALL || op.code == Code::ANY) {
+            depth = depth - op.arity + 1;
+        } else if (op.code != Code::NOT) {
+            ++depth;
+        }
+        max_depth = std::max(max_depth, depth);
+        ops.push_back(resolved);
+    }
+    return ops;
+}
+
+void evaluate_scalar(const std::vector<BatchOp>& ops, std::size_t depth, std::size_t steps, std::uint64_t* out) {
+    std::vector<std::uint64_t> stack(depth * kBatchWords);
+    for (std::size_t step = 0; step < steps; ++step) {
+        const std::size_t word = step * kBatchWords;
+        std::size_t top = 0;
+        for (const auto& op : ops) {
+            std::uint64_t* slot = stack.data() + top * kBatchWords;
+            switch (op.code) {
+                case Code::FLAG:
+                    std::copy_n(op.flags + word, kBatchWords, slot);
+                    ++top;
+                    break;
+                case Code::VAR_SET:
+                case Code::VAR_EQUALS:
+                    for (std::size_t w = 0; w < kBatchWords; ++w) {
+                        const std::uint32_t* ids = op.ids + (word + w) * 64;
+                        std::uint64_t bits = 0;
+                        for (std::size_t bit = 0; bit < 64; ++bit) {
+                            const bool match = op.code == Code::VAR_SET ? ids[bit] != WorldStateBlock::kUnset
+                                                                        : ids[bit] == op.id;
+                            bits |= std::uint64_t{match} << bit;
+                        }
+                        slot[w] = bits;
+                    }
+                    ++top;
+                    break;
+                case Code::ALL:
+                case Code::ANY: {
+                    const bool all = op.code == Code::ALL;
+                    std::uint64_t* first = stack.data() + (top - op.arity) * kBatchWords;
+                    if (op.arity == 0) {
+                        std::fill_n(first, kBatchWords, all ? ~std::uint64_t{0} : 0);
+                    }
+                    for (std::uint32_t i = 1; i < op.arity; ++i) {
+                        const std::uint64_t* other = first + i * kBatchWords;
+                        for (std::size_t w = 0; w < kBatchWords; ++w) {
+                            first[w] = all ? first[w] & other[w] : first[w] | other[w];
+                        }
+                    }
+                    top = top - op.arity + 1;
+                    break;
+                }
+                case Code::NOT: {
+                    std::uint64_t* operand = slot - kBatchWords;
+                    for (std::size_t w = 0; w < kBatchWords; ++w) {
+                        operand[w] = ~operand[w];
+                    }
+                    break;
+                }
+                case Code::FALSE:
+                    std::fill_n(slot, kBatchWords, 0);
+                    ++top;
+                    break;
+            }
+        }
+        std::copy_n(stack.data(), kBatchWords, out + word);
+    }
+}
+
+#ifdef GOETHE_BATCH_AVX2
+// 64 value ids compared against one id, eight at a time
+__attribute__((target("avx2"))) inline std::uint64_t match_ids_avx2(const std::uint32_t* ids, __m256i needle) {
+    std::uint64_t bits = 0;
+    for (int lane = 0; lane < 8; ++lane) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + lane * 8));
+        const __m256i equal = _mm256_cmpeq_epi32(values, needle);
+        bits |= std::uint64_t(static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(equal))))
+                << (lane * 8);
+    }
+    return bits;
+}
+
+__attribute__((target("avx2"))) void evaluate_avx2(const std::vector<BatchOp>& ops, std::size_t depth,
+                                                   std::size_t steps, std::uint64_t* out) {
+    // Unaligned accesses: std::vector only guarantees 16-byte alignment
+    std::vector<std::uint64_t> lanes(depth * kBatchWords);
+    std::uint64_t* stack = lanes.data();
+    auto load = [stack](std::size_t index) __attribute__((target("avx2"))) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stack + index * kBatchWords));
+    };
+    auto store = [stack](std::size_t index, __m256i value) __attribute__((target("avx2"))) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(stack + index * kBatchWords), value);
+    };
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    for (std::size_t step = 0; step < steps; ++step) {
+        const std::size_t word = step * kBatchWords;
+        std::size_t top = 0;
+        for (const auto& op : ops) {
+            switch (op.code) {
+                case Code::FLAG:
+                    store(top++, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(op.flags + word)));
+                    break;
+                case Code::VAR_SET:
+                case Code::VAR_EQUALS: {
+                    const __m256i needle = _mm256_set1_epi32(
+                        static_cast<int>(op.code == Code::VAR_SET ? WorldStateBlock::kUnset : op.id));
+                    std::uint64_t words[kBatchWords];
+                    for (std::size_t w = 0; w < kBatchWords; ++w) {
+                        words[w] = match_ids_avx2(op.ids + (word + w) * 64, needle);
+                    }
+                    __m256i result = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+                    store(top++, op.code == Code::VAR_SET ? _mm256_xor_si256(result, ones) : result);
+                    break;
+                }
+                case Code::ALL:
+                case Code::ANY: {
+                    const bool all = op.code == Code::ALL;
+                    const std::size_t first = top - op.arity;
+                    __m256i result = all ? ones : _mm256_setzero_si256();
+                    for (std::uint32_t i = 0; i < op.arity; ++i) {
+                        result = all ? _mm256_and_si256(result, load(first + i))
+                                     : _mm256_or_si256(result, load(first + i));
+                    }
+                    store(first, result);
+                    top = first + 1;
+                    break;
+                }
+                case Code::NOT:
+                    store(top - 1, _mm256_xor_si256(load(top - 1), ones));
+                    break;
+                case Code::FALSE:
+                    store(top++, _mm256_setzero_si256());
+                    break;
+            }
+        }
+        std::copy_n(lanes.data(), kBatchWords, out + word);
+    }
+}
+#endif
+
+using BatchKernel = void(const std::vector<BatchOp>&, std::size_t, std::size_t, std::uint64_t*);
+
+// A batch is one 256-bit lane, so AVX-512 runs the AVX2 kernel
+#ifdef GOETHE_BATCH_AVX2
+constexpr CpuDispatch<BatchKernel> batch_kernel({evaluate_scalar, nullptr, evaluate_avx2, nullptr});
+#else
+constexpr CpuDispatch<BatchKernel> batch_kernel({evaluate_scalar, nullptr, nullptr, nullptr});
+#endif
+
+} // anonymous namespace
+
+CpuTier batch_tier() {
+    return batch_kernel.tier();
+}
+
+std::vector<std::uint64_t> evaluate_batch(const CompiledCondition& condition, const WorldStateBlock& block) {
+    std::size_t depth = 0;
+    const auto ops = resolve(condition, block, depth);
+    std::vector<std::uint64_t> result(block.padded_size() / 64);
+    const std::size_t steps = block.padded_size() / kBatchActors;
+    batch_kernel.get()(ops, depth, steps, result.data());
+
+    // Drop the padding actors
+    result.resize((block.size() + 63) / 64);
+    if (block.size() % 64 != 0) {
+        result.back() &= (std::uint64_t{1} << (block.size() % 64)) - 1;
+    }
+    return result;
+}
+
+} // namespace goethe
@@ -0,0 +1,57 @@
+#include "goethe/cpu_dispatch.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace goethe {
+
+namespace {
+
+CpuTier detect() {
+#if defined(__x86_64__) || defined(__i386__)
+    // __builtin_cpu_supports also checks that the OS saves the wider registers
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return CpuTier::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return CpuTier::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("ssse3")) {
+        return CpuTier::SSE42;
+    }
+#endif
+    return CpuTier::SCALAR;
+}
+
+std::atomic<CpuTier> tier_limit{CpuTier::AVX512};
+
+} // anonymous namespace
+
+CpuTier detected_cpu_tier() {
+    static const CpuTier detected = detect();
+    return detected;
+}
+
+CpuTier active_cpu_tier() {
+    return std::min(detected_cpu_tier(), tier_limit.load(std::memory_order_relaxed));
+}
+
+CpuTier limit_cpu_tier(CpuTier limit) {
+    return tier_limit.exchange(limit, std::memory_order_relaxed);
+}
+
+const char* to_string(CpuTier tier) {
+    switch (tier) {
+        case CpuTier::SCALAR:
+            return "scalar";
+        case CpuTier::SSE42:
+            return "sse4.2";
+        case CpuTier::AVX2:
+            return "avx2";
+        case CpuTier::AVX512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+} // namespace goethe
@@ -1,11 +1,23 @@
 #include "goethe/dialog.hpp"
+#include "goethe/buffer.hpp"
 #include "goethe/goethe_dialog.h"
+#include "goethe/statistics.hpp"
+#include "goethe/trace.hpp"
+#include "goethe/yaml_subset.hpp"
 #include <fstream>
 #include <cstring>
 #include <memory>
 #include <unordered_map>
 #include <random>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <cctype>
+
+#ifdef GOETHE_SIMDJSON_AVAILABLE
+#include <simdjson.h>
+#endif
 
 namespace goethe {
 
@@ -88,6 +100,23 @@ YAML::Node to_yaml(const Condition& condition) {
     return node;
 }
 
+// Narrowest type a scalar converts to: bool, then int, then float, then string
+static std::variant<std::string, int, float, bool> scalar_effect_value(const YAML::Node& value) {
+    try {
+        return value.as<bool>();
+    } catch (...) {
+        try {
+            return value.as<int>();
+        } catch (...) {
+            try {
+                return value.as<float>();
+            } catch (...) {
+                return value.as<std::string>();
+            }
+        }
+    }
+}
+
 void from_yaml(const YAML::Node& node, Effect& effect) {
     // Handle new format: type, target, value
     if (node["type"]) {
@@ -123,20 +152,7 @@ void from_yaml(const YAML::Node& node, Effect& effect) {
                     // Handle as string for now
                     effect.value = node["value"].as<std::string>();
                 } else {
-                    // Try to determine the type
-                    try {
-                        effect.value = node["value"].as<bool>();
-                    } catch (...) {
-                        try {
-                            effect.value = node["value"].as<int>();
-                        } catch (...) {
-                            try {
-                                effect.value = node["value"].as<float>();
-                            } catch (...) {
-                                effect.value = node["value"].as<std::string>();
-                            }
-                        }
-                    }
+                    effect.value = scalar_effect_value(node["value"]);
                 }
             }
         }
@@ -542,13 +558,865 @@ YAML::Node to_yaml(const Dialogue& dialogue) {
     return node;
 }
 
+// ============================================================================
+// Streaming Emitter
+// ============================================================================
+//
+// Writes the same document as to_yaml() without building a YAML::Node tree.
+// Scalars are formatted the way YAML::convert encodes them and every value
+// goes through the same Emitter calls a Node would, so the output is
+// byte-identical to `output << to_yaml(dialogue)`.
+
+namespace {
+
+std::string scalar_text(const std::string& value) {
+    return value;
+}
+
+std::string scalar_text(bool value) {
+    return value ? "true" : "false";
+}
+
+std::string scalar_text(int value) {
+    return std::to_string(value);
+}
+
+std::string scalar_text(float value) {
+    if (std::isnan(value)) return ".nan";
+    if (std::isinf(value)) return std::signbit(value) ? "-.inf" : ".inf";
+    std::ostringstream stream;
+    stream.precision(std::numeric_limits<float>::max_digits10);
+    stream << value;
+    return stream.str();
+}
+
+template <typename T>
+void emit_entry(YAML::Emitter& out, const char* key, const T& value) {
+    out << YAML::Key << key << YAML::Value << scalar_text(value);
+}
+
+void emit_string_map(YAML::Emitter& out, const std::map<std::string, std::string>& values) {
+    out << YAML::BeginMap;
+    for (const auto& [key, value] : values) {
+        out << YAML::Key << key << YAML::Value << value;
+    }
+    out << YAML::EndMap;
+}
+
+// Sequences that to_yaml() leaves empty come out as null, not []
+template <typename T, typename EmitItem>
+void emit_sequence(YAML::Emitter& out, const std::vector<T>& items, EmitItem emit_item) {
+    if (items.empty()) {
+        out << YAML::Null;
+        return;
+    }
+    out << YAML::BeginSeq;
+    for (const auto& item : items) {
+        emit_item(out, item);
+    }
+    out << YAML::EndSeq;
+}
+
+void emit(YAML::Emitter& out, const Condition& condition) {
+    switch (condition.type) {
+        case Condition::Type::ALL:
+        case Condition::Type::ANY:
+            out << YAML::BeginMap << YAML::Key << (condition.type == Condition::Type::ALL ? "all" : "any")
+                << YAML::Value;
+            emit_sequence(out, condition.children, [](YAML::Emitter& o, const Condition& child) { emit(o, child); });
+            out << YAML::EndMap;
+            return;
+        case Condition::Type::NOT:
+            if (condition.children.empty()) break;
+            out << YAML::BeginMap << YAML::Key << "not" << YAML::Value;
+            emit(out, condition.children[0]);
+            out << YAML::EndMap;
+            return;
+        case Condition::Type::FLAG:
+            out << YAML::BeginMap;
+            emit_entry(out, "flag", condition.key);
+            out << YAML::EndMap;
+            return;
+        case Condition::Type::VAR:
+            out << YAML::BeginMap << YAML::Key << "var" << YAML::Value << YAML::BeginMap;
+            emit_entry(out, "name", condition.key);
+            std::visit([&out](const auto& v) { emit_entry(out, "value", v); }, condition.value);
+            out << YAML::EndMap << YAML::EndMap;
+            return;
+        default:
+            break;
+    }
+    out << YAML::Null;
+}
+
+void emit(YAML::Emitter& out, const Effect& effect) {
+    switch (effect.type) {
+        case Effect::Type::SET_FLAG:
+            out << YAML::BeginMap;
+            emit_entry(out, "setFlag", effect.target);
+            out << YAML::EndMap;
+            return;
+        case Effect::Type::SET_VAR:
+            out << YAML::BeginMap << YAML::Key << "setVar" << YAML::Value << YAML::BeginMap;
+            emit_entry(out, "name", effect.target);
+            std::visit([&out](const auto& v) { emit_entry(out, "value", v); }, effect.value);
+            out << YAML::EndMap << YAML::EndMap;
+            return;
+        case Effect::Type::QUEST_ADD:
+            out << YAML::BeginMap;
+            emit_entry(out, "quest.add", effect.target);
+            out << YAML::EndMap;
+            return;
+        case Effect::Type::NOTIFY:
+            out << YAML::BeginMap << YAML::Key << "notify" << YAML::Value << YAML::BeginMap;
+            emit_entry(out, "title", effect.target);
+            emit_entry(out, "body", std::get<std::string>(effect.value));
+            out << YAML::EndMap << YAML::EndMap;
+            return;
+        default:
+            break;
+    }
+    out << YAML::Null;
+}
+
+void emit_effects(YAML::Emitter& out, const std::vector<Effect>& effects) {
+    emit_sequence(out, effects, [](YAML::Emitter& o, const Effect& effect) { emit(o, effect); });
+}
+
+void emit(YAML::Emitter& out, const Line& line) {
+    out << YAML::BeginMap;
+    emit_entry(out, "text", line.text);
+    
+    if (line.voice) {
+        out << YAML::Key << "voice" << YAML::Value << YAML::BeginMap;
+        emit_entry(out, "clipId", line.voice->clipId);
+        if (!line.voice->subtitles) emit_entry(out, "subtitles", line.voice->subtitles);
+        if (line.voice->startMs > 0) emit_entry(out, "startMs", line.voice->startMs);
+        out << YAML::EndMap;
+    }
+    
+    if (line.portrait) {
+        out << YAML::Key << "portrait" << YAML::Value << YAML::BeginMap;
+        emit_entry(out, "id", line.portrait->id);
+        if (!line.portrait->mood.empty()) emit_entry(out, "mood", line.portrait->mood);
+        out << YAML::EndMap;
+    }
+    
+    if (!line.sfx.empty()) {
+        out << YAML::Key << "sfx" << YAML::Value;
+        emit_sequence(out, line.sfx, [](YAML::Emitter& o, const std::string& sfx) { o << sfx; });
+    }
+    
+    if (!line.params.empty()) {
+        out << YAML::Key << "params" << YAML::Value;
+        emit_string_map(out, line.params);
+    }
+    
+    if (line.conditions) {
+        out << YAML::Key << "conditions" << YAML::Value;
+        emit(out, *line.conditions);
+    }
+    
+    if (line.weight != 1.0f) {
+        emit_entry(out, "weight", line.weight);
+    }
+    out << YAML::EndMap;
+}
+
+void emit(YAML::Emitter& out, const Choice& choice) {
+    out << YAML::BeginMap;
+    emit_entry(out, "id", choice.id);
+    emit_entry(out, "text", choice.text);
+    emit_entry(out, "to", choice.to);
+    
+    if (choice.conditions) {
+        out << YAML::Key << "conditions" << YAML::Value;
+        emit(out, *choice.conditions);
+    }
+    
+    if (!choice.effects.empty()) {
+        out << YAML::Key << "effects" << YAML::Value;
+        emit_effects(out, choice.effects);
+    }
+    
+    if (choice.once) emit_entry(out, "once", choice.once);
+    if (choice.cooldownMs > 0) emit_entry(out, "cooldownMs", choice.cooldownMs);
+    if (choice.disabledText) emit_entry(out, "disabledText", *choice.disabledText);
+    out << YAML::EndMap;
+}
+
+void emit(YAML::Emitter& out, const Node& node_obj) {
+    out << YAML::BeginMap;
+    emit_entry(out, "id", node_obj.id);
+    
+    if (node_obj.speaker) {
+        emit_entry(out, "speaker", *node_obj.speaker);
+    }
+    
+    if (!node_obj.tags.empty()) {
+        out << YAML::Key << "tags" << YAML::Value;
+        emit_sequence(out, node_obj.tags, [](YAML::Emitter& o, const std::string& tag) { o << tag; });
+    }
+    
+    if (node_obj.line) {
+        out << YAML::Key << "line" << YAML::Value;
+        emit(out, *node_obj.line);
+    } else if (!node_obj.lines.empty()) {
+        out << YAML::Key << "lines" << YAML::Value;
+        emit_sequence(out, node_obj.lines, [](YAML::Emitter& o, const Line& line) { emit(o, line); });
+    }
+    
+    if (!node_obj.choices.empty()) {
+        out << YAML::Key << "choices" << YAML::Value;
+        emit_sequence(out, node_obj.choices, [](YAML::Emitter& o, const Choice& choice) { emit(o, choice); });
+    }
+    
+    if (!node_obj.onEnterEffects.empty()) {
+        out << YAML::Key << "onEnter" << YAML::Value << YAML::BeginMap << YAML::Key << "effects" << YAML::Value;
+        emit_effects(out, node_obj.onEnterEffects);
+        out << YAML::EndMap;
+    }
+    
+    if (!node_obj.onExitEffects.empty()) {
+        out << YAML::Key << "onExit" << YAML::Value << YAML::BeginMap << YAML::Key << "effects" << YAML::Value;
+        emit_effects(out, node_obj.onExitEffects);
+        out << YAML::EndMap;
+    }
+    
+    if (node_obj.autoAdvanceMs) {
+        emit_entry(out, "autoAdvanceMs", *node_obj.autoAdvanceMs);
+    }
+    
+    if (!node_obj.interruptible) {
+        emit_entry(out, "interruptible", node_obj.interruptible);
+    }
+    out << YAML::EndMap;
+}
+
+void emit(YAML::Emitter& out, const Dialogue& dialogue) {
+    out << YAML::BeginMap;
+    emit_entry(out, "kind", std::string("dialogue"));
+    emit_entry(out, "id", dialogue.id);
+    
+    if (!dialogue.metadata.empty()) {
+        out << YAML::Key << "metadata" << YAML::Value;
+        emit_string_map(out, dialogue.metadata);
+    }
+    
+    if (dialogue.startNode) {
+        emit_entry(out, "startNode", *dialogue.startNode);
+    }
+    
+    out << YAML::Key << "nodes" << YAML::Value;
+    emit_sequence(out, dialogue.nodes, [](YAML::Emitter& o, const Node& node_obj) { emit(o, node_obj); });
+    
+    if (!dialogue.localVars.empty()) {
+        out << YAML::Key << "localVars" << YAML::Value;
+        emit_string_map(out, dialogue.localVars);
+    }
+    out << YAML::EndMap;
+}
+
+} // namespace
+
+// ============================================================================
+// Memory Estimation
+// ============================================================================
+
+namespace {
+
+// Red-black tree node header (colour, parent, left, right) in the common
+// standard library implementations
+constexpr std::size_t kMapNodeOverhead = 4 * sizeof(void*);
+
+// Declared up front so the container templates below can see every overload
+std::size_t heap_size(const std::string& value);
+std::size_t heap_size(const Condition& condition);
+std::size_t heap_size(const Effect& effect);
+std::size_t heap_size(const Voice& voice);
+std::size_t heap_size(const Portrait& portrait);
+std::size_t heap_size(const Line& line);
+std::size_t heap_size(const Choice& choice);
+std::size_t heap_size(const Node& node);
+
+// Heap bytes only; the object itself is counted by its owner
+std::size_t heap_size(const std::string& value) {
+    const char* object = reinterpret_cast<const char*>(&value);
+    const char* data = value.data();
+    bool small_string = data >= object && data < object + sizeof(value);
+    return small_string ? 0 : value.capacity() + 1;
+}
+
+template <typename T>
+std::size_t heap_size(const std::optional<T>& value) {
+    return value ? heap_size(*value) : 0;
+}
+
+template <typename T>
+std::size_t heap_size(const std::vector<T>& values) {
+    std::size_t bytes = values.capacity() * sizeof(T);
+    for (const auto& value : values) {
+        bytes += heap_size(value);
+    }
+    return bytes;
+}
+
+std::size_t heap_size(const std::map<std::string, std::string>& values) {
+    std::size_t bytes = values.size() * (kMapNodeOverhead + sizeof(std::pair<const std::string, std::string>));
+    for (const auto& [key, value] : values) {
+        bytes += heap_size(key) + heap_size(value);
+    }
+    return bytes;
+}
+
+std::size_t heap_size(const std::variant<std::string, int, float, bool>& value) {
+    const auto* text = std::get_if<std::string>(&value);
+    return text ? heap_size(*text) : 0;
+}
+
+std::size_t heap_size(const Condition& condition) {
+    return heap_size(condition.key) + heap_size(condition.value) + heap_size(condition.children);
+}
+
+std::size_t heap_size(const Effect& effect) {
+    return heap_size(effect.target) + heap_size(effect.value) + heap_size(effect.params);
+}
+
+std::size_t heap_size(const Voice& voice) {
+    return heap_size(voice.clipId);
+}
+
+std::size_t heap_size(const Portrait& portrait) {
+    return heap_size(portrait.id) + heap_size(portrait.mood);
+}
+
+std::size_t heap_size(const Line& line) {
+    return heap_size(line.text) + heap_size(line.voice) + heap_size(line.portrait) + heap_size(line.sfx) +
+           heap_size(line.params) + heap_size(line.conditions);
+}
+
+std::size_t heap_size(const Choice& choice) {
+    return heap_size(choice.id) + heap_size(choice.text) + heap_size(choice.to) + heap_size(choice.conditions) +
+           heap_size(choice.effects) + heap_size(choice.disabledText);
+}
+
+std::size_t heap_size(const Node& node) {
+    return heap_size(node.id) + heap_size(node.speaker) + heap_size(node.tags) + heap_size(node.line) +
+           heap_size(node.lines) + heap_size(node.choices) + heap_size(node.onEnterEffects) +
+           heap_size(node.onExitEffects);
+}
+
+} // namespace
+
+std::size_t estimate_memory_usage(const Dialogue& dialogue) {
+    return sizeof(Dialogue) + heap_size(dialogue.id) + heap_size(dialogue.metadata) + heap_size(dialogue.nodes) +
+           heap_size(dialogue.startNode) + heap_size(dialogue.localVars);
+}
+
+// ============================================================================
+// JSON Ingestion
+// ============================================================================
+//
+// Machine-generated dialogues (exporters, build pipelines) are usually JSON.
+// With simdjson the document is walked once with the On-Demand API and fills
+// the structures directly, with no intermediate tree. The mapping mirrors
+// from_yaml(): the same keys, defaults and legacy formats, and string fields
+// accept any scalar the way YAML::Node::as<std::string>() does.
+
+#ifdef GOETHE_SIMDJSON_AVAILABLE
+
+namespace {
+
+namespace json = simdjson::ondemand;
+
+[[noreturn]] void missing_field(const char* object, const char* field) {
+    throw std::runtime_error(std::string("JSON dialogue: ") + object + " missing required '" + field + "' field");
+}
+
+// Text of a scalar: strings are unescaped, numbers and booleans keep their
+// literal spelling and null reads as "null"
+std::string json_text(json::value& value) {
+    switch (json::json_type(value.type())) {
+        case json::json_type::string:
+            return std::string(std::string_view(value.get_string()));
+        case json::json_type::number:
+        case json::json_type::boolean: {
+            std::string_view token = value.raw_json_token();
+            while (!token.empty() && std::isspace(static_cast<unsigned char>(token.back()))) {
+                token.remove_suffix(1);
+            }
+            return std::string(token);
+        }
+        case json::json_type::null:
+            return "null";
+        default:
+            throw std::runtime_error("JSON dialogue: expected a scalar value");
+    }
+}
+
+bool is_scalar(json::value& value) {
+    auto type = json::json_type(value.type());
+    return type != json::json_type::object && type != json::json_type::array && type != json::json_type::null;
+}
+
+// Typed values take the fast path; anything else converts like a YAML scalar
+bool json_bool(json::value& value) {
+    if (json::json_type(value.type()) == json::json_type::boolean) {
+        return value.get_bool();
+    }
+    return YAML::Node(json_text(value)).as<bool>();
+}
+
+int json_int(json::value& value) {
+    if (json::json_type(value.type()) == json::json_type::number) {
+        int64_t number = value.get_int64();
+        if (number < std::numeric_limits<int>::min() || number > std::numeric_limits<int>::max()) {
+            throw std::runtime_error("JSON dialogue: integer out of range");
+        }
+        return static_cast<int>(number);
+    }
+    return YAML::Node(json_text(value)).as<int>();
+}
+
+float json_float(json::value& value) {
+    if (json::json_type(value.type()) == json::json_type::number) {
+        return static_cast<float>(double(value.get_double()));
+    }
+    return YAML::Node(json_text(value)).as<float>();
+}
+
+void read_json(json::value& value, std::map<std::string, std::string>& map) {
+    for (json::field field : value.get_object()) {
+        std::string key(std::string_view(field.unescaped_key()));
+        map[std::move(key)] = json_text(field.value());
+    }
+}
+
+void read_json(json::value& value, std::vector<std::string>& strings) {
+    for (json::value element : value.get_array()) {
+        strings.push_back(json_text(element));
+    }
+}
+
+void read_json(json::value& value, Condition& condition) {
+    // from_yaml() checks all, any, not, flag, var in that order; keep the
+    // first one present in that order regardless of key order in the object
+    int rank = 5;
+    for (json::field field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        json::value child = field.value();
+        Condition parsed;
+        int parsed_rank;
+        if (key == "all" || key == "any") {
+            parsed_rank = key == "all" ? 0 : 1;
+            parsed.type = key == "all" ? Condition::Type::ALL : Condition::Type::ANY;
+            for (json::value element : child.get_array()) {
+                read_json(element, parsed.children.emplace_back());
+            }
+        } else if (key == "not") {
+            parsed_rank = 2;
+            parsed.type = Condition::Type::NOT;
+            read_json(child, parsed.children.emplace_back());
+        } else if (key == "flag") {
+            parsed_rank = 3;
+            parsed.type = Condition::Type::FLAG;
+            parsed.key = json_text(child);
+        } else if (key == "var") {
+            parsed_rank = 4;
+            parsed.type = Condition::Type::VAR;
+            bool has_name = false;
+            for (json::field var : child.get_object()) {
+                std::string_view var_key = var.unescaped_key();
+                if (var_key == "name") {
+                    parsed.key = json_text(var.value());
+                    has_name = true;
+                } else if (var_key == "value" && is_scalar(var.value())) {
+                    parsed.value = json_text(var.value());
+                }
+            }
+            if (!has_name) missing_field("var", "name");
+        } else {
+            continue;
+        }
+        if (parsed_rank < rank) {
+            condition = std::move(parsed);
+            rank = parsed_rank;
+        }
+    }
+}
+
+Effect::Type effect_type(std::string_view name, Effect::Type fallback) {
+    static const std::pair<std::string_view, Effect::Type> types[] = {
+        {"SET_FLAG", Effect::Type::SET_FLAG},       {"SET_VAR", Effect::Type::SET_VAR},
+        {"QUEST_ADD", Effect::Type::QUEST_ADD},     {"QUEST_COMPLETE", Effect::Type::QUEST_COMPLETE},
+        {"NOTIFY", Effect::Type::NOTIFY},           {"PLAY_SFX", Effect::Type::PLAY_SFX},
+        {"PLAY_MUSIC", Effect::Type::PLAY_MUSIC},   {"TELEPORT", Effect::Type::TELEPORT},
+    };
+    for (const auto& [type_name, type] : types) {
+        if (type_name == name) return type;
+    }
+    return fallback;
+}
+
+void read_json(json::value& value, Effect& effect) {
+    // The new format (type/target/value/params) wins over the legacy keys,
+    // and among legacy keys the first in from_yaml()'s order wins
+    Effect modern{};
+    bool has_type = false;
+    int rank = 4;
+    for (json::field field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        json::value child = field.value();
+        if (key == "type") {
+            modern.type = effect_type(json_text(child), modern.type);
+            has_type = true;
+        } else if (key == "target") {
+            modern.target = json_text(child);
+        } else if (key == "value") {
+            if (is_scalar(child)) {
+                modern.value = scalar_effect_value(YAML::Node(json_text(child)));
+            }
+        } else if (key == "params") {
+            read_json(child, modern.params);
+        } else if (key == "setFlag" && rank > 0) {
+            effect.type = Effect::Type::SET_FLAG;
+            effect.target = json_text(child);
+            rank = 0;
+        } else if (key == "setVar" && rank > 1) {
+            effect.type = Effect::Type::SET_VAR;
+            bool has_name = false;
+            for (json::field var : child.get_object()) {
+                std::string_view var_key = var.unescaped_key();
+                if (var_key == "name") {
+                    effect.target = json_text(var.value());
+                    has_name = true;
+                } else if (var_key == "value" && is_scalar(var.value())) {
+                    effect.value = json_text(var.value());
+                }
+            }
+            if (!has_name) missing_field("setVar", "name");
+            rank = 1;
+        } else if (key == "quest.add" && rank > 2) {
+            effect.type = Effect::Type::QUEST_ADD;
+            effect.target = json_text(child);
+            rank = 2;
+        } else if (key == "notify" && rank > 3) {
+            effect.type = Effect::Type::NOTIFY;
+            bool has_title = false;
+            bool has_body = false;
+            for (json::field notify : child.get_object()) {
+                std::string_view notify_key = notify.unescaped_key();
+                if (notify_key == "title") {
+                    effect.target = json_text(notify.value());
+                    has_title = true;
+                } else if (notify_key == "body") {
+                    effect.value = json_text(notify.value());
+                    has_body = true;
+                }
+            }
+            if (!has_title) missing_field("notify", "title");
+            if (!has_body) missing_field("notify", "body");
+            rank = 3;
+        }
+    }
+    if (has_type) {
+        effect = std::move(modern);
+    }
+}
+
+void read_json(json::value& value, std::vector<Effect>& effects) {
+    for (json::value element : value.get_array()) {
+        read_json(element, effects.emplace_back());
+    }
+}
+
+// onEnter / onExit hold their effects under an "effects" key
+void read_json_effect_block(json::value& value, std::vector<Effect>& effects) {
+    for (json::field field : value.get_object()) {
+        if (std::string_view(field.unescaped_key()) == "effects") {
+            read_json(field.value(), effects);
+        }
+    }
+}
+
+void read_json(json::value& value, Voice& voice) {
+    bool has_clip = false;
+    for (json::field field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        if (key == "clipId") {
+            voice.clipId = json_text(field.value());
+            has_clip = true;
+        } else if (key == "subtitles") {
+            voice.subtitles = json_bool(field.value());
+        } else if (key == "startMs") {
+            voice.startMs = json_int(field.value());
+        }
+    }
+    if (!has_clip) missing_field("voice", "clipId");
+}
+
+void read_json(json::value& value, Portrait& portrait) {
+    bool has_id = false;
+    for (json::field field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        if (key == "id") {
+            portrait.id = json_text(field.value());
+            has_id = true;
+        } else if (key == "mood") {
+            portrait.mood = json_text(field.value());
+        }
+    }
+    if (!has_id) missing_field("portrait", "id");
+}
+
+void read_json(json::value& value, Line& line) {
+    bool has_text = false;
+    for (json::field field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        json::value child = field.value();
+        if (key == "text") {
+            line.text = json_text(child);
+            has_text = true;
+        } else if (key == "voice") {
+            read_json(child, line.voice.emplace());
+        } else if (key == "portrait") {
+            read_json(child, line.portrait.emplace());
+        } else if (key == "sfx") {
+            read_json(child, line.sfx);
+        } else if (key == "params") {
+            read_json(child, line.params);
+        } else if (key == "conditions") {
+            read_json(child, line.conditions.emplace());
+        } else if (key == "weight") {
+            line.weight = json_float(child);
+        }
+    }
+    if (!has_text) missing_field("line", "text");
+}
+
+void read_json(json::value& value, Choice& choice) {
+    bool has_id = false;
+    bool has_text = false;
+    bool has_to = false;
+    for (json::field field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        json::value child = field.value();
+        if (key == "id") {
+            choice.id = json_text(child);
+            has_id = true;
+        } else if (key == "text") {
+            choice.text = json_text(child);
+            has_text = true;
+        } else if (key == "to") {
+            choice.to = json_text(child);
+            has_to = true;
+        } else if (key == "conditions") {
+            read_json(child, choice.conditions.emplace());
+        } else if (key == "effects") {
+            read_json(child, choice.effects);
+        } else if (key == "once") {
+            choice.once = json_bool(child);
+        } else if (key == "cooldownMs") {
+            choice.cooldownMs = json_int(child);
+        } else if (key == "disabledText") {
+            choice.disabledText = json_text(child);
+        }
+    }
+    if (!has_id) missing_field("choice", "id");
+    if (!has_text) missing_field("choice", "text");
+    if (!has_to) missing_field("choice", "to");
+}
+
+void read_json(json::value& value, Node& node) {
+    bool has_id = false;
+    bool has_legacy_auto_advance = false;
+    std::optional<int> legacy_auto_advance;
+    for (json::field field : value.get_object()) {
+        std::string_view key = field.unescaped_key();
+        json::value child = field.value();
+        if (key == "id") {
+            node.id = json_text(child);
+            has_id = true;
+        } else if (key == "speaker") {
+            node.speaker = json_text(child);
+        } else if (key == "tags") {
+            read_json(child, node.tags);
+        } else if (key == "line") {
+            // A single line takes precedence over a variant list
+            node.lines.clear();
+            read_json(child, node.line.emplace());
+        } else if (key == "lines") {
+            if (!node.line) {
+                for (json::value element : child.get_array()) {
+                    read_json(element, node.lines.emplace_back());
+                }
+            }
+        } else if (key == "choices") {
+            for (json::value element : child.get_array()) {
+                read_json(element, node.choices.emplace_back());
+            }
+        } else if (key == "onEnter") {
+            read_json_effect_block(child, node.onEnterEffects);
+        } else if (key == "onExit") {
+            read_json_effect_block(child, node.onExitEffects);
+        } else if (key == "autoAdvanceMs") {
+            node.autoAdvanceMs = json_int(child);
+        } else if (key == "autoAdvance") {
+            for (json::field auto_advance : child.get_object()) {
+                if (std::string_view(auto_advance.unescaped_key()) == "ms") {
+                    legacy_auto_advance = json_int(auto_advance.value());
+                }
+            }
+            has_legacy_auto_advance = true;
+        } else if (key == "interruptible") {
+            node.interruptible = json_bool(child);
+        }
+    }
+    if (!has_id) missing_field("node", "id");
+    if (!node.autoAdvanceMs && has_legacy_auto_advance) {
+        if (!legacy_auto_advance) missing_field("autoAdvance", "ms");
+        node.autoAdvanceMs = legacy_auto_advance;
+    }
+}
+
+Dialogue parse_json_dialogue(simdjson::padded_string_view input) {
+    // Parsers keep their buffers between documents; one per thread
+    thread_local json::parser parser;
+    json::document document = parser.iterate(input);
+    if (json::json_type(document.type()) != json::json_type::object) {
+        throw std::runtime_error("Invalid dialogue format: root must be an object");
+    }
+
+    Dialogue dialogue;
+    bool has_id = false;
+    bool has_nodes = false;
+    for (json::field field : document.get_object()) {
+        std::string_view key = field.unescaped_key();
+        json::value child = field.value();
+        if (key == "id") {
+            dialogue.id = json_text(child);
+            has_id = true;
+        } else if (key == "metadata") {
+            read_json(child, dialogue.metadata);
+        } else if (key == "startNode") {
+            dialogue.startNode = json_text(child);
+        } else if (key == "nodes") {
+            for (json::value element : child.get_array()) {
+                read_json(element, dialogue.nodes.emplace_back());
+            }
+            has_nodes = true;
+        } else if (key == "localVars") {
+            read_json(child, dialogue.localVars);
+        }
+    }
+    if (!document.at_end()) {
+        throw simdjson::simdjson_error(simdjson::TRAILING_CONTENT);
+    }
+    if (!has_id) {
+        throw std::runtime_error("Dialogue missing required 'id' field");
+    }
+    if (!has_nodes) {
+        throw std::runtime_error("Dialogue missing required 'nodes' field");
+    }
+    return dialogue;
+}
+
+} // anonymous namespace
+
+Dialogue read_dialogue_json(std::string_view json) {
+    TraceScope trace("read_dialogue_json", "dialogue");
+    try {
+        return parse_json_dialogue(simdjson::padded_string(json));
+    } catch (const simdjson::simdjson_error& e) {
+        throw std::runtime_error("JSON parsing error: " + std::string(e.what()));
+    }
+}
+
+Dialogue read_dialogue_json(std::istream& input) {
+    TraceScope trace("read_dialogue_json", "dialogue");
+    const BufferSlice buffer = read_stream(input, simdjson::SIMDJSON_PADDING);
+    try {
+        return parse_json_dialogue(
+            simdjson::padded_string_view(buffer.view().data(), buffer.size(), buffer.size() + buffer.tail_capacity()));
+    } catch (const simdjson::simdjson_error& e) {
+        throw std::runtime_error("JSON parsing error: " + std::string(e.what()));
+    }
+}
+
+#else
+
+// Without simdjson, JSON is read as the YAML flow document it also is
+Dialogue read_dialogue_json(std::istream& input) {
+    TraceScope trace("read_dialogue_json", "dialogue");
+    try {
+        // LoadAll, so trailing content after the object is an error as in JSON
+        std::vector<YAML::Node> documents = YAML::LoadAll(input);
+        if (documents.size() != 1 || !documents.front().IsMap()) {
+            throw std::runtime_error("Invalid dialogue format: root must be an object");
+        }
+        Dialogue dialogue;
+        from_yaml(documents.front(), dialogue);
+        return dialogue;
+    } catch (const YAML::Exception& e) {
+        throw std::runtime_error("JSON parsing error: " + std::string(e.what()));
+    }
+}
+
+Dialogue read_dialogue_json(std::string_view json) {
+    std::istringstream input{std::string(json)};
+    return read_dialogue_json(input);
+}
+
+#endif // GOETHE_SIMDJSON_AVAILABLE
+
 // ============================================================================
 // Core Functions
 // ============================================================================
 
-goethe::Dialogue read_dialogue(std::istream& input) {
+namespace {
+
+#ifdef GOETHE_SIMDJSON_AVAILABLE
+constexpr std::size_t kReadPadding = simdjson::SIMDJSON_PADDING;
+#else
+constexpr std::size_t kReadPadding = 0;
+#endif
+
+// Lets yaml-cpp read a document in place
+class MemoryStreamBuf : public std::streambuf {
+public:
+    explicit MemoryStreamBuf(std::string_view text) {
+        char* begin = const_cast<char*>(text.data());
+        setg(begin, begin, begin + text.size());
+    }
+};
+
+Dialogue read_document(const BufferSlice& document) {
     try {
-        YAML::Node node = YAML::Load(input);
+        const std::string_view text = document.view();
+#ifdef GOETHE_SIMDJSON_AVAILABLE
+        // JSON documents take the simdjson path. Flow-style YAML also starts
+        // with '{', so anything simdjson rejects is read as YAML below.
+        const auto first = text.find_first_not_of(" \t\r\n");
+        if (first != std::string_view::npos && text[first] == '{') {
+            try {
+                if (document.tail_capacity() >= simdjson::SIMDJSON_PADDING) {
+                    return parse_json_dialogue(
+                        simdjson::padded_string_view(text.data(), text.size(), text.size() + document.tail_capacity()));
+                }
+                return parse_json_dialogue(simdjson::padded_string(text));
+            } catch (const simdjson::simdjson_error&) {
+                // Not JSON
+            }
+        }
+#endif
+        // Files in the GOETHE subset of YAML skip yaml-cpp. Everything else,
+        // including every malformed file, is left to yaml-cpp and its errors.
+        if (auto dialogue = read_dialogue_subset(text)) {
+            return std::move(*dialogue);
+        }
+        MemoryStreamBuf streambuf(text);
+        std::istream stream(&streambuf);
+        YAML::Node node = YAML::Load(stream);
         if (!node.IsMap()) {
             throw std::runtime_error("Invalid dialogue format: root must be a map");
         }
@@ -565,9 +1433,25 @@ goethe::Dialogue read_dialogue(std::istream& input) {
     }
 }
 
+} // anonymous namespace
+
+goethe::Dialogue read_dialogue(std::istream& input) {
+    TraceScope trace("read_dialogue", "dialogue");
+    return read_document(read_stream(input, kReadPadding));
+}
+
+goethe::Dialogue read_dialogue(const BufferSlice& document) {
+    TraceScope trace("read_dialogue", "dialogue");
+    return read_document(document);
+}
+
 void write_dialogue(std::ostream& output, const goethe::Dialogue& dialogue) {
-    YAML::Node node = to_yaml(dialogue);
-    output << node;
+    TraceScope trace("write_dialogue", "dialogue");
+    YAML::Emitter emitter(output);
+    emit(emitter, dialogue);
+    if (!emitter.good()) {
+        throw std::runtime_error("YAML emitter error: " + emitter.GetLastError());
+    }
 }
 
 } // namespace goethe
@@ -582,6 +1466,7 @@ extern "C" {
 struct DialogImpl {
     goethe::Dialogue dialogue;
     std::vector<std::string> string_storage; // Keep strings alive
+    goethe::MemoryAccount memory; // Reported under MemoryCategory::DIALOGUE once loaded
 };
 
 GOETHE_API GoetheDialog* goethe_dialog_create(void) {
@@ -598,11 +1483,10 @@ GOETHE_API int goethe_dialog_load_from_file(GoetheDialog* dialog, const char* fi
     if (!dialog || !filename) return -1;
     
     try {
-        std::ifstream file(filename);
-        if (!file.is_open()) return -1;
-        
         auto impl = reinterpret_cast<DialogImpl*>(dialog);
-        impl->dialogue = goethe::read_dialogue(file);
+        impl->dialogue = goethe::read_dialogue(goethe::read_file(filename, goethe::kReadPadding));
+        impl->memory = goethe::MemoryAccount(goethe::MemoryCategory::DIALOGUE, impl->dialogue.id,
+                                             goethe::estimate_memory_usage(impl->dialogue));
         return 0;
     } catch (...) {
         return -1;
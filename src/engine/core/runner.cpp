@@ -0,0 +1,437 @@
+#include "goethe/runner.hpp"
+#include "goethe/allocator.hpp"
+#include "goethe/trace.hpp"
+#include <algorithm>
+#include <array>
+#include <new>
+#include <stdexcept>
+
+namespace goethe {
+
+// ============================================================================
+// Dialogue Runner
+// ============================================================================
+
+DialogueStepAwaitable::~DialogueStepAwaitable() {
+    // A script destroyed while suspended takes its awaitable with it
+    if (runner_ != nullptr && runner_->waiting_ == this) {
+        runner_->waiting_ = nullptr;
+    }
+}
+
+void DialogueStepAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    runner_->waiting_ = this;
+}
+
+DialogueStep DialogueStepAwaitable::await_resume() {
+    return runner_->step_;
+}
+
+DialogueRunner::DialogueRunner(const Dialogue& dialogue, WorldState& world, IDialoguePort* port,
+                               std::uint32_t seed)
+    : dialogue_(dialogue), world_(world), port_(port), rng_(seed), conditions_(world) {
+    node_index_.reserve(dialogue_.nodes.size());
+    for (std::size_t i = 0; i < dialogue_.nodes.size(); ++i) {
+        node_index_.emplace(dialogue_.nodes[i].id, i);
+    }
+}
+
+DialogueRunner::~DialogueRunner() {
+    if (waiting_ != nullptr) {
+        waiting_->runner_ = nullptr;
+    }
+}
+
+void DialogueRunner::check_idle_operation() const {
+    if (waiting_ != nullptr) {
+        throw std::logic_error("DialogueRunner: a step is already pending");
+    }
+}
+
+DialogueStepAwaitable DialogueRunner::next() {
+    check_idle_operation();
+    if (wait_ != Wait::NONE) {
+        // Polling again after tick, without a coroutine
+        return DialogueStepAwaitable(*this, pump());
+    }
+
+    switch (step_.state) {
+        case DialogueState::IDLE: {
+            step_.host_effects.clear();
+            std::size_t start = 0;
+            if (dialogue_.startNode) {
+                auto it = node_index_.find(*dialogue_.startNode);
+                if (it == node_index_.end()) {
+                    throw std::runtime_error("DialogueRunner: unknown start node '" + *dialogue_.startNode + "'");
+                }
+                start = it->second;
+            }
+            if (dialogue_.nodes.empty()) {
+                complete();
+            } else {
+                enter_node(start);
+            }
+            break;
+        }
+        case DialogueState::WAITING_CHOICE:
+            throw std::logic_error("DialogueRunner: node '" + step_.node->id + "' is waiting for a choice");
+        case DialogueState::RUNNING:
+            // Nodes without autoAdvanceMs continue at once
+            wait_ = Wait::TIMER;
+            return DialogueStepAwaitable(*this, pump());
+        default:
+            break; // Completed dialogues stay completed
+    }
+    return DialogueStepAwaitable(*this, wait_ == Wait::NONE);
+}
+
+DialogueStepAwaitable DialogueRunner::choose(const std::string& choice_id) {
+    check_idle_operation();
+    if (step_.state != DialogueState::WAITING_CHOICE || wait_ != Wait::NONE) {
+        throw std::logic_error("DialogueRunner: no choice is being offered");
+    }
+    auto offered = std::find_if(step_.choices.begin(), step_.choices.end(),
+                                [&](const DialogueStep::ChoiceView& view) { return view.choice->id == choice_id; });
+    if (offered == step_.choices.end() || !offered->enabled) {
+        throw std::invalid_argument("DialogueRunner: choice '" + choice_id + "' is not available");
+    }
+    const Choice& choice = *offered->choice;
+    std::size_t target = 0;
+    if (choice.to != "$END") {
+        auto it = node_index_.find(choice.to);
+        if (it == node_index_.end()) {
+            throw std::runtime_error("DialogueRunner: unknown node '" + choice.to + "'");
+        }
+        target = it->second;
+    }
+
+    step_.host_effects.clear();
+    run_effects(choice.effects);
+    if (choice.once) {
+        chosen_once_.insert(&choice);
+    }
+    if (choice.cooldownMs > 0) {
+        cooldown_until_ms_[&choice] = now_ms_ + choice.cooldownMs;
+    }
+    leave_node();
+    if (choice.to == "$END") {
+        complete();
+    } else {
+        enter_node(target);
+    }
+    return DialogueStepAwaitable(*this, wait_ == Wait::NONE);
+}
+
+void DialogueRunner::tick(int elapsed_ms) {
+    now_ms_ += elapsed_ms;
+    if (wait_ == Wait::NONE || !pump() || waiting_ == nullptr) {
+        return;
+    }
+    DialogueStepAwaitable* awaitable = std::exchange(waiting_, nullptr);
+    awaitable->ready_ = true;
+    awaitable->handle_.resume();
+}
+
+bool DialogueRunner::pump() {
+    if (wait_ == Wait::TIMER) {
+        const Node& node = dialogue_.nodes[node_];
+        if (now_ms_ < entered_at_ms_ + node.autoAdvanceMs.value_or(0)) {
+            return false;
+        }
+        wait_ = Wait::NONE;
+        step_.host_effects.clear();
+        leave_node();
+        if (node_ + 1 < dialogue_.nodes.size()) {
+            enter_node(node_ + 1);
+        } else {
+            complete();
+        }
+    } else if (wait_ == Wait::PRESENT) {
+        if (!present()) {
+            return false;
+        }
+        wait_ = Wait::NONE;
+    }
+    return wait_ == Wait::NONE;
+}
+
+void DialogueRunner::enter_node(std::size_t index) {
+    TraceScope trace("enter_node", "dialogue");
+    const Node& node = dialogue_.nodes[index];
+    node_ = index;
+    entered_at_ms_ = now_ms_;
+    run_effects(node.onEnterEffects);
+
+    step_.node = &node;
+    step_.line = pick_line(node);
+    choice_conditions_.clear();
+    for (const auto& choice : node.choices) {
+        if (choice.conditions) {
+            choice_conditions_.push_back(conditions_.intern(*choice.conditions));
+        }
+    }
+    step_.choices = offered_choices(node);
+    step_.state = step_.choices.empty() ? DialogueState::RUNNING : DialogueState::WAITING_CHOICE;
+
+    if (port_ != nullptr && !present()) {
+        wait_ = Wait::PRESENT;
+    }
+}
+
+bool DialogueRunner::refresh() {
+    if (step_.node == nullptr || wait_ != Wait::NONE) {
+        return false;
+    }
+    const bool stale = std::any_of(choice_conditions_.begin(), choice_conditions_.end(),
+                                   [this](ConditionCache::Id id) { return conditions_.is_dirty(id); });
+    if (!stale) {
+        return false;
+    }
+
+    auto choices = offered_choices(*step_.node);
+    const bool changed = choices.size() != step_.choices.size() ||
+        !std::equal(choices.begin(), choices.end(), step_.choices.begin(), [](const auto& a, const auto& b) {
+            return a.choice == b.choice && a.enabled == b.enabled;
+        });
+    if (!changed) {
+        return false;
+    }
+    step_.choices = std::move(choices);
+    step_.state = step_.choices.empty() ? DialogueState::RUNNING : DialogueState::WAITING_CHOICE;
+    if (port_ != nullptr && !present()) {
+        wait_ = Wait::PRESENT;
+    }
+    return true;
+}
+
+std::vector<DialogueStep::ChoiceView> DialogueRunner::offered_choices(const Node& node) {
+    std::vector<DialogueStep::ChoiceView> choices;
+    for (const auto& choice : node.choices) {
+        if (choice.once && chosen_once_.count(&choice)) {
+            continue;
+        }
+        auto cooldown = cooldown_until_ms_.find(&choice);
+        if (cooldown != cooldown_until_ms_.end() && now_ms_ < cooldown->second) {
+            continue;
+        }
+        const bool enabled = holds(choice.conditions);
+        if (enabled || choice.disabledText) {
+            choices.push_back({&choice, enabled});
+        }
+    }
+    return choices;
+}
+
+bool DialogueRunner::holds(const std::optional<Condition>& condition) {
+    return !condition || conditions_.evaluate(conditions_.intern(*condition));
+}
+
+void DialogueRunner::leave_node() {
+    run_effects(dialogue_.nodes[node_].onExitEffects);
+}
+
+void DialogueRunner::complete() {
+    step_.state = DialogueState::COMPLETED;
+    step_.node = nullptr;
+    step_.line = nullptr;
+    step_.choices.clear();
+}
+
+void DialogueRunner::run_effects(const std::vector<Effect>& effects) {
+    for (const auto& effect : effects) {
+        if (!apply(effect, world_)) {
+            step_.host_effects.push_back(&effect);
+        }
+    }
+}
+
+const Line* DialogueRunner::pick_line(const Node& node) {
+    if (node.line) {
+        return holds(node.line->conditions) ? &*node.line : nullptr;
+    }
+
+    // Weighted pick among the variants whose conditions hold
+    float total = 0.0f;
+    for (const auto& line : node.lines) {
+        if (line.weight > 0.0f && holds(line.conditions)) {
+            total += line.weight;
+        }
+    }
+    if (total <= 0.0f) {
+        return nullptr;
+    }
+    float pick = std::uniform_real_distribution<float>(0.0f, total)(rng_);
+    const Line* chosen = nullptr;
+    for (const auto& line : node.lines) {
+        if (line.weight > 0.0f && holds(line.conditions)) {
+            chosen = &line;
+            pick -= line.weight;
+            if (pick < 0.0f) {
+                break;
+            }
+        }
+    }
+    return chosen;
+}
+
+bool DialogueRunner::present() {
+    const bool show_disabled = port_->getCapabilities().supportsDisabledChoices;
+    std::vector<IDialoguePort::NodePayload> payload;
+    if (step_.line != nullptr) {
+        IDialoguePort::NodePayload line_payload;
+        line_payload.type = "line";
+        line_payload.line = IDialoguePort::LinePayload{step_.line->text, step_.line->voice, step_.line->portrait,
+                                                       step_.line->sfx};
+        payload.push_back(std::move(line_payload));
+    }
+    if (!step_.choices.empty()) {
+        std::vector<IDialoguePort::ChoicePayload> choices;
+        for (const auto& view : step_.choices) {
+            if (view.enabled) {
+                choices.push_back({view.choice->id, view.choice->text, false});
+            } else if (show_disabled) {
+                choices.push_back({view.choice->id, *view.choice->disabledText, true});
+            }
+        }
+        IDialoguePort::NodePayload choices_payload;
+        choices_payload.type = "choices";
+        choices_payload.choices = std::move(choices);
+        payload.push_back(std::move(choices_payload));
+    }
+    return port_->presentNode(dialogue_.id, step_.node->id, payload);
+}
+
+DialogueSnapshot DialogueRunner::snapshot() const {
+    DialogueSnapshot snapshot;
+    snapshot.dialogueId = dialogue_.id;
+    snapshot.localVars = dialogue_.localVars;
+    if (step_.node != nullptr) {
+        snapshot.currentNodeId = step_.node->id;
+        if (step_.node->autoAdvanceMs) {
+            snapshot.timeLeftMs = static_cast<int>(
+                std::max<std::int64_t>(0, entered_at_ms_ + *step_.node->autoAdvanceMs - now_ms_));
+        }
+    }
+    return snapshot;
+}
+
+// ============================================================================
+// Coroutine Frames
+// ============================================================================
+
+namespace {
+
+constexpr std::size_t kFrameGranularity = 64;
+constexpr std::size_t kFrameClasses = 64; // Frames up to 4 KiB are pooled
+
+// Sits in front of every frame and records where its memory came from. The
+// size keeps the frame at operator new's alignment.
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) FrameHeader {
+    std::pmr::memory_resource* resource;
+};
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+FrameHeader* header_of(void* frame) {
+    return static_cast<FrameHeader*>(frame) - 1;
+}
+
+void* new_frame(std::size_t bytes, std::pmr::memory_resource* resource) {
+    void* memory = resource->allocate(sizeof(FrameHeader) + bytes, alignof(FrameHeader));
+    auto* header = ::new (memory) FrameHeader{resource};
+    return header + 1;
+}
+
+void delete_frame(void* frame, std::size_t bytes) noexcept {
+    FrameHeader* header = header_of(frame);
+    header->resource->deallocate(header, sizeof(FrameHeader) + bytes, alignof(FrameHeader));
+}
+
+struct FrameFreeLists {
+    std::array<FreeFrame*, kFrameClasses> heads{};
+    CoroutineFramePool::Stats stats;
+
+    ~FrameFreeLists() {
+        for (std::size_t size_class = 0; size_class < kFrameClasses; ++size_class) {
+            for (FreeFrame* head = heads[size_class]; head != nullptr;) {
+                delete_frame(std::exchange(head, head->next), (size_class + 1) * kFrameGranularity);
+            }
+        }
+    }
+};
+
+thread_local FrameFreeLists frame_lists;
+
+std::size_t frame_class(std::size_t size) {
+    return (size + kFrameGranularity - 1) / kFrameGranularity - 1;
+}
+
+} // anonymous namespace
+
+void* CoroutineFramePool::allocate(std::size_t size) {
+    std::pmr::memory_resource* resource = memory_resource();
+    const std::size_t size_class = frame_class(size);
+    if (size_class >= kFrameClasses) {
+        ++frame_lists.stats.allocated;
+        return new_frame(size, resource);
+    }
+    FreeFrame*& head = frame_lists.heads[size_class];
+    while (head != nullptr) {
+        FreeFrame* frame = std::exchange(head, head->next);
+        if (header_of(frame)->resource == resource) {
+            ++frame_lists.stats.reused;
+            return frame;
+        }
+        // Cached before set_allocator() switched resources
+        delete_frame(frame, (size_class + 1) * kFrameGranularity);
+    }
+    ++frame_lists.stats.allocated;
+    return new_frame((size_class + 1) * kFrameGranularity, resource);
+}
+
+void CoroutineFramePool::deallocate(void* frame, std::size_t size) noexcept {
+    const std::size_t size_class = frame_class(size);
+    if (size_class >= kFrameClasses) {
+        delete_frame(frame, size);
+        return;
+    }
+    if (header_of(frame)->resource != memory_resource()) {
+        delete_frame(frame, (size_class + 1) * kFrameGranularity);
+        return;
+    }
+    // Frames freed on another thread join that thread's lists
+    auto* free_frame = static_cast<FreeFrame*>(frame);
+    free_frame->next = frame_lists.heads[size_class];
+    frame_lists.heads[size_class] = free_frame;
+}
+
+CoroutineFramePool::Stats CoroutineFramePool::thread_stats() {
+    return frame_lists.stats;
+}
+
+DialogueScript& DialogueScript::operator=(DialogueScript&& other) noexcept {
+    if (this != &other) {
+        if (handle_) {
+            handle_.destroy();
+        }
+        handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+}
+
+DialogueScript::~DialogueScript() {
+    if (handle_) {
+        handle_.destroy();
+    }
+}
+
+void DialogueScript::rethrow_if_failed() const {
+    if (handle_ && handle_.promise().error) {
+        std::rethrow_exception(handle_.promise().error);
+    }
+}
+
+} // namespace goethe
@@ -1,8 +1,13 @@
 #include "goethe/statistics.hpp"
 #include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <iomanip>
+#include <map>
 #include <sstream>
 #include <cmath>
+#include <utility>
 
 namespace goethe {
 
@@ -46,6 +51,13 @@ BackendStats::BackendStats(const BackendStats& other)
     total_decompressed_size.store(other.total_decompressed_size.load());
     total_compression_time_ns.store(other.total_compression_time_ns.load());
     total_decompression_time_ns.store(other.total_decompression_time_ns.load());
+    skipped_compressions.store(other.skipped_compressions.load());
+    skipped_input_size.store(other.skipped_input_size.load());
+    saved_compression_time_ns.store(other.saved_compression_time_ns.load());
+    for (std::size_t i = 0; i < latency_bucket_count; ++i) {
+        compression_latency_buckets[i].store(other.compression_latency_buckets[i].load());
+        decompression_latency_buckets[i].store(other.decompression_latency_buckets[i].load());
+    }
 }
 
 BackendStats& BackendStats::operator=(const BackendStats& other) {
@@ -64,6 +76,13 @@ BackendStats& BackendStats::operator=(const BackendStats& other) {
         total_decompressed_size.store(other.total_decompressed_size.load());
         total_compression_time_ns.store(other.total_compression_time_ns.load());
         total_decompression_time_ns.store(other.total_decompression_time_ns.load());
+        skipped_compressions.store(other.skipped_compressions.load());
+        skipped_input_size.store(other.skipped_input_size.load());
+        saved_compression_time_ns.store(other.saved_compression_time_ns.load());
+        for (std::size_t i = 0; i < latency_bucket_count; ++i) {
+            compression_latency_buckets[i].store(other.compression_latency_buckets[i].load());
+            decompression_latency_buckets[i].store(other.decompression_latency_buckets[i].load());
+        }
     }
     return *this;
 }
@@ -131,6 +150,267 @@ void BackendStats::reset() {
     total_decompressed_size.store(0);
     total_compression_time_ns.store(0);
     total_decompression_time_ns.store(0);
+    skipped_compressions.store(0);
+    skipped_input_size.store(0);
+    saved_compression_time_ns.store(0);
+    for (std::size_t i = 0; i < latency_bucket_count; ++i) {
+        compression_latency_buckets[i].store(0);
+        decompression_latency_buckets[i].store(0);
+    }
+}
+
+namespace {
+
+std::size_t latency_bucket(std::uint64_t duration_ns) {
+    const auto& bounds = BackendStats::latency_bucket_bounds_ns;
+    return static_cast<std::size_t>(std::lower_bound(bounds.begin(), bounds.end(), duration_ns) - bounds.begin());
+}
+
+// Counters are independent relaxed increments; readers may see an operation
+// half-applied, which is fine for monitoring and keeps recording cheap
+void apply_compression(BackendStats& target, const OperationStats& stats) {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    const auto duration_ns = static_cast<std::uint64_t>(stats.duration.count());
+    const std::uint64_t count = stats.operation_count;
+    target.total_compressions.fetch_add(count, relaxed);
+    target.total_input_size.fetch_add(stats.input_size, relaxed);
+    target.total_output_size.fetch_add(stats.output_size, relaxed);
+    target.total_compression_time_ns.fetch_add(duration_ns, relaxed);
+    // A batch lands in the bucket of its mean per-buffer latency
+    target.compression_latency_buckets[latency_bucket(duration_ns / std::max<std::uint64_t>(count, 1))]
+        .fetch_add(count, relaxed);
+    
+    if (stats.success) {
+        target.successful_compressions.fetch_add(count, relaxed);
+        target.total_compressed_size.fetch_add(stats.output_size, relaxed);
+    } else {
+        target.failed_compressions.fetch_add(count, relaxed);
+    }
+}
+
+void apply_decompression(BackendStats& target, const OperationStats& stats) {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    const auto duration_ns = static_cast<std::uint64_t>(stats.duration.count());
+    const std::uint64_t count = stats.operation_count;
+    target.total_decompressions.fetch_add(count, relaxed);
+    target.total_input_size.fetch_add(stats.input_size, relaxed);
+    target.total_output_size.fetch_add(stats.output_size, relaxed);
+    target.total_decompression_time_ns.fetch_add(duration_ns, relaxed);
+    // A batch lands in the bucket of its mean per-buffer latency
+    target.decompression_latency_buckets[latency_bucket(duration_ns / std::max<std::uint64_t>(count, 1))]
+        .fetch_add(count, relaxed);
+    
+    if (stats.success) {
+        target.successful_decompressions.fetch_add(count, relaxed);
+        target.total_decompressed_size.fetch_add(stats.output_size, relaxed);
+    } else {
+        target.failed_decompressions.fetch_add(count, relaxed);
+    }
+}
+
+void apply_skipped_compression(BackendStats& target, std::size_t input_size, Duration saved) {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    target.skipped_compressions.fetch_add(1, relaxed);
+    target.skipped_input_size.fetch_add(input_size, relaxed);
+    target.saved_compression_time_ns.fetch_add(static_cast<std::uint64_t>(saved.count()), relaxed);
+}
+
+// Label values escape backslash, double quote and newline
+std::string escape_label(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\') escaped += "\\\\";
+        else if (c == '"') escaped += "\\\"";
+        else if (c == '\n') escaped += "\\n";
+        else escaped += c;
+    }
+    return escaped;
+}
+
+std::string format_double(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+void write_histogram(std::ostringstream& oss, const std::string& labels,
+                     const std::array<std::atomic<std::uint64_t>, BackendStats::latency_bucket_count>& buckets,
+                     std::uint64_t sum_ns) {
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < BackendStats::latency_bucket_count; ++i) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        std::string le = i < BackendStats::latency_bucket_bounds_ns.size()
+            ? format_double(static_cast<double>(BackendStats::latency_bucket_bounds_ns[i]) / 1e9)
+            : "+Inf";
+        oss << "goethe_operation_latency_seconds_bucket{" << labels << ",le=\"" << le << "\"} " << cumulative << "\n";
+    }
+    oss << "goethe_operation_latency_seconds_count{" << labels << "} " << cumulative << "\n";
+    oss << "goethe_operation_latency_seconds_sum{" << labels << "} " << format_double(static_cast<double>(sum_ns) / 1e9) << "\n";
+}
+
+constexpr std::array<MemoryCategory, 5> memory_categories = {
+    MemoryCategory::DIALOGUE, MemoryCategory::COMPRESSION_CONTEXT, MemoryCategory::DICTIONARY,
+    MemoryCategory::CACHE, MemoryCategory::PACKAGE};
+
+void write_json_tags(std::ostringstream& oss, const std::vector<std::pair<std::string, BackendStats>>& tags,
+                     const std::string& indent) {
+    oss << indent << "\"tags\": {";
+    bool first_tag = true;
+    for (const auto& [tag, stats] : tags) {
+        oss << (first_tag ? "\n" : ",\n");
+        first_tag = false;
+        oss << indent << "  \"" << tag << "\": {\n";
+        oss << indent << "    \"total_compressions\": " << stats.total_compressions.load() << ",\n";
+        oss << indent << "    \"total_decompressions\": " << stats.total_decompressions.load() << ",\n";
+        oss << indent << "    \"failed_compressions\": " << stats.failed_compressions.load() << ",\n";
+        oss << indent << "    \"failed_decompressions\": " << stats.failed_decompressions.load() << ",\n";
+        oss << indent << "    \"total_input_size\": " << stats.total_input_size.load() << ",\n";
+        oss << indent << "    \"total_compressed_size\": " << stats.total_compressed_size.load() << ",\n";
+        oss << indent << "    \"total_decompressed_size\": " << stats.total_decompressed_size.load() << ",\n";
+        oss << indent << "    \"average_compression_ratio\": " << stats.average_compression_ratio() << ",\n";
+        oss << indent << "    \"average_compression_throughput_mbps\": " << stats.average_compression_throughput_mbps() << ",\n";
+        oss << indent << "    \"average_decompression_throughput_mbps\": " << stats.average_decompression_throughput_mbps() << "\n";
+        oss << indent << "  }";
+    }
+    oss << (first_tag ? "}\n" : "\n" + indent + "}\n");
+}
+
+} // namespace
+
+// WindowStats methods
+double WindowStats::operations_per_second() const {
+    if (elapsed_seconds <= 0.0) return 0.0;
+    return static_cast<double>(compressions + decompressions) / elapsed_seconds;
+}
+
+double WindowStats::compression_throughput_mbps() const {
+    if (elapsed_seconds <= 0.0) return 0.0;
+    return static_cast<double>(compression_input_size) / (1024.0 * 1024.0) / elapsed_seconds;
+}
+
+double WindowStats::decompression_throughput_mbps() const {
+    if (elapsed_seconds <= 0.0) return 0.0;
+    return static_cast<double>(decompressed_size) / (1024.0 * 1024.0) / elapsed_seconds;
+}
+
+double WindowStats::compression_ratio() const {
+    if (compression_input_size == 0) return 0.0;
+    return static_cast<double>(compressed_size) / static_cast<double>(compression_input_size);
+}
+
+double WindowStats::error_rate() const {
+    std::uint64_t total_ops = compressions + decompressions;
+    if (total_ops == 0) return 0.0;
+    return static_cast<double>(failed_operations) / static_cast<double>(total_ops) * 100.0;
+}
+
+// RollingWindows methods
+RollingWindows::RollingWindows() : start_ns_(now_ns()) {}
+
+std::uint64_t RollingWindows::now_ns() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+std::uint64_t RollingWindows::bucket_width_ns(StatsWindow window) {
+    switch (window) {
+        case StatsWindow::ONE_SECOND: return 100'000'000;
+        case StatsWindow::TEN_SECONDS: return 1'000'000'000;
+        case StatsWindow::ONE_MINUTE: return 6'000'000'000;
+    }
+    return 1'000'000'000;
+}
+
+RollingWindows::Bucket* RollingWindows::claim(Ring& ring, std::uint64_t width_ns, std::uint64_t now_ns) {
+    const std::uint64_t epoch = now_ns / width_ns + 1;
+    Bucket& bucket = ring[epoch % bucket_count];
+    std::uint64_t current = bucket.epoch.load(std::memory_order_acquire);
+    while (current != epoch) {
+        if (current > epoch) {
+            return nullptr; // A later period owns the bucket; this operation fell out of the window
+        }
+        if (bucket.epoch.compare_exchange_weak(current, epoch, std::memory_order_acq_rel)) {
+            bucket.compressions.store(0, std::memory_order_relaxed);
+            bucket.decompressions.store(0, std::memory_order_relaxed);
+            bucket.failed_operations.store(0, std::memory_order_relaxed);
+            bucket.compression_input_size.store(0, std::memory_order_relaxed);
+            bucket.compressed_size.store(0, std::memory_order_relaxed);
+            bucket.decompressed_size.store(0, std::memory_order_relaxed);
+            break;
+        }
+    }
+    return &bucket;
+}
+
+void RollingWindows::record_compression(const OperationStats& stats, std::uint64_t now_ns) {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    for (std::size_t i = 0; i < rings_.size(); ++i) {
+        Bucket* bucket = claim(rings_[i], bucket_width_ns(static_cast<StatsWindow>(i)), now_ns);
+        if (!bucket) continue;
+        bucket->compressions.fetch_add(stats.operation_count, relaxed);
+        bucket->compression_input_size.fetch_add(stats.input_size, relaxed);
+        if (stats.success) {
+            bucket->compressed_size.fetch_add(stats.output_size, relaxed);
+        } else {
+            bucket->failed_operations.fetch_add(stats.operation_count, relaxed);
+        }
+    }
+}
+
+void RollingWindows::record_decompression(const OperationStats& stats, std::uint64_t now_ns) {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    for (std::size_t i = 0; i < rings_.size(); ++i) {
+        Bucket* bucket = claim(rings_[i], bucket_width_ns(static_cast<StatsWindow>(i)), now_ns);
+        if (!bucket) continue;
+        bucket->decompressions.fetch_add(stats.operation_count, relaxed);
+        if (stats.success) {
+            bucket->decompressed_size.fetch_add(stats.output_size, relaxed);
+        } else {
+            bucket->failed_operations.fetch_add(stats.operation_count, relaxed);
+        }
+    }
+}
+
+WindowStats RollingWindows::get(StatsWindow window, std::uint64_t now_ns) const {
+    const std::uint64_t width_ns = bucket_width_ns(window);
+    const std::uint64_t newest = now_ns / width_ns + 1;
+    const std::uint64_t oldest = newest > bucket_count ? newest - bucket_count + 1 : 1;
+    
+    WindowStats result;
+    result.window = window;
+    for (const auto& bucket : rings_[static_cast<std::size_t>(window)]) {
+        std::uint64_t epoch = bucket.epoch.load(std::memory_order_acquire);
+        if (epoch < oldest || epoch > newest) continue;
+        result.compressions += bucket.compressions.load(std::memory_order_relaxed);
+        result.decompressions += bucket.decompressions.load(std::memory_order_relaxed);
+        result.failed_operations += bucket.failed_operations.load(std::memory_order_relaxed);
+        result.compression_input_size += bucket.compression_input_size.load(std::memory_order_relaxed);
+        result.compressed_size += bucket.compressed_size.load(std::memory_order_relaxed);
+        result.decompressed_size += bucket.decompressed_size.load(std::memory_order_relaxed);
+    }
+    
+    // The window spans the ten newest bucket periods, the current one partially
+    const std::uint64_t window_start = std::max((oldest - 1) * width_ns, start_ns_.load());
+    if (now_ns > window_start) {
+        result.elapsed_seconds = static_cast<double>(now_ns - window_start) / 1e9;
+    }
+    return result;
+}
+
+void RollingWindows::reset(std::uint64_t now_ns) {
+    for (auto& ring : rings_) {
+        for (auto& bucket : ring) {
+            bucket.epoch.store(0);
+            bucket.compressions.store(0);
+            bucket.decompressions.store(0);
+            bucket.failed_operations.store(0);
+            bucket.compression_input_size.store(0);
+            bucket.compressed_size.store(0);
+            bucket.decompressed_size.store(0);
+        }
+    }
+    start_ns_.store(now_ns);
 }
 
 // StatisticsManager methods
@@ -140,92 +420,158 @@ StatisticsManager& StatisticsManager::instance() {
 }
 
 void StatisticsManager::enable_statistics(bool enable) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    enabled_ = enable;
+    enabled_.store(enable);
 }
 
 bool StatisticsManager::is_statistics_enabled() const {
+    return enabled_.load();
+}
+
+StatisticsManager::StatisticsManager() : tag_names_{""} {}
+
+// BackendSlot methods
+StatisticsManager::BackendSlot::~BackendSlot() {
+    for (auto& tag : tags) {
+        delete tag.load();
+    }
+}
+
+BackendStats& StatisticsManager::BackendSlot::tag_stats(StatsTag tag) {
+    auto& entry = tags[tag];
+    BackendStats* existing = entry.load(std::memory_order_acquire);
+    if (existing) {
+        return *existing;
+    }
+    
+    auto created = std::make_unique<BackendStats>();
+    created->backend_name = stats.backend_name;
+    created->backend_version = stats.backend_version;
+    if (entry.compare_exchange_strong(existing, created.get(), std::memory_order_acq_rel)) {
+        return *created.release();
+    }
+    return *existing; // Another thread published first
+}
+
+void StatisticsManager::BackendSlot::reset(std::uint64_t now_ns) {
+    stats.reset();
+    windows.reset(now_ns);
+    for (auto& tag : tags) {
+        if (auto* tag_stats = tag.load()) {
+            tag_stats->reset();
+        }
+    }
+}
+
+StatsTag StatisticsManager::intern_tag(const std::string& name) {
+    if (name.empty()) return NO_STATS_TAG;
+    
     std::lock_guard<std::mutex> lock(mutex_);
-    return enabled_;
+    auto it = std::find(tag_names_.begin(), tag_names_.end(), name);
+    if (it != tag_names_.end()) {
+        return static_cast<StatsTag>(it - tag_names_.begin());
+    }
+    if (tag_names_.size() >= MAX_STATS_TAGS) {
+        throw std::runtime_error("Too many statistics tags, cannot add '" + name + "'");
+    }
+    tag_names_.push_back(name);
+    return static_cast<StatsTag>(tag_names_.size() - 1);
 }
 
-void StatisticsManager::record_compression(const std::string& backend_name, const std::string& backend_version,
-                                         const OperationStats& stats) {
+std::string StatisticsManager::get_tag_name(StatsTag tag) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (!enabled_) return;
-    
-    auto& backend_stats = backend_stats_[backend_name];
-    backend_stats.backend_name = backend_name;
-    backend_stats.backend_version = backend_version;
+    return tag < tag_names_.size() ? tag_names_[tag] : std::string();
+}
+
+StatisticsManager::BackendSlot& StatisticsManager::backend_slot(const std::string& backend_name,
+                                                                const std::string& backend_version) {
+    // Slots are never freed, so each thread can cache the pointer and skip the lock
+    thread_local std::unordered_map<std::string, BackendSlot*> cache;
+    auto cached = cache.find(backend_name);
+    if (cached != cache.end()) {
+        return *cached->second;
+    }
     
-    backend_stats.total_compressions.fetch_add(1);
-    backend_stats.total_input_size.fetch_add(stats.input_size);
-    backend_stats.total_output_size.fetch_add(stats.output_size);
-    backend_stats.total_compression_time_ns.fetch_add(stats.duration.count());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = backend_stats_[backend_name];
+    if (!slot) {
+        slot = std::make_unique<BackendSlot>();
+        slot->stats.backend_name = backend_name;
+        slot->stats.backend_version = backend_version;
+    }
+    cache.emplace(backend_name, slot.get());
+    return *slot;
+}
+
+void StatisticsManager::record_compression(const std::string& backend_name, const std::string& backend_version,
+                                         const OperationStats& stats, StatsTag tag) {
+    if (!enabled_.load(std::memory_order_relaxed)) return;
+    if (tag >= MAX_STATS_TAGS) tag = NO_STATS_TAG;
     
-    if (stats.success) {
-        backend_stats.successful_compressions.fetch_add(1);
-        backend_stats.total_compressed_size.fetch_add(stats.output_size);
-    } else {
-        backend_stats.failed_compressions.fetch_add(1);
+    const auto now = RollingWindows::now_ns();
+    auto& slot = backend_slot(backend_name, backend_version);
+    apply_compression(slot.stats, stats);
+    slot.windows.record_compression(stats, now);
+    if (tag != NO_STATS_TAG) {
+        apply_compression(slot.tag_stats(tag), stats);
     }
     
     // Update global stats
-    global_stats_.total_compressions.fetch_add(1);
-    global_stats_.total_input_size.fetch_add(stats.input_size);
-    global_stats_.total_output_size.fetch_add(stats.output_size);
-    global_stats_.total_compression_time_ns.fetch_add(stats.duration.count());
-    
-    if (stats.success) {
-        global_stats_.successful_compressions.fetch_add(1);
-        global_stats_.total_compressed_size.fetch_add(stats.output_size);
-    } else {
-        global_stats_.failed_compressions.fetch_add(1);
+    apply_compression(global_.stats, stats);
+    global_.windows.record_compression(stats, now);
+    if (tag != NO_STATS_TAG) {
+        apply_compression(global_.tag_stats(tag), stats);
     }
 }
 
 void StatisticsManager::record_decompression(const std::string& backend_name, const std::string& backend_version,
-                                           const OperationStats& stats) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!enabled_) return;
+                                           const OperationStats& stats, StatsTag tag) {
+    if (!enabled_.load(std::memory_order_relaxed)) return;
+    if (tag >= MAX_STATS_TAGS) tag = NO_STATS_TAG;
     
-    auto& backend_stats = backend_stats_[backend_name];
-    backend_stats.backend_name = backend_name;
-    backend_stats.backend_version = backend_version;
+    const auto now = RollingWindows::now_ns();
+    auto& slot = backend_slot(backend_name, backend_version);
+    apply_decompression(slot.stats, stats);
+    slot.windows.record_decompression(stats, now);
+    if (tag != NO_STATS_TAG) {
+        apply_decompression(slot.tag_stats(tag), stats);
+    }
     
-    backend_stats.total_decompressions.fetch_add(1);
-    backend_stats.total_input_size.fetch_add(stats.input_size);
-    backend_stats.total_output_size.fetch_add(stats.output_size);
-    backend_stats.total_decompression_time_ns.fetch_add(stats.duration.count());
+    // Update global stats
+    apply_decompression(global_.stats, stats);
+    global_.windows.record_decompression(stats, now);
+    if (tag != NO_STATS_TAG) {
+        apply_decompression(global_.tag_stats(tag), stats);
+    }
+}
+
+void StatisticsManager::record_skipped_compression(const std::string& backend_name,
+                                                   const std::string& backend_version, std::size_t input_size,
+                                                   Duration saved, StatsTag tag) {
+    if (!enabled_.load(std::memory_order_relaxed)) return;
+    if (tag >= MAX_STATS_TAGS) tag = NO_STATS_TAG;
     
-    if (stats.success) {
-        backend_stats.successful_decompressions.fetch_add(1);
-        backend_stats.total_decompressed_size.fetch_add(stats.output_size);
-    } else {
-        backend_stats.failed_decompressions.fetch_add(1);
+    auto& slot = backend_slot(backend_name, backend_version);
+    apply_skipped_compression(slot.stats, input_size, saved);
+    if (tag != NO_STATS_TAG) {
+        apply_skipped_compression(slot.tag_stats(tag), input_size, saved);
     }
     
     // Update global stats
-    global_stats_.total_decompressions.fetch_add(1);
-    global_stats_.total_input_size.fetch_add(stats.input_size);
-    global_stats_.total_output_size.fetch_add(stats.output_size);
-    global_stats_.total_decompression_time_ns.fetch_add(stats.duration.count());
-    
-    if (stats.success) {
-        global_stats_.successful_decompressions.fetch_add(1);
-        global_stats_.total_decompressed_size.fetch_add(stats.output_size);
-    } else {
-        global_stats_.failed_decompressions.fetch_add(1);
+    apply_skipped_compression(global_.stats, input_size, saved);
+    if (tag != NO_STATS_TAG) {
+        apply_skipped_compression(global_.tag_stats(tag), input_size, saved);
     }
 }
 
-BackendStats StatisticsManager::get_backend_stats(const std::string& backend_name) const {
+const StatisticsManager::BackendSlot* StatisticsManager::find_slot(const std::string& backend_name) const {
     std::lock_guard<std::mutex> lock(mutex_);
     auto it = backend_stats_.find(backend_name);
-    if (it != backend_stats_.end()) {
-        return it->second;
-    }
-    return BackendStats{};
+    return it != backend_stats_.end() ? it->second.get() : nullptr;
+}
+
+BackendStats StatisticsManager::get_backend_stats(const std::string& backend_name) const {
+    const auto* slot = find_slot(backend_name);
+    return slot ? slot->stats : BackendStats{};
 }
 
 std::vector<std::string> StatisticsManager::get_backend_names() const {
@@ -239,60 +585,150 @@ std::vector<std::string> StatisticsManager::get_backend_names() const {
 }
 
 BackendStats StatisticsManager::get_global_stats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return global_stats_;
+    return global_.stats;
+}
+
+BackendStats StatisticsManager::get_tag_stats(const std::string& backend_name, StatsTag tag) const {
+    const auto* slot = find_slot(backend_name);
+    if (!slot || tag >= MAX_STATS_TAGS) {
+        return BackendStats{};
+    }
+    const auto* tag_stats = slot->tags[tag].load(std::memory_order_acquire);
+    if (!tag_stats) {
+        BackendStats empty;
+        empty.backend_name = slot->stats.backend_name;
+        empty.backend_version = slot->stats.backend_version;
+        return empty;
+    }
+    return *tag_stats;
+}
+
+BackendStats StatisticsManager::get_global_tag_stats(StatsTag tag) const {
+    if (tag >= MAX_STATS_TAGS) {
+        return BackendStats{};
+    }
+    const auto* tag_stats = global_.tags[tag].load(std::memory_order_acquire);
+    return tag_stats ? *tag_stats : BackendStats{};
+}
+
+WindowStats StatisticsManager::get_window_stats(const std::string& backend_name, StatsWindow window) const {
+    const auto* slot = find_slot(backend_name);
+    if (!slot) {
+        WindowStats empty;
+        empty.window = window;
+        return empty;
+    }
+    return slot->windows.get(window, RollingWindows::now_ns());
+}
+
+WindowStats StatisticsManager::get_global_window_stats(StatsWindow window) const {
+    return global_.windows.get(window, RollingWindows::now_ns());
 }
 
 void StatisticsManager::reset_backend_stats(const std::string& backend_name) {
     std::lock_guard<std::mutex> lock(mutex_);
     auto it = backend_stats_.find(backend_name);
     if (it != backend_stats_.end()) {
-        it->second.reset();
+        it->second->reset(RollingWindows::now_ns());
     }
 }
 
 void StatisticsManager::reset_all_stats() {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& [_, stats] : backend_stats_) {
-        stats.reset();
+    const auto now = RollingWindows::now_ns();
+    for (auto& [_, slot] : backend_stats_) {
+        slot->reset(now);
     }
-    global_stats_.reset();
+    global_.reset(now);
+}
+
+StatisticsManager::SlotSnapshot StatisticsManager::snapshot_slot(const BackendSlot& slot,
+                                                                 const std::vector<std::string>& tag_names) const {
+    SlotSnapshot snapshot;
+    snapshot.stats = slot.stats;
+    for (std::size_t tag = 1; tag < tag_names.size(); ++tag) {
+        if (const auto* tag_stats = slot.tags[tag].load(std::memory_order_acquire)) {
+            snapshot.tags.emplace_back(tag_names[tag], *tag_stats);
+        }
+    }
+    return snapshot;
+}
+
+// Copies every backend's counters, sorted by name. The lock is only held to
+// collect slot pointers, so exporting never blocks recording.
+std::vector<StatisticsManager::SlotSnapshot> StatisticsManager::snapshot_backends() const {
+    std::vector<const BackendSlot*> slots;
+    std::vector<std::string> tag_names;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slots.reserve(backend_stats_.size());
+        for (const auto& [_, slot] : backend_stats_) {
+            slots.push_back(slot.get());
+        }
+        tag_names = tag_names_;
+    }
+    
+    std::vector<SlotSnapshot> snapshot;
+    snapshot.reserve(slots.size());
+    for (const auto* slot : slots) {
+        snapshot.push_back(snapshot_slot(*slot, tag_names));
+    }
+    std::sort(snapshot.begin(), snapshot.end(), [](const SlotSnapshot& a, const SlotSnapshot& b) {
+        return a.stats.backend_name < b.stats.backend_name;
+    });
+    return snapshot;
+}
+
+StatisticsManager::SlotSnapshot StatisticsManager::snapshot_global() const {
+    std::vector<std::string> tag_names;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tag_names = tag_names_;
+    }
+    return snapshot_slot(global_, tag_names);
 }
 
 std::string StatisticsManager::export_json() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const auto backends = snapshot_backends();
+    const auto global = snapshot_global();
+    const BackendStats& global_stats = global.stats;
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(2);
     
     oss << "{\n";
-    oss << "  \"statistics_enabled\": " << (enabled_ ? "true" : "false") << ",\n";
+    oss << "  \"statistics_enabled\": " << (is_statistics_enabled() ? "true" : "false") << ",\n";
     oss << "  \"global_stats\": {\n";
-    oss << "    \"total_compressions\": " << global_stats_.total_compressions.load() << ",\n";
-    oss << "    \"total_decompressions\": " << global_stats_.total_decompressions.load() << ",\n";
-    oss << "    \"successful_compressions\": " << global_stats_.successful_compressions.load() << ",\n";
-    oss << "    \"successful_decompressions\": " << global_stats_.successful_decompressions.load() << ",\n";
-    oss << "    \"failed_compressions\": " << global_stats_.failed_compressions.load() << ",\n";
-    oss << "    \"failed_decompressions\": " << global_stats_.failed_decompressions.load() << ",\n";
-    oss << "    \"total_input_size\": " << global_stats_.total_input_size.load() << ",\n";
-    oss << "    \"total_output_size\": " << global_stats_.total_output_size.load() << ",\n";
-    oss << "    \"total_compressed_size\": " << global_stats_.total_compressed_size.load() << ",\n";
-    oss << "    \"total_decompressed_size\": " << global_stats_.total_decompressed_size.load() << ",\n";
-    oss << "    \"total_compression_time_ns\": " << global_stats_.total_compression_time_ns.load() << ",\n";
-    oss << "    \"total_decompression_time_ns\": " << global_stats_.total_decompression_time_ns.load() << ",\n";
-    oss << "    \"average_compression_ratio\": " << global_stats_.average_compression_ratio() << ",\n";
-    oss << "    \"average_compression_rate\": " << global_stats_.average_compression_rate() << ",\n";
-    oss << "    \"average_compression_throughput_mbps\": " << global_stats_.average_compression_throughput_mbps() << ",\n";
-    oss << "    \"average_decompression_throughput_mbps\": " << global_stats_.average_decompression_throughput_mbps() << ",\n";
-    oss << "    \"success_rate\": " << global_stats_.success_rate() << "\n";
+    oss << "    \"total_compressions\": " << global_stats.total_compressions.load() << ",\n";
+    oss << "    \"total_decompressions\": " << global_stats.total_decompressions.load() << ",\n";
+    oss << "    \"successful_compressions\": " << global_stats.successful_compressions.load() << ",\n";
+    oss << "    \"successful_decompressions\": " << global_stats.successful_decompressions.load() << ",\n";
+    oss << "    \"failed_compressions\": " << global_stats.failed_compressions.load() << ",\n";
+    oss << "    \"failed_decompressions\": " << global_stats.failed_decompressions.load() << ",\n";
+    oss << "    \"total_input_size\": " << global_stats.total_input_size.load() << ",\n";
+    oss << "    \"total_output_size\": " << global_stats.total_output_size.load() << ",\n";
+    oss << "    \"total_compressed_size\": " << global_stats.total_compressed_size.load() << ",\n";
+    oss << "    \"total_decompressed_size\": " << global_stats.total_decompressed_size.load() << ",\n";
+    oss << "    \"total_compression_time_ns\": " << global_stats.total_compression_time_ns.load() << ",\n";
+    oss << "    \"total_decompression_time_ns\": " << global_stats.total_decompression_time_ns.load() << ",\n";
+    oss << "    \"skipped_compressions\": " << global_stats.skipped_compressions.load() << ",\n";
+    oss << "    \"skipped_input_size\": " << global_stats.skipped_input_size.load() << ",\n";
+    oss << "    \"saved_compression_time_ns\": " << global_stats.saved_compression_time_ns.load() << ",\n";
+    oss << "    \"average_compression_ratio\": " << global_stats.average_compression_ratio() << ",\n";
+    oss << "    \"average_compression_rate\": " << global_stats.average_compression_rate() << ",\n";
+    oss << "    \"average_compression_throughput_mbps\": " << global_stats.average_compression_throughput_mbps() << ",\n";
+    oss << "    \"average_decompression_throughput_mbps\": " << global_stats.average_decompression_throughput_mbps() << ",\n";
+    oss << "    \"success_rate\": " << global_stats.success_rate() << ",\n";
+    write_json_tags(oss, global.tags, "    ");
     oss << "  },\n";
     oss << "  \"backend_stats\": {\n";
     
     bool first_backend = true;
-    for (const auto& [name, stats] : backend_stats_) {
+    for (const auto& backend : backends) {
+        const BackendStats& stats = backend.stats;
         if (!first_backend) oss << ",\n";
         first_backend = false;
         
-        oss << "    \"" << name << "\": {\n";
+        oss << "    \"" << stats.backend_name << "\": {\n";
         oss << "      \"backend_name\": \"" << stats.backend_name << "\",\n";
         oss << "      \"backend_version\": \"" << stats.backend_version << "\",\n";
         oss << "      \"total_compressions\": " << stats.total_compressions.load() << ",\n";
@@ -307,22 +743,49 @@ std::string StatisticsManager::export_json() const {
         oss << "      \"total_decompressed_size\": " << stats.total_decompressed_size.load() << ",\n";
         oss << "      \"total_compression_time_ns\": " << stats.total_compression_time_ns.load() << ",\n";
         oss << "      \"total_decompression_time_ns\": " << stats.total_decompression_time_ns.load() << ",\n";
+        oss << "      \"skipped_compressions\": " << stats.skipped_compressions.load() << ",\n";
+        oss << "      \"skipped_input_size\": " << stats.skipped_input_size.load() << ",\n";
+        oss << "      \"saved_compression_time_ns\": " << stats.saved_compression_time_ns.load() << ",\n";
         oss << "      \"average_compression_ratio\": " << stats.average_compression_ratio() << ",\n";
         oss << "      \"average_compression_rate\": " << stats.average_compression_rate() << ",\n";
         oss << "      \"average_compression_throughput_mbps\": " << stats.average_compression_throughput_mbps() << ",\n";
         oss << "      \"average_decompression_throughput_mbps\": " << stats.average_decompression_throughput_mbps() << ",\n";
-        oss << "      \"success_rate\": " << stats.success_rate() << "\n";
+        oss << "      \"success_rate\": " << stats.success_rate() << ",\n";
+        write_json_tags(oss, backend.tags, "      ");
         oss << "    }";
     }
     
-    oss << "\n  }\n";
+    oss << "\n  },\n";
+    
+    const auto memory = get_memory_breakdown();
+    std::size_t memory_total = 0;
+    for (const auto& usage : memory) {
+        memory_total += usage.bytes;
+    }
+    oss << "  \"memory\": {\n";
+    oss << "    \"total_bytes\": " << memory_total << ",\n";
+    oss << "    \"categories\": {\n";
+    for (std::size_t i = 0; i < memory_categories.size(); ++i) {
+        oss << "      \"" << memory_category_name(memory_categories[i]) << "\": "
+            << get_memory_usage(memory_categories[i]) << (i + 1 < memory_categories.size() ? ",\n" : "\n");
+    }
+    oss << "    },\n";
+    oss << "    \"objects\": [";
+    for (std::size_t i = 0; i < memory.size(); ++i) {
+        oss << (i ? ",\n" : "\n");
+        oss << "      {\"category\": \"" << memory_category_name(memory[i].category) << "\", \"name\": \""
+            << escape_label(memory[i].name) << "\", \"bytes\": " << memory[i].bytes << "}";
+    }
+    oss << (memory.empty() ? "]\n" : "\n    ]\n");
+    oss << "  }\n";
     oss << "}";
     
     return oss.str();
 }
 
 std::string StatisticsManager::export_csv() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const auto backends = snapshot_backends();
+    const BackendStats global_stats = global_.stats;
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(2);
     
@@ -332,29 +795,34 @@ std::string StatisticsManager::export_csv() const {
         << "Total_Input_Size,Total_Output_Size,Total_Compressed_Size,Total_Decompressed_Size,"
         << "Total_Compression_Time_ns,Total_Decompression_Time_ns,"
         << "Average_Compression_Ratio,Average_Compression_Rate,"
-        << "Average_Compression_Throughput_MBps,Average_Decompression_Throughput_MBps,Success_Rate\n";
+        << "Average_Compression_Throughput_MBps,Average_Decompression_Throughput_MBps,Success_Rate,"
+        << "Skipped_Compressions,Skipped_Input_Size,Saved_Compression_Time_ns\n";
     
     // Global stats
-    oss << "GLOBAL,," << global_stats_.total_compressions.load() << ","
-        << global_stats_.total_decompressions.load() << ","
-        << global_stats_.successful_compressions.load() << ","
-        << global_stats_.successful_decompressions.load() << ","
-        << global_stats_.failed_compressions.load() << ","
-        << global_stats_.failed_decompressions.load() << ","
-        << global_stats_.total_input_size.load() << ","
-        << global_stats_.total_output_size.load() << ","
-        << global_stats_.total_compressed_size.load() << ","
-        << global_stats_.total_decompressed_size.load() << ","
-        << global_stats_.total_compression_time_ns.load() << ","
-        << global_stats_.total_decompression_time_ns.load() << ","
-        << global_stats_.average_compression_ratio() << ","
-        << global_stats_.average_compression_rate() << ","
-        << global_stats_.average_compression_throughput_mbps() << ","
-        << global_stats_.average_decompression_throughput_mbps() << ","
-        << global_stats_.success_rate() << "\n";
+    oss << "GLOBAL,," << global_stats.total_compressions.load() << ","
+        << global_stats.total_decompressions.load() << ","
+        << global_stats.successful_compressions.load() << ","
+        << global_stats.successful_decompressions.load() << ","
+        << global_stats.failed_compressions.load() << ","
+        << global_stats.failed_decompressions.load() << ","
+        << global_stats.total_input_size.load() << ","
+        << global_stats.total_output_size.load() << ","
+        << global_stats.total_compressed_size.load() << ","
+        << global_stats.total_decompressed_size.load() << ","
+        << global_stats.total_compression_time_ns.load() << ","
+        << global_stats.total_decompression_time_ns.load() << ","
+        << global_stats.average_compression_ratio() << ","
+        << global_stats.average_compression_rate() << ","
+        << global_stats.average_compression_throughput_mbps() << ","
+        << global_stats.average_decompression_throughput_mbps() << ","
+        << global_stats.success_rate() << ","
+        << global_stats.skipped_compressions.load() << ","
+        << global_stats.skipped_input_size.load() << ","
+        << global_stats.saved_compression_time_ns.load() << "\n";
     
     // Backend stats
-    for (const auto& [name, stats] : backend_stats_) {
+    for (const auto& backend : backends) {
+        const BackendStats& stats = backend.stats;
         oss << "\"" << stats.backend_name << "\",\"" << stats.backend_version << "\","
             << stats.total_compressions.load() << ","
             << stats.total_decompressions.load() << ","
@@ -372,12 +840,340 @@ std::string StatisticsManager::export_csv() const {
             << stats.average_compression_rate() << ","
             << stats.average_compression_throughput_mbps() << ","
             << stats.average_decompression_throughput_mbps() << ","
-            << stats.success_rate() << "\n";
+            << stats.success_rate() << ","
+            << stats.skipped_compressions.load() << ","
+            << stats.skipped_input_size.load() << ","
+            << stats.saved_compression_time_ns.load() << "\n";
     }
     
     return oss.str();
 }
 
+std::string StatisticsManager::export_openmetrics() const {
+    const auto backends = snapshot_backends();
+    std::ostringstream oss;
+    
+    oss << "# TYPE goethe_statistics_enabled gauge\n";
+    oss << "# HELP goethe_statistics_enabled Whether statistics collection is enabled.\n";
+    oss << "goethe_statistics_enabled " << (is_statistics_enabled() ? 1 : 0) << "\n";
+    
+    oss << "# TYPE goethe_backend info\n";
+    oss << "# HELP goethe_backend Compression backend version.\n";
+    for (const auto& [stats, _] : backends) {
+        oss << "goethe_backend_info{backend=\"" << escape_label(stats.backend_name) << "\",version=\""
+            << escape_label(stats.backend_version) << "\"} 1\n";
+    }
+    
+    oss << "# TYPE goethe_operations counter\n";
+    oss << "# HELP goethe_operations Compression and decompression calls by result.\n";
+    for (const auto& [stats, _] : backends) {
+        std::string backend = "backend=\"" + escape_label(stats.backend_name) + "\"";
+        oss << "goethe_operations_total{" << backend << ",operation=\"compress\",result=\"success\"} "
+            << stats.successful_compressions.load() << "\n";
+        oss << "goethe_operations_total{" << backend << ",operation=\"compress\",result=\"failure\"} "
+            << stats.failed_compressions.load() << "\n";
+        oss << "goethe_operations_total{" << backend << ",operation=\"decompress\",result=\"success\"} "
+            << stats.successful_decompressions.load() << "\n";
+        oss << "goethe_operations_total{" << backend << ",operation=\"decompress\",result=\"failure\"} "
+            << stats.failed_decompressions.load() << "\n";
+    }
+    
+    struct ByteCounter {
+        const char* name;
+        const char* help;
+        std::atomic<std::uint64_t> BackendStats::*field;
+    };
+    const ByteCounter byte_counters[] = {
+        {"goethe_input_bytes", "Bytes passed to compress and decompress.", &BackendStats::total_input_size},
+        {"goethe_output_bytes", "Bytes returned by compress and decompress.", &BackendStats::total_output_size},
+        {"goethe_compressed_bytes", "Bytes produced by successful compressions.", &BackendStats::total_compressed_size},
+        {"goethe_decompressed_bytes", "Bytes produced by successful decompressions.", &BackendStats::total_decompressed_size},
+    };
+    for (const auto& counter : byte_counters) {
+        oss << "# TYPE " << counter.name << " counter\n";
+        oss << "# UNIT " << counter.name << " bytes\n";
+        oss << "# HELP " << counter.name << " " << counter.help << "\n";
+        for (const auto& [stats, _] : backends) {
+            oss << counter.name << "_total{backend=\"" << escape_label(stats.backend_name) << "\"} "
+                << (stats.*counter.field).load() << "\n";
+        }
+    }
+    
+    oss << "# TYPE goethe_skipped_compressions counter\n";
+    oss << "# HELP goethe_skipped_compressions Compressions skipped because the input looked incompressible.\n";
+    for (const auto& [stats, _] : backends) {
+        oss << "goethe_skipped_compressions_total{backend=\"" << escape_label(stats.backend_name) << "\"} "
+            << stats.skipped_compressions.load() << "\n";
+    }
+    oss << "# TYPE goethe_skipped_bytes counter\n";
+    oss << "# UNIT goethe_skipped_bytes bytes\n";
+    oss << "# HELP goethe_skipped_bytes Input stored raw instead of compressed.\n";
+    for (const auto& [stats, _] : backends) {
+        oss << "goethe_skipped_bytes_total{backend=\"" << escape_label(stats.backend_name) << "\"} "
+            << stats.skipped_input_size.load() << "\n";
+    }
+    oss << "# TYPE goethe_saved_compression_seconds counter\n";
+    oss << "# UNIT goethe_saved_compression_seconds seconds\n";
+    oss << "# HELP goethe_saved_compression_seconds Estimated compression time spared by skipping.\n";
+    for (const auto& [stats, _] : backends) {
+        oss << "goethe_saved_compression_seconds_total{backend=\"" << escape_label(stats.backend_name) << "\"} "
+            << format_double(static_cast<double>(stats.saved_compression_time_ns.load()) / 1e9) << "\n";
+    }
+    
+    oss << "# TYPE goethe_compression_ratio gauge\n";
+    oss << "# HELP goethe_compression_ratio Compressed size over input size, lifetime average.\n";
+    for (const auto& [stats, _] : backends) {
+        oss << "goethe_compression_ratio{backend=\"" << escape_label(stats.backend_name) << "\"} "
+            << format_double(stats.average_compression_ratio()) << "\n";
+    }
+    
+    oss << "# TYPE goethe_operation_latency_seconds histogram\n";
+    oss << "# UNIT goethe_operation_latency_seconds seconds\n";
+    oss << "# HELP goethe_operation_latency_seconds Latency of compress and decompress calls.\n";
+    for (const auto& [stats, _] : backends) {
+        std::string backend = "backend=\"" + escape_label(stats.backend_name) + "\"";
+        write_histogram(oss, backend + ",operation=\"compress\"", stats.compression_latency_buckets,
+                        stats.total_compression_time_ns.load());
+        write_histogram(oss, backend + ",operation=\"decompress\"", stats.decompression_latency_buckets,
+                        stats.total_decompression_time_ns.load());
+    }
+    
+    // Per-tag breakdown; PromQL derives throughput as rate(bytes) / rate(seconds)
+    oss << "# TYPE goethe_tag_operations counter\n";
+    oss << "# HELP goethe_tag_operations Compression and decompression calls per content tag.\n";
+    for (const auto& backend : backends) {
+        for (const auto& [tag, stats] : backend.tags) {
+            std::string labels = "backend=\"" + escape_label(stats.backend_name) + "\",tag=\"" + escape_label(tag) + "\"";
+            oss << "goethe_tag_operations_total{" << labels << ",operation=\"compress\"} "
+                << stats.total_compressions.load() << "\n";
+            oss << "goethe_tag_operations_total{" << labels << ",operation=\"decompress\"} "
+                << stats.total_decompressions.load() << "\n";
+        }
+    }
+    
+    const ByteCounter tag_counters[] = {
+        {"goethe_tag_input_bytes", "Bytes passed to compress and decompress per content tag.",
+         &BackendStats::total_input_size},
+        {"goethe_tag_compressed_bytes", "Bytes produced by successful compressions per content tag.",
+         &BackendStats::total_compressed_size},
+        {"goethe_tag_decompressed_bytes", "Bytes produced by successful decompressions per content tag.",
+         &BackendStats::total_decompressed_size},
+    };
+    for (const auto& counter : tag_counters) {
+        oss << "# TYPE " << counter.name << " counter\n";
+        oss << "# UNIT " << counter.name << " bytes\n";
+        oss << "# HELP " << counter.name << " " << counter.help << "\n";
+        for (const auto& backend : backends) {
+            for (const auto& [tag, stats] : backend.tags) {
+                oss << counter.name << "_total{backend=\"" << escape_label(stats.backend_name) << "\",tag=\""
+                    << escape_label(tag) << "\"} " << (stats.*counter.field).load() << "\n";
+            }
+        }
+    }
+    
+    oss << "# TYPE goethe_tag_operation_seconds counter\n";
+    oss << "# UNIT goethe_tag_operation_seconds seconds\n";
+    oss << "# HELP goethe_tag_operation_seconds Time spent in compress and decompress per content tag.\n";
+    for (const auto& backend : backends) {
+        for (const auto& [tag, stats] : backend.tags) {
+            std::string labels = "backend=\"" + escape_label(stats.backend_name) + "\",tag=\"" + escape_label(tag) + "\"";
+            oss << "goethe_tag_operation_seconds_total{" << labels << ",operation=\"compress\"} "
+                << format_double(static_cast<double>(stats.total_compression_time_ns.load()) / 1e9) << "\n";
+            oss << "goethe_tag_operation_seconds_total{" << labels << ",operation=\"decompress\"} "
+                << format_double(static_cast<double>(stats.total_decompression_time_ns.load()) / 1e9) << "\n";
+        }
+    }
+    
+    oss << "# TYPE goethe_tag_compression_ratio gauge\n";
+    oss << "# HELP goethe_tag_compression_ratio Compressed size over input size per content tag, lifetime average.\n";
+    for (const auto& backend : backends) {
+        for (const auto& [tag, stats] : backend.tags) {
+            oss << "goethe_tag_compression_ratio{backend=\"" << escape_label(stats.backend_name) << "\",tag=\""
+                << escape_label(tag) << "\"} " << format_double(stats.average_compression_ratio()) << "\n";
+        }
+    }
+    
+    oss << "# TYPE goethe_memory_bytes gauge\n";
+    oss << "# UNIT goethe_memory_bytes bytes\n";
+    oss << "# HELP goethe_memory_bytes Live bytes held per memory category.\n";
+    for (auto category : memory_categories) {
+        oss << "goethe_memory_bytes{category=\"" << memory_category_name(category) << "\"} "
+            << get_memory_usage(category) << "\n";
+    }
+    
+    // Objects sharing a name, such as two zstd backends, are summed so every
+    // label set appears once
+    std::map<std::pair<MemoryCategory, std::string>, std::size_t> memory_objects;
+    for (const auto& usage : get_memory_breakdown()) {
+        memory_objects[{usage.category, usage.name}] += usage.bytes;
+    }
+    oss << "# TYPE goethe_memory_object_bytes gauge\n";
+    oss << "# UNIT goethe_memory_object_bytes bytes\n";
+    oss << "# HELP goethe_memory_object_bytes Live bytes held per tracked object.\n";
+    for (const auto& [key, bytes] : memory_objects) {
+        oss << "goethe_memory_object_bytes{category=\"" << memory_category_name(key.first) << "\",name=\""
+            << escape_label(key.second) << "\"} " << bytes << "\n";
+    }
+    
+    oss << "# EOF\n";
+    return oss.str();
+}
+
+// Memory accounting
+const char* memory_category_name(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::DIALOGUE: return "dialogue";
+        case MemoryCategory::COMPRESSION_CONTEXT: return "compression_context";
+        case MemoryCategory::DICTIONARY: return "dictionary";
+        case MemoryCategory::CACHE: return "cache";
+        case MemoryCategory::PACKAGE: return "package";
+    }
+    return "unknown";
+}
+
+StatisticsManager::MemoryEntry* StatisticsManager::add_memory_entry(MemoryCategory category, const std::string& name,
+                                                                    std::size_t bytes) {
+    auto entry = std::make_unique<MemoryEntry>();
+    entry->category = category;
+    entry->name = name;
+    entry->bytes.store(bytes, std::memory_order_relaxed);
+    
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    memory_entries_.push_back(std::move(entry));
+    return memory_entries_.back().get();
+}
+
+void StatisticsManager::remove_memory_entry(MemoryEntry* entry) {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    auto it = std::find_if(memory_entries_.begin(), memory_entries_.end(),
+                           [entry](const std::unique_ptr<MemoryEntry>& candidate) { return candidate.get() == entry; });
+    if (it != memory_entries_.end()) {
+        std::swap(*it, memory_entries_.back());
+        memory_entries_.pop_back();
+    }
+}
+
+std::size_t StatisticsManager::get_memory_usage(MemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    std::size_t total = 0;
+    for (const auto& entry : memory_entries_) {
+        if (entry->category == category) {
+            total += entry->bytes.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+std::size_t StatisticsManager::get_total_memory_usage() const {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    std::size_t total = 0;
+    for (const auto& entry : memory_entries_) {
+        total += entry->bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::vector<MemoryUsage> StatisticsManager::get_memory_breakdown() const {
+    std::vector<MemoryUsage> breakdown;
+    {
+        std::lock_guard<std::mutex> lock(memory_mutex_);
+        breakdown.reserve(memory_entries_.size());
+        for (const auto& entry : memory_entries_) {
+            breakdown.push_back({entry->category, entry->name, entry->bytes.load(std::memory_order_relaxed)});
+        }
+    }
+    std::stable_sort(breakdown.begin(), breakdown.end(), [](const MemoryUsage& a, const MemoryUsage& b) {
+        return a.bytes > b.bytes;
+    });
+    return breakdown;
+}
+
+// MemoryAccount methods
+MemoryAccount::MemoryAccount(MemoryCategory category, const std::string& name, std::size_t bytes)
+    : entry_(StatisticsManager::instance().add_memory_entry(category, name, bytes)) {}
+
+MemoryAccount::~MemoryAccount() {
+    if (entry_) {
+        StatisticsManager::instance().remove_memory_entry(entry_);
+    }
+}
+
+MemoryAccount::MemoryAccount(MemoryAccount&& other) noexcept : entry_(std::exchange(other.entry_, nullptr)) {}
+
+MemoryAccount& MemoryAccount::operator=(MemoryAccount&& other) noexcept {
+    if (this != &other) {
+        if (entry_) {
+            StatisticsManager::instance().remove_memory_entry(entry_);
+        }
+        entry_ = std::exchange(other.entry_, nullptr);
+    }
+    return *this;
+}
+
+void MemoryAccount::update(std::size_t bytes) {
+    if (entry_) {
+        entry_->bytes.store(bytes, std::memory_order_relaxed);
+    }
+}
+
+std::size_t MemoryAccount::bytes() const {
+    return entry_ ? entry_->bytes.load(std::memory_order_relaxed) : 0;
+}
+
+// OpenMetricsFileSink methods
+OpenMetricsFileSink::OpenMetricsFileSink(std::string path, std::chrono::milliseconds interval)
+    : path_(std::move(path)), interval_(interval) {}
+
+OpenMetricsFileSink::~OpenMetricsFileSink() {
+    stop();
+}
+
+void OpenMetricsFileSink::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            lock.unlock();
+            write_now();
+            lock.lock();
+            wake_.wait_for(lock, interval_, [this]() { return !running_; });
+        }
+    });
+}
+
+void OpenMetricsFileSink::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    write_now();
+}
+
+bool OpenMetricsFileSink::is_running() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+bool OpenMetricsFileSink::write_now() {
+    const std::string temp_path = path_ + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file.is_open()) return false;
+        file << StatisticsManager::instance().export_openmetrics();
+        if (!file.good()) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, path_, error);
+    return !error;
+}
+
 // Timer methods
 StatisticsManager::Timer::Timer() : running_(false) {}
 
@@ -402,8 +1198,9 @@ bool StatisticsManager::Timer::is_running() const {
 }
 
 // StatisticsScope methods
-StatisticsScope::StatisticsScope(const std::string& backend_name, const std::string& backend_version, bool is_compression)
-    : backend_name_(backend_name), backend_version_(backend_version), is_compression_(is_compression) {
+StatisticsScope::StatisticsScope(const std::string& backend_name, const std::string& backend_version, bool is_compression,
+                                 StatsTag tag)
+    : backend_name_(backend_name), backend_version_(backend_version), is_compression_(is_compression), tag_(tag) {
     timer_.start();
 }
 
@@ -428,9 +1225,9 @@ void StatisticsScope::set_success(bool success, const std::string& error_message
     auto stats = create_operation_stats(input_size_, output_size_, timer_, success, error_message);
     
     if (is_compression_) {
-        stats_manager.record_compression(backend_name_, backend_version_, stats);
+        stats_manager.record_compression(backend_name_, backend_version_, stats, tag_);
     } else {
-        stats_manager.record_decompression(backend_name_, backend_version_, stats);
+        stats_manager.record_decompression(backend_name_, backend_version_, stats, tag_);
     }
     
     recorded_ = true;
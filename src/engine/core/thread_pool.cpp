@@ -0,0 +1,119 @@
+#include "goethe/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace goethe {
+
+namespace {
+
+// Shared with helper tasks, which may start after parallel_for has returned
+// when the pool is busy; those find no indices left and exit untouched.
+struct ParallelForState {
+    std::size_t count = 0;
+    const ThreadPool::IndexedTask* body = nullptr; // Valid until all indices finish
+    std::atomic<std::size_t> next_index{0};
+    std::atomic<std::size_t> next_slot{0};
+    std::atomic<bool> failed{false};
+
+    std::mutex mutex;
+    std::condition_variable all_done;
+    std::size_t finished = 0;
+    std::exception_ptr error;
+};
+
+void participate(ParallelForState& state) {
+    const std::size_t slot = state.next_slot.fetch_add(1, std::memory_order_relaxed);
+    std::size_t finished = 0;
+    for (std::size_t index = state.next_index.fetch_add(1); index < state.count;
+         index = state.next_index.fetch_add(1)) {
+        // After a failure the remaining indices are claimed but not run
+        if (!state.failed.load(std::memory_order_relaxed)) {
+            try {
+                (*state.body)(slot, index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.error) state.error = std::current_exception();
+                state.failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        ++finished;
+    }
+    if (finished > 0) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.finished += finished;
+        if (state.finished == state.count) {
+            state.all_done.notify_all();
+        }
+    }
+}
+
+} // anonymous namespace
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] { run_worker(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::default_thread_count() {
+    const std::size_t cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+}
+
+void ThreadPool::run_worker() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return; // Stopping and drained
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t count, const IndexedTask& body, std::size_t max_helpers) {
+    if (count == 0) return;
+
+    auto state = std::make_shared<ParallelForState>();
+    state->count = count;
+    state->body = &body;
+
+    const std::size_t helpers = std::min({size(), max_helpers, count - 1});
+    for (std::size_t i = 0; i < helpers; ++i) {
+        submit([state] { participate(*state); });
+    }
+    participate(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->all_done.wait(lock, [&] { return state->finished == count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace goethe
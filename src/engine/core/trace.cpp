@@ -0,0 +1,313 @@
+#include "goethe/trace.hpp"
+#include "goethe/allocator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+namespace goethe {
+
+namespace {
+
+// Exported traces describe a single process
+constexpr std::uint64_t kTracePid = 1;
+constexpr std::uint64_t kProcessTrackUuid = 1;
+constexpr std::uint64_t kThreadTrackUuidBase = 0x1000;
+
+std::string json_escape(const char* text) {
+    std::string escaped;
+    for (const char* p = text ? text : ""; *p; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            escaped += buffer;
+        } else {
+            escaped += static_cast<char>(c);
+        }
+    }
+    return escaped;
+}
+
+// Minimal protobuf wire format writer for the Perfetto trace schema
+void put_varint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void put_uint(std::string& out, std::uint32_t field, std::uint64_t value) {
+    put_varint(out, static_cast<std::uint64_t>(field) << 3); // Wire type 0: varint
+    put_varint(out, value);
+}
+
+void put_bytes(std::string& out, std::uint32_t field, const std::string& value) {
+    put_varint(out, (static_cast<std::uint64_t>(field) << 3) | 2); // Wire type 2: length-delimited
+    put_varint(out, value.size());
+    out += value;
+}
+
+// Field numbers from perfetto/protos/perfetto/trace/
+namespace pb {
+constexpr std::uint32_t kTracePacket = 1;                 // Trace.packet
+constexpr std::uint32_t kTimestamp = 8;                   // TracePacket.timestamp
+constexpr std::uint32_t kTrustedPacketSequenceId = 10;    // TracePacket.trusted_packet_sequence_id
+constexpr std::uint32_t kTrackEvent = 11;                 // TracePacket.track_event
+constexpr std::uint32_t kTrackDescriptor = 60;            // TracePacket.track_descriptor
+constexpr std::uint32_t kTrackUuid = 1;                   // TrackDescriptor.uuid
+constexpr std::uint32_t kTrackParentUuid = 5;             // TrackDescriptor.parent_uuid
+constexpr std::uint32_t kTrackProcess = 3;                // TrackDescriptor.process
+constexpr std::uint32_t kTrackThread = 4;                 // TrackDescriptor.thread
+constexpr std::uint32_t kProcessPid = 1;                  // ProcessDescriptor.pid
+constexpr std::uint32_t kProcessName = 6;                 // ProcessDescriptor.process_name
+constexpr std::uint32_t kThreadPid = 1;                   // ThreadDescriptor.pid
+constexpr std::uint32_t kThreadTid = 2;                   // ThreadDescriptor.tid
+constexpr std::uint32_t kThreadName = 5;                  // ThreadDescriptor.thread_name
+constexpr std::uint32_t kEventType = 9;                   // TrackEvent.type
+constexpr std::uint32_t kEventTrackUuid = 11;             // TrackEvent.track_uuid
+constexpr std::uint32_t kEventCategories = 22;            // TrackEvent.categories
+constexpr std::uint32_t kEventName = 23;                  // TrackEvent.name
+constexpr std::uint64_t kSliceBegin = 1;
+constexpr std::uint64_t kSliceEnd = 2;
+} // namespace pb
+
+void put_packet(std::string& trace, const std::string& packet) {
+    put_bytes(trace, pb::kTracePacket, packet);
+}
+
+} // namespace
+
+struct TraceManager::ThreadBuffer {
+    std::mutex mutex; // Only contended while a snapshot is being taken
+    std::uint32_t thread_id = 0;
+    std::string thread_name;
+    std::pmr::vector<TraceEvent> ring{memory_resource()};
+    std::uint64_t written = 0;
+};
+
+std::size_t TraceSnapshot::event_count() const {
+    std::size_t count = 0;
+    for (const auto& thread : threads) {
+        count += thread.events.size();
+    }
+    return count;
+}
+
+TraceManager& TraceManager::instance() {
+    static TraceManager instance;
+    return instance;
+}
+
+void TraceManager::enable_tracing(bool enable) {
+    enabled_.store(enable, std::memory_order_relaxed);
+}
+
+void TraceManager::set_buffer_capacity(std::size_t events_per_thread) {
+    events_per_thread = std::max<std::size_t>(events_per_thread, 1);
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    capacity_.store(events_per_thread);
+    for (auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->ring.assign(events_per_thread, TraceEvent{});
+        buffer->written = 0;
+    }
+}
+
+std::size_t TraceManager::get_buffer_capacity() const {
+    return capacity_.load();
+}
+
+TraceManager::ThreadBuffer& TraceManager::local_buffer() {
+    // The registry keeps a reference so events outlive the thread that recorded them
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        auto created = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        created->thread_id = next_thread_id_++;
+        created->thread_name = "thread " + std::to_string(created->thread_id);
+        created->ring.resize(capacity_.load());
+        buffers_.push_back(created);
+        buffer = std::move(created);
+    }
+    return *buffer;
+}
+
+void TraceManager::set_thread_name(const std::string& name) {
+    auto& buffer = local_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.thread_name = name;
+}
+
+void TraceManager::record(const char* name, const char* category, std::uint64_t start_ns, std::uint64_t end_ns) {
+    if (!is_tracing_enabled()) return;
+
+    auto& buffer = local_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    auto& event = buffer.ring[buffer.written % buffer.ring.size()];
+    event.name = name;
+    event.category = category;
+    event.start_ns = start_ns;
+    event.duration_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+    ++buffer.written;
+}
+
+TraceSnapshot TraceManager::snapshot() const {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        buffers = buffers_;
+    }
+
+    TraceSnapshot result;
+    result.threads.reserve(buffers.size());
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        TraceThread thread;
+        thread.thread_id = buffer->thread_id;
+        thread.thread_name = buffer->thread_name;
+
+        const std::uint64_t capacity = buffer->ring.size();
+        const std::uint64_t count = std::min(buffer->written, capacity);
+        thread.dropped_events = buffer->written - count;
+        thread.events.reserve(count);
+        for (std::uint64_t i = buffer->written - count; i < buffer->written; ++i) {
+            thread.events.push_back(buffer->ring[i % capacity]);
+        }
+        result.threads.push_back(std::move(thread));
+    }
+    return result;
+}
+
+void TraceManager::clear() {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    // Drop buffers whose threads have exited; the registry holds the last reference
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                  [](const auto& buffer) { return buffer.use_count() == 1; }),
+                   buffers_.end());
+    for (auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->written = 0;
+    }
+}
+
+std::string TraceManager::export_chrome_json() const {
+    return export_chrome_json(snapshot());
+}
+
+std::string TraceManager::export_perfetto() const {
+    return export_perfetto(snapshot());
+}
+
+std::string TraceManager::export_chrome_json(const TraceSnapshot& snapshot) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+
+    std::uint64_t dropped = 0;
+    bool first = true;
+    oss << "{\"traceEvents\":[\n";
+    for (const auto& thread : snapshot.threads) {
+        dropped += thread.dropped_events;
+        if (!first) oss << ",\n";
+        first = false;
+        oss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << kTracePid << ",\"tid\":" << thread.thread_id
+            << ",\"args\":{\"name\":\"" << json_escape(thread.thread_name.c_str()) << "\"}}";
+
+        // Complete events; ts and dur are in microseconds
+        for (const auto& event : thread.events) {
+            oss << ",\n{\"name\":\"" << json_escape(event.name) << "\",\"cat\":\"" << json_escape(event.category)
+                << "\",\"ph\":\"X\",\"ts\":" << static_cast<double>(event.start_ns) / 1e3
+                << ",\"dur\":" << static_cast<double>(event.duration_ns) / 1e3 << ",\"pid\":" << kTracePid
+                << ",\"tid\":" << thread.thread_id << "}";
+        }
+    }
+    oss << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+    return oss.str();
+}
+
+std::string TraceManager::export_perfetto(const TraceSnapshot& snapshot) {
+    std::string trace;
+
+    std::string process;
+    put_uint(process, pb::kProcessPid, kTracePid);
+    put_bytes(process, pb::kProcessName, "goethe");
+    std::string process_track;
+    put_uint(process_track, pb::kTrackUuid, kProcessTrackUuid);
+    put_bytes(process_track, pb::kTrackProcess, process);
+    std::string process_packet;
+    put_uint(process_packet, pb::kTrustedPacketSequenceId, 1);
+    put_bytes(process_packet, pb::kTrackDescriptor, process_track);
+    put_packet(trace, process_packet);
+
+    for (const auto& thread : snapshot.threads) {
+        // One packet sequence per thread keeps each sequence's timestamps ordered
+        const std::uint64_t sequence_id = thread.thread_id + 1;
+        const std::uint64_t track_uuid = kThreadTrackUuidBase + thread.thread_id;
+
+        std::string descriptor;
+        put_uint(descriptor, pb::kThreadPid, kTracePid);
+        put_uint(descriptor, pb::kThreadTid, thread.thread_id);
+        put_bytes(descriptor, pb::kThreadName, thread.thread_name);
+        std::string track;
+        put_uint(track, pb::kTrackUuid, track_uuid);
+        put_uint(track, pb::kTrackParentUuid, kProcessTrackUuid);
+        put_bytes(track, pb::kTrackThread, descriptor);
+        std::string track_packet;
+        put_uint(track_packet, pb::kTrustedPacketSequenceId, sequence_id);
+        put_bytes(track_packet, pb::kTrackDescriptor, track);
+        put_packet(trace, track_packet);
+
+        auto put_slice = [&](const TraceEvent* event, std::uint64_t timestamp) {
+            std::string track_event;
+            put_uint(track_event, pb::kEventType, event ? pb::kSliceBegin : pb::kSliceEnd);
+            put_uint(track_event, pb::kEventTrackUuid, track_uuid);
+            if (event) {
+                put_bytes(track_event, pb::kEventCategories, event->category ? event->category : "");
+                put_bytes(track_event, pb::kEventName, event->name ? event->name : "");
+            }
+            std::string packet;
+            put_uint(packet, pb::kTimestamp, timestamp);
+            put_uint(packet, pb::kTrustedPacketSequenceId, sequence_id);
+            put_bytes(packet, pb::kTrackEvent, track_event);
+            put_packet(trace, packet);
+        };
+
+        // Spans are recorded when they end, so inner scopes precede outer ones.
+        // Order by start (outermost first) and replay as nested begin/end pairs.
+        std::vector<TraceEvent> events = thread.events;
+        std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+            if (a.start_ns != b.start_ns) return a.start_ns < b.start_ns;
+            return a.duration_ns > b.duration_ns;
+        });
+
+        std::vector<std::uint64_t> open_ends;
+        for (const auto& event : events) {
+            while (!open_ends.empty() && open_ends.back() <= event.start_ns) {
+                put_slice(nullptr, open_ends.back());
+                open_ends.pop_back();
+            }
+            put_slice(&event, event.start_ns);
+            // Clamp to the parent so a slice never outlives the one enclosing it
+            std::uint64_t end = event.start_ns + event.duration_ns;
+            if (!open_ends.empty()) end = std::min(end, open_ends.back());
+            open_ends.push_back(end);
+        }
+        while (!open_ends.empty()) {
+            put_slice(nullptr, open_ends.back());
+            open_ends.pop_back();
+        }
+    }
+    return trace;
+}
+
+std::uint64_t TraceManager::now_ns() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+} // namespace goethe
@@ -0,0 +1,1366 @@
+#include "goethe/yaml_subset.hpp"
+#include "goethe/allocator.hpp"
+#include "goethe/cpu_dispatch.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <string>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GOETHE_YAML_SIMD 1
+#endif
+
+namespace goethe {
+
+// ============================================================================
+// Structural Index
+// ============================================================================
+
+namespace {
+
+constexpr std::array<bool, 256> make_structural_table() {
+    std::array<bool, 256> table{};
+    for (char c : std::string_view("\t\n\r\"#',:[\\]{}")) {
+        table[static_cast<unsigned char>(c)] = true;
+    }
+    return table;
+}
+
+constexpr auto kStructural = make_structural_table();
+
+void index_scalar(const char* data, std::size_t size, std::pmr::vector<std::uint32_t>& positions) {
+    for (std::size_t i = 0; i < size; ++i) {
+        if (kStructural[static_cast<unsigned char>(data[i])]) {
+            positions.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
+
+#ifdef GOETHE_YAML_SIMD
+// The SIMD scanners take 64 bytes per step and set one mask bit per
+// structural byte. Each byte is looked up by its low and by its high nibble;
+// the two tables share a bit only for the structural bytes, grouped by high
+// nibble: 0x0 (\t \n \r), 0x2 (" # ' ,), 0x3 (:), 0x5 ([ \ ]) and 0x7 ({ }).
+#define GOETHE_YAML_LOW_TABLE 0, 0, 2, 2, 0, 0, 0, 2, 0, 1, 5, 24, 10, 25, 0, 0
+#define GOETHE_YAML_HIGH_TABLE 1, 0, 2, 4, 0, 8, 0, 16, 0, 0, 0, 0, 0, 0, 0, 0
+
+// The 64 bytes at offset, padded with zero bytes (never structural) past the
+// end of the text
+inline const char* block_at(const char* data, std::size_t size, std::size_t offset, char (&tail)[64]) {
+    if (size - offset >= 64) {
+        return data + offset;
+    }
+    std::memset(tail, 0, sizeof(tail));
+    std::memcpy(tail, data + offset, size - offset);
+    return tail;
+}
+
+// Appends the positions of a block's mask bits, growing the output ahead of
+// the writes
+inline void append_positions(std::pmr::vector<std::uint32_t>& positions, std::size_t& count, std::size_t offset,
+                             std::uint64_t mask) {
+    if (positions.size() < count + 64) {
+        positions.resize(std::max(positions.size() * 2, count + 64));
+    }
+    std::uint32_t* out = positions.data() + count;
+    while (mask != 0) {
+        *out++ = static_cast<std::uint32_t>(offset + static_cast<std::size_t>(__builtin_ctzll(mask)));
+        mask &= mask - 1;
+    }
+    count = static_cast<std::size_t>(out - positions.data());
+}
+
+__attribute__((target("sse4.2"))) inline std::uint64_t structural_mask_sse42(__m128i bytes) {
+    const __m128i low_table = _mm_setr_epi8(GOETHE_YAML_LOW_TABLE);
+    const __m128i high_table = _mm_setr_epi8(GOETHE_YAML_HIGH_TABLE);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i low = _mm_shuffle_epi8(low_table, _mm_and_si128(bytes, nibble));
+    const __m128i high = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble));
+    const __m128i miss = _mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128());
+    return ~static_cast<std::uint32_t>(_mm_movemask_epi8(miss)) & 0xFFFFu;
+}
+
+__attribute__((target("sse4.2"))) void index_sse42(const char* data, std::size_t size,
+                                                  std::pmr::vector<std::uint32_t>& positions) {
+    std::size_t count = 0;
+    for (std::size_t offset = 0; offset < size; offset += 64) {
+        char tail[64];
+        const char* block = block_at(data, size, offset, tail);
+        std::uint64_t mask = 0;
+        for (int part = 0; part < 4; ++part) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + part * 16));
+            mask |= structural_mask_sse42(bytes) << (part * 16);
+        }
+        append_positions(positions, count, offset, mask);
+    }
+    positions.resize(count);
+}
+
+__attribute__((target("avx2"))) inline std::uint32_t structural_mask_avx2(__m256i bytes) {
+    const __m256i low_table = _mm256_setr_epi8(GOETHE_YAML_LOW_TABLE, GOETHE_YAML_LOW_TABLE);
+    const __m256i high_table = _mm256_setr_epi8(GOETHE_YAML_HIGH_TABLE, GOETHE_YAML_HIGH_TABLE);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(bytes, nibble));
+    const __m256i high = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+    const __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+    return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(miss));
+}
+
+__attribute__((target("avx2"))) void index_avx2(const char* data, std::size_t size,
+                                                std::pmr::vector<std::uint32_t>& positions) {
+    std::size_t count = 0;
+    for (std::size_t offset = 0; offset < size; offset += 64) {
+        char tail[64];
+        const char* block = block_at(data, size, offset, tail);
+        const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+        append_positions(positions, count, offset,
+                         structural_mask_avx2(first) | (std::uint64_t{structural_mask_avx2(second)} << 32));
+    }
+    positions.resize(count);
+}
+
+// Packs four consecutive bytes of a 16-byte table, little-endian, into one
+// of the lanes _mm512_set4_epi32 repeats
+constexpr int table_word(const std::array<std::uint8_t, 16>& table, std::size_t word) {
+    return static_cast<int>(std::uint32_t{table[4 * word]} | std::uint32_t{table[4 * word + 1]} << 8 |
+                            std::uint32_t{table[4 * word + 2]} << 16 | std::uint32_t{table[4 * word + 3]} << 24);
+}
+
+// The table in every 128-bit lane. GCC 12's _mm512_broadcast_i32x4 and
+// _mm512_inserti* start from an undefined register and warn about it.
+__attribute__((target("avx512f"))) inline __m512i repeat_table(const std::array<std::uint8_t, 16>& table) {
+    return _mm512_set4_epi32(table_word(table, 3), table_word(table, 2), table_word(table, 1), table_word(table, 0));
+}
+
+__attribute__((target("avx512f,avx512bw"))) void index_avx512(const char* data, std::size_t size,
+                                                              std::pmr::vector<std::uint32_t>& positions) {
+    const __m512i low_table = repeat_table({GOETHE_YAML_LOW_TABLE});
+    const __m512i high_table = repeat_table({GOETHE_YAML_HIGH_TABLE});
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    std::size_t count = 0;
+    for (std::size_t offset = 0; offset < size; offset += 64) {
+        char tail[64];
+        const __m512i bytes = _mm512_loadu_si512(block_at(data, size, offset, tail));
+        const __m512i low = _mm512_shuffle_epi8(low_table, _mm512_and_si512(bytes, nibble));
+        const __m512i high = _mm512_shuffle_epi8(high_table, _mm512_and_si512(_mm512_srli_epi16(bytes, 4), nibble));
+        append_positions(positions, count, offset, _mm512_test_epi8_mask(low, high));
+    }
+    positions.resize(count);
+}
+
+#undef GOETHE_YAML_LOW_TABLE
+#undef GOETHE_YAML_HIGH_TABLE
+#endif
+
+using IndexKernel = void(const char*, std::size_t, std::pmr::vector<std::uint32_t>&);
+
+#ifdef GOETHE_YAML_SIMD
+constexpr CpuDispatch<IndexKernel> index_kernel({index_scalar, index_sse42, index_avx2, index_avx512});
+#else
+constexpr CpuDispatch<IndexKernel> index_kernel({index_scalar, nullptr, nullptr, nullptr});
+#endif
+
+} // namespace
+
+CpuTier yaml_scan_tier() {
+    return index_kernel.tier();
+}
+
+void index_yaml_structure(std::string_view text, std::pmr::vector<std::uint32_t>& positions) {
+    if (text.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("YAML document too large to index");
+    }
+    positions.clear();
+    index_kernel.get()(text.data(), text.size(), positions);
+}
+
+// ============================================================================
+// Subset Parser
+// ============================================================================
+
+namespace {
+
+// Thrown wherever a document leaves the subset; read_dialogue_subset turns
+// it into nullopt so yaml-cpp gets the document
+struct Unsupported {};
+
+[[noreturn]] void unsupported() {
+    throw Unsupported{};
+}
+
+constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+constexpr int kMaxDepth = 256;
+constexpr std::size_t kMaxKeyLength = 1024; // yaml-cpp's limit for implicit keys
+
+struct Value {
+    enum class Kind : std::uint8_t { NUL, SCALAR, SEQUENCE, MAP };
+    Kind kind = Kind::NUL;
+    std::string_view text;       // Scalars; views the input or Document::decoded
+    std::uint32_t first = kNone; // Items, or keys and values alternating
+    std::uint32_t next = kNone;  // Next child of the parent
+};
+
+struct Document {
+    explicit Document(std::pmr::memory_resource* resource) : values(resource), decoded(resource) {}
+
+    std::pmr::vector<Value> values;
+    std::pmr::deque<std::pmr::string> decoded; // Quoted scalars that contained escapes
+    std::uint32_t root = kNone;
+
+    void clear() {
+        values.clear();
+        decoded.clear();
+        root = kNone;
+    }
+};
+
+// Plain scalars yaml-cpp reads as null
+bool is_null_spelling(std::string_view text) {
+    return text.empty() || text == "~" || text == "null" || text == "Null" || text == "NULL";
+}
+
+void append_utf8(std::pmr::string& out, std::uint32_t code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+// Recursive descent over the structural index. Text between structural
+// bytes is never looked at byte by byte, except for indentation. The parser
+// only moves forward, so the index is consumed with a single cursor.
+class Parser {
+public:
+    Parser(std::string_view text, const std::pmr::vector<std::uint32_t>& positions, Document& document)
+        : text_(text), data_(text.data()), size_(text.size()), structural_(positions.data()), doc_(document) {}
+
+    void parse() {
+        std::size_t start = 0;
+        if (text_.substr(0, 3) == "\xEF\xBB\xBF") {
+            start = 3; // UTF-8 byte order mark
+        }
+        start_line(start);
+        if (indent_ < 0) {
+            unsupported(); // Empty document
+        }
+        doc_.root = parse_node(indent_);
+        if (indent_ >= 0) {
+            unsupported(); // Content after the root node
+        }
+    }
+
+private:
+    using Kind = Value::Kind;
+
+    // Guards recursion so deeply nested input cannot exhaust the stack
+    struct DepthGuard {
+        explicit DepthGuard(int& depth) : depth_(depth) {
+            if (++depth_ > kMaxDepth) {
+                unsupported();
+            }
+        }
+        ~DepthGuard() {
+            --depth_;
+        }
+        int& depth_;
+    };
+
+    char at(std::size_t p) const {
+        return p < size_ ? data_[p] : '\0';
+    }
+
+    bool blank_or_end(std::size_t p) const {
+        const char c = at(p);
+        return p >= size_ || c == ' ' || c == '\n' || c == '\r';
+    }
+
+    // First structural byte at or after p; positions end with a sentinel at size_
+    std::size_t next_structural(std::size_t p) {
+        while (*structural_ < p) {
+            ++structural_;
+        }
+        return *structural_;
+    }
+
+    std::size_t find_newline(std::size_t p) {
+        for (p = next_structural(p); p < size_ && data_[p] != '\n'; p = next_structural(p + 1)) {
+            if (data_[p] == '\r' && at(p + 1) != '\n') {
+                unsupported(); // Lone carriage return
+            }
+        }
+        return p;
+    }
+
+    void skip_spaces() {
+        while (at(pos_) == ' ') {
+            ++pos_;
+        }
+    }
+
+    bool is_document_marker(std::size_t p) const {
+        const std::string_view marker = text_.substr(p, 3);
+        return (marker == "---" || marker == "...") && blank_or_end(p + 3);
+    }
+
+    std::uint32_t add(Kind kind, std::string_view text = {}) {
+        doc_.values.push_back(Value{kind, text});
+        return static_cast<std::uint32_t>(doc_.values.size() - 1);
+    }
+
+    void append(std::uint32_t parent, std::uint32_t& last, std::uint32_t child) {
+        if (last == kNone) {
+            doc_.values[parent].first = child;
+        } else {
+            doc_.values[last].next = child;
+        }
+        last = child;
+    }
+
+    // Moves to the first character of the next line with content, skipping
+    // blank and comment lines. indent_ is -1 at the end of the input.
+    void start_line(std::size_t p) {
+        for (;;) {
+            line_start_ = p;
+            while (at(p) == ' ') {
+                ++p;
+            }
+            if (p >= size_) {
+                indent_ = -1;
+                pos_ = size_;
+                return;
+            }
+            const char c = data_[p];
+            if (c == '\n' || (c == '\r' && at(p + 1) == '\n')) {
+                p += c == '\r' ? 2 : 1;
+                continue;
+            }
+            if (c == '#') {
+                p = find_newline(p) + 1;
+                continue;
+            }
+            if (p == line_start_ && is_document_marker(p)) {
+                // A single "---" may open the document
+                if (!allow_marker_ || c != '-') {
+                    unsupported();
+                }
+                allow_marker_ = false;
+                p += 3;
+                while (at(p) == ' ') {
+                    ++p;
+                }
+                if (p < size_ && at(p) != '\n' && at(p) != '\r' && at(p) != '#') {
+                    unsupported(); // Content on the marker line
+                }
+                p = find_newline(p) + 1;
+                continue;
+            }
+            allow_marker_ = false;
+            indent_ = static_cast<int>(p - line_start_);
+            pos_ = p;
+            return;
+        }
+    }
+
+    // Requires the rest of the line to be empty or a comment, then moves on
+    void end_line() {
+        skip_spaces();
+        if (pos_ >= size_) {
+            indent_ = -1;
+            return;
+        }
+        const char c = data_[pos_];
+        if (c == '\n') {
+            start_line(pos_ + 1);
+        } else if (c == '\r' && at(pos_ + 1) == '\n') {
+            start_line(pos_ + 2);
+        } else if (c == '#' && data_[pos_ - 1] == ' ') {
+            start_line(find_newline(pos_) + 1);
+        } else {
+            unsupported();
+        }
+    }
+
+    bool at_line_end() const {
+        const char c = at(pos_);
+        return pos_ >= size_ || c == '\n' || c == '\r' || c == '#';
+    }
+
+    // Characters that cannot start a plain scalar, or that start constructs
+    // left to yaml-cpp (anchors, aliases, tags, block scalars, complex keys)
+    void check_plain_start(std::size_t p) const {
+        switch (at(p)) {
+            case ',': case '[': case ']': case '{': case '}': case '#': case '&': case '*':
+            case '!': case '|': case '>': case '\'': case '"': case '%': case '@': case '`':
+            case '?': case '\t':
+                unsupported();
+            case '-':
+            case ':':
+                if (blank_or_end(p + 1)) {
+                    unsupported();
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::uint32_t add_plain(std::size_t start, std::size_t end) {
+        while (end > start && data_[end - 1] == ' ') {
+            --end;
+        }
+        const std::string_view text = text_.substr(start, end - start);
+        return add(is_null_spelling(text) ? Kind::NUL : Kind::SCALAR, text);
+    }
+
+    // Plain scalar in block context, ending at ": ", " #" or the line end.
+    // is_key is set when it ends at ": ".
+    std::uint32_t parse_plain_block(bool& is_key) {
+        const std::size_t start = pos_;
+        check_plain_start(start);
+        std::size_t p = start;
+        is_key = false;
+        for (;; ++p) {
+            p = next_structural(p);
+            if (p >= size_) {
+                break;
+            }
+            const char c = data_[p];
+            if (c == '\n') {
+                break;
+            }
+            if (c == '\r') {
+                if (at(p + 1) != '\n') {
+                    unsupported();
+                }
+                break;
+            }
+            if (c == ':' && blank_or_end(p + 1)) {
+                is_key = true;
+                break;
+            }
+            if (c == '#' && p > start && data_[p - 1] == ' ') {
+                break;
+            }
+            if (c == '\t') {
+                unsupported();
+            }
+        }
+        pos_ = p;
+        return add_plain(start, p);
+    }
+
+    // Plain scalar in a flow collection, ending at ',', ']', '}', ": ",
+    // " #" or the line end
+    std::uint32_t parse_plain_flow() {
+        const std::size_t start = pos_;
+        check_plain_start(start);
+        std::size_t p = start;
+        for (;; ++p) {
+            p = next_structural(p);
+            if (p >= size_) {
+                break;
+            }
+            const char c = data_[p];
+            if (c == '\n' || c == ',' || c == ']' || c == '}') {
+                break;
+            }
+            if (c == '\r') {
+                if (at(p + 1) != '\n') {
+                    unsupported();
+                }
+                break;
+            }
+            if (c == ':') {
+                if (blank_or_end(p + 1)) {
+                    break;
+                }
+                const char after = at(p + 1);
+                if (after == ',' || after == ']' || after == '}') {
+                    unsupported();
+                }
+            }
+            if (c == '#' && data_[p - 1] == ' ') {
+                break;
+            }
+            if (c == '[' || c == '{' || c == '\t') {
+                unsupported();
+            }
+        }
+        // yaml-cpp also ends flow scalars at '?'
+        if (std::memchr(data_ + start, '?', p - start) != nullptr) {
+            unsupported();
+        }
+        pos_ = p;
+        return add_plain(start, p);
+    }
+
+    std::uint32_t parse_hex_escape(std::size_t& p, int digits) {
+        std::uint32_t code_point = 0;
+        for (int i = 0; i < digits; ++i, ++p) {
+            const char c = at(p);
+            std::uint32_t digit;
+            if (c >= '0' && c <= '9') {
+                digit = static_cast<std::uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                digit = static_cast<std::uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                digit = static_cast<std::uint32_t>(c - 'A' + 10);
+            } else {
+                unsupported();
+            }
+            code_point = code_point * 16 + digit;
+        }
+        if ((code_point >= 0xD800 && code_point <= 0xDFFF) || code_point > 0x10FFFF) {
+            unsupported();
+        }
+        return code_point;
+    }
+
+    // Decodes the escape after a backslash at p - 1; returns the position after it
+    std::size_t decode_escape(std::size_t p, std::pmr::string& out) {
+        const char c = at(p++);
+        switch (c) {
+            case '0': out += '\0'; break;
+            case 'a': out += '\a'; break;
+            case 'b': out += '\b'; break;
+            case 't': case '\t': out += '\t'; break;
+            case 'n': out += '\n'; break;
+            case 'v': out += '\v'; break;
+            case 'f': out += '\f'; break;
+            case 'r': out += '\r'; break;
+            case 'e': out += '\x1B'; break;
+            case ' ': case '"': case '/': case '\\': out += c; break;
+            case 'x': append_utf8(out, parse_hex_escape(p, 2)); break;
+            case 'u': append_utf8(out, parse_hex_escape(p, 4)); break;
+            case 'U': append_utf8(out, parse_hex_escape(p, 8)); break;
+            default: unsupported();
+        }
+        return p;
+    }
+
+    // Single-line single- or double-quoted scalar. Views the input unless
+    // it contains escapes.
+    std::uint32_t parse_quoted() {
+        const char quote = data_[pos_];
+        const std::size_t start = pos_ + 1;
+        std::pmr::string* decoded = nullptr;
+        std::size_t copied = start; // Start of the input not yet in *decoded
+        std::size_t p = start;
+        for (;;) {
+            p = next_structural(p);
+            if (p >= size_) {
+                unsupported();
+            }
+            const char c = data_[p];
+            if (c == '\n' || c == '\r') {
+                unsupported(); // Multi-line scalars fold line breaks
+            }
+            if (c == quote) {
+                if (quote == '\'' && at(p + 1) == '\'') {
+                    if (decoded == nullptr) {
+                        decoded = &doc_.decoded.emplace_back();
+                    }
+                    decoded->append(data_ + copied, p + 1 - copied);
+                    p += 2;
+                    copied = p;
+                    continue;
+                }
+                break;
+            }
+            if (c == '\\' && quote == '"') {
+                if (decoded == nullptr) {
+                    decoded = &doc_.decoded.emplace_back();
+                }
+                decoded->append(data_ + copied, p - copied);
+                p = decode_escape(p + 1, *decoded);
+                copied = p;
+                continue;
+            }
+            ++p;
+        }
+        std::string_view text = text_.substr(start, p - start);
+        if (decoded != nullptr) {
+            decoded->append(data_ + copied, p - copied);
+            text = *decoded;
+        }
+        pos_ = p + 1;
+        return add(Kind::SCALAR, text);
+    }
+
+    void check_key(std::uint32_t key) const {
+        if (doc_.values[key].text.size() > kMaxKeyLength) {
+            unsupported();
+        }
+    }
+
+    // A block node starting at pos_, which is at `column`
+    std::uint32_t parse_node(int column) {
+        DepthGuard guard(depth_);
+        const char c = data_[pos_];
+        if (c == '-' && blank_or_end(pos_ + 1)) {
+            return parse_block_sequence(column);
+        }
+        if (c == '[' || c == '{') {
+            const auto value = parse_flow();
+            end_line();
+            return value;
+        }
+        std::uint32_t scalar;
+        bool is_key;
+        if (c == '"' || c == '\'') {
+            scalar = parse_quoted();
+            std::size_t p = pos_;
+            while (at(p) == ' ') {
+                ++p;
+            }
+            is_key = at(p) == ':' && blank_or_end(p + 1);
+            if (is_key) {
+                pos_ = p;
+            }
+        } else {
+            scalar = parse_plain_block(is_key);
+        }
+        if (is_key) {
+            return parse_block_map(column, scalar);
+        }
+        end_line();
+        return scalar;
+    }
+
+    // A key at the start of a line, leaving pos_ at its ':'
+    std::uint32_t parse_block_key() {
+        const char c = data_[pos_];
+        std::uint32_t key;
+        if (c == '"' || c == '\'') {
+            key = parse_quoted();
+            skip_spaces();
+            if (at(pos_) != ':' || !blank_or_end(pos_ + 1)) {
+                unsupported();
+            }
+        } else {
+            bool is_key;
+            key = parse_plain_block(is_key);
+            if (!is_key) {
+                unsupported();
+            }
+        }
+        return key;
+    }
+
+    // A value on the same line as its key
+    std::uint32_t parse_inline_value() {
+        const char c = data_[pos_];
+        std::uint32_t value;
+        if (c == '[' || c == '{') {
+            value = parse_flow();
+        } else if (c == '"' || c == '\'') {
+            value = parse_quoted();
+        } else {
+            bool is_key;
+            value = parse_plain_block(is_key);
+            if (is_key) {
+                unsupported(); // "a: b: c"
+            }
+        }
+        end_line();
+        return value;
+    }
+
+    std::uint32_t parse_block_map(int column, std::uint32_t key) {
+        const auto map = add(Kind::MAP);
+        std::uint32_t last = kNone;
+        for (;;) {
+            check_key(key);
+            ++pos_; // The ':'
+            skip_spaces();
+            std::uint32_t value;
+            if (at_line_end()) {
+                end_line();
+                if (indent_ > column) {
+                    value = parse_node(indent_);
+                } else if (indent_ == column && data_[pos_] == '-' && blank_or_end(pos_ + 1)) {
+                    value = parse_block_sequence(column); // Sequences may sit at the key's indentation
+                } else {
+                    value = add(Kind::NUL);
+                }
+            } else {
+                value = parse_inline_value();
+            }
+            append(map, last, key);
+            append(map, last, value);
+            if (indent_ != column) {
+                if (indent_ > column) {
+                    unsupported(); // Continuation lines or bad indentation
+                }
+                return map;
+            }
+            if (data_[pos_] == '-' && blank_or_end(pos_ + 1)) {
+                unsupported();
+            }
+            key = parse_block_key();
+        }
+    }
+
+    std::uint32_t parse_block_sequence(int column) {
+        const auto sequence = add(Kind::SEQUENCE);
+        std::uint32_t last = kNone;
+        do {
+            ++pos_; // The '-'
+            skip_spaces();
+            std::uint32_t item;
+            if (at_line_end()) {
+                end_line();
+                item = indent_ > column ? parse_node(indent_) : add(Kind::NUL);
+            } else {
+                item = parse_node(static_cast<int>(pos_ - line_start_));
+            }
+            append(sequence, last, item);
+        } while (indent_ == column && data_[pos_] == '-' && blank_or_end(pos_ + 1));
+        if (indent_ > column) {
+            unsupported();
+        }
+        return sequence;
+    }
+
+    // Skips spaces, line breaks and comments inside a flow collection. Like
+    // yaml-cpp, ignores the indentation of continuation lines.
+    void skip_flow_space() {
+        for (;;) {
+            const char c = at(pos_);
+            if (c == ' ') {
+                ++pos_;
+            } else if (c == '\n' || (c == '\r' && at(pos_ + 1) == '\n')) {
+                pos_ += c == '\r' ? 2 : 1;
+                line_start_ = pos_;
+                if (is_document_marker(pos_)) {
+                    unsupported();
+                }
+            } else if (c == '#' && (data_[pos_ - 1] == ' ' || data_[pos_ - 1] == '\n')) {
+                pos_ = find_newline(pos_);
+            } else {
+                return;
+            }
+        }
+    }
+
+    std::uint32_t parse_flow_node() {
+        const char c = at(pos_);
+        if (c == '[' || c == '{') {
+            return parse_flow();
+        }
+        if (c == '"' || c == '\'') {
+            return parse_quoted();
+        }
+        return parse_plain_flow();
+    }
+
+    std::uint32_t parse_flow() {
+        DepthGuard guard(depth_);
+        const bool is_map = data_[pos_] == '{';
+        const char close = is_map ? '}' : ']';
+        const auto collection = add(is_map ? Kind::MAP : Kind::SEQUENCE);
+        std::uint32_t last = kNone;
+        ++pos_;
+        skip_flow_space();
+        if (at(pos_) == close) {
+            ++pos_;
+            return collection;
+        }
+        for (;;) {
+            if (is_map) {
+                const char c = at(pos_);
+                if (c == '[' || c == '{') {
+                    unsupported(); // Collections as keys
+                }
+                const auto key = c == '"' || c == '\'' ? parse_quoted() : parse_plain_flow();
+                check_key(key);
+                skip_spaces();
+                if (at(pos_) != ':' || !blank_or_end(pos_ + 1)) {
+                    unsupported(); // Keys without values, or "a":b
+                }
+                ++pos_;
+                skip_flow_space();
+                const char after = at(pos_);
+                const auto value = after == ',' || after == '}' ? add(Kind::NUL) : parse_flow_node();
+                append(collection, last, key);
+                append(collection, last, value);
+            } else {
+                append(collection, last, parse_flow_node());
+            }
+            skip_flow_space();
+            const char c = at(pos_);
+            if (c == close) {
+                ++pos_;
+                return collection;
+            }
+            if (c != ',') {
+                unsupported(); // Also single-pair maps in sequences, "[a: b]"
+            }
+            ++pos_;
+            skip_flow_space();
+            if (at(pos_) == close) {
+                unsupported(); // Trailing comma
+            }
+        }
+    }
+
+    std::string_view text_;
+    const char* data_;
+    std::size_t size_;
+    const std::uint32_t* structural_;
+    Document& doc_;
+
+    std::size_t pos_ = 0;
+    std::size_t line_start_ = 0;
+    int indent_ = -1; // Column of the current line's content, -1 at the end
+    int depth_ = 0;
+    bool allow_marker_ = true;
+};
+
+// ============================================================================
+// Scalar Conversion
+// ============================================================================
+// yaml-cpp converts through std::stringstream, detecting the base of
+// integers from the text. Decimal spellings are converted here, text that is
+// clearly not a number fails as it does there, and anything in between
+// (octal, hex, '+', surrounding whitespace) is Unsupported.
+
+// convert<bool>::decode: y/n, yes/no, true/false and on/off, in lower case,
+// upper case or capitalized
+std::optional<bool> scalar_to_bool(std::string_view text) {
+    auto lower = [](char c) { return c >= 'a' && c <= 'z'; };
+    auto upper = [](char c) { return c >= 'A' && c <= 'Z'; };
+    const std::string_view rest = text.empty() ? text : text.substr(1);
+    const bool flexible = text.empty() || std::all_of(text.begin(), text.end(), lower) ||
+                          (upper(text[0]) && (std::all_of(rest.begin(), rest.end(), lower) ||
+                                              std::all_of(rest.begin(), rest.end(), upper)));
+    if (!flexible || text.size() > 5) {
+        return std::nullopt;
+    }
+    char folded[5];
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        folded[i] = upper(text[i]) ? static_cast<char>(text[i] - 'A' + 'a') : text[i];
+    }
+    const std::string_view name(folded, text.size());
+    if (name == "y" || name == "yes" || name == "true" || name == "on") {
+        return true;
+    }
+    if (name == "n" || name == "no" || name == "false" || name == "off") {
+        return false;
+    }
+    return std::nullopt;
+}
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+std::size_t skip_digits(std::string_view text, std::size_t p) {
+    while (p < text.size() && is_digit(text[p])) {
+        ++p;
+    }
+    return p;
+}
+
+// The stream stops at the first character that cannot continue the number
+// and the conversion fails unless only whitespace follows. A stop at
+// whitespace, or at a character that might have continued the number, is
+// left to yaml-cpp.
+std::nullopt_t stopped_at(char c, std::string_view continuations) {
+    if (is_space(c) || continuations.find(c) != std::string_view::npos) {
+        unsupported();
+    }
+    return std::nullopt;
+}
+
+std::optional<int> scalar_to_int(std::string_view text) {
+    if (text.empty() || text[0] == '+') {
+        if (!text.empty()) {
+            unsupported();
+        }
+        return std::nullopt;
+    }
+    const std::size_t begin = text[0] == '-' ? 1 : 0;
+    const std::size_t end = skip_digits(text, begin);
+    if (end == begin) {
+        return std::nullopt;
+    }
+    if (text[begin] == '0' && end - begin > 1) {
+        unsupported(); // Octal
+    }
+    if (end < text.size()) {
+        return stopped_at(text[end], text[begin] == '0' ? "xX" : "");
+    }
+    int value = 0;
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc{}) {
+        return std::nullopt; // Out of range fails in yaml-cpp as well
+    }
+    return value;
+}
+
+std::optional<float> scalar_to_float(std::string_view text) {
+    if (text == ".inf" || text == ".Inf" || text == ".INF" || text == "+.inf" || text == "+.Inf" || text == "+.INF") {
+        return std::numeric_limits<float>::infinity();
+    }
+    if (text == "-.inf" || text == "-.Inf" || text == "-.INF") {
+        return -std::numeric_limits<float>::infinity();
+    }
+    if (text == ".nan" || text == ".NaN" || text == ".NAN") {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+    if (text.empty() || text[0] == '+' || text[0] == '.') {
+        if (!text.empty()) {
+            unsupported();
+        }
+        return std::nullopt;
+    }
+    // -?digits(.digits)?([eE][+-]?digits)?
+    const std::size_t begin = text[0] == '-' ? 1 : 0;
+    std::size_t p = skip_digits(text, begin);
+    if (p == begin) {
+        return p < text.size() ? stopped_at(text[p], ".") : std::nullopt;
+    }
+    if (p < text.size() && text[p] == '.') {
+        const std::size_t fraction = p + 1;
+        p = skip_digits(text, fraction);
+        if (p == fraction) {
+            unsupported();
+        }
+    }
+    if (p < text.size() && (text[p] == 'e' || text[p] == 'E')) {
+        std::size_t exponent = p + 1;
+        if (exponent < text.size() && (text[exponent] == '+' || text[exponent] == '-')) {
+            ++exponent;
+        }
+        p = skip_digits(text, exponent);
+        if (p == exponent) {
+            unsupported();
+        }
+    }
+    if (p < text.size()) {
+        return stopped_at(text[p], ".eE+-");
+    }
+    const std::string terminated(text);
+    errno = 0;
+    const float value = std::strtof(terminated.c_str(), nullptr);
+    if (errno == ERANGE) {
+        unsupported();
+    }
+    return value;
+}
+
+// ============================================================================
+// Dialogue Mapping
+// ============================================================================
+// Mirrors from_yaml() in dialog.cpp field by field, through a handle with
+// the parts of the YAML::Node interface it uses. Where yaml-cpp would throw
+// (missing fields, conversions that fail, subscripting a scalar) the handle
+// throws Unsupported, and yaml-cpp reports the error itself.
+
+class SubsetNode {
+public:
+    SubsetNode(const Document& document, std::uint32_t index) : doc_(&document), index_(index) {}
+
+    explicit operator bool() const {
+        return index_ != kNone; // Like YAML::Node, true for null values
+    }
+
+    SubsetNode operator[](std::string_view key) const {
+        const Value& map = value();
+        if (map.kind != Value::Kind::MAP) {
+            unsupported();
+        }
+        for (std::uint32_t k = map.first; k != kNone; k = doc_->values[doc_->values[k].next].next) {
+            const Value& candidate = doc_->values[k];
+            if (candidate.kind == Value::Kind::SCALAR && candidate.text == key) {
+                return {*doc_, candidate.next};
+            }
+        }
+        return {*doc_, kNone};
+    }
+
+    bool is_map() const {
+        return value().kind == Value::Kind::MAP;
+    }
+    bool is_scalar() const {
+        return value().kind == Value::Kind::SCALAR;
+    }
+
+    std::string text() const {
+        const Value& v = value();
+        if (v.kind == Value::Kind::NUL) {
+            return "null";
+        }
+        if (v.kind != Value::Kind::SCALAR) {
+            unsupported();
+        }
+        return std::string(v.text);
+    }
+
+    bool as_bool() const {
+        return required(scalar_to_bool(scalar_text()));
+    }
+    int as_int() const {
+        return required(scalar_to_int(scalar_text()));
+    }
+    float as_float() const {
+        return required(scalar_to_float(scalar_text()));
+    }
+
+    // Narrowest type a scalar converts to: bool, then int, then float, then string
+    std::variant<std::string, int, float, bool> effect_value() const {
+        const std::string_view text = scalar_text();
+        if (auto flag = scalar_to_bool(text)) {
+            return *flag;
+        }
+        if (auto integer = scalar_to_int(text)) {
+            return *integer;
+        }
+        if (auto number = scalar_to_float(text)) {
+            return *number;
+        }
+        return std::string(text);
+    }
+
+    // Iterates sequence items, or map keys and values as pairs; a null
+    // value iterates as empty like in yaml-cpp
+    template <bool Pairs>
+    class Children {
+    public:
+        class iterator {
+        public:
+            iterator(const Document* doc, std::uint32_t index) : doc_(doc), index_(index) {}
+            auto operator*() const {
+                if constexpr (Pairs) {
+                    return std::pair<SubsetNode, SubsetNode>{{*doc_, index_}, {*doc_, doc_->values[index_].next}};
+                } else {
+                    return SubsetNode{*doc_, index_};
+                }
+            }
+            iterator& operator++() {
+                index_ = doc_->values[index_].next;
+                if constexpr (Pairs) {
+                    index_ = doc_->values[index_].next;
+                }
+                return *this;
+            }
+            bool operator!=(const iterator& other) const {
+                return index_ != other.index_;
+            }
+
+        private:
+            const Document* doc_;
+            std::uint32_t index_;
+        };
+
+        Children(const Document* doc, std::uint32_t first) : doc_(doc), first_(first) {}
+        iterator begin() const {
+            return {doc_, first_};
+        }
+        iterator end() const {
+            return {doc_, kNone};
+        }
+
+    private:
+        const Document* doc_;
+        std::uint32_t first_;
+    };
+
+    Children<false> items() const {
+        return {doc_, children(Value::Kind::SEQUENCE)};
+    }
+    Children<true> entries() const {
+        return {doc_, children(Value::Kind::MAP)};
+    }
+
+private:
+    const Value& value() const {
+        if (index_ == kNone) {
+            unsupported(); // yaml-cpp throws InvalidNode
+        }
+        return doc_->values[index_];
+    }
+
+    std::string_view scalar_text() const {
+        const Value& v = value();
+        if (v.kind != Value::Kind::SCALAR) {
+            unsupported();
+        }
+        return v.text;
+    }
+
+    std::uint32_t children(Value::Kind kind) const {
+        const Value& v = value();
+        if (v.kind == Value::Kind::NUL) {
+            return kNone;
+        }
+        if (v.kind != kind) {
+            unsupported();
+        }
+        return v.first;
+    }
+
+    template <typename T>
+    static T required(std::optional<T> converted) {
+        if (!converted) {
+            unsupported(); // yaml-cpp throws TypedBadConversion
+        }
+        return *converted;
+    }
+
+    const Document* doc_;
+    std::uint32_t index_;
+};
+
+void read_subset(const SubsetNode& node, Condition& condition) {
+    if (node["all"]) {
+        condition.type = Condition::Type::ALL;
+        for (const auto child : node["all"].items()) {
+            read_subset(child, condition.children.emplace_back());
+        }
+    } else if (node["any"]) {
+        condition.type = Condition::Type::ANY;
+        for (const auto child : node["any"].items()) {
+            read_subset(child, condition.children.emplace_back());
+        }
+    } else if (node["not"]) {
+        condition.type = Condition::Type::NOT;
+        read_subset(node["not"], condition.children.emplace_back());
+    } else if (node["flag"]) {
+        condition.type = Condition::Type::FLAG;
+        condition.key = node["flag"].text();
+    } else if (node["var"]) {
+        condition.type = Condition::Type::VAR;
+        condition.key = node["var"]["name"].text();
+        if (node["var"]["value"].is_scalar()) {
+            condition.value = node["var"]["value"].text();
+        }
+    } else {
+        unsupported(); // from_yaml leaves the type indeterminate
+    }
+}
+
+void read_subset(const SubsetNode& node, Effect& effect) {
+    if (node["type"]) {
+        const std::string type = node["type"].text();
+        if (type == "SET_FLAG") {
+            effect.type = Effect::Type::SET_FLAG;
+        } else if (type == "SET_VAR") {
+            effect.type = Effect::Type::SET_VAR;
+        } else if (type == "QUEST_ADD") {
+            effect.type = Effect::Type::QUEST_ADD;
+        } else if (type == "QUEST_COMPLETE") {
+            effect.type = Effect::Type::QUEST_COMPLETE;
+        } else if (type == "NOTIFY") {
+            effect.type = Effect::Type::NOTIFY;
+        } else if (type == "PLAY_SFX") {
+            effect.type = Effect::Type::PLAY_SFX;
+        } else if (type == "PLAY_MUSIC") {
+            effect.type = Effect::Type::PLAY_MUSIC;
+        } else if (type == "TELEPORT") {
+            effect.type = Effect::Type::TELEPORT;
+        } else {
+            unsupported(); // from_yaml leaves the type indeterminate
+        }
+        if (node["target"]) {
+            effect.target = node["target"].text();
+        }
+        if (node["value"] && node["value"].is_scalar()) {
+            effect.value = node["value"].effect_value();
+        }
+        if (node["params"]) {
+            for (const auto [key, value] : node["params"].entries()) {
+                effect.params[key.text()] = value.text();
+            }
+        }
+    } else if (node["setFlag"]) {
+        effect.type = Effect::Type::SET_FLAG;
+        effect.target = node["setFlag"].text();
+    } else if (node["setVar"]) {
+        effect.type = Effect::Type::SET_VAR;
+        effect.target = node["setVar"]["name"].text();
+        if (node["setVar"]["value"].is_scalar()) {
+            effect.value = node["setVar"]["value"].text();
+        }
+    } else if (node["quest.add"]) {
+        effect.type = Effect::Type::QUEST_ADD;
+        effect.target = node["quest.add"].text();
+    } else if (node["notify"]) {
+        effect.type = Effect::Type::NOTIFY;
+        effect.target = node["notify"]["title"].text();
+        effect.value = node["notify"]["body"].text();
+    } else {
+        unsupported();
+    }
+}
+
+void read_effects(const SubsetNode& node, std::vector<Effect>& effects) {
+    for (const auto item : node.items()) {
+        read_subset(item, effects.emplace_back());
+    }
+}
+
+void read_strings(const SubsetNode& node, std::map<std::string, std::string>& map) {
+    for (const auto [key, value] : node.entries()) {
+        map[key.text()] = value.text();
+    }
+}
+
+void read_subset(const SubsetNode& node, Line& line) {
+    line.text = node["text"].text();
+    if (node["voice"]) {
+        const auto voice = node["voice"];
+        line.voice = Voice{voice["clipId"].text(), voice["subtitles"] ? voice["subtitles"].as_bool() : true,
+                           voice["startMs"] ? voice["startMs"].as_int() : 0};
+    }
+    if (node["portrait"]) {
+        const auto portrait = node["portrait"];
+        line.portrait = Portrait{portrait["id"].text(), portrait["mood"] ? portrait["mood"].text() : ""};
+    }
+    if (node["sfx"]) {
+        for (const auto sfx : node["sfx"].items()) {
+            line.sfx.push_back(sfx.text());
+        }
+    }
+    if (node["params"]) {
+        read_strings(node["params"], line.params);
+    }
+    if (node["conditions"]) {
+        read_subset(node["conditions"], line.conditions.emplace());
+    }
+    line.weight = node["weight"] ? node["weight"].as_float() : 1.0f;
+}
+
+void read_subset(const SubsetNode& node, Choice& choice) {
+    choice.id = node["id"].text();
+    choice.text = node["text"].text();
+    choice.to = node["to"].text();
+    if (node["conditions"]) {
+        read_subset(node["conditions"], choice.conditions.emplace());
+    }
+    if (node["effects"]) {
+        read_effects(node["effects"], choice.effects);
+    }
+    choice.once = node["once"] ? node["once"].as_bool() : false;
+    choice.cooldownMs = node["cooldownMs"] ? node["cooldownMs"].as_int() : 0;
+    if (node["disabledText"]) {
+        choice.disabledText = node["disabledText"].text();
+    }
+}
+
+void read_subset(const SubsetNode& node, Node& node_obj) {
+    node_obj.id = node["id"].text();
+    if (node["speaker"]) {
+        node_obj.speaker = node["speaker"].text();
+    }
+    if (node["tags"]) {
+        for (const auto tag : node["tags"].items()) {
+            node_obj.tags.push_back(tag.text());
+        }
+    }
+    if (node["line"]) {
+        read_subset(node["line"], node_obj.line.emplace());
+    } else if (node["lines"]) {
+        for (const auto line : node["lines"].items()) {
+            read_subset(line, node_obj.lines.emplace_back());
+        }
+    }
+    if (node["choices"]) {
+        for (const auto choice : node["choices"].items()) {
+            read_subset(choice, node_obj.choices.emplace_back());
+        }
+    }
+    if (node["onEnter"] && node["onEnter"]["effects"]) {
+        read_effects(node["onEnter"]["effects"], node_obj.onEnterEffects);
+    }
+    if (node["onExit"] && node["onExit"]["effects"]) {
+        read_effects(node["onExit"]["effects"], node_obj.onExitEffects);
+    }
+    if (node["autoAdvanceMs"]) {
+        node_obj.autoAdvanceMs = node["autoAdvanceMs"].as_int();
+    } else if (node["autoAdvance"]) {
+        node_obj.autoAdvanceMs = node["autoAdvance"]["ms"].as_int();
+    }
+    node_obj.interruptible = node["interruptible"] ? node["interruptible"].as_bool() : true;
+}
+
+void read_subset(const SubsetNode& node, Dialogue& dialogue) {
+    if (!node["id"] || !node["nodes"]) {
+        unsupported(); // yaml-cpp path reports the missing field
+    }
+    dialogue.id = node["id"].text();
+    if (node["metadata"]) {
+        read_strings(node["metadata"], dialogue.metadata);
+    }
+    if (node["startNode"]) {
+        dialogue.startNode = node["startNode"].text();
+    }
+    for (const auto item : node["nodes"].items()) {
+        read_subset(item, dialogue.nodes.emplace_back());
+    }
+    if (node["localVars"]) {
+        read_strings(node["localVars"], dialogue.localVars);
+    }
+}
+
+} // namespace
+
+std::optional<Dialogue> read_dialogue_subset(std::string_view yaml) {
+    if (yaml.size() >= kNone) {
+        return std::nullopt;
+    }
+    // Buffers are kept between documents, one set per thread, and replaced
+    // when the allocator changes
+    struct Scratch {
+        explicit Scratch(std::pmr::memory_resource* resource) : positions(resource), document(resource) {}
+        std::pmr::vector<std::uint32_t> positions;
+        Document document;
+    };
+    thread_local std::optional<Scratch> scratch;
+    if (!scratch || scratch->positions.get_allocator().resource() != memory_resource()) {
+        scratch.emplace(memory_resource());
+    }
+    auto& [positions, document] = *scratch;
+    try {
+        index_yaml_structure(yaml, positions);
+        positions.push_back(static_cast<std::uint32_t>(yaml.size()));
+        document.clear();
+        Parser(yaml, positions, document).parse();
+
+        const SubsetNode root(document, document.root);
+        if (!root.is_map()) {
+            return std::nullopt;
+        }
+        Dialogue dialogue;
+        read_subset(root, dialogue);
+        return dialogue;
+    } catch (const Unsupported&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace goethe
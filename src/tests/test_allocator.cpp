@@ -0,0 +1,257 @@
+#include "goethe/allocator.hpp"
+#include "goethe/buffer.hpp"
+#include "goethe/condition.hpp"
+#include "goethe/factory.hpp"
+#include "goethe/register_backends.hpp"
+#include "goethe/runner.hpp"
+#include "goethe/yaml_subset.hpp"
+#include <gtest/gtest.h>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Host allocator that records every live allocation
+struct CountingHeap {
+    struct Block {
+        std::size_t size;
+        std::size_t alignment;
+    };
+
+    std::mutex mutex;
+    std::map<void*, Block> live;
+    std::size_t allocations = 0;
+    std::size_t mismatched_frees = 0;
+    bool fail = false;
+
+    static void* allocate(std::size_t size, std::size_t alignment, void* user_data) {
+        auto* heap = static_cast<CountingHeap*>(user_data);
+        std::lock_guard<std::mutex> lock(heap->mutex);
+        if (heap->fail) {
+            return nullptr;
+        }
+        void* pointer = ::operator new(size, std::align_val_t{alignment});
+        heap->live[pointer] = {size, alignment};
+        ++heap->allocations;
+        return pointer;
+    }
+
+    static void deallocate(void* pointer, std::size_t size, std::size_t alignment, void* user_data) {
+        auto* heap = static_cast<CountingHeap*>(user_data);
+        std::lock_guard<std::mutex> lock(heap->mutex);
+        auto it = heap->live.find(pointer);
+        if (it == heap->live.end() || it->second.size != size || it->second.alignment != alignment) {
+            ++heap->mismatched_frees;
+            return;
+        }
+        heap->live.erase(it);
+        ::operator delete(pointer, std::align_val_t{alignment});
+    }
+
+    goethe::AllocatorHooks hooks() {
+        return {allocate, deallocate, this};
+    }
+
+    std::size_t live_count() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return live.size();
+    }
+
+    // Character arrays, e.g. the heap part of a pmr::string
+    std::size_t live_strings() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t count = 0;
+        for (const auto& [pointer, block] : live) {
+            count += block.alignment == 1 ? 1 : 0;
+        }
+        return count;
+    }
+};
+
+goethe::DialogueScript finished_script() {
+    co_return;
+}
+
+} // namespace
+
+class AllocatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        goethe::BufferPool::instance().trim();
+        goethe::set_allocator(heap.hooks());
+    }
+
+    void TearDown() override {
+        goethe::set_allocator({});
+        goethe::BufferPool::instance().trim();
+        EXPECT_EQ(heap.live_count(), 0u);
+        EXPECT_EQ(heap.mismatched_frees, 0u);
+    }
+
+    CountingHeap heap;
+};
+
+TEST_F(AllocatorTest, HooksAreInstalled) {
+    const auto hooks = goethe::get_allocator();
+    EXPECT_EQ(hooks.allocate, &CountingHeap::allocate);
+    EXPECT_EQ(hooks.deallocate, &CountingHeap::deallocate);
+    EXPECT_EQ(hooks.user_data, &heap);
+
+    goethe::set_allocator({});
+    EXPECT_EQ(goethe::get_allocator().allocate, nullptr);
+}
+
+TEST_F(AllocatorTest, RejectsHalfSetHooks) {
+    goethe::AllocatorHooks hooks = heap.hooks();
+    hooks.deallocate = nullptr;
+    EXPECT_THROW(goethe::set_allocator(hooks), std::invalid_argument);
+    EXPECT_EQ(goethe::get_allocator().user_data, &heap);
+}
+
+TEST_F(AllocatorTest, MemoryResourceUsesHooks) {
+    std::pmr::vector<int> values(goethe::memory_resource());
+    values.resize(1000);
+    EXPECT_GE(heap.allocations, 1u);
+    EXPECT_EQ(heap.live_count(), 1u);
+}
+
+TEST_F(AllocatorTest, BuffersUseHooks) {
+    {
+        goethe::Buffer buffer(5000);
+        EXPECT_EQ(heap.live_count(), 1u);
+    }
+    // Idle in the pool until trimmed
+    EXPECT_EQ(heap.live_count(), 1u);
+    goethe::BufferPool::instance().trim();
+    EXPECT_EQ(heap.live_count(), 0u);
+}
+
+TEST_F(AllocatorTest, FailedAllocationThrows) {
+    heap.fail = true;
+    EXPECT_THROW(goethe::Buffer(100), std::bad_alloc);
+    heap.fail = false;
+}
+
+TEST_F(AllocatorTest, MemoryGoesBackToItsHooks) {
+    CountingHeap other;
+    std::pmr::vector<int> values(goethe::memory_resource());
+    values.resize(100);
+    goethe::Buffer buffer(100);
+
+    goethe::set_allocator(other.hooks());
+    values = std::pmr::vector<int>();
+    buffer = goethe::Buffer();
+    EXPECT_EQ(heap.live_count(), 1u); // The idle buffer block
+
+    // The pool does not hand out blocks from the old hooks
+    goethe::Buffer fresh(100);
+    EXPECT_EQ(other.live_count(), 1u);
+    fresh = goethe::Buffer();
+    goethe::BufferPool::instance().trim();
+    EXPECT_EQ(other.live_count(), 0u);
+    EXPECT_EQ(other.mismatched_frees, 0u);
+}
+
+TEST_F(AllocatorTest, PoolReleasesBlocksFromEarlierHooks) {
+    std::vector<goethe::Buffer> buffers;
+    buffers.emplace_back(100);
+    buffers.emplace_back(100);
+    buffers.clear();
+    EXPECT_EQ(heap.live_count(), 2u); // Idle in the pool
+
+    // The first acquire of the class under new hooks frees the old blocks
+    CountingHeap other;
+    goethe::set_allocator(other.hooks());
+    goethe::Buffer buffer(100);
+    EXPECT_EQ(heap.live_count(), 0u);
+    EXPECT_EQ(other.live_count(), 1u);
+
+    // And the same the other way round
+    buffer = goethe::Buffer();
+    goethe::set_allocator(heap.hooks());
+    buffer = goethe::Buffer(100);
+    EXPECT_EQ(other.live_count(), 0u);
+    EXPECT_EQ(heap.live_count(), 1u);
+    EXPECT_EQ(other.mismatched_frees, 0u);
+}
+
+TEST_F(AllocatorTest, ContainersUseHooks) {
+    {
+        goethe::WorldStateBlock block(1000);
+        block.set_flag(3, "met_alice");
+        block.set_var(4, "mood", "happy");
+        EXPECT_GE(heap.live_count(), 2u);
+    }
+    EXPECT_EQ(heap.live_count(), 0u);
+
+    const std::string yaml = "id: test\nnodes:\n  - id: start\n    line:\n      text: \"Hi \\u00e9\"\n";
+    const auto before = heap.allocations;
+    auto dialogue = goethe::read_dialogue_subset(yaml);
+    ASSERT_TRUE(dialogue);
+    EXPECT_GT(heap.allocations, before); // The per-thread scratch buffers
+
+    // The next read replaces the scratch buffers and frees the old ones
+    goethe::set_allocator({});
+    EXPECT_TRUE(goethe::read_dialogue_subset(yaml));
+    EXPECT_EQ(heap.live_count(), 0u);
+}
+
+TEST_F(AllocatorTest, StringKeysUseHooks) {
+    // Too long for the small-string buffer, so each copy allocates
+    const std::string flag(40, 'f');
+    const std::string var(40, 'v');
+    const std::string value(40, 'x');
+    goethe::WorldStateBlock block(64);
+    block.set_flag(1, flag);
+    block.set_var(2, var, value);
+    EXPECT_EQ(heap.live_strings(), 3u);
+
+    // Lookups by std::string do not copy the key
+    const auto before = heap.allocations;
+    block.set_flag(3, flag);
+    block.set_var(4, var, value);
+    EXPECT_TRUE(block.has_flag(3, flag));
+    EXPECT_EQ(std::string_view(*block.get_var(4, var)), value);
+    EXPECT_EQ(heap.allocations, before);
+}
+
+TEST_F(AllocatorTest, CoroutineFramesUseHooks) {
+    {
+        auto script = finished_script();
+        EXPECT_TRUE(script.done());
+        EXPECT_EQ(heap.live_count(), 1u);
+    }
+    // Kept for the next script on this thread
+    EXPECT_EQ(heap.live_count(), 1u);
+
+    // Once the hooks change, the kept frame goes back instead of being reused
+    goethe::set_allocator({});
+    {
+        auto script = finished_script();
+    }
+    EXPECT_EQ(heap.live_count(), 0u);
+}
+
+#ifdef GOETHE_ZSTD_AVAILABLE
+TEST_F(AllocatorTest, ZstdContextsUseHooks) {
+    goethe::register_compression_backends();
+    const std::string text(10000, 'x');
+    {
+        auto backend = goethe::CompressionFactory::instance().create_backend("zstd");
+        const std::size_t before = heap.live_count();
+        auto compressed = backend->compress(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+        auto decompressed = backend->decompress(compressed.data(), compressed.size());
+        EXPECT_EQ(decompressed.size(), text.size());
+        EXPECT_GT(heap.live_count(), before);
+    }
+    EXPECT_EQ(heap.live_count(), 0u);
+}
+#endif
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
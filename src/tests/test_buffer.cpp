@@ -0,0 +1,297 @@
+#include "goethe/buffer.hpp"
+#include "goethe/manager.hpp"
+#include "goethe/register_backends.hpp"
+#include "goethe/statistics.hpp"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class BufferTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        pool.trim();
+    }
+
+    void TearDown() override {
+        pool.set_retained_limit(std::size_t{64} << 20);
+        pool.trim();
+    }
+
+    static goethe::Buffer filled(std::size_t size, char value) {
+        goethe::Buffer buffer(size);
+        std::memset(buffer.data(), value, size);
+        return buffer;
+    }
+
+    goethe::BufferPool& pool = goethe::BufferPool::instance();
+};
+
+TEST_F(BufferTest, ReleasedBlocksAreReused) {
+    const uint8_t* first = nullptr;
+    {
+        goethe::Buffer buffer(1000);
+        first = buffer.data();
+        EXPECT_EQ(buffer.size(), 1000u);
+        EXPECT_EQ(buffer.capacity(), 1024u);
+    }
+    auto stats = pool.get_stats();
+    EXPECT_EQ(stats.idle_bytes, 1024u);
+
+    // Any size in the same class gets the same block back
+    goethe::Buffer again(600);
+    EXPECT_EQ(again.data(), first);
+    EXPECT_EQ(pool.get_stats().reused, stats.reused + 1);
+    EXPECT_EQ(pool.get_stats().idle_bytes, 0u);
+}
+
+TEST_F(BufferTest, CopiesShareBytes) {
+    goethe::Buffer buffer = filled(100, 'a');
+    EXPECT_EQ(buffer.use_count(), 1u);
+    {
+        goethe::Buffer copy = buffer;
+        goethe::BufferSlice slice(buffer, 10, 20);
+        EXPECT_EQ(buffer.use_count(), 3u);
+        EXPECT_EQ(copy.data(), buffer.data());
+        EXPECT_EQ(slice.data(), buffer.data() + 10);
+    }
+    EXPECT_EQ(buffer.use_count(), 1u);
+    EXPECT_EQ(pool.get_stats().idle_bytes, 0u);
+
+    goethe::Buffer moved = std::move(buffer);
+    EXPECT_EQ(moved.use_count(), 1u);
+    EXPECT_EQ(buffer.data(), nullptr);
+    EXPECT_EQ(buffer.use_count(), 0u);
+}
+
+TEST_F(BufferTest, SlicesKeepBufferAlive) {
+    goethe::BufferSlice tail;
+    {
+        goethe::Buffer buffer = goethe::Buffer::copy_of(std::span<const uint8_t>(
+            reinterpret_cast<const uint8_t*>("hello, world"), 12));
+        tail = goethe::BufferSlice(buffer).slice(7, 5);
+    }
+    EXPECT_EQ(tail.view(), "world");
+    EXPECT_EQ(tail.slice(1, 3).view(), "orl");
+    EXPECT_EQ(tail.tail_capacity(), goethe::BufferPool::kMinBlock - 12);
+    EXPECT_EQ(pool.get_stats().idle_bytes, 0u);
+}
+
+TEST_F(BufferTest, SlicesOutOfRangeThrow) {
+    goethe::Buffer buffer(10);
+    EXPECT_THROW(goethe::BufferSlice(buffer, 11, 0), std::out_of_range);
+    EXPECT_THROW(goethe::BufferSlice(buffer, 5, 6), std::out_of_range);
+    EXPECT_NO_THROW(goethe::BufferSlice(buffer, 10, 0));
+
+    goethe::BufferSlice slice(buffer, 2, 6);
+    EXPECT_THROW(slice.slice(0, 7), std::out_of_range);
+    EXPECT_THROW(slice.slice(7, 0), std::out_of_range);
+    EXPECT_EQ(slice.slice(6, 0).size(), 0u);
+}
+
+TEST_F(BufferTest, ResizeKeepsContents) {
+    goethe::Buffer buffer = filled(200, 'x');
+    const uint8_t* small = buffer.data();
+    buffer.resize(256);
+    EXPECT_EQ(buffer.data(), small);
+
+    goethe::Buffer old = buffer;
+    buffer.resize(5000);
+    EXPECT_NE(buffer.data(), small);
+    EXPECT_GE(buffer.capacity(), 5000u);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(buffer.data()), 200), std::string(200, 'x'));
+    // The other handle keeps the old block
+    EXPECT_EQ(old.data(), small);
+    EXPECT_EQ(old.size(), 256u);
+}
+
+TEST_F(BufferTest, LargeBlocksAreNotPooled) {
+    const auto before = pool.get_stats();
+    {
+        goethe::Buffer buffer(goethe::BufferPool::kMaxBlock + 1);
+        EXPECT_EQ(buffer.capacity(), goethe::BufferPool::kMaxBlock + 1);
+    }
+    const auto after = pool.get_stats();
+    EXPECT_EQ(after.allocated, before.allocated + 1);
+    EXPECT_EQ(after.idle_bytes, 0u);
+}
+
+TEST_F(BufferTest, RetainedLimitCapsIdleBytes) {
+    pool.set_retained_limit(4096);
+    {
+        goethe::Buffer a(4096);
+        goethe::Buffer b(4096);
+    }
+    EXPECT_EQ(pool.get_stats().idle_bytes, 4096u);
+
+    {
+        goethe::Buffer c(256);
+    }
+    EXPECT_EQ(pool.get_stats().idle_bytes, 4096u);
+
+    pool.set_retained_limit(0);
+    EXPECT_EQ(pool.get_stats().idle_bytes, 0u);
+}
+
+TEST_F(BufferTest, IdleBytesReportedAsCache) {
+    auto& stats = goethe::StatisticsManager::instance();
+    const auto before = stats.get_memory_usage(goethe::MemoryCategory::CACHE);
+    {
+        goethe::Buffer buffer(3000);
+    }
+    EXPECT_EQ(stats.get_memory_usage(goethe::MemoryCategory::CACHE), before + 4096);
+    pool.trim();
+    EXPECT_EQ(stats.get_memory_usage(goethe::MemoryCategory::CACHE), before);
+}
+
+TEST_F(BufferTest, ReadFileAndStream) {
+    const std::string content(40000, 'q');
+    const auto path = std::filesystem::temp_directory_path() / "goethe_buffer_test.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+    }
+    goethe::Buffer from_file = goethe::read_file(path, 64);
+    EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(from_file.data()), from_file.size()), content);
+    EXPECT_GE(from_file.capacity(), content.size() + 64);
+    std::filesystem::remove(path);
+    EXPECT_THROW(goethe::read_file(path), std::runtime_error);
+
+    std::istringstream input(content);
+    goethe::Buffer from_stream = goethe::read_stream(input, 64);
+    EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(from_stream.data()), from_stream.size()), content);
+    EXPECT_GE(from_stream.capacity(), content.size() + 64);
+
+    std::istringstream empty;
+    EXPECT_TRUE(goethe::read_stream(empty).empty());
+}
+
+TEST_F(BufferTest, ConcurrentUse) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < 1000; ++i) {
+                goethe::Buffer buffer = filled(64 + (i % 5000), static_cast<char>('a' + t));
+                goethe::BufferSlice slice(buffer);
+                goethe::Buffer copy = buffer;
+                ASSERT_EQ(slice.view().front(), 'a' + t);
+                ASSERT_EQ(slice.view().back(), 'a' + t);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_LE(pool.get_stats().idle_bytes, pool.get_retained_limit());
+}
+
+// Compression and parsing on pooled buffers
+class BufferPipelineTest : public BufferTest {
+protected:
+    void SetUp() override {
+        BufferTest::SetUp();
+        goethe::register_compression_backends();
+    }
+
+    static std::string written(const goethe::Dialogue& dialogue) {
+        std::ostringstream output;
+        goethe::write_dialogue(output, dialogue);
+        return output.str();
+    }
+
+    goethe::CompressionManager& manager = goethe::CompressionManager::instance();
+    std::string yaml = R"(id: pipeline
+nodes:
+  - id: start
+    speaker: alice
+    line:
+      text: Hello there
+  - id: reply
+    speaker: bob
+    line:
+      text: General Kenobi
+)";
+};
+
+TEST_F(BufferPipelineTest, NullBackendIsZeroCopy) {
+    manager.initialize("null");
+    goethe::BufferSlice input = goethe::Buffer::copy_of(
+        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(yaml.data()), yaml.size()));
+    auto compressed = manager.compress(input);
+    auto decompressed = manager.decompress(compressed);
+    EXPECT_EQ(decompressed.data(), input.data());
+    EXPECT_EQ(decompressed.view(), yaml);
+    EXPECT_TRUE(manager.decompress(goethe::BufferSlice()).empty());
+}
+
+#ifdef GOETHE_ZSTD_AVAILABLE
+TEST_F(BufferPipelineTest, ZstdRoundTripsThroughPool) {
+    manager.initialize("zstd");
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += yaml;
+    }
+    goethe::BufferSlice input = goethe::Buffer::copy_of(
+        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+    auto compressed = manager.compress(input);
+    EXPECT_LT(compressed.size(), text.size());
+    auto decompressed = manager.decompress(compressed);
+    EXPECT_EQ(decompressed.view(), text);
+
+    // A second round trip runs on recycled blocks
+    const auto before = pool.get_stats();
+    compressed = goethe::BufferSlice();
+    decompressed = goethe::BufferSlice();
+    decompressed = manager.decompress(manager.compress(input));
+    EXPECT_EQ(decompressed.view(), text);
+    EXPECT_EQ(pool.get_stats().allocated, before.allocated);
+}
+#endif
+
+TEST_F(BufferPipelineTest, ReadDialogueFromBuffer) {
+    std::istringstream input(yaml);
+    const auto expected = written(goethe::read_dialogue(input));
+
+    goethe::BufferSlice document = goethe::Buffer::copy_of(
+        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(yaml.data()), yaml.size()));
+    EXPECT_EQ(written(goethe::read_dialogue(document)), expected);
+
+    // Flow style is left to yaml-cpp, reading the buffer in place
+    const std::string flow = "{id: pipeline, nodes: [{id: start, speaker: alice, line: {text: Hi}}]}";
+    goethe::BufferSlice flow_document = goethe::Buffer::copy_of(
+        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(flow.data()), flow.size()));
+    EXPECT_EQ(goethe::read_dialogue(flow_document).nodes.at(0).line->text, "Hi");
+
+    const std::string bad = "id: [unclosed";
+    goethe::BufferSlice bad_document = goethe::Buffer::copy_of(
+        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(bad.data()), bad.size()));
+    EXPECT_THROW(goethe::read_dialogue(bad_document), std::runtime_error);
+}
+
+#ifdef GOETHE_SIMDJSON_AVAILABLE
+TEST_F(BufferPipelineTest, ReadJsonDialogueFromBuffer) {
+    const std::string json =
+        R"({"id": "pipeline", "nodes": [{"id": "start", "speaker": "alice", "line": {"text": "Hi"}}]})";
+    // Enough tail capacity for simdjson to read in place, and a slice that
+    // ends at the very end of its block
+    goethe::Buffer padded(json.size());
+    std::memcpy(padded.data(), json.data(), json.size());
+    EXPECT_EQ(goethe::read_dialogue(goethe::BufferSlice(padded)).nodes.at(0).line->text, "Hi");
+
+    goethe::Buffer exact(goethe::BufferPool::kMinBlock);
+    const std::size_t offset = exact.size() - json.size();
+    std::memcpy(exact.data() + offset, json.data(), json.size());
+    goethe::BufferSlice slice(exact, offset, json.size());
+    EXPECT_EQ(slice.tail_capacity(), 0u);
+    EXPECT_EQ(goethe::read_dialogue(slice).nodes.at(0).line->text, "Hi");
+}
+#endif
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,10 +1,20 @@
 #include "goethe/backend.hpp"
+#include "goethe/compressibility.hpp"
+#include "goethe/envelope.hpp"
 #include "goethe/factory.hpp"
 #include "goethe/manager.hpp"
 #include "goethe/register_backends.hpp"
+#include "goethe/zstd.hpp"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <atomic>
+#include <coroutine>
+#include <future>
+#include <limits>
+#include <memory>
+#include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
 class CompressionTest : public ::testing::Test {
@@ -78,6 +88,35 @@ TEST_F(CompressionFactoryTest, GetAvailableBackends) {
 #endif
 }
 
+TEST_F(CompressionFactoryTest, ProbesDoNotConstructBackends) {
+    // The factory outlives this test, so the callbacks share ownership of their state
+    auto constructed = std::make_shared<int>(0);
+    auto available = std::make_shared<bool>(false);
+    factory.register_backend("probe_test", [constructed]() {
+        ++*constructed;
+        return goethe::create_compression_backend("null");
+    }, [available]() { return *available; });
+
+    EXPECT_FALSE(factory.is_backend_available("probe_test"));
+    auto backends = factory.get_available_backends();
+    EXPECT_TRUE(std::find(backends.begin(), backends.end(), "probe_test") == backends.end());
+    EXPECT_THROW(factory.create_backend("probe_test"), goethe::CompressionError);
+    EXPECT_EQ(*constructed, 0);
+
+    *available = true;
+    EXPECT_TRUE(factory.is_backend_available("probe_test"));
+    EXPECT_EQ(*constructed, 0);
+    EXPECT_NE(factory.create_backend("probe_test"), nullptr);
+    EXPECT_EQ(*constructed, 1);
+}
+
+TEST_F(CompressionFactoryTest, RegistrationIsIdempotent) {
+    goethe::register_compression_backends();
+    goethe::register_compression_backends();
+    EXPECT_TRUE(factory.is_backend_available("null"));
+    EXPECT_EQ(factory.is_backend_available("zstd"), goethe::ZstdCompressionBackend::is_library_available());
+}
+
 // Manager tests
 class CompressionManagerTest : public CompressionTest {
 protected:
@@ -123,6 +162,180 @@ TEST_F(CompressionManagerTest, ManagerSetZstdBackend) {
 }
 #endif
 
+// Buffers of varying size and content, including an empty one
+static std::vector<std::vector<uint8_t>> make_batch_inputs(std::size_t count) {
+    std::vector<std::vector<uint8_t>> inputs;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string line = "Line " + std::to_string(i) + ": ";
+        for (std::size_t j = 0; j < i % 40; ++j) {
+            line += "the quick brown fox " + std::to_string(j * i) + " ";
+        }
+        inputs.emplace_back(line.begin(), line.end());
+    }
+    inputs[count / 2].clear();
+    return inputs;
+}
+
+TEST_F(CompressionManagerTest, BatchRoundTripNull) {
+    manager.initialize("null");
+    auto inputs = make_batch_inputs(300);
+    
+    auto compressed = manager.compress_batch(inputs);
+    ASSERT_EQ(compressed.size(), inputs.size());
+    EXPECT_EQ(compressed.offsets.back(), compressed.data.size());
+    
+    std::vector<std::vector<uint8_t>> parts;
+    for (std::size_t i = 0; i < compressed.size(); ++i) {
+        parts.emplace_back(compressed[i].begin(), compressed[i].end());
+    }
+    auto decompressed = manager.decompress_batch(parts);
+    ASSERT_EQ(decompressed.size(), inputs.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        EXPECT_EQ(std::vector<uint8_t>(decompressed[i].begin(), decompressed[i].end()), inputs[i]);
+    }
+}
+
+TEST_F(CompressionManagerTest, BatchRecordsStatisticsOnce) {
+    manager.initialize("null");
+    auto& stats_manager = goethe::StatisticsManager::instance();
+    stats_manager.reset_backend_stats("null");
+    auto inputs = make_batch_inputs(64);
+    std::size_t input_size = 0;
+    for (const auto& input : inputs) input_size += input.size();
+    
+    auto compressed = manager.compress_batch(inputs);
+    auto stats = stats_manager.get_backend_stats("null");
+    EXPECT_EQ(stats.total_compressions.load(), inputs.size());
+    EXPECT_EQ(stats.successful_compressions.load(), inputs.size());
+    EXPECT_EQ(stats.total_input_size.load(), input_size);
+    EXPECT_EQ(stats.total_output_size.load(), compressed.data.size());
+}
+
+TEST_F(CompressionManagerTest, BatchSingleThreaded) {
+    manager.initialize("null");
+    const auto threads = manager.get_batch_threads();
+    manager.set_batch_threads(0);
+    auto inputs = make_batch_inputs(20);
+    auto compressed = manager.compress_batch(inputs);
+    manager.set_batch_threads(threads);
+    ASSERT_EQ(compressed.size(), inputs.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        EXPECT_EQ(std::vector<uint8_t>(compressed[i].begin(), compressed[i].end()), inputs[i]);
+    }
+}
+
+#ifdef GOETHE_ZSTD_AVAILABLE
+TEST_F(CompressionManagerTest, BatchMatchesSingleCallsZstd) {
+    manager.initialize("zstd");
+    // Enough data that the pool gets involved
+    auto inputs = make_batch_inputs(2000);
+    
+    auto compressed = manager.compress_batch(inputs);
+    ASSERT_EQ(compressed.size(), inputs.size());
+    std::vector<std::vector<uint8_t>> parts;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        parts.emplace_back(compressed[i].begin(), compressed[i].end());
+        if (!inputs[i].empty()) {
+            EXPECT_EQ(parts.back(), manager.compress(inputs[i]));
+        }
+    }
+    
+    auto decompressed = manager.decompress_batch(parts);
+    ASSERT_EQ(decompressed.size(), inputs.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        EXPECT_EQ(std::vector<uint8_t>(decompressed[i].begin(), decompressed[i].end()), inputs[i]);
+    }
+}
+
+TEST_F(CompressionManagerTest, BatchThrowsOnCorruptItemZstd) {
+    manager.initialize("zstd");
+    auto inputs = make_batch_inputs(200);
+    auto compressed = manager.compress_batch(inputs);
+    std::vector<std::vector<uint8_t>> parts;
+    for (std::size_t i = 0; i < compressed.size(); ++i) {
+        parts.emplace_back(compressed[i].begin(), compressed[i].end());
+    }
+    parts[7] = {0xde, 0xad, 0xbe, 0xef, 0x00, 0x01};
+    EXPECT_THROW(manager.decompress_batch(parts), goethe::CompressionError);
+}
+#endif
+
+TEST_F(CompressionManagerTest, AsyncRoundTrip) {
+    manager.initialize("null");
+    manager.set_executor(nullptr);
+    std::vector<uint8_t> original_data(test_data.begin(), test_data.end());
+    
+    std::vector<std::future<std::vector<uint8_t>>> futures;
+    for (int i = 0; i < 16; ++i) {
+        futures.push_back(manager.compress_async(original_data));
+    }
+    for (auto& future : futures) {
+        auto compressed = future.get();
+        EXPECT_EQ(manager.decompress_async(compressed).get(), original_data);
+    }
+}
+
+TEST_F(CompressionManagerTest, AsyncUsesInjectedExecutor) {
+    manager.initialize("null");
+    std::vector<std::function<void()>> queued;
+    manager.set_executor([&](std::function<void()> task) { queued.push_back(std::move(task)); });
+    
+    std::vector<uint8_t> original_data(test_data.begin(), test_data.end());
+    auto future = manager.compress_async(original_data);
+    // Reconfiguring after the call does not affect the queued job
+    manager.switch_backend("null");
+    ASSERT_EQ(queued.size(), 1u);
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+    queued.front()();
+    EXPECT_EQ(future.get(), original_data);
+    manager.set_executor(nullptr);
+}
+
+TEST_F(CompressionManagerTest, AsyncPropagatesErrors) {
+    manager.initialize("null");
+    manager.set_executor(nullptr);
+    auto future = manager.decompress_async(std::vector<uint8_t>(64, 0x00));
+    EXPECT_THROW(future.get(), goethe::CompressionError);
+}
+
+// Fire-and-forget coroutine type for driving co_compress in tests
+struct DetachedCoroutine {
+    struct promise_type {
+        DetachedCoroutine get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+static DetachedCoroutine round_trip_coroutine(goethe::CompressionManager& manager, std::vector<uint8_t> data,
+                                              std::promise<std::vector<uint8_t>>& done) {
+    auto compressed = co_await manager.co_compress(data);
+    try {
+        done.set_value(co_await manager.co_decompress(std::move(compressed)));
+    } catch (...) {
+        done.set_exception(std::current_exception());
+    }
+}
+
+TEST_F(CompressionManagerTest, CoroutineRoundTrip) {
+    manager.initialize("null");
+    std::vector<uint8_t> original_data(test_data.begin(), test_data.end());
+    
+    manager.set_executor(nullptr);
+    std::promise<std::vector<uint8_t>> pooled;
+    round_trip_coroutine(manager, original_data, pooled);
+    EXPECT_EQ(pooled.get_future().get(), original_data);
+    
+    // An inline executor resumes the coroutine before co_await returns
+    manager.set_executor([](std::function<void()> task) { task(); });
+    std::promise<std::vector<uint8_t>> inline_run;
+    round_trip_coroutine(manager, original_data, inline_run);
+    EXPECT_EQ(inline_run.get_future().get(), original_data);
+    manager.set_executor(nullptr);
+}
+
 TEST_F(CompressionManagerTest, ManagerSetInvalidBackend) {
     // This should not throw but should keep the current backend
     EXPECT_NO_THROW(manager.switch_backend("invalid_backend"));
@@ -145,6 +358,434 @@ TEST_F(CompressionManagerTest, ManagerIsInitialized) {
     EXPECT_TRUE(manager.is_initialized());
 }
 
+// Context tests
+class CompressionContextTest : public CompressionTest {
+protected:
+    std::vector<uint8_t> original_data{test_data.begin(), test_data.end()};
+};
+
+TEST_F(CompressionContextTest, StartsUninitialized) {
+    goethe::CompressionContext context;
+    EXPECT_FALSE(context.is_initialized());
+    EXPECT_EQ(context.get_backend_name(), "uninitialized");
+    EXPECT_THROW(context.compress(original_data), goethe::CompressionError);
+
+    goethe::CompressionContext initialized("null");
+    EXPECT_EQ(initialized.decompress(initialized.compress(original_data)), original_data);
+}
+
+TEST_F(CompressionContextTest, ContextsDoNotShareBackends) {
+    auto& manager = goethe::CompressionManager::instance();
+    manager.initialize("null");
+    goethe::CompressionContext saves("null");
+    goethe::CompressionContext packages("null");
+
+#ifdef GOETHE_ZSTD_AVAILABLE
+    packages.switch_backend("zstd");
+    packages.set_compression_level(19);
+    EXPECT_EQ(manager.get_backend_name(), "null");
+    EXPECT_EQ(saves.get_backend_name(), "null");
+
+    saves.switch_backend("zstd");
+    EXPECT_NE(saves.get_compression_level(), 19);
+    EXPECT_EQ(packages.get_compression_level(), 19);
+#endif
+    manager.switch_backend("null");
+    EXPECT_EQ(packages.decompress(packages.compress(original_data)), original_data);
+}
+
+TEST_F(CompressionContextTest, StatisticsSwitchStaysWithItsContext) {
+    auto& manager = goethe::CompressionManager::instance();
+    manager.initialize("null");
+    manager.enable_statistics(true);
+    goethe::CompressionContext quiet;
+    quiet.enable_statistics(false); // Kept through initialize
+    quiet.initialize("null");
+    EXPECT_FALSE(quiet.is_statistics_enabled());
+    EXPECT_TRUE(manager.is_statistics_enabled());
+    EXPECT_TRUE(goethe::StatisticsManager::instance().is_statistics_enabled());
+
+    const auto before = manager.get_statistics().total_compressions.load();
+    quiet.compress(original_data);
+    EXPECT_EQ(manager.get_statistics().total_compressions.load(), before);
+    manager.compress(original_data);
+    EXPECT_EQ(manager.get_statistics().total_compressions.load(), before + 1);
+
+    quiet.switch_backend("null");
+    EXPECT_FALSE(quiet.is_statistics_enabled());
+}
+
+#ifdef GOETHE_ZSTD_AVAILABLE
+TEST_F(CompressionContextTest, DictionariesStayWithTheirContext) {
+    std::vector<std::vector<uint8_t>> samples;
+    for (int i = 0; i < 200; ++i) {
+        std::string record = "id: dlg_" + std::to_string(i) + "\nspeaker: marshal\nline:\n  text: dlg_chapter1.node_" +
+                             std::to_string(i * 7) + ".text\n";
+        samples.emplace_back(record.begin(), record.end());
+    }
+    goethe::CompressionOptions options;
+    options.dictionary_mode = true;
+    options.dictionary = goethe::ZstdCompressionBackend::train_dictionary(samples, 2048);
+    ASSERT_FALSE(options.dictionary.empty());
+
+    goethe::CompressionContext network("zstd");
+    goethe::CompressionContext saves("zstd");
+    network.set_options(options);
+    EXPECT_TRUE(saves.get_options().dictionary.empty());
+
+    auto compressed = network.compress(samples.back());
+    EXPECT_EQ(network.decompress(compressed), samples.back());
+    EXPECT_EQ(network.decompress_async(compressed).get(), samples.back());
+    EXPECT_THROW(saves.decompress(compressed), goethe::CompressionError);
+}
+#endif
+
+TEST_F(CompressionContextTest, ContextsRunOnTheirOwnThreads) {
+    const std::string backend = goethe::CompressionFactory::instance().is_backend_available("zstd") ? "zstd" : "null";
+    std::atomic<int> round_trips{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            goethe::CompressionContext context(backend);
+            context.set_compression_level(1 + t * 5);
+            context.set_batch_threads(0);
+            std::vector<uint8_t> data = original_data;
+            data.push_back(static_cast<uint8_t>(t));
+            for (int i = 0; i < 50; ++i) {
+                if (context.decompress(context.compress(data)) == data) {
+                    ++round_trips;
+                }
+            }
+            if (context.decompress_async(context.compress_async(data).get()).get() == data) {
+                ++round_trips;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(round_trips.load(), 4 * 51);
+}
+
+TEST_F(CompressionContextTest, QueuedJobsOutliveTheirContext) {
+    std::vector<std::function<void()>> queued;
+    std::future<std::vector<uint8_t>> future;
+    {
+        goethe::CompressionContext context("null");
+        context.set_executor([&](std::function<void()> task) { queued.push_back(std::move(task)); });
+        future = context.compress_async(original_data);
+    }
+    ASSERT_EQ(queued.size(), 1u);
+    queued.front()();
+    EXPECT_EQ(future.get(), original_data);
+}
+
+// Envelope tests
+TEST(EnvelopeTest, HeaderRoundTrip) {
+    const std::uint64_t sizes[] = {0, 1, 127, 128, 16383, 16384, std::uint64_t{1} << 32,
+                                   std::numeric_limits<std::uint64_t>::max()};
+    for (std::uint64_t size : sizes) {
+        for (bool checksum : {false, true}) {
+            goethe::EnvelopeHeader header;
+            header.backend = 7;
+            header.original_size = size;
+            if (checksum) {
+                header.checksum = 0xDEADBEEF;
+            }
+            uint8_t bytes[goethe::kMaxEnvelopeHeader];
+            const std::size_t written = goethe::write_envelope_header(header, bytes);
+            ASSERT_LE(written, goethe::kMaxEnvelopeHeader);
+
+            auto read = goethe::read_envelope_header({bytes, written});
+            ASSERT_TRUE(read);
+            EXPECT_EQ(read->backend, 7);
+            EXPECT_EQ(read->original_size, size);
+            EXPECT_EQ(read->checksum, header.checksum);
+            EXPECT_EQ(read->size, written);
+
+            // Every proper prefix past the magic is truncated
+            for (std::size_t length = goethe::kEnvelopeMagic.size(); length < written; ++length) {
+                EXPECT_THROW(goethe::read_envelope_header({bytes, length}), goethe::CompressionError);
+            }
+        }
+    }
+}
+
+TEST(EnvelopeTest, RejectsMalformedHeaders) {
+    const std::vector<uint8_t> plain = {'h', 'e', 'l', 'l', 'o'};
+    EXPECT_FALSE(goethe::read_envelope_header(plain));
+    EXPECT_FALSE(goethe::read_envelope_header({}));
+
+    const std::vector<uint8_t> valid = {0xE7, 'G', 'T', 'H', 1, 0, 0, 5};
+    EXPECT_TRUE(goethe::read_envelope_header(valid));
+
+    auto version = valid;
+    version[4] = 2;
+    EXPECT_THROW(goethe::read_envelope_header(version), goethe::CompressionError);
+    auto flags = valid;
+    flags[5] = 0x80;
+    EXPECT_THROW(goethe::read_envelope_header(flags), goethe::CompressionError);
+    std::vector<uint8_t> overflow = {0xE7, 'G', 'T', 'H', 1, 0, 0};
+    overflow.insert(overflow.end(), 9, 0xFF);
+    overflow.push_back(0x02);
+    EXPECT_THROW(goethe::read_envelope_header(overflow), goethe::CompressionError);
+}
+
+TEST(EnvelopeTest, Crc32cMatchesAtEveryTier) {
+    const std::string check = "123456789";
+    const std::span<const uint8_t> check_bytes(reinterpret_cast<const uint8_t*>(check.data()), check.size());
+
+    std::mt19937 rng(3);
+    std::vector<uint8_t> data(300);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    std::vector<std::uint32_t> expected;
+    {
+        goethe::ScopedCpuTierLimit limit(goethe::CpuTier::SCALAR);
+        for (std::size_t size = 0; size <= data.size(); ++size) {
+            expected.push_back(goethe::crc32c({data.data(), size}));
+        }
+    }
+    for (auto tier : {goethe::CpuTier::SCALAR, goethe::CpuTier::SSE42, goethe::CpuTier::AVX512}) {
+        goethe::ScopedCpuTierLimit limit(tier);
+        EXPECT_EQ(goethe::crc32c(check_bytes), 0xE3069283u) << goethe::to_string(goethe::crc32c_tier());
+        EXPECT_EQ(goethe::crc32c(check_bytes.subspan(4), goethe::crc32c(check_bytes.first(4))), 0xE3069283u);
+        for (std::size_t size = 0; size <= data.size(); ++size) {
+            ASSERT_EQ(goethe::crc32c({data.data(), size}), expected[size]) << "size " << size;
+        }
+    }
+}
+
+TEST_F(CompressionFactoryTest, BackendIds) {
+    EXPECT_EQ(factory.get_backend_id("null"), goethe::BackendId{0});
+    EXPECT_EQ(factory.get_backend_id("zstd"), goethe::BackendId{1});
+    EXPECT_FALSE(factory.get_backend_id("missing"));
+    EXPECT_EQ(factory.create_backend_by_id(0)->name(), "null");
+    EXPECT_THROW(factory.create_backend_by_id(200), goethe::CompressionError);
+
+    // IDs stay with their backend
+    EXPECT_THROW(factory.register_backend("impostor", [&] { return factory.create_backend("null"); },
+                                          nullptr, goethe::BackendId{0}),
+                 goethe::CompressionError);
+}
+
+TEST_F(CompressionManagerTest, EnvelopeRoundTrip) {
+    manager.initialize("null");
+    const std::vector<uint8_t> original(test_data.begin(), test_data.end());
+    for (bool checksum : {false, true}) {
+        auto packed = manager.compress_envelope(original.data(), original.size(), checksum);
+        auto header = goethe::read_envelope_header(packed);
+        ASSERT_TRUE(header);
+        EXPECT_EQ(header->backend, 0);
+        EXPECT_EQ(header->original_size, original.size());
+        EXPECT_EQ(header->checksum.has_value(), checksum);
+        EXPECT_EQ(manager.decompress_envelope(packed.data(), packed.size()), original);
+    }
+
+    auto empty = manager.compress_envelope(nullptr, 0);
+    EXPECT_TRUE(manager.decompress_envelope(empty.data(), empty.size()).empty());
+    EXPECT_THROW(manager.decompress_envelope(original.data(), original.size()), goethe::CompressionError);
+}
+
+TEST_F(CompressionManagerTest, EnvelopeDetectsDamage) {
+    manager.initialize("null");
+    const std::vector<uint8_t> original(test_data.begin(), test_data.end());
+    auto packed = manager.compress_envelope(original.data(), original.size(), true);
+
+    auto flipped = packed;
+    flipped.back() ^= 0x01;
+    EXPECT_THROW(manager.decompress_envelope(flipped.data(), flipped.size()), goethe::CompressionError);
+
+    auto truncated = packed;
+    truncated.pop_back();
+    EXPECT_THROW(manager.decompress_envelope(truncated.data(), truncated.size()), goethe::CompressionError);
+
+    auto unknown = packed;
+    unknown[6] = 200; // Backend ID
+    EXPECT_THROW(manager.decompress_envelope(unknown.data(), unknown.size()), goethe::CompressionError);
+
+    // A size field inflated past the payload is refused before allocating
+    auto header = goethe::read_envelope_header(packed);
+    ASSERT_TRUE(header);
+    for (std::uint64_t declared : {std::uint64_t{original.size() + 1}, std::uint64_t{1} << 32, std::uint64_t{1} << 62}) {
+        goethe::EnvelopeHeader inflated = *header;
+        inflated.original_size = declared;
+        std::vector<uint8_t> forged(goethe::kMaxEnvelopeHeader);
+        forged.resize(goethe::write_envelope_header(inflated, forged.data()));
+        forged.insert(forged.end(), packed.begin() + static_cast<std::ptrdiff_t>(header->size), packed.end());
+        EXPECT_THROW(manager.decompress_envelope(forged.data(), forged.size()), goethe::CompressionError);
+        EXPECT_THROW(manager.decompress_envelope(goethe::BufferSlice(goethe::Buffer::copy_of(forged))),
+                     goethe::CompressionError);
+    }
+}
+
+TEST_F(CompressionManagerTest, EnvelopeBuffersShareStoredBytes) {
+    manager.initialize("null");
+    goethe::BufferSlice input = goethe::Buffer::copy_of(
+        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(test_data.data()), test_data.size()));
+    auto packed = manager.compress_envelope(input, true);
+    auto header = goethe::read_envelope_header(packed.span());
+    ASSERT_TRUE(header);
+
+    auto unpacked = manager.decompress_envelope(packed);
+    EXPECT_EQ(unpacked.view(), test_data);
+    EXPECT_EQ(unpacked.data(), packed.data() + header->size);
+}
+
+#ifdef GOETHE_ZSTD_AVAILABLE
+TEST_F(CompressionManagerTest, EnvelopeReadsAcrossBackendSwitches) {
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += test_data;
+    }
+    const std::vector<uint8_t> original(text.begin(), text.end());
+
+    manager.initialize("zstd");
+    auto zstd_packed = manager.compress_envelope(original.data(), original.size(), true);
+    EXPECT_LT(zstd_packed.size(), original.size());
+    goethe::BufferSlice zstd_slice = goethe::Buffer::copy_of(zstd_packed);
+
+    manager.switch_backend("null");
+    auto null_packed = manager.compress_envelope(original.data(), original.size());
+    EXPECT_EQ(manager.decompress_envelope(zstd_packed.data(), zstd_packed.size()), original);
+    EXPECT_EQ(manager.decompress_envelope(zstd_slice).view(), text);
+
+    manager.switch_backend("zstd");
+    EXPECT_EQ(manager.decompress_envelope(null_packed.data(), null_packed.size()), original);
+
+    // The declared size must agree with the frame's own
+    auto header = goethe::read_envelope_header(zstd_packed);
+    ASSERT_TRUE(header);
+    header->original_size = std::uint64_t{1} << 40;
+    std::vector<uint8_t> forged(goethe::kMaxEnvelopeHeader);
+    forged.resize(goethe::write_envelope_header(*header, forged.data()));
+    forged.insert(forged.end(), zstd_packed.begin() + static_cast<std::ptrdiff_t>(header->size), zstd_packed.end());
+    EXPECT_THROW(manager.decompress_envelope(forged.data(), forged.size()), goethe::CompressionError);
+}
+#endif
+
+// Compressibility tests
+static std::vector<uint8_t> random_bytes(std::size_t size, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (auto& byte : bytes) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+static std::vector<uint8_t> dialogue_text(std::size_t lines) {
+    std::string text;
+    for (std::size_t i = 0; i < lines; ++i) {
+        text += "- id: node_" + std::to_string(i) + "\n  speaker: marshal\n  line: { text: \"Line " +
+                std::to_string(i * 37 % 1000) + " of the chapter\" }\n";
+    }
+    return {text.begin(), text.end()};
+}
+
+TEST(CompressibilityTest, TellsTextFromNoise) {
+    const auto noise = goethe::estimate_compressibility(random_bytes(64 * 1024, 1));
+    EXPECT_FALSE(noise.compressible);
+    EXPECT_EQ(noise.sampled, 8192u);
+    EXPECT_GT(noise.entropy, 7.9);
+    EXPECT_LT(noise.match_ratio, 0.001);
+
+    // Small random inputs look less random; the correction keeps them out
+    const auto small_noise = goethe::estimate_compressibility(random_bytes(1500, 2));
+    EXPECT_FALSE(small_noise.compressible);
+    EXPECT_EQ(small_noise.sampled, 1500u);
+
+    const auto text = goethe::estimate_compressibility(dialogue_text(1000));
+    EXPECT_TRUE(text.compressible);
+    EXPECT_LT(text.entropy, 6.0);
+    EXPECT_GT(text.match_ratio, 0.5);
+}
+
+TEST(CompressibilityTest, RepeatsCountEvenAtHighEntropy) {
+    // Random bytes, but the same 2 KiB over and over
+    const auto block = random_bytes(2048, 3);
+    std::vector<uint8_t> repeated;
+    for (int i = 0; i < 32; ++i) {
+        repeated.insert(repeated.end(), block.begin(), block.end());
+    }
+    const auto estimate = goethe::estimate_compressibility(repeated);
+    EXPECT_GT(estimate.entropy, 7.5);
+    EXPECT_GT(estimate.match_ratio, 0.5);
+    EXPECT_TRUE(estimate.compressible);
+}
+
+TEST(CompressibilityTest, SmallInputsAreNotSampled) {
+    const auto estimate = goethe::estimate_compressibility(random_bytes(goethe::kMinEstimateSize - 1, 4));
+    EXPECT_TRUE(estimate.compressible);
+    EXPECT_EQ(estimate.sampled, 0u);
+    EXPECT_TRUE(goethe::estimate_compressibility({}).compressible);
+}
+
+TEST_F(CompressionContextTest, NullBackendNeverEstimates) {
+    goethe::CompressionContext context("null");
+    const auto noise = random_bytes(16 * 1024, 5);
+    const auto before = context.get_statistics().skipped_compressions.load();
+    auto packed = context.compress_envelope(noise.data(), noise.size());
+    EXPECT_EQ(goethe::read_envelope_header(packed)->backend, goethe::kRawBackendId);
+    EXPECT_EQ(context.get_statistics().skipped_compressions.load(), before);
+}
+
+#ifdef GOETHE_ZSTD_AVAILABLE
+TEST_F(CompressionContextTest, IncompressibleInputIsStoredRaw) {
+    goethe::CompressionContext context("zstd");
+    context.enable_statistics(true);
+    const auto zstd_id = *goethe::CompressionFactory::instance().get_backend_id("zstd");
+
+    // Compressing something first gives the context a cost per byte
+    const auto text = dialogue_text(500);
+    auto text_packed = context.compress_envelope(text.data(), text.size());
+    EXPECT_EQ(goethe::read_envelope_header(text_packed)->backend, zstd_id);
+    EXPECT_LT(text_packed.size(), text.size());
+
+    const auto before = context.get_statistics();
+    const auto noise = random_bytes(64 * 1024, 6);
+    auto packed = context.compress_envelope(noise.data(), noise.size(), true);
+    auto header = goethe::read_envelope_header(packed);
+    ASSERT_TRUE(header);
+    EXPECT_EQ(header->backend, goethe::kRawBackendId);
+    EXPECT_EQ(packed.size(), header->size + noise.size());
+    EXPECT_EQ(context.decompress_envelope(packed.data(), packed.size()), noise);
+
+    const auto after = context.get_statistics();
+    EXPECT_EQ(after.skipped_compressions.load() - before.skipped_compressions.load(), 1u);
+    EXPECT_EQ(after.skipped_input_size.load() - before.skipped_input_size.load(), noise.size());
+    EXPECT_GT(after.saved_compression_time_ns.load(), before.saved_compression_time_ns.load());
+
+    goethe::BufferSlice slice = goethe::Buffer::copy_of(noise);
+    EXPECT_EQ(goethe::read_envelope_header(context.compress_envelope(slice).span())->backend, goethe::kRawBackendId);
+
+    context.set_skip_incompressible(false);
+    EXPECT_FALSE(context.get_skip_incompressible());
+    packed = context.compress_envelope(noise.data(), noise.size());
+    EXPECT_EQ(goethe::read_envelope_header(packed)->backend, zstd_id);
+    EXPECT_EQ(context.decompress_envelope(packed.data(), packed.size()), noise);
+}
+
+TEST_F(CompressionContextTest, SkipsBeforeAnyCompressionSaveNothing) {
+    goethe::CompressionContext context("zstd");
+    const auto noise = random_bytes(64 * 1024, 7);
+
+    // No envelope written yet, so there is no cost to price the skip at
+    const auto before = context.get_statistics();
+    auto packed = context.compress_envelope(noise.data(), noise.size());
+    EXPECT_EQ(goethe::read_envelope_header(packed)->backend, goethe::kRawBackendId);
+    auto after = context.get_statistics();
+    EXPECT_EQ(after.skipped_compressions.load() - before.skipped_compressions.load(), 1u);
+    EXPECT_EQ(after.saved_compression_time_ns.load(), before.saved_compression_time_ns.load());
+
+    const auto text = dialogue_text(500);
+    context.compress_envelope(text.data(), text.size());
+    context.compress_envelope(noise.data(), noise.size());
+    EXPECT_GT(context.get_statistics().saved_compression_time_ns.load(), after.saved_compression_time_ns.load());
+}
+#endif
+
 // Convenience function tests
 TEST_F(CompressionTest, ConvenienceFunctions) {
     std::vector<uint8_t> original_data(test_data.begin(), test_data.end());
@@ -155,6 +796,13 @@ TEST_F(CompressionTest, ConvenienceFunctions) {
     
     auto decompressed = goethe::decompress_data(compressed.data(), compressed.size(), "null");
     EXPECT_EQ(decompressed, original_data);
+    
+    // Raw payloads that happen to start like an envelope stay raw
+    std::vector<uint8_t> lookalike(goethe::kEnvelopeMagic.begin(), goethe::kEnvelopeMagic.end());
+    lookalike.insert(lookalike.end(), {1, 0, 0, 0x7F});
+    lookalike.insert(lookalike.end(), original_data.begin(), original_data.end());
+    compressed = goethe::compress_data(lookalike.data(), lookalike.size(), "null");
+    EXPECT_EQ(goethe::decompress_data(compressed.data(), compressed.size(), "null"), lookalike);
 }
 
 // Error handling tests
@@ -230,6 +878,52 @@ TEST_F(CompressionTest, ZstdBackendPerformance) {
     EXPECT_LT(compress_time.count(), 1000000); // Should complete in less than 1 second
     EXPECT_LT(decompress_time.count(), 1000000); // Should complete in less than 1 second
 }
+
+TEST_F(CompressionTest, ZstdAppliesDictionaryOptions) {
+    // Small, similar records: the case dictionaries exist for
+    std::vector<std::vector<uint8_t>> samples;
+    for (int i = 0; i < 200; ++i) {
+        std::string record = "id: dlg_" + std::to_string(i) + "\nspeaker: marshal\nline:\n  text: dlg_chapter1.node_" +
+                             std::to_string(i * 7) + ".text\n  portrait: { id: marshal, mood: neutral }\n";
+        samples.emplace_back(record.begin(), record.end());
+    }
+    auto dictionary = goethe::ZstdCompressionBackend::train_dictionary(samples, 2048);
+    ASSERT_FALSE(dictionary.empty());
+
+    auto backend = goethe::CompressionFactory::instance().create_backend("zstd");
+    const auto& sample = samples.back();
+    auto plain = backend->compress(sample.data(), sample.size());
+
+    goethe::CompressionOptions options;
+    options.dictionary_mode = true;
+    options.dictionary = dictionary;
+    backend->set_options(options);
+    auto with_dictionary = backend->compress(sample.data(), sample.size());
+    EXPECT_LT(with_dictionary.size(), plain.size());
+    EXPECT_EQ(backend->decompress(with_dictionary.data(), with_dictionary.size()), sample);
+
+    // Switching the dictionary off again restores plain frames
+    backend->set_options(goethe::CompressionOptions{});
+    EXPECT_EQ(backend->compress(sample.data(), sample.size()), plain);
+}
+
+TEST_F(CompressionTest, ZstdReportsContextMemory) {
+    auto& stats_manager = goethe::StatisticsManager::instance();
+    const auto before = stats_manager.get_memory_usage(goethe::MemoryCategory::COMPRESSION_CONTEXT);
+    {
+        // Contexts are created on first use, not by the factory
+        auto backend = goethe::CompressionFactory::instance().create_backend("zstd");
+        EXPECT_EQ(stats_manager.get_memory_usage(goethe::MemoryCategory::COMPRESSION_CONTEXT), before);
+
+        std::vector<uint8_t> data(64 * 1024, 'a');
+        auto compressed = backend->compress(data);
+        const auto compressing = stats_manager.get_memory_usage(goethe::MemoryCategory::COMPRESSION_CONTEXT);
+        EXPECT_GT(compressing, before);
+        backend->decompress(compressed);
+        EXPECT_GT(stats_manager.get_memory_usage(goethe::MemoryCategory::COMPRESSION_CONTEXT), compressing);
+    }
+    EXPECT_EQ(stats_manager.get_memory_usage(goethe::MemoryCategory::COMPRESSION_CONTEXT), before);
+}
 #endif
 
 int main(int argc, char **argv) {
@@ -0,0 +1,69 @@
+#include "goethe/cpu_dispatch.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+
+namespace {
+
+int scalar_kernel() {
+    return 0;
+}
+int avx2_kernel() {
+    return 2;
+}
+
+constexpr goethe::CpuTier kTiers[] = {goethe::CpuTier::SCALAR, goethe::CpuTier::SSE42, goethe::CpuTier::AVX2,
+                                      goethe::CpuTier::AVX512};
+
+} // namespace
+
+TEST(CpuDispatchTest, DetectionMatchesCpu) {
+    const auto detected = goethe::detected_cpu_tier();
+#if defined(__x86_64__) || defined(__i386__)
+    EXPECT_EQ(detected >= goethe::CpuTier::AVX2, static_cast<bool>(__builtin_cpu_supports("avx2")));
+    EXPECT_EQ(detected == goethe::CpuTier::AVX512, __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"));
+    if (detected >= goethe::CpuTier::SSE42) {
+        EXPECT_TRUE(__builtin_cpu_supports("sse4.2"));
+    }
+#else
+    EXPECT_EQ(detected, goethe::CpuTier::SCALAR);
+#endif
+    EXPECT_EQ(goethe::active_cpu_tier(), detected);
+}
+
+TEST(CpuDispatchTest, LimitCapsActiveTier) {
+    const auto detected = goethe::detected_cpu_tier();
+    for (auto tier : kTiers) {
+        goethe::ScopedCpuTierLimit limit(tier);
+        EXPECT_EQ(goethe::active_cpu_tier(), std::min(tier, detected)) << goethe::to_string(tier);
+        {
+            goethe::ScopedCpuTierLimit inner(goethe::CpuTier::SCALAR);
+            EXPECT_EQ(goethe::active_cpu_tier(), goethe::CpuTier::SCALAR);
+        }
+        EXPECT_EQ(goethe::active_cpu_tier(), std::min(tier, detected));
+    }
+    EXPECT_EQ(goethe::active_cpu_tier(), detected);
+}
+
+TEST(CpuDispatchTest, MissingTiersUseTheTierBelow) {
+    const goethe::CpuDispatch<int()> kernel({scalar_kernel, nullptr, avx2_kernel, nullptr});
+    const auto detected = goethe::detected_cpu_tier();
+    for (auto tier : kTiers) {
+        goethe::ScopedCpuTierLimit limit(tier);
+        const bool wide = std::min(tier, detected) >= goethe::CpuTier::AVX2;
+        EXPECT_EQ(kernel.get()(), wide ? 2 : 0) << goethe::to_string(tier);
+        EXPECT_EQ(kernel.tier(), wide ? goethe::CpuTier::AVX2 : goethe::CpuTier::SCALAR);
+    }
+}
+
+TEST(CpuDispatchTest, TierNames) {
+    EXPECT_EQ(std::string(goethe::to_string(goethe::CpuTier::SCALAR)), "scalar");
+    EXPECT_EQ(std::string(goethe::to_string(goethe::CpuTier::SSE42)), "sse4.2");
+    EXPECT_EQ(std::string(goethe::to_string(goethe::CpuTier::AVX2)), "avx2");
+    EXPECT_EQ(std::string(goethe::to_string(goethe::CpuTier::AVX512)), "avx512");
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
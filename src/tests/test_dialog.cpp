@@ -1,7 +1,12 @@
 #include "goethe/dialog.hpp"
+#include "goethe/yaml_subset.hpp"
+#include "corpus_generator.hpp"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <fstream>
+#include <limits>
+#include <optional>
+#include <random>
 #include <sstream>
 
 class DialogTest : public ::testing::Test {
@@ -296,6 +301,471 @@ nodes:
     EXPECT_EQ(node.choices.size(), 1);
 }
 
+// Memory estimation tests
+TEST_F(GoetheFormatTest, MemoryEstimateGrowsWithContent) {
+    std::istringstream stream(goethe_yaml);
+    goethe::Dialogue dialogue = goethe::read_dialogue(stream);
+    
+    std::size_t base = goethe::estimate_memory_usage(dialogue);
+    EXPECT_GT(base, sizeof(goethe::Dialogue) + dialogue.nodes.size() * sizeof(goethe::Node));
+    
+    // A long string adds at least its own length
+    dialogue.metadata["notes"] = std::string(4096, 'x');
+    EXPECT_GE(goethe::estimate_memory_usage(dialogue), base + 4096);
+    
+    goethe::Dialogue empty;
+    EXPECT_EQ(goethe::estimate_memory_usage(empty), sizeof(goethe::Dialogue));
+}
+
+// Streaming writer tests: write_dialogue must match the YAML::Node path byte for byte
+static std::string write_with_node_tree(const goethe::Dialogue& dialogue) {
+    std::ostringstream stream;
+    stream << goethe::to_yaml(dialogue);
+    return stream.str();
+}
+
+static std::string write_streaming(const goethe::Dialogue& dialogue) {
+    std::ostringstream stream;
+    goethe::write_dialogue(stream, dialogue);
+    return stream.str();
+}
+
+TEST_F(GoetheFormatTest, StreamingWriterMatchesNodeTree) {
+    std::istringstream stream(goethe_yaml);
+    goethe::Dialogue dialogue = goethe::read_dialogue(stream);
+    EXPECT_EQ(write_streaming(dialogue), write_with_node_tree(dialogue));
+}
+
+TEST_F(DialogTest, StreamingWriterMatchesNodeTreeOnCorpus) {
+    goethe::corpus::CorpusOptions options;
+    options.node_count = 48;
+    options.condition_depth = 3;
+    for (std::uint64_t seed = 1; seed <= 20; ++seed) {
+        options.seed = seed;
+        options.text_style = static_cast<goethe::corpus::TextStyle>(seed % 3);
+        auto dialogue = goethe::corpus::generate_dialogue(options, "corpus_" + std::to_string(seed));
+        std::string streamed = write_streaming(dialogue);
+        ASSERT_EQ(streamed, write_with_node_tree(dialogue)) << "seed " << seed;
+        EXPECT_EQ(streamed, write_streaming(dialogue)); // Deterministic
+    }
+}
+
+TEST_F(DialogTest, StreamingWriterMatchesNodeTreeOnEdgeCases) {
+    goethe::Dialogue dialogue;
+    dialogue.id = "edge: cases";
+    dialogue.metadata["title"] = "Quotes \"and\" 'apostrophes'";
+    dialogue.metadata["multiline"] = "first\nsecond";
+    dialogue.localVars["yes"] = "true";
+    dialogue.localVars["empty"] = "";
+
+    goethe::Node node;
+    node.id = "- dash";
+    node.tags = {"#hash", "null", "~", "123"};
+    goethe::Line variant;
+    variant.text = "  leading spaces";
+    variant.weight = 0.1f;
+    variant.voice = goethe::Voice{"clip", false, 250};
+    variant.sfx = {"a", "b"};
+    variant.params["name"] = "{player}";
+    goethe::Condition var_condition{goethe::Condition::Type::VAR, "gold", 2.5f, {}};
+    goethe::Condition not_condition{goethe::Condition::Type::NOT, "", std::string(), {var_condition}};
+    goethe::Condition empty_all{goethe::Condition::Type::ALL, "", std::string(), {}};
+    goethe::Condition unsupported{goethe::Condition::Type::EVENT, "ignored", std::string(), {}};
+    variant.conditions = goethe::Condition{goethe::Condition::Type::ANY, "", std::string(),
+                                           {not_condition, empty_all, unsupported}};
+    node.lines = {variant, variant};
+    node.lines[1].weight = std::numeric_limits<float>::infinity();
+
+    goethe::Choice choice;
+    choice.id = "c";
+    choice.text = "yes";
+    choice.to = "$END";
+    choice.once = true;
+    choice.cooldownMs = 5;
+    choice.disabledText = "";
+    choice.effects.push_back({goethe::Effect::Type::SET_VAR, "flagged", true, {}});
+    choice.effects.push_back({goethe::Effect::Type::SET_VAR, "count", -3, {}});
+    choice.effects.push_back({goethe::Effect::Type::NOTIFY, "Title", std::string("Body: text"), {}});
+    choice.effects.push_back({goethe::Effect::Type::TELEPORT, "unsupported", std::string(), {}});
+    node.choices.push_back(choice);
+    node.onExitEffects.push_back({goethe::Effect::Type::QUEST_ADD, "quest", std::string(), {}});
+    node.autoAdvanceMs = 0;
+    node.interruptible = false;
+    dialogue.nodes.push_back(node);
+
+    EXPECT_EQ(write_streaming(dialogue), write_with_node_tree(dialogue));
+
+    goethe::Dialogue no_nodes;
+    no_nodes.id = "empty";
+    EXPECT_EQ(write_streaming(no_nodes), write_with_node_tree(no_nodes));
+}
+
+static std::string read_json_rewritten(const std::string& json) {
+    return write_streaming(goethe::read_dialogue_json(json));
+}
+
+static std::string read_yaml_rewritten(const std::string& yaml) {
+    std::istringstream stream(yaml);
+    return write_streaming(goethe::read_dialogue(stream));
+}
+
+TEST_F(GoetheFormatTest, JsonMatchesYamlOnFixture) {
+    std::string goethe_json = R"({
+  "kind": "dialogue", "id": "test_goethe", "startNode": "intro",
+  "nodes": [
+    {"id": "intro", "speaker": "marshal",
+     "line": {"text": "dlg_test.intro.text", "portrait": {"id": "marshal", "mood": "neutral"},
+              "voice": {"clipId": "vo_test_intro"}},
+     "choices": [
+       {"id": "accept", "text": "dlg_test.intro.choice.accept", "to": "agree",
+        "effects": [{"type": "SET_FLAG", "target": "test_accepted", "value": true}]},
+       {"id": "refuse", "text": "dlg_test.intro.choice.refuse", "to": "farewell"}]},
+    {"id": "agree", "line": {"text": "dlg_test.agree.text"}, "autoAdvanceMs": 1000,
+     "choices": [{"id": "continue", "text": "dlg_common.continue", "to": "$END"}]},
+    {"id": "farewell", "line": {"text": "dlg_test.farewell.text"},
+     "choices": [{"id": "close", "text": "dlg_common.close", "to": "$END"}]}
+  ]
+})";
+
+    auto dialogue = goethe::read_dialogue_json(goethe_json);
+    EXPECT_EQ(dialogue.id, "test_goethe");
+    ASSERT_EQ(dialogue.nodes.size(), 3);
+    const auto& effect = dialogue.nodes[0].choices[0].effects.at(0);
+    EXPECT_EQ(effect.type, goethe::Effect::Type::SET_FLAG);
+    EXPECT_EQ(std::get<bool>(effect.value), true);
+    EXPECT_EQ(dialogue.nodes[1].autoAdvanceMs, 1000);
+
+    EXPECT_EQ(write_streaming(dialogue), read_yaml_rewritten(goethe_yaml));
+}
+
+TEST_F(DialogTest, JsonMatchesYamlOnCorpus) {
+    goethe::corpus::CorpusOptions options;
+    options.node_count = 48;
+    options.condition_depth = 3;
+    for (std::uint64_t seed = 1; seed <= 20; ++seed) {
+        options.seed = seed;
+        options.text_style = static_cast<goethe::corpus::TextStyle>(seed % 3);
+        std::string id = "corpus_" + std::to_string(seed);
+        std::string json = goethe::corpus::generate_dialogue_json(options, id);
+        std::string expected = read_yaml_rewritten(goethe::corpus::generate_dialogue_yaml(options, id));
+
+        ASSERT_EQ(read_json_rewritten(json), expected) << "seed " << seed;
+        std::istringstream stream(json);
+        EXPECT_EQ(write_streaming(goethe::read_dialogue_json(stream)), expected) << "seed " << seed;
+    }
+}
+
+TEST_F(DialogTest, JsonScalarsConvertLikeYaml) {
+    // Untyped fields, legacy effect formats, escapes and unknown keys
+    std::string json = R"({"id": 7, "extra": {"nested": [1, {"deep": null}]},
+  "metadata": {"version": 2, "draft": false, "title": "Café \"quoted\""},
+  "nodes": [{"id": "n", "speaker": null, "tags": [1, true, "x"],
+    "line": {"text": 42, "weight": "0.5", "voice": {"clipId": "v", "subtitles": "no", "startMs": "250"}},
+    "lines": [{"text": "ignored"}],
+    "autoAdvance": {"ms": 1500},
+    "interruptible": "false",
+    "onEnter": {"effects": [
+      {"setVar": {"name": "gold", "value": 10}},
+      {"quest.add": "q1", "setFlag": "wins"},
+      {"notify": {"title": "T", "body": "B"}},
+      {"type": "SET_VAR", "target": "ratio", "value": 2.5, "setFlag": "loses"},
+      {"type": "SET_VAR", "target": "count", "value": "12"},
+      {"type": "NOTIFY", "target": "t", "value": "hello", "params": {"n": 1}}]},
+    "choices": [{"id": 1, "text": "go", "to": "$END", "once": true, "cooldownMs": 3000,
+      "conditions": {"var": {"name": "gold", "value": 10}, "all": [{"flag": "a"}, {"not": {"flag": "b"}}]}}]}],
+  "localVars": {"count": 3}})";
+
+    std::string yaml = R"(
+id: 7
+extra: {nested: [1, {deep: null}]}
+metadata: {version: 2, draft: false, title: "Café \"quoted\""}
+nodes:
+  - id: n
+    speaker: null
+    tags: [1, true, x]
+    line: {text: 42, weight: "0.5", voice: {clipId: v, subtitles: "no", startMs: "250"}}
+    lines: [{text: ignored}]
+    autoAdvance: {ms: 1500}
+    interruptible: "false"
+    onEnter:
+      effects:
+        - setVar: {name: gold, value: 10}
+        - {quest.add: q1, setFlag: wins}
+        - notify: {title: T, body: B}
+        - {type: SET_VAR, target: ratio, value: 2.5, setFlag: loses}
+        - {type: SET_VAR, target: count, value: "12"}
+        - {type: NOTIFY, target: t, value: hello, params: {n: 1}}
+    choices:
+      - id: 1
+        text: go
+        to: $END
+        once: true
+        cooldownMs: 3000
+        conditions: {var: {name: gold, value: 10}, all: [{flag: a}, {not: {flag: b}}]}
+localVars: {count: 3}
+)";
+
+    auto dialogue = goethe::read_dialogue_json(json);
+    EXPECT_EQ(dialogue.id, "7");
+    EXPECT_EQ(dialogue.metadata["title"], "Caf\xC3\xA9 \"quoted\"");
+    const auto& node = dialogue.nodes.at(0);
+    EXPECT_EQ(node.speaker, "null");
+    EXPECT_EQ(node.tags, (std::vector<std::string>{"1", "true", "x"}));
+    EXPECT_TRUE(node.lines.empty());
+    EXPECT_FLOAT_EQ(node.line->weight, 0.5f);
+    EXPECT_FALSE(node.line->voice->subtitles);
+    EXPECT_EQ(node.autoAdvanceMs, 1500);
+    EXPECT_FALSE(node.interruptible);
+    ASSERT_EQ(node.onEnterEffects.size(), 6);
+    EXPECT_EQ(node.onEnterEffects[1].type, goethe::Effect::Type::SET_FLAG);
+    EXPECT_EQ(std::get<float>(node.onEnterEffects[3].value), 2.5f);
+    EXPECT_EQ(std::get<int>(node.onEnterEffects[4].value), 12);
+    EXPECT_EQ(node.choices.at(0).conditions->type, goethe::Condition::Type::ALL);
+
+    EXPECT_EQ(write_streaming(dialogue), read_yaml_rewritten(yaml));
+}
+
+TEST_F(DialogTest, ReadDialogueDetectsJson) {
+    std::string json = goethe::corpus::generate_dialogue_json(goethe::corpus::CorpusOptions{}, "detected");
+    std::istringstream stream("\n  \t" + json);
+    auto dialogue = goethe::read_dialogue(stream);
+    EXPECT_EQ(dialogue.id, "detected");
+    EXPECT_EQ(write_streaming(dialogue), read_json_rewritten(json));
+}
+
+TEST_F(DialogTest, FlowYamlFallsBackToYamlParser) {
+    std::istringstream stream("{id: flow, nodes: [{id: a, line: {text: hi}}]}  # comment\n");
+    auto dialogue = goethe::read_dialogue(stream);
+    EXPECT_EQ(dialogue.id, "flow");
+    ASSERT_EQ(dialogue.nodes.size(), 1);
+    EXPECT_EQ(dialogue.nodes[0].line->text, "hi");
+}
+
+TEST_F(DialogTest, InvalidJsonThrowsException) {
+    EXPECT_THROW(goethe::read_dialogue_json(R"({"id": "x", "nodes": [)"), std::runtime_error);
+    EXPECT_THROW(goethe::read_dialogue_json(R"({"id": "x", "nodes": []} {})"), std::runtime_error);
+    EXPECT_THROW(goethe::read_dialogue_json(R"([1, 2])"), std::runtime_error);
+    EXPECT_THROW(goethe::read_dialogue_json(R"({"id": "x", "nodes": [{"line": {"text": "t"}}]})"),
+                 std::runtime_error);
+
+    try {
+        goethe::read_dialogue_json(R"({"nodes": []})");
+        FAIL() << "missing id accepted";
+    } catch (const std::runtime_error& e) {
+        EXPECT_THAT(e.what(), ::testing::HasSubstr("'id'"));
+    }
+    try {
+        goethe::read_dialogue_json(R"({"id": "x"})");
+        FAIL() << "missing nodes accepted";
+    } catch (const std::runtime_error& e) {
+        EXPECT_THAT(e.what(), ::testing::HasSubstr("'nodes'"));
+    }
+}
+
+// GOETHE YAML subset reader: it must either decline a document or read it
+// exactly as yaml-cpp does
+static std::optional<std::string> read_with_yaml_cpp(const std::string& yaml) {
+    try {
+        YAML::Node node = YAML::Load(yaml);
+        if (!node.IsMap()) {
+            return std::nullopt;
+        }
+        goethe::Dialogue dialogue;
+        goethe::from_yaml(node, dialogue);
+        return write_streaming(dialogue);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+static void expect_subset_reads(const std::string& yaml) {
+    auto expected = read_with_yaml_cpp(yaml);
+    ASSERT_TRUE(expected) << yaml;
+    auto dialogue = goethe::read_dialogue_subset(yaml);
+    ASSERT_TRUE(dialogue) << "declined:\n" << yaml;
+    EXPECT_EQ(write_streaming(*dialogue), *expected) << yaml;
+}
+
+static void expect_subset_agrees(const std::string& yaml) {
+    if (auto dialogue = goethe::read_dialogue_subset(yaml)) {
+        auto expected = read_with_yaml_cpp(yaml);
+        ASSERT_TRUE(expected) << "yaml-cpp rejects what the subset read:\n" << yaml;
+        EXPECT_EQ(write_streaming(*dialogue), *expected) << yaml;
+    }
+}
+
+TEST(YamlScanTest, EveryTierMatchesScalar) {
+    std::pmr::vector<std::uint32_t> positions;
+    {
+        goethe::ScopedCpuTierLimit limit(goethe::CpuTier::SCALAR);
+        goethe::index_yaml_structure("a: [b, 'c']\t#\r\n{\"d\\\"}", positions);
+    }
+    EXPECT_EQ(positions, (std::pmr::vector<std::uint32_t>{1, 3, 5, 7, 9, 10, 11, 12, 13, 14, 15, 16, 18, 19, 20}));
+
+    const std::string alphabet = "ab -:#,'\"[]{}\\\t\r\n\x7B\xFB\x3A\xBA\x0B";
+    std::mt19937 rng(7);
+    std::pmr::vector<std::uint32_t> simd;
+    for (std::size_t size = 0; size < 300; ++size) {
+        std::string text(size, ' ');
+        for (auto& c : text) {
+            c = alphabet[rng() % alphabet.size()];
+        }
+        {
+            goethe::ScopedCpuTierLimit limit(goethe::CpuTier::SCALAR);
+            goethe::index_yaml_structure(text, positions);
+        }
+        for (auto tier : {goethe::CpuTier::SSE42, goethe::CpuTier::AVX2, goethe::CpuTier::AVX512}) {
+            goethe::ScopedCpuTierLimit limit(tier);
+            goethe::index_yaml_structure(text, simd);
+            ASSERT_EQ(simd, positions) << goethe::to_string(goethe::yaml_scan_tier()) << ", size " << size;
+        }
+    }
+}
+
+TEST_F(DialogTest, SubsetMatchesYamlCppOnCorpus) {
+    goethe::corpus::CorpusOptions options;
+    options.node_count = 48;
+    options.condition_depth = 3;
+    for (std::uint64_t seed = 1; seed <= 20; ++seed) {
+        options.seed = seed;
+        options.text_style = static_cast<goethe::corpus::TextStyle>(seed % 3);
+        expect_subset_reads(goethe::corpus::generate_dialogue_yaml(options, "corpus_" + std::to_string(seed)));
+    }
+}
+
+TEST_F(GoetheFormatTest, SubsetMatchesYamlCppOnFixtures) {
+    expect_subset_reads(goethe_yaml);
+
+    std::istringstream stream(goethe_yaml);
+    expect_subset_reads(write_streaming(goethe::read_dialogue(stream)));
+}
+
+TEST_F(DialogTest, SubsetMatchesYamlCppOnSyntax) {
+    // Comments, document start, byte order mark and CRLF line ends
+    expect_subset_reads("\xEF\xBB\xBF# header\n---  # start\nid: a   # trailing\n\nnodes: []\n");
+    expect_subset_reads("id: a\r\nnodes:\r\n  - id: n\r\n    line: {text: hi}\r\n");
+
+    // Quoting, escapes and plain scalars with indicators inside
+    expect_subset_reads(R"(
+id: "quoted \"id\" é\x41\t\\ \/"
+metadata:
+  'single': 'it''s'
+  plain: It's a "test", isn't it? [not] {flow} a:b #1
+  colon: 'a: b'
+  hash: "# not a comment"
+  empty: ""
+  "": x
+nodes: []
+)");
+
+    // Nulls, booleans and numbers as yaml-cpp converts them
+    expect_subset_reads(R"(
+id: conversions
+nodes:
+  - id: n
+    speaker: ~
+    tags: [null, Null, ~, "null", yes, Off]
+    line:
+      text:
+      weight: -1.5e2
+      voice: {clipId: v, subtitles: No, startMs: -0}
+    interruptible: TRUE
+    onEnter:
+      effects:
+        - {type: SET_VAR, target: a, value: y}
+        - {type: SET_VAR, target: b, value: 2.5}
+        - {type: SET_VAR, target: c, value: 99999999999}
+        - {type: SET_VAR, target: d, value: 3rd}
+        - {type: SET_VAR, target: e, value: .inf}
+        - {type: SET_VAR, target: f, value: -}
+        - {type: SET_VAR, target: g, value: 1.5x}
+localVars:
+  ~: nil
+  blank:
+)");
+
+    // Block layout: sequences at the key's indentation, nested sequences,
+    // values on the next line and flow collections over several lines
+    expect_subset_reads(R"(
+id: layout
+nodes:
+- id: first
+  tags:
+  - a
+  -   b
+  -
+    c
+  line:
+      text:
+        hello
+  choices: [
+    {id: go, text: Go, to: $END},   # comment inside flow
+    {id: stay,
+     text: Stay, to: first, conditions: {all: [{flag: x}, {not: {flag: y}}]}}
+  ]
+-   id: second
+    lines:
+      - text: nested
+      - text: variant
+        weight: 2
+)");
+
+    expect_subset_reads(R"({id: flow, nodes: [{id: a, line: {text: hi, sfx: [], params: {}}}]}  # comment)");
+    expect_subset_reads(R"(
+id: flow
+nodes: [{id: a, line: {text: hi, portrait: {id: p, mood: }}}]
+)");
+}
+
+TEST_F(DialogTest, SubsetDeclinesOutsideSubset) {
+    const std::vector<std::string> documents = {
+        "id: a\nnodes: &n []\nmetadata: {copy: *n}\n",        // Anchors and aliases
+        "id: !tag a\nnodes: []\n",                           // Tags
+        "id: |\n  block\nnodes: []\n",                       // Block scalars
+        "id: two\n  lines\nnodes: []\n",                     // Multi-line plain scalars
+        "id: \"two\n  lines\"\nnodes: []\n",                 // Multi-line quoted scalars
+        "id: a\nnodes: []\n---\nid: b\n",                    // Several documents
+        "id: a\nnodes:\n\t- id: n\n",                        // Tabs
+        "? id\n: a\nnodes: []\n",                            // Complex keys
+        "id: a\nnodes:\n  - id: n\n    autoAdvanceMs: 0x10\n", // Numbers in other bases
+        "id: a\nnodes:\n  - id: n\n    autoAdvanceMs: 010\n",
+        "nodes: []\n",                                       // Errors are yaml-cpp's to report
+        "id: a\n",
+        "id: a\nnodes: [\n",
+        "id: a: b\nnodes: []\n",
+        "id: a\nnodes:\n  - id: n\n    line: {text: t, weight: heavy}\n",
+        "- id: a\n",
+        "",
+    };
+    for (const auto& yaml : documents) {
+        EXPECT_FALSE(goethe::read_dialogue_subset(yaml)) << yaml;
+
+        std::istringstream stream(yaml);
+        auto expected = read_with_yaml_cpp(yaml);
+        if (expected) {
+            EXPECT_EQ(write_streaming(goethe::read_dialogue(stream)), *expected) << yaml;
+        } else {
+            EXPECT_THROW(goethe::read_dialogue(stream), std::runtime_error) << yaml;
+        }
+    }
+}
+
+TEST_F(GoetheFormatTest, SubsetNeverDisagreesWithYamlCpp) {
+    // Every truncation of the fixture, then random structural edits
+    for (std::size_t size = 0; size <= goethe_yaml.size(); ++size) {
+        expect_subset_agrees(goethe_yaml.substr(0, size));
+    }
+    const std::string replacements = " -:#,'\"[]{}\\\n\tx~";
+    std::mt19937 rng(11);
+    for (int round = 0; round < 2000; ++round) {
+        std::string yaml = goethe_yaml;
+        for (int edits = 1 + static_cast<int>(rng() % 3); edits > 0; --edits) {
+            yaml[rng() % yaml.size()] = replacements[rng() % replacements.size()];
+        }
+        expect_subset_agrees(yaml);
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
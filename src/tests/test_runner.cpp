@@ -0,0 +1,494 @@
+#include "goethe/runner.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* kDialogueYaml = R"(
+id: tavern
+startNode: greet
+nodes:
+  - id: greet
+    line:
+      text: Welcome, traveller.
+    onEnter:
+      effects:
+        - type: SET_FLAG
+          target: met_keeper
+          value: true
+    choices:
+      - id: ask_room
+        text: A room, please.
+        to: room
+        effects:
+          - type: SET_VAR
+            target: lodging
+            value: tavern
+      - id: ask_secret
+        text: Heard any rumours?
+        to: secret
+        conditions:
+          flag: trusted
+        disabledText: You are not trusted yet.
+      - id: leave
+        text: Goodbye.
+        to: $END
+  - id: room
+    line:
+      text: Upstairs, second door.
+    autoAdvanceMs: 500
+  - id: farewell
+    line:
+      text: Sleep well.
+  - id: secret
+    line:
+      text: The mayor is not who he seems.
+)";
+
+goethe::Dialogue load_dialogue() {
+    std::istringstream input(kDialogueYaml);
+    return goethe::read_dialogue(input);
+}
+
+// Records presented nodes and refuses the first `refusals` of them
+class RecordingPort : public goethe::IDialoguePort {
+public:
+    int refusals = 0;
+    std::vector<std::string> presented;
+    std::vector<std::vector<NodePayload>> payloads;
+
+    Capabilities getCapabilities() override {
+        Capabilities capabilities;
+        capabilities.supportsDisabledChoices = true;
+        return capabilities;
+    }
+
+    bool presentNode(const std::string&, const std::string& nodeId,
+                     const std::vector<NodePayload>& payload) override {
+        if (refusals > 0) {
+            --refusals;
+            return false;
+        }
+        presented.push_back(nodeId);
+        payloads.push_back(payload);
+        return true;
+    }
+};
+
+goethe::DialogueScript take_room(goethe::DialogueRunner& runner, std::vector<std::string>& seen) {
+    auto step = co_await runner.next();
+    seen.push_back(step.node->id);
+    step = co_await runner.choose("ask_room");
+    seen.push_back(step.node->id);
+    while (step.state != goethe::DialogueState::COMPLETED) {
+        step = co_await runner.next();
+        seen.push_back(step.node ? step.node->id : "$END");
+    }
+}
+
+goethe::DialogueScript choose_missing(goethe::DialogueRunner& runner) {
+    co_await runner.next();
+    co_await runner.choose("no_such_choice");
+}
+
+} // anonymous namespace
+
+TEST(WorldStateTest, EvaluatesFlagsAndVars) {
+    goethe::WorldState world;
+    goethe::Condition flag{goethe::Condition::Type::FLAG, "door_open", std::string{}, {}};
+    goethe::Condition var{goethe::Condition::Type::VAR, "mood", std::string("happy"), {}};
+    goethe::Condition both{goethe::Condition::Type::ALL, "", std::string{}, {flag, var}};
+    goethe::Condition neither{goethe::Condition::Type::NOT, "", std::string{},
+                              {goethe::Condition{goethe::Condition::Type::ANY, "", std::string{}, {flag, var}}}};
+
+    EXPECT_FALSE(goethe::evaluate(both, world));
+    EXPECT_TRUE(goethe::evaluate(neither, world));
+
+    world.set_flag("door_open");
+    world.set_var("mood", "happy");
+    EXPECT_TRUE(goethe::evaluate(both, world));
+    EXPECT_FALSE(goethe::evaluate(neither, world));
+
+    world.set_var("mood", "grumpy");
+    EXPECT_FALSE(goethe::evaluate(var, world));
+    world.set_flag("door_open", false);
+    EXPECT_FALSE(goethe::evaluate(flag, world));
+}
+
+TEST(WorldStateTest, AppliesStateEffectsOnly) {
+    goethe::WorldState world;
+    goethe::Effect set_flag{goethe::Effect::Type::SET_FLAG, "met", std::string{}, {}};
+    goethe::Effect set_var{goethe::Effect::Type::SET_VAR, "gold", 12, {}};
+    goethe::Effect notify{goethe::Effect::Type::NOTIFY, "Quest", std::string("Started"), {}};
+
+    EXPECT_TRUE(goethe::apply(set_flag, world));
+    EXPECT_TRUE(goethe::apply(set_var, world));
+    EXPECT_FALSE(goethe::apply(notify, world));
+    EXPECT_TRUE(world.has_flag("met"));
+    ASSERT_NE(world.get_var("gold"), nullptr);
+    EXPECT_EQ(*world.get_var("gold"), "12");
+}
+
+TEST(WorldStateTest, ListenersMayChangeListenersWhileNotified) {
+    goethe::WorldState world;
+    using Kind = goethe::WorldState::KeyKind;
+    std::vector<std::string> heard;
+
+    // Unsubscribes itself on the first change, capturing enough to notice
+    // if its callback were destroyed while running
+    std::size_t once = 0;
+    const std::string once_name = "once";
+    once = world.add_listener([&, once_name](Kind, const std::string&) {
+        world.remove_listener(once);
+        heard.push_back(once_name);
+    });
+    world.watch(once, Kind::FLAG, "door");
+
+    // Removes the other listeners and subscribes a new one to the same key
+    std::size_t other = 0;
+    std::size_t late = 0;
+    const std::size_t churn = world.add_listener([&](Kind, const std::string&) {
+        heard.push_back("churn");
+        world.remove_listener(other);
+        late = world.add_listener([&](Kind, const std::string&) { heard.push_back("late"); });
+        world.watch(late, Kind::FLAG, "door");
+    });
+    world.watch(churn, Kind::FLAG, "door");
+    other = world.add_listener([&](Kind, const std::string&) { heard.push_back("other"); });
+    world.watch(other, Kind::FLAG, "door");
+
+    world.set_flag("door");
+    // Listener order is unspecified, and other may have run before churn
+    EXPECT_NE(std::find(heard.begin(), heard.end(), "once"), heard.end());
+    EXPECT_NE(std::find(heard.begin(), heard.end(), "churn"), heard.end());
+    EXPECT_EQ(std::find(heard.begin(), heard.end(), "late"), heard.end());
+
+    // once and other are gone; the listener churn added hears this change,
+    // the one it adds now does not
+    heard.clear();
+    world.set_flag("door", false);
+    std::sort(heard.begin(), heard.end());
+    EXPECT_EQ(heard, (std::vector<std::string>{"churn", "late"}));
+}
+
+// Random ALL/ANY/NOT trees over a handful of flags and variables
+static goethe::Condition random_condition(std::mt19937& rng, int depth) {
+    static const char* kNames[] = {"a", "b", "c", "d"};
+    goethe::Condition condition;
+    const int kind = depth == 0 ? 3 + static_cast<int>(rng() % 2) : static_cast<int>(rng() % 5);
+    switch (kind) {
+        case 0:
+        case 1:
+            condition.type = kind == 0 ? goethe::Condition::Type::ALL : goethe::Condition::Type::ANY;
+            for (std::uint32_t i = rng() % 4; i > 0; --i) {
+                condition.children.push_back(random_condition(rng, depth - 1));
+            }
+            break;
+        case 2:
+            condition.type = goethe::Condition::Type::NOT;
+            condition.children.push_back(random_condition(rng, depth - 1));
+            break;
+        case 3:
+            condition.type = goethe::Condition::Type::FLAG;
+            condition.key = kNames[rng() % 4];
+            break;
+        default:
+            condition.type = goethe::Condition::Type::VAR;
+            condition.key = kNames[rng() % 4];
+            condition.value = rng() % 3 == 0 ? std::string{} : std::string(rng() % 2 ? "x" : "y");
+            break;
+    }
+    return condition;
+}
+
+TEST(CompiledConditionTest, MatchesTreeEvaluation) {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 200; ++round) {
+        const auto condition = random_condition(rng, 4);
+        const goethe::CompiledCondition compiled(condition);
+        goethe::WorldState world;
+        for (int change = 0; change < 16; ++change) {
+            const std::string name(1, static_cast<char>('a' + rng() % 4));
+            switch (rng() % 3) {
+                case 0: world.set_flag(name, rng() % 2 == 0); break;
+                case 1: world.set_var(name, rng() % 2 ? "x" : "y"); break;
+                default: world.erase_var(name); break;
+            }
+            ASSERT_EQ(compiled.evaluate(world), goethe::evaluate(condition, world)) << "round " << round;
+        }
+    }
+}
+
+TEST(CompiledConditionTest, RecordsKeysRead) {
+    goethe::Condition condition{goethe::Condition::Type::ANY, "", std::string{},
+        {goethe::Condition{goethe::Condition::Type::FLAG, "door", std::string{}, {}},
+         goethe::Condition{goethe::Condition::Type::VAR, "door", std::string("open"), {}},
+         goethe::Condition{goethe::Condition::Type::FLAG, "door", std::string{}, {}}}};
+    const goethe::CompiledCondition compiled(condition);
+    ASSERT_EQ(compiled.keys().size(), 2u);
+    EXPECT_EQ(compiled.keys()[0].kind, goethe::WorldState::KeyKind::FLAG);
+    EXPECT_EQ(compiled.keys()[1].kind, goethe::WorldState::KeyKind::VAR);
+    EXPECT_EQ(compiled.ops().size(), 4u);
+}
+
+TEST(BatchConditionTest, MatchesPerActorEvaluation) {
+    std::mt19937 rng(11);
+    for (std::size_t actors : {1u, 63u, 64u, 65u, 300u, 1000u}) {
+        goethe::WorldStateBlock block(actors);
+        std::vector<goethe::WorldState> worlds(actors);
+        for (std::size_t actor = 0; actor < actors; ++actor) {
+            for (int change = 0; change < 6; ++change) {
+                const std::string name(1, static_cast<char>('a' + rng() % 4));
+                if (rng() % 2) {
+                    block.set_flag(actor, name);
+                    worlds[actor].set_flag(name);
+                } else {
+                    const std::string value = rng() % 2 ? "x" : "y";
+                    block.set_var(actor, name, value);
+                    worlds[actor].set_var(name, value);
+                }
+            }
+        }
+
+        for (int round = 0; round < 50; ++round) {
+            const auto condition = random_condition(rng, 4);
+            const goethe::CompiledCondition compiled(condition);
+            std::vector<std::uint64_t> scalar;
+            {
+                goethe::ScopedCpuTierLimit limit(goethe::CpuTier::SCALAR);
+                scalar = goethe::evaluate_batch(compiled, block);
+            }
+            ASSERT_EQ(scalar.size(), (actors + 63) / 64);
+            for (auto tier : {goethe::CpuTier::SSE42, goethe::CpuTier::AVX2, goethe::CpuTier::AVX512}) {
+                goethe::ScopedCpuTierLimit limit(tier);
+                EXPECT_EQ(goethe::evaluate_batch(compiled, block), scalar) << goethe::to_string(goethe::batch_tier());
+            }
+            for (std::size_t actor = 0; actor < actors; ++actor) {
+                const bool bit = (scalar[actor / 64] >> (actor % 64) & 1) != 0;
+                ASSERT_EQ(bit, goethe::evaluate(condition, worlds[actor])) << actors << " actors, actor " << actor;
+            }
+            // Padding actors never show up, even under NOT
+            if (actors % 64 != 0) {
+                EXPECT_EQ(scalar.back() >> (actors % 64), 0u);
+            }
+        }
+    }
+}
+
+TEST(BatchConditionTest, BlockStoresValues) {
+    goethe::WorldStateBlock block(10);
+    EXPECT_EQ(block.padded_size(), 256u);
+    block.set_var(3, "mood", "happy");
+    block.set_flag(9, "door");
+    ASSERT_NE(block.get_var(3, "mood"), nullptr);
+    EXPECT_EQ(*block.get_var(3, "mood"), "happy");
+    EXPECT_EQ(block.get_var(4, "mood"), nullptr);
+    EXPECT_TRUE(block.has_flag(9, "door"));
+    block.set_flag(9, "door", false);
+    block.erase_var(3, "mood");
+    EXPECT_FALSE(block.has_flag(9, "door"));
+    EXPECT_EQ(block.get_var(3, "mood"), nullptr);
+}
+
+TEST(BatchConditionTest, BlockRejectsActorsOutOfRange) {
+    goethe::WorldStateBlock block(10);
+    // Padding actors included
+    for (std::size_t actor : {std::size_t{10}, std::size_t{255}, std::size_t{256}}) {
+        EXPECT_THROW(block.set_flag(actor, "door"), std::out_of_range);
+        EXPECT_THROW(block.has_flag(actor, "door"), std::out_of_range);
+        EXPECT_THROW(block.set_var(actor, "mood", "happy"), std::out_of_range);
+        EXPECT_THROW(block.erase_var(actor, "mood"), std::out_of_range);
+        EXPECT_THROW(block.get_var(actor, "mood"), std::out_of_range);
+    }
+    EXPECT_EQ(block.flag_column("door"), nullptr);
+    EXPECT_FALSE(block.value_id("happy"));
+
+    goethe::WorldStateBlock empty(0);
+    EXPECT_EQ(empty.padded_size(), 0u);
+    EXPECT_THROW(empty.set_flag(0, "door"), std::out_of_range);
+    EXPECT_THROW(empty.get_var(0, "mood"), std::out_of_range);
+}
+
+TEST(ConditionCacheTest, InvalidatesOnlyDependents) {
+    goethe::WorldState world;
+    goethe::ConditionCache cache(world);
+    goethe::Condition door{goethe::Condition::Type::FLAG, "door", std::string{}, {}};
+    goethe::Condition mood{goethe::Condition::Type::VAR, "mood", std::string("happy"), {}};
+    const auto door_id = cache.intern(door);
+    const auto mood_id = cache.intern(mood);
+    EXPECT_EQ(cache.intern(door), door_id);
+
+    EXPECT_FALSE(cache.evaluate(door_id));
+    EXPECT_FALSE(cache.evaluate(mood_id));
+    EXPECT_EQ(cache.evaluations(), 2u);
+
+    // Unrelated and no-op changes leave both results cached
+    world.set_flag("window");
+    world.set_flag("door", false);
+    EXPECT_FALSE(cache.evaluate(door_id));
+    EXPECT_FALSE(cache.evaluate(mood_id));
+    EXPECT_EQ(cache.evaluations(), 2u);
+
+    world.set_var("mood", "happy");
+    EXPECT_FALSE(cache.is_dirty(door_id));
+    EXPECT_TRUE(cache.is_dirty(mood_id));
+    EXPECT_TRUE(cache.evaluate(mood_id));
+    EXPECT_EQ(cache.evaluations(), 3u);
+}
+
+TEST(DialogueRunnerTest, StepsThroughChoices) {
+    auto dialogue = load_dialogue();
+    goethe::WorldState world;
+    RecordingPort port;
+    goethe::DialogueRunner runner(dialogue, world, &port);
+
+    auto start = runner.next();
+    ASSERT_TRUE(start.await_ready());
+    auto step = start.await_resume();
+    EXPECT_EQ(step.state, goethe::DialogueState::WAITING_CHOICE);
+    EXPECT_EQ(step.node->id, "greet");
+    EXPECT_TRUE(world.has_flag("met_keeper"));
+    ASSERT_EQ(step.choices.size(), 3u);
+    EXPECT_FALSE(step.choices[1].enabled);
+
+    // Gated choices are shown disabled with their disabledText
+    const auto& choices = *port.payloads.back()[1].choices;
+    EXPECT_TRUE(choices[1].disabled);
+    EXPECT_EQ(choices[1].text, "You are not trusted yet.");
+
+    EXPECT_THROW(runner.next(), std::logic_error);
+    EXPECT_THROW(runner.choose("ask_secret"), std::invalid_argument);
+
+    step = runner.choose("ask_room").await_resume();
+    EXPECT_EQ(step.node->id, "room");
+    ASSERT_NE(world.get_var("lodging"), nullptr);
+    EXPECT_EQ(*world.get_var("lodging"), "tavern");
+    EXPECT_EQ(runner.snapshot().timeLeftMs, 500);
+}
+
+TEST(DialogueRunnerTest, ScriptWaitsForAutoAdvance) {
+    auto dialogue = load_dialogue();
+    goethe::WorldState world;
+    goethe::DialogueRunner runner(dialogue, world);
+    std::vector<std::string> seen;
+
+    auto script = take_room(runner, seen);
+    EXPECT_FALSE(script.done());
+    EXPECT_EQ(seen, (std::vector<std::string>{"greet", "room"}));
+
+    runner.tick(499);
+    EXPECT_EQ(seen.size(), 2u);
+    runner.tick(1);
+    // farewell has no autoAdvanceMs, so the script runs to the end
+    EXPECT_TRUE(script.done());
+    EXPECT_EQ(seen, (std::vector<std::string>{"greet", "room", "farewell", "secret", "$END"}));
+    EXPECT_NO_THROW(script.rethrow_if_failed());
+}
+
+TEST(DialogueRunnerTest, RetriesRefusedPresentation) {
+    auto dialogue = load_dialogue();
+    goethe::WorldState world;
+    RecordingPort port;
+    port.refusals = 2;
+    goethe::DialogueRunner runner(dialogue, world, &port);
+
+    EXPECT_FALSE(runner.next().await_ready());
+    runner.tick(16);
+    EXPECT_TRUE(port.presented.empty());
+    runner.tick(16);
+    EXPECT_EQ(port.presented, (std::vector<std::string>{"greet"}));
+    EXPECT_FALSE(runner.is_waiting());
+}
+
+TEST(DialogueRunnerTest, RefreshTracksGatedChoices) {
+    auto dialogue = load_dialogue();
+    goethe::WorldState world;
+    RecordingPort port;
+    goethe::DialogueRunner runner(dialogue, world, &port);
+    runner.next();
+    const auto evaluations = runner.conditions().evaluations();
+
+    // Nothing the choices read has changed, so nothing is evaluated
+    world.set_var("weather", "rain");
+    EXPECT_FALSE(runner.refresh());
+    EXPECT_EQ(runner.conditions().evaluations(), evaluations);
+    EXPECT_EQ(port.presented.size(), 1u);
+
+    world.set_flag("trusted");
+    EXPECT_TRUE(runner.refresh());
+    EXPECT_TRUE(runner.current_step().choices[1].enabled);
+    EXPECT_EQ(port.presented.size(), 2u);
+    EXPECT_FALSE(runner.refresh());
+    EXPECT_EQ(runner.choose("ask_secret").await_resume().node->id, "secret");
+}
+
+TEST(DialogueRunnerTest, OnceChoicesDisappear) {
+    goethe::Dialogue dialogue;
+    dialogue.id = "loop";
+    goethe::Node hub;
+    hub.id = "hub";
+    hub.choices.push_back({"gift", "Take the gift", "hub", std::nullopt, {}, true, 0, std::nullopt});
+    hub.choices.push_back({"bye", "Bye", "$END", std::nullopt, {}, false, 0, std::nullopt});
+    dialogue.nodes.push_back(hub);
+
+    goethe::WorldState world;
+    goethe::DialogueRunner runner(dialogue, world);
+    EXPECT_EQ(runner.next().await_resume().choices.size(), 2u);
+    auto step = runner.choose("gift").await_resume();
+    ASSERT_EQ(step.choices.size(), 1u);
+    EXPECT_EQ(step.choices[0].choice->id, "bye");
+    EXPECT_EQ(runner.choose("bye").await_resume().state, goethe::DialogueState::COMPLETED);
+}
+
+TEST(DialogueRunnerTest, ScriptKeepsExceptions) {
+    auto dialogue = load_dialogue();
+    goethe::WorldState world;
+    goethe::DialogueRunner runner(dialogue, world);
+
+    auto script = choose_missing(runner);
+    EXPECT_TRUE(script.done());
+    EXPECT_THROW(script.rethrow_if_failed(), std::invalid_argument);
+}
+
+TEST(DialogueRunnerTest, DestroyedScriptDetaches) {
+    auto dialogue = load_dialogue();
+    goethe::WorldState world;
+    goethe::DialogueRunner runner(dialogue, world);
+    std::vector<std::string> seen;
+    {
+        auto script = take_room(runner, seen);
+        EXPECT_FALSE(script.done());
+    }
+    // The runner still advances, with nothing left to resume
+    runner.tick(1000);
+    EXPECT_EQ(seen.size(), 2u);
+    EXPECT_EQ(runner.current_step().node->id, "farewell");
+}
+
+TEST(CoroutineFramePoolTest, FinishedScriptsRecycleFrames) {
+    auto dialogue = load_dialogue();
+    goethe::WorldState world;
+    const auto before = goethe::CoroutineFramePool::thread_stats();
+
+    for (int i = 0; i < 100; ++i) {
+        goethe::DialogueRunner runner(dialogue, world);
+        std::vector<std::string> seen;
+        auto script = take_room(runner, seen);
+        runner.tick(500);
+        EXPECT_TRUE(script.done());
+    }
+
+    const auto after = goethe::CoroutineFramePool::thread_stats();
+    EXPECT_LE(after.allocated - before.allocated, 1u);
+    EXPECT_GE(after.reused - before.reused, 99u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
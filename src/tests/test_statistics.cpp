@@ -0,0 +1,327 @@
+#include "goethe/statistics.hpp"
+#include "goethe/manager.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class StatisticsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        stats_manager.enable_statistics(true);
+        stats_manager.reset_all_stats();
+    }
+
+    void TearDown() override {
+        stats_manager.reset_all_stats();
+    }
+
+    static goethe::OperationStats make_stats(std::size_t input, std::size_t output, std::chrono::nanoseconds duration,
+                                             bool success = true) {
+        goethe::OperationStats stats;
+        stats.input_size = input;
+        stats.output_size = output;
+        stats.duration = duration;
+        stats.success = success;
+        return stats;
+    }
+
+    // Lines of an export that start with `prefix`
+    static std::vector<std::string> lines_with(const std::string& text, const std::string& prefix) {
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) {
+            if (line.rfind(prefix, 0) == 0) lines.push_back(line);
+        }
+        return lines;
+    }
+
+    goethe::StatisticsManager& stats_manager = goethe::StatisticsManager::instance();
+};
+
+TEST_F(StatisticsTest, ConcurrentRecordingIsExact) {
+    constexpr int kThreads = 8;
+    constexpr int kOperations = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, t]() {
+            // Half the threads share a backend, the rest record to their own
+            std::string backend = t % 2 ? "shared" : "own_" + std::to_string(t);
+            for (int i = 0; i < kOperations; ++i) {
+                stats_manager.record_compression(backend, "1.0", make_stats(100, 40, std::chrono::microseconds(3)));
+                stats_manager.record_decompression(backend, "1.0", make_stats(40, 100, std::chrono::microseconds(1)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto shared = stats_manager.get_backend_stats("shared");
+    EXPECT_EQ(shared.total_compressions.load(), static_cast<std::uint64_t>(kThreads / 2 * kOperations));
+    EXPECT_EQ(shared.total_decompressed_size.load(), static_cast<std::uint64_t>(kThreads / 2 * kOperations * 100));
+    EXPECT_EQ(stats_manager.get_backend_stats("own_0").successful_decompressions.load(),
+              static_cast<std::uint64_t>(kOperations));
+
+    auto global = stats_manager.get_global_stats();
+    EXPECT_EQ(global.total_compressions.load(), static_cast<std::uint64_t>(kThreads * kOperations));
+    EXPECT_EQ(global.total_decompressions.load(), static_cast<std::uint64_t>(kThreads * kOperations));
+}
+
+TEST_F(StatisticsTest, LatencyHistogramBuckets) {
+    stats_manager.record_compression("histogram", "1.0", make_stats(10, 5, std::chrono::nanoseconds(500)));
+    stats_manager.record_compression("histogram", "1.0", make_stats(10, 5, std::chrono::microseconds(1)));
+    stats_manager.record_compression("histogram", "1.0", make_stats(10, 5, std::chrono::microseconds(30)));
+    stats_manager.record_compression("histogram", "1.0", make_stats(10, 5, std::chrono::seconds(20)));
+
+    auto stats = stats_manager.get_backend_stats("histogram");
+    const auto& buckets = stats.compression_latency_buckets;
+    EXPECT_EQ(buckets[0].load(), 2u);  // <= 1 us, bounds are inclusive
+    EXPECT_EQ(buckets[5].load(), 1u);  // (25 us, 50 us]
+    EXPECT_EQ(buckets[goethe::BackendStats::latency_bucket_count - 1].load(), 1u); // > 10 s
+    EXPECT_EQ(stats.decompression_latency_buckets[0].load(), 0u);
+}
+
+TEST_F(StatisticsTest, OpenMetricsExport) {
+    stats_manager.record_compression("zstd", "1.5.5", make_stats(1000, 250, std::chrono::microseconds(20)));
+    stats_manager.record_compression("zstd", "1.5.5", make_stats(1000, 0, std::chrono::microseconds(2), false));
+    stats_manager.record_decompression("zstd", "1.5.5", make_stats(250, 1000, std::chrono::microseconds(4)));
+
+    std::string text = stats_manager.export_openmetrics();
+    EXPECT_EQ(text.substr(text.size() - 6), "# EOF\n");
+
+    EXPECT_EQ(lines_with(text, "goethe_backend_info{backend=\"zstd\",version=\"1.5.5\"} 1").size(), 1u);
+    EXPECT_EQ(lines_with(text, "goethe_operations_total{backend=\"zstd\",operation=\"compress\",result=\"success\"} 1")
+                  .size(),
+              1u);
+    EXPECT_EQ(lines_with(text, "goethe_operations_total{backend=\"zstd\",operation=\"compress\",result=\"failure\"} 1")
+                  .size(),
+              1u);
+    EXPECT_EQ(lines_with(text, "goethe_compressed_bytes_total{backend=\"zstd\"} 250").size(), 1u);
+
+    // Buckets are cumulative and end at +Inf, which equals _count
+    auto buckets = lines_with(text, "goethe_operation_latency_seconds_bucket{backend=\"zstd\",operation=\"compress\"");
+    ASSERT_EQ(buckets.size(), goethe::BackendStats::latency_bucket_count);
+    std::uint64_t previous = 0;
+    for (const auto& line : buckets) {
+        std::uint64_t value = std::stoull(line.substr(line.rfind(' ') + 1));
+        EXPECT_GE(value, previous);
+        previous = value;
+    }
+    EXPECT_NE(buckets.back().find("le=\"+Inf\"} 2"), std::string::npos);
+    EXPECT_EQ(lines_with(text, "goethe_operation_latency_seconds_count{backend=\"zstd\",operation=\"compress\"} 2")
+                  .size(),
+              1u);
+
+    // Every family is declared before its samples
+    for (const char* family : {"goethe_operations", "goethe_input_bytes", "goethe_operation_latency_seconds"}) {
+        EXPECT_LT(text.find(std::string("# TYPE ") + family + " "), text.find(std::string(family) + "_"));
+    }
+}
+
+TEST_F(StatisticsTest, SkippedCompressions) {
+    const auto tag = stats_manager.intern_tag("skipped_media");
+    stats_manager.record_skipped_compression("zstd", "1.5.5", 4096, std::chrono::microseconds(50), tag);
+    stats_manager.record_skipped_compression("zstd", "1.5.5", 1024, std::chrono::microseconds(10));
+
+    auto stats = stats_manager.get_backend_stats("zstd");
+    EXPECT_EQ(stats.skipped_compressions.load(), 2u);
+    EXPECT_EQ(stats.skipped_input_size.load(), 5120u);
+    EXPECT_EQ(stats.saved_compression_time_ns.load(), 60000u);
+    EXPECT_EQ(stats.total_compressions.load(), 0u); // Not an operation
+    EXPECT_EQ(stats_manager.get_tag_stats("zstd", tag).skipped_input_size.load(), 4096u);
+    EXPECT_EQ(stats_manager.get_global_stats().skipped_compressions.load(), 2u);
+
+    std::string text = stats_manager.export_openmetrics();
+    EXPECT_EQ(lines_with(text, "goethe_skipped_bytes_total{backend=\"zstd\"} 5120").size(), 1u);
+    EXPECT_EQ(lines_with(text, "goethe_saved_compression_seconds_total{backend=\"zstd\"} 6e-05").size(), 1u);
+    EXPECT_NE(stats_manager.export_json().find("\"skipped_input_size\": 5120"), std::string::npos);
+    EXPECT_NE(stats_manager.export_csv().find(",2,5120,60000\n"), std::string::npos);
+
+    stats_manager.reset_all_stats();
+    EXPECT_EQ(stats_manager.get_backend_stats("zstd").skipped_compressions.load(), 0u);
+}
+
+TEST_F(StatisticsTest, OpenMetricsEscapesLabels) {
+    stats_manager.record_compression("odd\"name\\", "1.0", make_stats(1, 1, std::chrono::nanoseconds(1)));
+    std::string text = stats_manager.export_openmetrics();
+    EXPECT_NE(text.find("backend=\"odd\\\"name\\\\\""), std::string::npos);
+}
+
+TEST_F(StatisticsTest, OpenMetricsFileSinkWritesFile) {
+    auto path = std::filesystem::temp_directory_path() / "goethe_statistics_test.prom";
+    std::filesystem::remove(path);
+
+    stats_manager.record_compression("sink", "1.0", make_stats(10, 5, std::chrono::microseconds(1)));
+    {
+        goethe::OpenMetricsFileSink sink(path.string(), std::chrono::milliseconds(10));
+        sink.start();
+        EXPECT_TRUE(sink.is_running());
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    } // Destructor stops the sink and writes a final export
+
+    std::ifstream file(path);
+    ASSERT_TRUE(file.is_open());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_NE(contents.str().find("goethe_backend_info{backend=\"sink\""), std::string::npos);
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+    std::filesystem::remove(path);
+}
+
+TEST_F(StatisticsTest, RollingWindowsExpireOldBuckets) {
+    constexpr std::uint64_t kSecond = 1'000'000'000;
+    const std::uint64_t t0 = 1000 * kSecond;
+    goethe::RollingWindows windows;
+    windows.reset(t0);
+
+    for (int i = 0; i < 10; ++i) {
+        windows.record_compression(make_stats(1000, 250, std::chrono::microseconds(5)), t0 + i * kSecond / 10);
+    }
+    windows.record_decompression(make_stats(250, 0, std::chrono::microseconds(5), false), t0 + kSecond / 2);
+
+    auto one = windows.get(goethe::StatsWindow::ONE_SECOND, t0 + kSecond - 1);
+    EXPECT_EQ(one.compressions, 10u);
+    EXPECT_EQ(one.decompressions, 1u);
+    EXPECT_DOUBLE_EQ(one.compression_ratio(), 0.25);
+    EXPECT_NEAR(one.error_rate(), 100.0 / 11.0, 1e-9);
+    EXPECT_NEAR(one.operations_per_second(), 11.0, 0.01);
+
+    // Five seconds later the 1 s window is empty, the longer ones still count everything
+    auto later = t0 + 5 * kSecond;
+    EXPECT_EQ(windows.get(goethe::StatsWindow::ONE_SECOND, later).compressions, 0u);
+    EXPECT_EQ(windows.get(goethe::StatsWindow::TEN_SECONDS, later).compressions, 10u);
+    EXPECT_EQ(windows.get(goethe::StatsWindow::ONE_MINUTE, later).compressions, 10u);
+
+    // Rates use the time covered since reset, not the full window length
+    EXPECT_NEAR(windows.get(goethe::StatsWindow::ONE_MINUTE, later).elapsed_seconds, 5.0, 1e-9);
+
+    // Buckets are reused once their period has passed
+    auto much_later = t0 + 120 * kSecond;
+    windows.record_compression(make_stats(1000, 500, std::chrono::microseconds(5)), much_later);
+    auto minute = windows.get(goethe::StatsWindow::ONE_MINUTE, much_later);
+    EXPECT_EQ(minute.compressions, 1u);
+    EXPECT_EQ(minute.failed_operations, 0u);
+    EXPECT_DOUBLE_EQ(minute.compression_ratio(), 0.5);
+}
+
+TEST_F(StatisticsTest, WindowStatsThroughManager) {
+    for (int i = 0; i < 100; ++i) {
+        stats_manager.record_compression("windowed", "1.0", make_stats(1024, 256, std::chrono::microseconds(2)));
+    }
+
+    auto window = stats_manager.get_window_stats("windowed", goethe::StatsWindow::TEN_SECONDS);
+    EXPECT_EQ(window.compressions, 100u);
+    EXPECT_EQ(window.compression_input_size, 100u * 1024u);
+    EXPECT_GT(window.operations_per_second(), 0.0);
+    EXPECT_EQ(stats_manager.get_global_window_stats(goethe::StatsWindow::ONE_SECOND).compressions, 100u);
+    EXPECT_EQ(stats_manager.get_window_stats("unknown", goethe::StatsWindow::ONE_SECOND).compressions, 0u);
+
+    stats_manager.reset_backend_stats("windowed");
+    EXPECT_EQ(stats_manager.get_window_stats("windowed", goethe::StatsWindow::TEN_SECONDS).compressions, 0u);
+}
+
+TEST_F(StatisticsTest, InternTagIsIdempotent) {
+    auto dialogue = stats_manager.intern_tag("dialogue");
+    EXPECT_NE(dialogue, goethe::NO_STATS_TAG);
+    EXPECT_EQ(stats_manager.intern_tag("dialogue"), dialogue);
+    EXPECT_NE(stats_manager.intern_tag("voice"), dialogue);
+    EXPECT_EQ(stats_manager.intern_tag(""), goethe::NO_STATS_TAG);
+    EXPECT_EQ(stats_manager.get_tag_name(dialogue), "dialogue");
+}
+
+TEST_F(StatisticsTest, TagBreakdown) {
+    auto dialogue = stats_manager.intern_tag("dialogue");
+    auto voice = stats_manager.intern_tag("voice");
+
+    stats_manager.record_compression("tagged", "1.0", make_stats(1000, 200, std::chrono::microseconds(5)), dialogue);
+    stats_manager.record_compression("tagged", "1.0", make_stats(1000, 900, std::chrono::microseconds(5)), voice);
+    stats_manager.record_compression("tagged", "1.0", make_stats(1000, 500, std::chrono::microseconds(5)));
+
+    // Untagged calls only count towards the backend totals
+    EXPECT_EQ(stats_manager.get_backend_stats("tagged").total_compressions.load(), 3u);
+    auto dialogue_stats = stats_manager.get_tag_stats("tagged", dialogue);
+    EXPECT_EQ(dialogue_stats.total_compressions.load(), 1u);
+    EXPECT_EQ(dialogue_stats.backend_name, "tagged");
+    EXPECT_DOUBLE_EQ(dialogue_stats.average_compression_ratio(), 0.2);
+    EXPECT_DOUBLE_EQ(stats_manager.get_tag_stats("tagged", voice).average_compression_ratio(), 0.9);
+    EXPECT_EQ(stats_manager.get_global_tag_stats(voice).total_compressions.load(), 1u);
+    EXPECT_EQ(stats_manager.get_tag_stats("unknown", voice).total_compressions.load(), 0u);
+
+    std::string json = stats_manager.export_json();
+    EXPECT_NE(json.find("\"tags\": {\n"), std::string::npos);
+    EXPECT_NE(json.find("\"dialogue\": {"), std::string::npos);
+
+    std::string text = stats_manager.export_openmetrics();
+    EXPECT_EQ(lines_with(text, "goethe_tag_operations_total{backend=\"tagged\",tag=\"voice\",operation=\"compress\"} 1")
+                  .size(),
+              1u);
+    EXPECT_EQ(lines_with(text, "goethe_tag_compressed_bytes_total{backend=\"tagged\",tag=\"dialogue\"} 200").size(), 1u);
+
+    stats_manager.reset_backend_stats("tagged");
+    EXPECT_EQ(stats_manager.get_tag_stats("tagged", dialogue).total_compressions.load(), 0u);
+}
+
+TEST_F(StatisticsTest, ManagerRecordsTaggedCalls) {
+    auto& manager = goethe::CompressionManager::instance();
+    manager.initialize("null");
+    auto tag = manager.intern_tag("manager");
+
+    std::string data(512, 'x');
+    auto compressed = manager.compress(data, tag);
+    EXPECT_EQ(manager.decompress_to_string(compressed), data);
+
+    EXPECT_EQ(manager.get_statistics().total_compressions.load(), 1u);
+    EXPECT_EQ(manager.get_statistics().total_decompressions.load(), 1u);
+    auto tagged = manager.get_tag_statistics(tag);
+    EXPECT_EQ(tagged.total_compressions.load(), 1u);
+    EXPECT_EQ(tagged.total_decompressions.load(), 0u);
+    EXPECT_EQ(tagged.total_input_size.load(), data.size());
+}
+
+TEST_F(StatisticsTest, MemoryAccountsReportGauges) {
+    using goethe::MemoryCategory;
+    const std::size_t before = stats_manager.get_memory_usage(MemoryCategory::CACHE);
+    {
+        goethe::MemoryAccount small(MemoryCategory::CACHE, "small_cache", 100);
+        goethe::MemoryAccount large(MemoryCategory::CACHE, "large_cache", 5000);
+        EXPECT_EQ(stats_manager.get_memory_usage(MemoryCategory::CACHE), before + 5100);
+
+        large.update(3000);
+        EXPECT_EQ(large.bytes(), 3000u);
+        EXPECT_EQ(stats_manager.get_memory_usage(MemoryCategory::CACHE), before + 3100);
+
+        // Moving keeps a single registration
+        goethe::MemoryAccount moved(std::move(small));
+        EXPECT_FALSE(small.is_registered());
+        EXPECT_EQ(stats_manager.get_memory_usage(MemoryCategory::CACHE), before + 3100);
+
+        auto breakdown = stats_manager.get_memory_breakdown();
+        auto large_it = std::find_if(breakdown.begin(), breakdown.end(),
+                                     [](const goethe::MemoryUsage& usage) { return usage.name == "large_cache"; });
+        auto small_it = std::find_if(breakdown.begin(), breakdown.end(),
+                                     [](const goethe::MemoryUsage& usage) { return usage.name == "small_cache"; });
+        ASSERT_NE(large_it, breakdown.end());
+        ASSERT_NE(small_it, breakdown.end());
+        EXPECT_LT(large_it, small_it); // Largest first
+
+        std::string text = stats_manager.export_openmetrics();
+        EXPECT_EQ(lines_with(text, "goethe_memory_object_bytes{category=\"cache\",name=\"large_cache\"} 3000").size(),
+                  1u);
+        EXPECT_EQ(lines_with(text, "goethe_memory_bytes{category=\"cache\"}").size(), 1u);
+        EXPECT_NE(stats_manager.export_json().find("\"name\": \"small_cache\", \"bytes\": 100"), std::string::npos);
+    }
+    EXPECT_EQ(stats_manager.get_memory_usage(MemoryCategory::CACHE), before);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
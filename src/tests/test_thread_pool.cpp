@@ -0,0 +1,83 @@
+#include "goethe/thread_pool.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+    goethe::ThreadPool pool(4);
+    std::vector<std::atomic<int>> visits(1000);
+    std::mutex mutex;
+    std::set<std::size_t> slots;
+
+    pool.parallel_for(visits.size(), [&](std::size_t slot, std::size_t index) {
+        visits[index].fetch_add(1);
+        std::lock_guard<std::mutex> lock(mutex);
+        slots.insert(slot);
+    });
+
+    for (const auto& count : visits) {
+        EXPECT_EQ(count.load(), 1);
+    }
+    EXPECT_LE(*slots.rbegin(), pool.size());
+}
+
+TEST(ThreadPoolTest, MaxHelpersBoundsSlots) {
+    goethe::ThreadPool pool(4);
+    std::atomic<std::size_t> max_slot{0};
+    pool.parallel_for(200, [&](std::size_t slot, std::size_t) {
+        std::size_t seen = max_slot.load();
+        while (slot > seen && !max_slot.compare_exchange_weak(seen, slot)) {}
+    }, 1);
+    EXPECT_LE(max_slot.load(), 1u);
+}
+
+TEST(ThreadPoolTest, ParallelForRethrowsFirstException) {
+    goethe::ThreadPool pool(3);
+    EXPECT_THROW(pool.parallel_for(100, [](std::size_t, std::size_t index) {
+        if (index == 42) throw std::runtime_error("boom");
+    }), std::runtime_error);
+
+    // The pool stays usable afterwards
+    std::atomic<int> total{0};
+    pool.parallel_for(10, [&](std::size_t, std::size_t) { total.fetch_add(1); });
+    EXPECT_EQ(total.load(), 10);
+}
+
+TEST(ThreadPoolTest, ZeroThreadsRunsOnCaller) {
+    goethe::ThreadPool pool(0);
+    EXPECT_EQ(pool.size(), 0u);
+    std::vector<int> order;
+    pool.parallel_for(5, [&](std::size_t slot, std::size_t index) {
+        EXPECT_EQ(slot, 0u);
+        order.push_back(static_cast<int>(index));
+    });
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+TEST(ThreadPoolTest, SubmitRunsTasks) {
+    goethe::ThreadPool pool(2);
+    std::promise<int> promise;
+    auto future = promise.get_future();
+    pool.submit([&] { promise.set_value(7); });
+    EXPECT_EQ(future.get(), 7);
+}
+
+TEST(ThreadPoolTest, DestructorDrainsQueue) {
+    std::atomic<int> ran{0};
+    {
+        goethe::ThreadPool pool(1);
+        for (int i = 0; i < 50; ++i) {
+            pool.submit([&] { ran.fetch_add(1); });
+        }
+    }
+    EXPECT_EQ(ran.load(), 50);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
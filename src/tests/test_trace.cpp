@@ -0,0 +1,250 @@
+#include "goethe/trace.hpp"
+#include "goethe/backend.hpp"
+#include "goethe/factory.hpp"
+#include "goethe/register_backends.hpp"
+#include <gtest/gtest.h>
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        tracer.set_buffer_capacity(1024);
+        tracer.clear();
+        tracer.enable_tracing(true);
+    }
+
+    void TearDown() override {
+        tracer.enable_tracing(false);
+        tracer.clear();
+    }
+
+    // Events named `name` across all threads
+    static std::size_t count_events(const goethe::TraceSnapshot& snapshot, const std::string& name) {
+        std::size_t count = 0;
+        for (const auto& thread : snapshot.threads) {
+            for (const auto& event : thread.events) {
+                if (name == event.name) ++count;
+            }
+        }
+        return count;
+    }
+
+    goethe::TraceManager& tracer = goethe::TraceManager::instance();
+};
+
+TEST_F(TraceTest, DisabledRecordsNothing) {
+    tracer.enable_tracing(false);
+    {
+        goethe::TraceScope scope("ignored", "test");
+    }
+    EXPECT_EQ(tracer.snapshot().event_count(), 0u);
+}
+
+TEST_F(TraceTest, ScopeRecordsSpan) {
+    {
+        goethe::TraceScope outer("outer", "test");
+        goethe::TraceScope inner("inner", "test");
+    }
+
+    auto snapshot = tracer.snapshot();
+    ASSERT_EQ(snapshot.event_count(), 2u);
+
+    const goethe::TraceEvent* outer = nullptr;
+    const goethe::TraceEvent* inner = nullptr;
+    for (const auto& thread : snapshot.threads) {
+        for (const auto& event : thread.events) {
+            if (std::string(event.name) == "outer") outer = &event;
+            if (std::string(event.name) == "inner") inner = &event;
+        }
+    }
+    ASSERT_NE(outer, nullptr);
+    ASSERT_NE(inner, nullptr);
+    EXPECT_STREQ(outer->category, "test");
+    EXPECT_LE(outer->start_ns, inner->start_ns);
+    EXPECT_GE(outer->start_ns + outer->duration_ns, inner->start_ns + inner->duration_ns);
+}
+
+TEST_F(TraceTest, RingBufferKeepsNewestEvents) {
+    tracer.set_buffer_capacity(4);
+    static const char* names[] = {"e0", "e1", "e2", "e3", "e4", "e5"};
+    for (const char* name : names) {
+        auto now = goethe::TraceManager::now_ns();
+        tracer.record(name, "test", now, now + 1);
+    }
+
+    auto snapshot = tracer.snapshot();
+    ASSERT_EQ(snapshot.event_count(), 4u);
+    for (const auto& thread : snapshot.threads) {
+        if (thread.events.empty()) continue;
+        EXPECT_EQ(thread.dropped_events, 2u);
+        EXPECT_STREQ(thread.events.front().name, "e2");
+        EXPECT_STREQ(thread.events.back().name, "e5");
+    }
+}
+
+TEST_F(TraceTest, ThreadsRecordIntoSeparateBuffers) {
+    constexpr int kThreads = 4;
+    constexpr int kEventsPerThread = 100;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            goethe::TraceManager::instance().set_thread_name("worker " + std::to_string(t));
+            for (int i = 0; i < kEventsPerThread; ++i) {
+                goethe::TraceScope scope("work", "test");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto snapshot = tracer.snapshot();
+    EXPECT_EQ(count_events(snapshot, "work"), static_cast<std::size_t>(kThreads * kEventsPerThread));
+
+    int workers = 0;
+    for (const auto& thread : snapshot.threads) {
+        if (thread.thread_name.rfind("worker ", 0) == 0) {
+            EXPECT_EQ(thread.events.size(), static_cast<std::size_t>(kEventsPerThread));
+            ++workers;
+        }
+    }
+    EXPECT_EQ(workers, kThreads);
+}
+
+TEST_F(TraceTest, DialogueAndCompressionAreInstrumented) {
+    std::istringstream input("id: traced\nnodes:\n  - id: start\n    line:\n      text: hello\n");
+    auto dialogue = goethe::read_dialogue(input);
+    EXPECT_EQ(dialogue.id, "traced");
+
+    goethe::register_compression_backends();
+    auto backend = goethe::CompressionFactory::instance().create_backend("null");
+    std::vector<uint8_t> data(256, 'x');
+    backend->decompress(backend->compress(data));
+
+    auto snapshot = tracer.snapshot();
+    EXPECT_EQ(count_events(snapshot, "read_dialogue"), 1u);
+    EXPECT_EQ(count_events(snapshot, "compress"), 1u);
+    EXPECT_EQ(count_events(snapshot, "decompress"), 1u);
+}
+
+TEST_F(TraceTest, ChromeJsonExport) {
+    tracer.set_thread_name("main \"thread\"");
+    {
+        goethe::TraceScope scope("exported", "test");
+    }
+
+    // Chrome trace JSON is plain JSON, which yaml-cpp can read
+    YAML::Node root = YAML::Load(tracer.export_chrome_json());
+    ASSERT_TRUE(root["traceEvents"].IsSequence());
+
+    bool found_event = false;
+    bool found_name = false;
+    for (const auto& event : root["traceEvents"]) {
+        auto phase = event["ph"].as<std::string>();
+        if (phase == "X" && event["name"].as<std::string>() == "exported") {
+            EXPECT_EQ(event["cat"].as<std::string>(), "test");
+            EXPECT_GE(event["dur"].as<double>(), 0.0);
+            found_event = true;
+        }
+        if (phase == "M" && event["args"]["name"].as<std::string>() == "main \"thread\"") {
+            found_name = true;
+        }
+    }
+    EXPECT_TRUE(found_event);
+    EXPECT_TRUE(found_name);
+}
+
+// Fields of one protobuf message: varints as numbers, length-delimited as bytes
+struct ProtoField {
+    uint32_t number = 0;
+    uint64_t value = 0;
+    std::string bytes;
+};
+
+static std::vector<ProtoField> parse_message(const std::string& data) {
+    std::vector<ProtoField> fields;
+    std::size_t pos = 0;
+    auto varint = [&]() {
+        uint64_t result = 0;
+        for (int shift = 0; pos < data.size(); shift += 7) {
+            auto byte = static_cast<uint8_t>(data[pos++]);
+            result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        return result;
+    };
+    while (pos < data.size()) {
+        uint64_t key = varint();
+        ProtoField field;
+        field.number = static_cast<uint32_t>(key >> 3);
+        if ((key & 7) == 0) {
+            field.value = varint();
+        } else if ((key & 7) == 2) {
+            auto length = static_cast<std::size_t>(varint());
+            field.bytes = data.substr(pos, length);
+            pos += length;
+        } else {
+            ADD_FAILURE() << "unexpected wire type " << (key & 7);
+            break;
+        }
+        fields.push_back(std::move(field));
+    }
+    return fields;
+}
+
+TEST_F(TraceTest, PerfettoExportBalancesSlices) {
+    {
+        goethe::TraceScope outer("outer", "test");
+        goethe::TraceScope inner("inner", "test");
+    }
+
+    std::string trace = tracer.export_perfetto();
+    ASSERT_FALSE(trace.empty());
+
+    // Replay slice begin/end per sequence and check they nest
+    std::vector<std::string> begun;
+    std::size_t ends = 0;
+    std::size_t depth = 0;
+    std::size_t max_depth = 0;
+    uint64_t last_timestamp = 0;
+    for (const auto& packet_field : parse_message(trace)) {
+        ASSERT_EQ(packet_field.number, 1u); // Trace.packet
+        uint64_t timestamp = 0;
+        std::string track_event;
+        for (const auto& field : parse_message(packet_field.bytes)) {
+            if (field.number == 8) timestamp = field.value;
+            if (field.number == 11) track_event = field.bytes;
+        }
+        if (track_event.empty()) continue;
+
+        EXPECT_GE(timestamp, last_timestamp);
+        last_timestamp = timestamp;
+        for (const auto& field : parse_message(track_event)) {
+            if (field.number == 9 && field.value == 1) {
+                max_depth = std::max(max_depth, ++depth);
+            } else if (field.number == 9 && field.value == 2) {
+                ASSERT_GT(depth, 0u);
+                --depth;
+                ++ends;
+            } else if (field.number == 23) {
+                begun.push_back(field.bytes);
+            }
+        }
+    }
+
+    EXPECT_EQ(begun, (std::vector<std::string>{"outer", "inner"}));
+    EXPECT_EQ(ends, 2u);
+    EXPECT_EQ(depth, 0u);
+    EXPECT_EQ(max_depth, 2u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
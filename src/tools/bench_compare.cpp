@@ -0,0 +1,362 @@
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+void print_usage(const char* program_name) {
+    std::cout << "Goethe Benchmark Regression Gate\n\n";
+    std::cout << "Usage:\n";
+    std::cout << "  " << program_name << " <baseline.json> <current.json> [options]\n";
+    std::cout << "  " << program_name << " --run <goethe_bench> <baseline.json> [options]\n\n";
+    std::cout << "Compares Google Benchmark JSON results per benchmark with a two-sided\n";
+    std::cout << "Mann-Whitney U test over the repetitions. A benchmark regresses when its\n";
+    std::cout << "median slows down by more than the threshold and the difference is\n";
+    std::cout << "significant. Results must be produced with --benchmark_repetitions >= 3.\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --threshold <fraction>  Allowed median slowdown (default: 0.10 = 10%)\n";
+    std::cout << "  --alpha <p>             Significance level (default: 0.05)\n";
+    std::cout << "  --metric <name>         real_time or cpu_time (default: real_time)\n";
+    std::cout << "  --repetitions <n>       Repetitions for --run (default: 5)\n";
+    std::cout << "  --filter <regex>        Benchmark filter for --run\n";
+    std::cout << "  --min-time <seconds>    Minimum time per repetition for --run\n";
+    std::cout << "  --update                With --run, overwrite the baseline with the new results\n";
+    std::cout << "  --help                  Show this help message\n\n";
+    std::cout << "Exit status is 1 when any benchmark regresses.\n";
+}
+
+// Samples of one benchmark, in nanoseconds
+using Samples = std::vector<double>;
+
+double to_ns(double value, const std::string& unit) {
+    if (unit == "us") return value * 1e3;
+    if (unit == "ms") return value * 1e6;
+    if (unit == "s") return value * 1e9;
+    return value;
+}
+
+// Google Benchmark JSON is plain JSON, which yaml-cpp reads as YAML
+std::map<std::string, Samples> load_results(const std::string& path, const std::string& metric) {
+    YAML::Node root = YAML::LoadFile(path);
+    if (!root["benchmarks"]) {
+        throw std::runtime_error(path + ": not a Google Benchmark JSON file");
+    }
+
+    std::map<std::string, Samples> results;
+    for (const auto& entry : root["benchmarks"]) {
+        std::string run_type = entry["run_type"] ? entry["run_type"].as<std::string>() : "iteration";
+        if (run_type != "iteration" || entry["error_occurred"]) {
+            continue; // Aggregates are recomputed here from the raw repetitions
+        }
+        std::string name = entry["run_name"] ? entry["run_name"].as<std::string>() : entry["name"].as<std::string>();
+        std::string unit = entry["time_unit"] ? entry["time_unit"].as<std::string>() : "ns";
+        results[name].push_back(to_ns(entry[metric].as<double>(), unit));
+    }
+    return results;
+}
+
+double median(Samples samples) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    std::size_t mid = samples.size() / 2;
+    return samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0;
+}
+
+// Two-sided Mann-Whitney U test. Small samples without ties use the exact
+// distribution of U; otherwise the normal approximation with tie and
+// continuity corrections is used.
+double mann_whitney_p(const Samples& a, const Samples& b) {
+    const std::size_t n1 = a.size();
+    const std::size_t n2 = b.size();
+    if (n1 == 0 || n2 == 0) return 1.0;
+
+    std::vector<std::pair<double, int>> pooled;
+    for (double x : a) pooled.emplace_back(x, 0);
+    for (double x : b) pooled.emplace_back(x, 1);
+    std::sort(pooled.begin(), pooled.end());
+
+    // Average ranks for ties
+    double rank_sum_a = 0.0;
+    double tie_term = 0.0;
+    bool has_ties = false;
+    for (std::size_t i = 0; i < pooled.size();) {
+        std::size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) ++j;
+        double rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+        double t = static_cast<double>(j - i);
+        if (t > 1) {
+            has_ties = true;
+            tie_term += t * t * t - t;
+        }
+        for (std::size_t k = i; k < j; ++k) {
+            if (pooled[k].second == 0) rank_sum_a += rank;
+        }
+        i = j;
+    }
+
+    const double u = rank_sum_a - static_cast<double>(n1 * (n1 + 1)) / 2.0;
+    const double max_u = static_cast<double>(n1 * n2);
+
+    if (!has_ties && n1 <= 20 && n2 <= 20) {
+        // counts[m][n][u]: orderings of m and n samples with statistic u,
+        // via N(u; m, n) = N(u - n; m - 1, n) + N(u; m, n - 1)
+        std::vector<std::vector<std::vector<double>>> counts(
+            n1 + 1, std::vector<std::vector<double>>(n2 + 1));
+        for (std::size_t m = 0; m <= n1; ++m) {
+            for (std::size_t n = 0; n <= n2; ++n) {
+                counts[m][n].assign(m * n + 1, 0.0);
+                if (m == 0 || n == 0) {
+                    counts[m][n][0] = 1.0;
+                    continue;
+                }
+                for (std::size_t k = 0; k <= m * n; ++k) {
+                    double value = k < counts[m][n - 1].size() ? counts[m][n - 1][k] : 0.0;
+                    if (k >= n && k - n < counts[m - 1][n].size()) value += counts[m - 1][n][k - n];
+                    counts[m][n][k] = value;
+                }
+            }
+        }
+        const auto& dist = counts[n1][n2];
+        double total = 0.0;
+        for (double c : dist) total += c;
+
+        auto u_index = static_cast<std::size_t>(std::llround(u));
+        double lower = 0.0;
+        double upper = 0.0;
+        for (std::size_t k = 0; k < dist.size(); ++k) {
+            if (k <= u_index) lower += dist[k];
+            if (k >= u_index) upper += dist[k];
+        }
+        return std::min(1.0, 2.0 * std::min(lower, upper) / total);
+    }
+
+    const double n = static_cast<double>(n1 + n2);
+    const double mean = max_u / 2.0;
+    const double variance = max_u / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0)));
+    if (variance <= 0.0) return 1.0;
+    const double z = (std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::min(1.0, std::erfc(std::max(z, 0.0) / std::sqrt(2.0)));
+}
+
+struct CompareOptions {
+    double threshold = 0.10;
+    double alpha = 0.05;
+    std::string metric = "real_time";
+};
+
+// Returns the number of regressions
+int compare(const std::map<std::string, Samples>& baseline, const std::map<std::string, Samples>& current,
+            const CompareOptions& options) {
+    int regressions = 0;
+    int improvements = 0;
+    int compared = 0;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(56) << "Benchmark" << std::right << std::setw(14) << "Baseline ns"
+              << std::setw(14) << "Current ns" << std::setw(10) << "Change" << std::setw(10) << "p" << "  Result\n";
+    std::cout << std::string(110, '-') << "\n";
+
+    for (const auto& [name, samples] : current) {
+        auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            std::cout << std::left << std::setw(56) << name << std::right << std::setw(14) << "-" << std::setw(14)
+                      << median(samples) << std::setw(10) << "-" << std::setw(10) << "-" << "  new\n";
+            continue;
+        }
+
+        double base = median(it->second);
+        double now = median(samples);
+        double change = base > 0.0 ? now / base - 1.0 : 0.0;
+        double p = mann_whitney_p(it->second, samples);
+        bool significant = p < options.alpha;
+
+        std::string verdict = "ok";
+        if (significant && change > options.threshold) {
+            verdict = "REGRESSION";
+            ++regressions;
+        } else if (significant && change < -options.threshold) {
+            verdict = "improved";
+            ++improvements;
+        } else if (it->second.size() < 3 || samples.size() < 3) {
+            verdict = "too few repetitions";
+        }
+        ++compared;
+
+        std::cout << std::left << std::setw(56) << name << std::right << std::setw(14) << base << std::setw(14) << now
+                  << std::setw(9) << change * 100.0 << "%" << std::setw(10) << std::setprecision(4) << p
+                  << std::setprecision(2) << "  " << verdict << "\n";
+    }
+
+    for (const auto& [name, _] : baseline) {
+        if (!current.count(name)) {
+            std::cout << std::left << std::setw(56) << name << "  missing from current results\n";
+        }
+    }
+
+    std::cout << "\n" << compared << " compared, " << regressions << " regressed, " << improvements
+              << " improved (threshold " << options.threshold * 100.0 << "%, alpha " << options.alpha << ", "
+              << options.metric << ")\n";
+    return regressions;
+}
+
+std::string shell_quote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') quoted += "'\\''";
+        else quoted += c;
+    }
+    return quoted + "'";
+}
+
+// Results file of one --run, unique so concurrent gates do not overwrite
+// each other, and removed afterwards
+class TempResults {
+public:
+    TempResults() {
+        std::string pattern = (fs::temp_directory_path() / "goethe_bench_XXXXXX").string();
+        const int fd = mkstemp(pattern.data());
+        if (fd < 0) {
+            throw std::runtime_error("cannot create a temporary results file in " +
+                                     fs::temp_directory_path().string());
+        }
+        close(fd);
+        path_ = pattern;
+    }
+    ~TempResults() {
+        std::error_code error;
+        fs::remove(path_, error);
+    }
+    TempResults(const TempResults&) = delete;
+    TempResults& operator=(const TempResults&) = delete;
+
+    const std::string& path() const {
+        return path_;
+    }
+
+private:
+    std::string path_;
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return argc == 2 && std::string(argv[1]) == "--help" ? 0 : 1;
+    }
+
+    CompareOptions options;
+    std::vector<std::string> positional;
+    std::string bench_executable;
+    std::string filter;
+    std::string min_time;
+    int repetitions = 5;
+    bool update = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "--update") {
+                update = true;
+            } else if (arg.rfind("--", 0) == 0 && i + 1 < argc) {
+                std::string value = argv[++i];
+                if (arg == "--run") bench_executable = value;
+                else if (arg == "--threshold") options.threshold = std::stod(value);
+                else if (arg == "--alpha") options.alpha = std::stod(value);
+                else if (arg == "--metric") options.metric = value;
+                else if (arg == "--repetitions") repetitions = std::stoi(value);
+                else if (arg == "--filter") filter = value;
+                else if (arg == "--min-time") min_time = value;
+                else {
+                    std::cerr << "Error: unknown option " << arg << "\n";
+                    return 1;
+                }
+            } else {
+                positional.push_back(arg);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (options.metric != "real_time" && options.metric != "cpu_time") {
+        std::cerr << "Error: --metric must be real_time or cpu_time\n";
+        return 1;
+    }
+
+    std::string baseline_path;
+    std::string current_path;
+    std::optional<TempResults> temp_results;
+    if (!bench_executable.empty()) {
+        if (positional.size() != 1) {
+            std::cerr << "Error: --run expects exactly one baseline file\n";
+            return 1;
+        }
+        baseline_path = positional[0];
+        if (!update && !fs::exists(baseline_path)) {
+            std::cerr << "Error: no baseline at " << baseline_path
+                      << "; record one on this machine with --update (the bench_baseline target)\n";
+            return 1;
+        }
+        try {
+            temp_results.emplace();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        current_path = temp_results->path();
+
+        std::string command = shell_quote(bench_executable) +
+                              " --benchmark_repetitions=" + std::to_string(repetitions) +
+                              " --benchmark_out_format=json --benchmark_out=" + shell_quote(current_path);
+        if (!filter.empty()) command += " --benchmark_filter=" + shell_quote(filter);
+        if (!min_time.empty()) command += " --benchmark_min_time=" + shell_quote(min_time);
+
+        std::cout << "Running: " << command << "\n" << std::flush;
+        if (std::system(command.c_str()) != 0) {
+            std::cerr << "Error: benchmark run failed\n";
+            return 1;
+        }
+
+        if (update) {
+            fs::copy_file(current_path, baseline_path, fs::copy_options::overwrite_existing);
+            std::cout << "Baseline updated: " << baseline_path << "\n";
+            return 0;
+        }
+    } else {
+        if (positional.size() != 2) {
+            std::cerr << "Error: expected <baseline.json> <current.json>\n";
+            return 1;
+        }
+        baseline_path = positional[0];
+        current_path = positional[1];
+    }
+
+    try {
+        auto baseline = load_results(baseline_path, options.metric);
+        auto current = load_results(current_path, options.metric);
+        if (current.empty()) {
+            std::cerr << "Error: no benchmark results in " << current_path << "\n";
+            return 1;
+        }
+        return compare(baseline, current, options) > 0 ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,647 @@
+#include "corpus_generator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <type_traits>
+
+namespace goethe::corpus {
+
+// Rng methods
+std::uint64_t Rng::next() {
+    std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+int Rng::range(int lo, int hi) {
+    if (hi <= lo) return lo;
+    return lo + static_cast<int>(next() % static_cast<std::uint64_t>(hi - lo + 1));
+}
+
+double Rng::uniform() {
+    return static_cast<double>(next() >> 11) * 0x1.0p-53;
+}
+
+namespace {
+
+const char* const kSyllables[] = {
+    "an", "ar", "be", "ca", "da", "del", "en", "er", "fa", "ga", "ha", "in", "is", "ka", "la", "le",
+    "lo", "ma", "mi", "na", "ne", "no", "or", "ra", "re", "ri", "ro", "sa", "se", "ta", "te", "th",
+    "to", "ul", "un", "va", "ve", "wa", "we", "ya", "ze", "mor", "gan", "tir", "wen", "dor", "val"};
+
+const char* const kMoods[] = {"neutral", "happy", "sad", "angry", "surprised", "worried", "smug"};
+const char* const kTags[] = {"intro", "quest", "ambient", "combat", "romance", "shop", "lore"};
+const char* const kPunctuation[] = {".", ".", ".", "?", "!", "..."};
+
+// Vocabulary with a Zipf-like frequency distribution, so generated prose has
+// the skewed word reuse of real dialogue instead of uniform noise
+class Vocabulary {
+public:
+    explicit Vocabulary(int size) {
+        size = std::max(size, 1);
+        Rng rng(0x60E7E5EEDull); // Fixed: the vocabulary never depends on the corpus seed
+        words_.reserve(static_cast<std::size_t>(size));
+        cumulative_.reserve(static_cast<std::size_t>(size));
+
+        double total = 0.0;
+        for (int rank = 1; rank <= size; ++rank) {
+            // Frequent words are short, rare words are long
+            int syllables = 1 + std::min(3, static_cast<int>(std::log10(static_cast<double>(rank)))) +
+                            rng.range(0, 1);
+            std::string word;
+            for (int s = 0; s < syllables; ++s) {
+                word += kSyllables[rng.range(0, static_cast<int>(std::size(kSyllables)) - 1)];
+            }
+            words_.push_back(word);
+            total += 1.0 / std::pow(static_cast<double>(rank), 1.07);
+            cumulative_.push_back(total);
+        }
+        for (auto& c : cumulative_) {
+            c /= total;
+        }
+    }
+
+    const std::string& sample(Rng& rng) const {
+        auto it = std::lower_bound(cumulative_.begin(), cumulative_.end(), rng.uniform());
+        if (it == cumulative_.end()) --it;
+        return words_[static_cast<std::size_t>(it - cumulative_.begin())];
+    }
+
+private:
+    std::vector<std::string> words_;
+    std::vector<double> cumulative_;
+};
+
+class Generator {
+public:
+    Generator(const CorpusOptions& options, const std::string& id)
+        : options_(options), id_(id), rng_(options.seed), vocabulary_(options.vocabulary_size) {}
+
+    Dialogue generate() {
+        Dialogue dialogue;
+        dialogue.id = id_;
+        dialogue.metadata["title"] = capitalize(prose(2, 5, false));
+        dialogue.metadata["author"] = "corpus_generator";
+        dialogue.metadata["chapter"] = std::to_string(rng_.range(1, 12));
+
+        int node_count = std::max(options_.node_count, 1);
+        dialogue.startNode = node_id(0);
+        for (int i = 0; i < node_count; ++i) {
+            dialogue.nodes.push_back(generate_node(i, node_count));
+        }
+
+        int locals = rng_.range(0, 3);
+        for (int i = 0; i < locals; ++i) {
+            dialogue.localVars["local_" + std::to_string(i)] = std::to_string(rng_.range(0, 10));
+        }
+        return dialogue;
+    }
+
+private:
+    std::string node_id(int index) const {
+        return "node_" + std::to_string(index);
+    }
+
+    std::string i18n_key(const std::string& node, const std::string& suffix) const {
+        return "dlg_" + id_ + "." + node + "." + suffix;
+    }
+
+    std::string prose(int min_words, int max_words, bool punctuate = true) {
+        int words = rng_.range(std::max(min_words, 1), std::max(max_words, min_words));
+        std::string text;
+        for (int w = 0; w < words; ++w) {
+            if (w > 0) {
+                text += rng_.chance(0.08) ? ", " : " ";
+            }
+            text += vocabulary_.sample(rng_);
+        }
+        if (punctuate) {
+            text += kPunctuation[rng_.range(0, static_cast<int>(std::size(kPunctuation)) - 1)];
+        }
+        return capitalize(text);
+    }
+
+    static std::string capitalize(std::string text) {
+        if (!text.empty() && text[0] >= 'a' && text[0] <= 'z') {
+            text[0] = static_cast<char>(text[0] - 'a' + 'A');
+        }
+        return text;
+    }
+
+    std::string flag() {
+        return "flag_" + std::to_string(rng_.range(0, std::max(options_.flag_count, 1) - 1));
+    }
+
+    std::string var() {
+        return "var_" + std::to_string(rng_.range(0, std::max(options_.var_count, 1) - 1));
+    }
+
+    Condition generate_condition(int depth) {
+        Condition condition;
+        if (depth <= 0 || rng_.chance(0.35)) {
+            if (rng_.chance(0.6)) {
+                condition.type = Condition::Type::FLAG;
+                condition.key = flag();
+            } else {
+                condition.type = Condition::Type::VAR;
+                condition.key = var();
+                condition.value = std::to_string(rng_.range(0, 9));
+            }
+            return condition;
+        }
+
+        int kind = rng_.range(0, 9);
+        if (kind < 2) {
+            condition.type = Condition::Type::NOT;
+            condition.children.push_back(generate_condition(depth - 1));
+            return condition;
+        }
+        condition.type = kind < 6 ? Condition::Type::ALL : Condition::Type::ANY;
+        int children = rng_.range(2, 4);
+        for (int i = 0; i < children; ++i) {
+            condition.children.push_back(generate_condition(depth - 1));
+        }
+        return condition;
+    }
+
+    std::optional<Condition> maybe_condition() {
+        if (options_.condition_depth < 0 || !rng_.chance(options_.condition_probability)) {
+            return std::nullopt;
+        }
+        return generate_condition(rng_.range(0, options_.condition_depth));
+    }
+
+    // Only effect types that write_dialogue can serialize are generated
+    Effect generate_effect(const std::string& node) {
+        Effect effect;
+        switch (rng_.range(0, 5)) {
+            case 0:
+            case 1:
+            case 2:
+                effect.type = Effect::Type::SET_FLAG;
+                effect.target = flag();
+                break;
+            case 3:
+                effect.type = Effect::Type::SET_VAR;
+                effect.target = var();
+                effect.value = rng_.range(-5, 20);
+                break;
+            case 4:
+                effect.type = Effect::Type::QUEST_ADD;
+                effect.target = "quest_" + std::to_string(rng_.range(0, 40));
+                break;
+            default:
+                effect.type = Effect::Type::NOTIFY;
+                effect.target = i18n_key(node, "notify");
+                effect.value = prose(3, 8);
+                break;
+        }
+        return effect;
+    }
+
+    std::vector<Effect> maybe_effects(const std::string& node, double probability) {
+        std::vector<Effect> effects;
+        if (options_.max_effects <= 0 || !rng_.chance(probability)) {
+            return effects;
+        }
+        int count = rng_.range(1, options_.max_effects);
+        for (int i = 0; i < count; ++i) {
+            effects.push_back(generate_effect(node));
+        }
+        return effects;
+    }
+
+    Line generate_line(const std::string& node, const std::optional<std::string>& speaker, int variant) {
+        Line line;
+        std::string suffix = variant < 0 ? "text" : "text_" + std::to_string(variant);
+        line.text = options_.text_style == TextStyle::I18N_KEYS ? i18n_key(node, suffix)
+                                                                : prose(options_.min_words, options_.max_words);
+
+        if (speaker && rng_.chance(options_.voice_probability)) {
+            Voice voice;
+            voice.clipId = "vo_" + id_ + "_" + node + (variant < 0 ? "" : "_" + std::to_string(variant));
+            voice.subtitles = !rng_.chance(0.05);
+            voice.startMs = rng_.chance(0.1) ? rng_.range(1, 20) * 50 : 0;
+            line.voice = voice;
+        }
+        if (speaker && rng_.chance(options_.portrait_probability)) {
+            line.portrait = Portrait{*speaker, kMoods[rng_.range(0, static_cast<int>(std::size(kMoods)) - 1)]};
+        }
+        if (rng_.chance(0.05)) {
+            line.sfx.push_back("sfx_" + vocabulary_.sample(rng_));
+        }
+        if (options_.text_style != TextStyle::I18N_KEYS && rng_.chance(0.1)) {
+            line.params["name"] = "{player.name}";
+        }
+        if (variant >= 0) {
+            line.conditions = maybe_condition();
+            line.weight = static_cast<float>(rng_.range(1, 6)) * 0.5f;
+        }
+        return line;
+    }
+
+    Choice generate_choice(const std::string& node, int index, int choice_index, int node_count) {
+        Choice choice;
+        choice.id = "c" + std::to_string(choice_index);
+        choice.text = options_.text_style == TextStyle::PROSE ? prose(2, 8)
+                                                              : i18n_key(node, "choice." + choice.id);
+
+        // Mostly forward edges, with occasional loops back and early exits
+        if (rng_.chance(0.04) || index == node_count - 1) {
+            choice.to = "$END";
+        } else if (index > 0 && rng_.chance(options_.back_edge_probability)) {
+            choice.to = node_id(rng_.range(0, index - 1));
+        } else {
+            choice.to = node_id(std::min(node_count - 1, index + rng_.range(1, 4)));
+        }
+
+        choice.conditions = maybe_condition();
+        choice.effects = maybe_effects(node, options_.effect_probability);
+        choice.once = rng_.chance(0.1);
+        choice.cooldownMs = rng_.chance(0.05) ? rng_.range(1, 60) * 1000 : 0;
+        if (choice.conditions && rng_.chance(0.5)) {
+            choice.disabledText = i18n_key(node, "choice." + choice.id + ".disabled");
+        }
+        return choice;
+    }
+
+    Node generate_node(int index, int node_count) {
+        Node node;
+        node.id = node_id(index);
+        if (options_.speaker_count > 0 && rng_.chance(0.9)) {
+            node.speaker = "char_" + std::to_string(rng_.range(0, options_.speaker_count - 1));
+        }
+        int tags = rng_.range(0, 2);
+        for (int t = 0; t < tags; ++t) {
+            node.tags.push_back(kTags[rng_.range(0, static_cast<int>(std::size(kTags)) - 1)]);
+        }
+
+        if (options_.max_variants > 1 && rng_.chance(options_.variant_probability)) {
+            int variants = rng_.range(2, options_.max_variants);
+            for (int v = 0; v < variants; ++v) {
+                node.lines.push_back(generate_line(node.id, node.speaker, v));
+            }
+        } else {
+            node.line = generate_line(node.id, node.speaker, -1);
+        }
+
+        int choices = rng_.range(std::max(options_.min_choices, 0), std::max(options_.max_choices, 0));
+        for (int c = 0; c < choices; ++c) {
+            node.choices.push_back(generate_choice(node.id, index, c, node_count));
+        }
+
+        node.onEnterEffects = maybe_effects(node.id, options_.effect_probability * 0.5);
+        if (node.choices.empty()) {
+            node.autoAdvanceMs = rng_.range(3, 8) * 500;
+        }
+        node.interruptible = !rng_.chance(0.05);
+        return node;
+    }
+
+    const CorpusOptions& options_;
+    std::string id_;
+    Rng rng_;
+    Vocabulary vocabulary_;
+};
+
+// JSON with the same structure as to_yaml(). Written by hand so numbers and
+// booleans keep their JSON types, as machine exporters produce them.
+class JsonWriter {
+public:
+    std::string write(const Dialogue& dialogue) {
+        out_ += "{\"kind\":\"dialogue\",\"id\":";
+        string(dialogue.id);
+        if (!dialogue.metadata.empty()) {
+            out_ += ",\"metadata\":";
+            string_map(dialogue.metadata);
+        }
+        if (dialogue.startNode) {
+            out_ += ",\"startNode\":";
+            string(*dialogue.startNode);
+        }
+        out_ += ",\"nodes\":[";
+        for (std::size_t i = 0; i < dialogue.nodes.size(); ++i) {
+            if (i > 0) out_ += ',';
+            node(dialogue.nodes[i]);
+        }
+        out_ += ']';
+        if (!dialogue.localVars.empty()) {
+            out_ += ",\"localVars\":";
+            string_map(dialogue.localVars);
+        }
+        out_ += "}\n";
+        return std::move(out_);
+    }
+
+private:
+    void string(const std::string& text) {
+        out_ += '"';
+        for (char c : text) {
+            switch (c) {
+                case '"': out_ += "\\\""; break;
+                case '\\': out_ += "\\\\"; break;
+                case '\n': out_ += "\\n"; break;
+                case '\t': out_ += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escape[8];
+                        std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned char>(c));
+                        out_ += escape;
+                    } else {
+                        out_ += c;
+                    }
+            }
+        }
+        out_ += '"';
+    }
+
+    void key(const char* name) {
+        out_ += ",\"";
+        out_ += name;
+        out_ += "\":";
+    }
+
+    // Same digits as YAML::convert<float>, so both formats carry equal text
+    void number(float value) {
+        std::ostringstream stream;
+        stream.precision(std::numeric_limits<float>::max_digits10);
+        stream << value;
+        out_ += stream.str();
+    }
+
+    void value(const std::variant<std::string, int, float, bool>& value) {
+        std::visit([this](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) string(v);
+            else if constexpr (std::is_same_v<T, bool>) out_ += v ? "true" : "false";
+            else if constexpr (std::is_same_v<T, int>) out_ += std::to_string(v);
+            else number(v);
+        }, value);
+    }
+
+    void string_map(const std::map<std::string, std::string>& map) {
+        out_ += '{';
+        bool first = true;
+        for (const auto& [name, text] : map) {
+            if (!first) out_ += ',';
+            first = false;
+            string(name);
+            out_ += ':';
+            string(text);
+        }
+        out_ += '}';
+    }
+
+    void condition(const Condition& condition) {
+        switch (condition.type) {
+            case Condition::Type::ALL:
+            case Condition::Type::ANY:
+                out_ += condition.type == Condition::Type::ALL ? "{\"all\":[" : "{\"any\":[";
+                for (std::size_t i = 0; i < condition.children.size(); ++i) {
+                    if (i > 0) out_ += ',';
+                    this->condition(condition.children[i]);
+                }
+                out_ += "]}";
+                break;
+            case Condition::Type::NOT:
+                out_ += "{\"not\":";
+                this->condition(condition.children.at(0));
+                out_ += '}';
+                break;
+            case Condition::Type::FLAG:
+                out_ += "{\"flag\":";
+                string(condition.key);
+                out_ += '}';
+                break;
+            case Condition::Type::VAR:
+                out_ += "{\"var\":{\"name\":";
+                string(condition.key);
+                out_ += ",\"value\":";
+                value(condition.value);
+                out_ += "}}";
+                break;
+            default:
+                out_ += "{}";
+                break;
+        }
+    }
+
+    void effect(const Effect& effect) {
+        switch (effect.type) {
+            case Effect::Type::SET_FLAG:
+                out_ += "{\"setFlag\":";
+                string(effect.target);
+                out_ += '}';
+                break;
+            case Effect::Type::SET_VAR:
+                out_ += "{\"setVar\":{\"name\":";
+                string(effect.target);
+                out_ += ",\"value\":";
+                value(effect.value);
+                out_ += "}}";
+                break;
+            case Effect::Type::QUEST_ADD:
+                out_ += "{\"quest.add\":";
+                string(effect.target);
+                out_ += '}';
+                break;
+            case Effect::Type::NOTIFY:
+                out_ += "{\"notify\":{\"title\":";
+                string(effect.target);
+                out_ += ",\"body\":";
+                value(effect.value);
+                out_ += "}}";
+                break;
+            default:
+                out_ += "{}";
+                break;
+        }
+    }
+
+    void effects(const std::vector<Effect>& effects) {
+        out_ += '[';
+        for (std::size_t i = 0; i < effects.size(); ++i) {
+            if (i > 0) out_ += ',';
+            effect(effects[i]);
+        }
+        out_ += ']';
+    }
+
+    void line(const Line& line) {
+        out_ += "{\"text\":";
+        string(line.text);
+        if (line.voice) {
+            key("voice");
+            out_ += "{\"clipId\":";
+            string(line.voice->clipId);
+            if (!line.voice->subtitles) out_ += ",\"subtitles\":false";
+            if (line.voice->startMs > 0) {
+                key("startMs");
+                out_ += std::to_string(line.voice->startMs);
+            }
+            out_ += '}';
+        }
+        if (line.portrait) {
+            key("portrait");
+            out_ += "{\"id\":";
+            string(line.portrait->id);
+            if (!line.portrait->mood.empty()) {
+                key("mood");
+                string(line.portrait->mood);
+            }
+            out_ += '}';
+        }
+        if (!line.sfx.empty()) {
+            key("sfx");
+            out_ += '[';
+            for (std::size_t i = 0; i < line.sfx.size(); ++i) {
+                if (i > 0) out_ += ',';
+                string(line.sfx[i]);
+            }
+            out_ += ']';
+        }
+        if (!line.params.empty()) {
+            key("params");
+            string_map(line.params);
+        }
+        if (line.conditions) {
+            key("conditions");
+            condition(*line.conditions);
+        }
+        if (line.weight != 1.0f) {
+            key("weight");
+            number(line.weight);
+        }
+        out_ += '}';
+    }
+
+    void choice(const Choice& choice) {
+        out_ += "{\"id\":";
+        string(choice.id);
+        key("text");
+        string(choice.text);
+        key("to");
+        string(choice.to);
+        if (choice.conditions) {
+            key("conditions");
+            condition(*choice.conditions);
+        }
+        if (!choice.effects.empty()) {
+            key("effects");
+            effects(choice.effects);
+        }
+        if (choice.once) out_ += ",\"once\":true";
+        if (choice.cooldownMs > 0) {
+            key("cooldownMs");
+            out_ += std::to_string(choice.cooldownMs);
+        }
+        if (choice.disabledText) {
+            key("disabledText");
+            string(*choice.disabledText);
+        }
+        out_ += '}';
+    }
+
+    void node(const Node& node) {
+        out_ += "{\"id\":";
+        string(node.id);
+        if (node.speaker) {
+            key("speaker");
+            string(*node.speaker);
+        }
+        if (!node.tags.empty()) {
+            key("tags");
+            out_ += '[';
+            for (std::size_t i = 0; i < node.tags.size(); ++i) {
+                if (i > 0) out_ += ',';
+                string(node.tags[i]);
+            }
+            out_ += ']';
+        }
+        if (node.line) {
+            key("line");
+            line(*node.line);
+        } else if (!node.lines.empty()) {
+            key("lines");
+            out_ += '[';
+            for (std::size_t i = 0; i < node.lines.size(); ++i) {
+                if (i > 0) out_ += ',';
+                line(node.lines[i]);
+            }
+            out_ += ']';
+        }
+        if (!node.choices.empty()) {
+            key("choices");
+            out_ += '[';
+            for (std::size_t i = 0; i < node.choices.size(); ++i) {
+                if (i > 0) out_ += ',';
+                choice(node.choices[i]);
+            }
+            out_ += ']';
+        }
+        if (!node.onEnterEffects.empty()) {
+            out_ += ",\"onEnter\":{\"effects\":";
+            effects(node.onEnterEffects);
+            out_ += '}';
+        }
+        if (!node.onExitEffects.empty()) {
+            out_ += ",\"onExit\":{\"effects\":";
+            effects(node.onExitEffects);
+            out_ += '}';
+        }
+        if (node.autoAdvanceMs) {
+            key("autoAdvanceMs");
+            out_ += std::to_string(*node.autoAdvanceMs);
+        }
+        if (!node.interruptible) out_ += ",\"interruptible\":false";
+        out_ += '}';
+    }
+
+    std::string out_;
+};
+
+} // namespace
+
+Dialogue generate_dialogue(const CorpusOptions& options, const std::string& id) {
+    return Generator(options, id).generate();
+}
+
+std::string generate_dialogue_yaml(const CorpusOptions& options, const std::string& id) {
+    std::ostringstream oss;
+    write_dialogue(oss, generate_dialogue(options, id));
+    oss << "\n";
+    return oss.str();
+}
+
+std::string generate_dialogue_json(const CorpusOptions& options, const std::string& id) {
+    return JsonWriter().write(generate_dialogue(options, id));
+}
+
+std::vector<std::string> generate_corpus(const CorpusOptions& options, std::size_t total_bytes) {
+    std::vector<std::string> corpus;
+    std::size_t bytes = 0;
+    CorpusOptions file_options = options;
+    for (std::uint64_t index = 0; bytes < total_bytes; ++index) {
+        file_options.seed = options.seed + index;
+        corpus.push_back(generate_dialogue_yaml(file_options, "gen_" + std::to_string(index)));
+        bytes += corpus.back().size();
+    }
+    return corpus;
+}
+
+std::vector<uint8_t> generate_payload(const CorpusOptions& options, std::size_t size) {
+    std::vector<uint8_t> payload;
+    payload.reserve(size);
+    for (const auto& yaml : generate_corpus(options, size)) {
+        std::size_t take = std::min(yaml.size(), size - payload.size());
+        payload.insert(payload.end(), yaml.begin(), yaml.begin() + static_cast<std::ptrdiff_t>(take));
+    }
+    return payload;
+}
+
+} // namespace goethe::corpus
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "goethe/dialog.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace goethe::corpus {
+
+// Small portable PRNG (splitmix64). std::uniform_*_distribution is not
+// specified bit-for-bit across standard libraries, so corpora built with it
+// would differ between toolchains and make results incomparable.
+class Rng {
+public:
+    explicit Rng(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next();
+
+    // Uniform integer in [lo, hi]
+    int range(int lo, int hi);
+
+    // Uniform double in [0, 1)
+    double uniform();
+
+    bool chance(double probability) {
+        return uniform() < probability;
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+// How line text is generated
+enum class TextStyle {
+    I18N_KEYS, // "dlg_<id>.<node>.text" keys, as shipped content uses
+    PROSE,     // Inline prose drawn from a Zipf-distributed vocabulary
+    MIXED      // Keys for choices, prose for lines
+};
+
+struct CorpusOptions {
+    std::uint64_t seed = 42;
+
+    // Graph shape
+    int node_count = 64;
+    int min_choices = 0;            // Choice fan-out per node
+    int max_choices = 3;
+    double back_edge_probability = 0.1; // Choices jumping to an earlier node
+
+    // Conditions
+    int condition_depth = 2;        // Maximum nesting of all/any/not
+    double condition_probability = 0.3; // Chance a choice or variant is gated
+
+    // Effects
+    int max_effects = 2;            // Per choice and per onEnter block
+    double effect_probability = 0.4;
+
+    // Lines
+    double variant_probability = 0.2; // Node uses weighted variants
+    int max_variants = 4;
+    double voice_probability = 0.5;
+    double portrait_probability = 0.6;
+    TextStyle text_style = TextStyle::MIXED;
+    int min_words = 4;              // Prose length per line
+    int max_words = 24;
+    int vocabulary_size = 2000;
+
+    // World state referenced by conditions and effects
+    int speaker_count = 6;
+    int flag_count = 128;
+    int var_count = 32;
+};
+
+// Generate one dialogue. The same options always give the same dialogue.
+Dialogue generate_dialogue(const CorpusOptions& options, const std::string& id = "gen_dialogue");
+
+// Generate one dialogue serialized in the GOETHE YAML format
+std::string generate_dialogue_yaml(const CorpusOptions& options, const std::string& id = "gen_dialogue");
+
+// The same dialogue as compact JSON, with typed numbers and booleans
+std::string generate_dialogue_json(const CorpusOptions& options, const std::string& id = "gen_dialogue");
+
+// Generate dialogues until at least `total_bytes` of YAML is produced. Each
+// dialogue uses seed + index so corpora grow without reshuffling earlier files.
+std::vector<std::string> generate_corpus(const CorpusOptions& options, std::size_t total_bytes);
+
+// Exactly `size` bytes of concatenated dialogue YAML, for compression inputs
+std::vector<uint8_t> generate_payload(const CorpusOptions& options, std::size_t size);
+
+} // namespace goethe::corpus
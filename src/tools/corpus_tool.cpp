@@ -0,0 +1,151 @@
+#include "corpus_generator.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+void print_usage(const char* program_name) {
+    std::cout << "Goethe Dialogue Corpus Generator\n\n";
+    std::cout << "Usage: " << program_name << " <output_directory|-> [options]\n\n";
+    std::cout << "Writes seeded, reproducible GOETHE-format dialogues. Use '-' to print a\n";
+    std::cout << "single dialogue to stdout.\n\n";
+    std::cout << "Corpus options:\n";
+    std::cout << "  --size <bytes>          Total corpus size, K/M/G suffixes allowed (default: 1M)\n";
+    std::cout << "  --files <count>         Number of dialogues to write (overrides --size)\n";
+    std::cout << "  --seed <n>              Base seed (default: 42)\n";
+    std::cout << "  --format <fmt>          yaml or json (default: yaml)\n\n";
+    std::cout << "Dialogue options:\n";
+    std::cout << "  --nodes <n>             Nodes per dialogue (default: 64)\n";
+    std::cout << "  --min-choices <n>       Minimum choices per node (default: 0)\n";
+    std::cout << "  --max-choices <n>       Maximum choices per node (default: 3)\n";
+    std::cout << "  --condition-depth <n>   Maximum condition nesting (default: 2)\n";
+    std::cout << "  --condition-prob <p>    Chance a choice/variant is gated (default: 0.3)\n";
+    std::cout << "  --max-effects <n>       Maximum effects per block (default: 2)\n";
+    std::cout << "  --effect-prob <p>       Chance a choice has effects (default: 0.4)\n";
+    std::cout << "  --variant-prob <p>      Chance a node uses weighted variants (default: 0.2)\n";
+    std::cout << "  --max-variants <n>      Maximum variants per node (default: 4)\n";
+    std::cout << "  --text <style>          keys, prose or mixed (default: mixed)\n";
+    std::cout << "  --min-words <n>         Minimum words per prose line (default: 4)\n";
+    std::cout << "  --max-words <n>         Maximum words per prose line (default: 24)\n";
+    std::cout << "  --help                  Show this help message\n\n";
+    std::cout << "Examples:\n";
+    std::cout << "  " << program_name << " ./corpus --size 50M\n";
+    std::cout << "  " << program_name << " ./corpus --files 10 --nodes 500 --condition-depth 4\n";
+    std::cout << "  " << program_name << " - --nodes 8 --text prose\n";
+    std::cout << "  " << program_name << " ./corpus_json --size 200M --format json\n";
+}
+
+std::size_t parse_size(const std::string& text) {
+    std::size_t pos = 0;
+    double value = std::stod(text, &pos);
+    std::string suffix = text.substr(pos);
+    if (suffix == "K" || suffix == "k") value *= 1024.0;
+    else if (suffix == "M" || suffix == "m") value *= 1024.0 * 1024.0;
+    else if (suffix == "G" || suffix == "g") value *= 1024.0 * 1024.0 * 1024.0;
+    else if (!suffix.empty()) throw std::invalid_argument("invalid size suffix: " + suffix);
+    return static_cast<std::size_t>(value);
+}
+
+goethe::corpus::TextStyle parse_text_style(const std::string& text) {
+    if (text == "keys") return goethe::corpus::TextStyle::I18N_KEYS;
+    if (text == "prose") return goethe::corpus::TextStyle::PROSE;
+    if (text == "mixed") return goethe::corpus::TextStyle::MIXED;
+    throw std::invalid_argument("unknown text style: " + text);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string output = argv[1];
+    if (output == "help" || output == "--help" || output == "-h") {
+        print_usage(argv[0]);
+        return 0;
+    }
+
+    goethe::corpus::CorpusOptions options;
+    std::size_t total_size = 1024 * 1024;
+    int file_count = 0;
+    bool json = false;
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "Error: missing value for " << arg << "\n";
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--size") total_size = parse_size(value);
+            else if (arg == "--files") file_count = std::stoi(value);
+            else if (arg == "--seed") options.seed = std::stoull(value);
+            else if (arg == "--format") {
+                if (value != "yaml" && value != "json") throw std::invalid_argument("unknown format: " + value);
+                json = value == "json";
+            }
+            else if (arg == "--nodes") options.node_count = std::stoi(value);
+            else if (arg == "--min-choices") options.min_choices = std::stoi(value);
+            else if (arg == "--max-choices") options.max_choices = std::stoi(value);
+            else if (arg == "--condition-depth") options.condition_depth = std::stoi(value);
+            else if (arg == "--condition-prob") options.condition_probability = std::stod(value);
+            else if (arg == "--max-effects") options.max_effects = std::stoi(value);
+            else if (arg == "--effect-prob") options.effect_probability = std::stod(value);
+            else if (arg == "--variant-prob") options.variant_probability = std::stod(value);
+            else if (arg == "--max-variants") options.max_variants = std::stoi(value);
+            else if (arg == "--text") options.text_style = parse_text_style(value);
+            else if (arg == "--min-words") options.min_words = std::stoi(value);
+            else if (arg == "--max-words") options.max_words = std::stoi(value);
+            else {
+                std::cerr << "Error: unknown option " << arg << "\n";
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (output == "-") {
+        std::cout << (json ? goethe::corpus::generate_dialogue_json(options)
+                           : goethe::corpus::generate_dialogue_yaml(options));
+        return 0;
+    }
+
+    try {
+        fs::create_directories(output);
+
+        std::size_t bytes = 0;
+        int written = 0;
+        goethe::corpus::CorpusOptions file_options = options;
+        while (file_count > 0 ? written < file_count : bytes < total_size) {
+            file_options.seed = options.seed + static_cast<std::uint64_t>(written);
+            std::string id = "gen_" + std::to_string(written);
+            std::string text = json ? goethe::corpus::generate_dialogue_json(file_options, id)
+                                    : goethe::corpus::generate_dialogue_yaml(file_options, id);
+
+            std::ostringstream name;
+            name << "gen_" << std::setw(5) << std::setfill('0') << written << (json ? ".json" : ".yaml");
+            std::ofstream file(fs::path(output) / name.str(), std::ios::binary);
+            if (!file.is_open()) {
+                std::cerr << "Error: could not write " << (fs::path(output) / name.str()) << "\n";
+                return 1;
+            }
+            file << text;
+            bytes += text.size();
+            ++written;
+        }
+
+        std::cout << "Wrote " << written << " dialogues (" << bytes << " bytes) to " << output << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
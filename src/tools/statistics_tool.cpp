@@ -1,5 +1,9 @@
+#include "corpus_generator.hpp"
+#include "goethe/factory.hpp"
 #include "goethe/manager.hpp"
 #include "goethe/statistics.hpp"
+#include "goethe/trace.hpp"
+#include "goethe/zstd.hpp"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -7,7 +11,13 @@
 #include <iomanip>
 #include <chrono>
 #include <thread>
-#include <random>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <cctype>
+#include <filesystem>
+#include <map>
 
 void print_usage(const char* program_name) {
     std::cout << "Usage: " << program_name << " <command> [options]\n\n";
@@ -20,16 +30,52 @@ void print_usage(const char* program_name) {
     std::cout << "  reset                   - Reset all statistics\n";
     std::cout << "  export-json <file>      - Export statistics to JSON file\n";
     std::cout << "  export-csv <file>       - Export statistics to CSV file\n";
+    std::cout << "  export-openmetrics <file> - Export statistics in OpenMetrics (Prometheus) format\n";
     std::cout << "  benchmark <size>        - Run compression benchmark with given size (bytes)\n";
     std::cout << "  stress-test <count>     - Run stress test with given number of operations\n";
+    std::cout << "  stress-test --threads <n> [--duration <s>] [--sizes <list>] [--no-scaling]\n";
+    std::cout << "                          - Run threaded stress test with a 1..n thread scaling curve\n";
+    std::cout << "  watch [--interval <s>] [--duration <s>] [--threads <n>] [--sizes <list>]\n";
+    std::cout << "                          - Print 1s/10s/60s rolling statistics live; --threads 0\n";
+    std::cout << "                            disables the background load\n";
+    std::cout << "  memory [dialogue...]    - Show tracked memory, loading the given dialogue files first\n";
+    std::cout << "  sweep <dir> [--levels <list>] [--strategies <list>|all] [--window-logs <list>]\n";
+    std::cout << "        [--no-dictionary] [--threads <n>] [--min-mbps <x>]\n";
+    std::cout << "                          - Compress every file under <dir> with each zstd setting and\n";
+    std::cout << "                            print the ratio/speed Pareto frontier per file extension\n";
     std::cout << "  switch <backend>        - Switch to specified backend (zstd, null)\n";
     std::cout << "  help                    - Show this help message\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --trace <file>          - Record a trace of the command: Chrome JSON for *.json,\n";
+    std::cout << "                            Perfetto protobuf otherwise (ui.perfetto.dev opens both)\n";
+    std::cout << "  --metrics <file>        - Rewrite <file> in OpenMetrics format every second while\n";
+    std::cout << "                            the command runs (node_exporter textfile collector)\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << " info\n";
     std::cout << "  " << program_name << " stats\n";
     std::cout << "  " << program_name << " benchmark 1048576\n";
     std::cout << "  " << program_name << " export-json stats.json\n";
     std::cout << "  " << program_name << " stress-test 1000\n";
+    std::cout << "  " << program_name << " stress-test --threads 8 --duration 5 --sizes 1K,64K,1M\n";
+    std::cout << "  " << program_name << " stress-test --threads 4 --duration 2 --trace stress.pftrace\n";
+    std::cout << "  " << program_name << " stress-test --threads 4 --duration 60 --metrics goethe.prom\n";
+    std::cout << "  " << program_name << " watch --threads 2 --duration 20\n";
+    std::cout << "  " << program_name << " memory intro.yaml tavern.yaml\n";
+    std::cout << "  " << program_name << " sweep assets/dialogues --levels 1-19 --strategies all --threads 8\n";
+}
+
+bool write_trace(const std::string& filename) {
+    auto& tracer = goethe::TraceManager::instance();
+    bool chrome = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Error: Could not write to file " << filename << "\n";
+        return false;
+    }
+    auto snapshot = tracer.snapshot();
+    file << (chrome ? goethe::TraceManager::export_chrome_json(snapshot) : goethe::TraceManager::export_perfetto(snapshot));
+    std::cout << "Trace with " << snapshot.event_count() << " events written to " << filename << "\n";
+    return true;
 }
 
 void print_backend_info(const goethe::CompressionManager& manager) {
@@ -38,6 +84,11 @@ void print_backend_info(const goethe::CompressionManager& manager) {
     std::cout << "Name: " << manager.get_backend_name() << "\n";
     std::cout << "Version: " << manager.get_backend_version() << "\n";
     std::cout << "Initialized: " << (manager.is_initialized() ? "Yes" : "No") << "\n";
+    std::cout << "Available Backends:";
+    for (const auto& name : goethe::get_available_compression_backends()) {
+        std::cout << " " << name;
+    }
+    std::cout << "\n";
     std::cout << "Statistics Enabled: " << (manager.is_statistics_enabled() ? "Yes" : "No") << "\n";
 }
 
@@ -70,17 +121,9 @@ void print_statistics(const goethe::BackendStats& stats, const std::string& titl
     std::cout << "  Average Decompression Throughput: " << stats.average_decompression_throughput_mbps() << " MB/s\n";
 }
 
+// Test data is generated dialogue YAML so reported ratios match real content
 std::vector<uint8_t> generate_test_data(size_t size) {
-    std::vector<uint8_t> data(size);
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 255);
-    
-    for (size_t i = 0; i < size; ++i) {
-        data[i] = dis(gen) % 20; // Limited range for better compression
-    }
-    
-    return data;
+    return goethe::corpus::generate_payload(goethe::corpus::CorpusOptions{}, size);
 }
 
 void run_benchmark(goethe::CompressionManager& manager, size_t data_size) {
@@ -118,15 +161,15 @@ void run_stress_test(goethe::CompressionManager& manager, int count) {
     std::cout << "Running stress test with " << count << " operations...\n";
     
     std::vector<size_t> sizes = {1024, 10240, 102400, 1048576}; // 1KB, 10KB, 100KB, 1MB
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> size_dis(0, sizes.size() - 1);
+    std::vector<std::vector<uint8_t>> datasets;
+    for (size_t size : sizes) {
+        datasets.push_back(generate_test_data(size));
+    }
     
     auto start = std::chrono::high_resolution_clock::now();
     
     for (int i = 0; i < count; ++i) {
-        size_t data_size = sizes[size_dis(gen)];
-        auto data = generate_test_data(data_size);
+        const auto& data = datasets[static_cast<size_t>(i) % datasets.size()];
         
         try {
             auto compressed = manager.compress(data);
@@ -154,19 +197,640 @@ void run_stress_test(goethe::CompressionManager& manager, int count) {
     std::cout << "Average time per operation: " << (duration.count() / static_cast<double>(count)) << " ms\n";
 }
 
+// Multi-threaded stress test configuration
+struct StressConfig {
+    int threads = 1;
+    double duration_s = 5.0;
+    std::vector<size_t> sizes = {1024, 10240, 102400, 1048576};
+    bool scaling = true; // Also run 1, 2, 4, ... threads up to `threads`
+};
+
+// Result of one worker thread in a run
+struct WorkerResult {
+    uint64_t operations = 0;      // Round trips (compress + decompress)
+    uint64_t bytes = 0;           // Uncompressed bytes round-tripped
+    std::vector<uint64_t> latencies_ns;
+    std::string error;
+};
+
+struct RunResult {
+    int threads = 0;
+    double elapsed_s = 0.0;
+    std::vector<WorkerResult> workers;
+    
+    uint64_t operations() const {
+        uint64_t total = 0;
+        for (const auto& w : workers) total += w.operations;
+        return total;
+    }
+    uint64_t bytes() const {
+        uint64_t total = 0;
+        for (const auto& w : workers) total += w.bytes;
+        return total;
+    }
+};
+
+size_t parse_size(const std::string& text) {
+    size_t pos = 0;
+    double value = std::stod(text, &pos);
+    std::string suffix = text.substr(pos);
+    if (suffix == "K" || suffix == "k") value *= 1024.0;
+    else if (suffix == "M" || suffix == "m") value *= 1024.0 * 1024.0;
+    else if (!suffix.empty()) throw std::invalid_argument("invalid size suffix: " + suffix);
+    return static_cast<size_t>(value);
+}
+
+std::vector<size_t> parse_sizes(const std::string& text) {
+    std::vector<size_t> sizes;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) sizes.push_back(parse_size(item));
+    }
+    if (sizes.empty()) throw std::invalid_argument("no sizes given");
+    return sizes;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+double to_us(uint64_t ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+// Each worker owns a backend configured like the manager's: zstd contexts are
+// not thread-safe, so sharing the singleton's backend would be a data race.
+// The workers still share StatisticsManager, which is the contention we want
+// to see, because the vector overloads record statistics on every call.
+RunResult run_stress_workers(const goethe::CompressionManager& manager, int thread_count, double duration_s,
+                             const std::vector<std::vector<uint8_t>>& datasets) {
+    RunResult result;
+    result.threads = thread_count;
+    result.workers.resize(static_cast<size_t>(thread_count));
+    
+    std::vector<std::unique_ptr<goethe::CompressionBackend>> backends;
+    for (int t = 0; t < thread_count; ++t) {
+        auto backend = goethe::create_compression_backend(manager.get_backend_name());
+        backend->set_options(manager.get_options());
+        backend->set_compression_level(manager.get_compression_level());
+        backends.push_back(std::move(backend));
+    }
+    
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            auto& worker = result.workers[static_cast<size_t>(t)];
+            auto& backend = *backends[static_cast<size_t>(t)];
+            goethe::TraceManager::instance().set_thread_name("stress worker " + std::to_string(t));
+            worker.latencies_ns.reserve(1 << 16);
+            size_t next = static_cast<size_t>(t);
+            
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto& data = datasets[next++ % datasets.size()];
+                try {
+                    auto op_start = std::chrono::steady_clock::now();
+                    auto compressed = backend.compress(data);
+                    auto decompressed = backend.decompress(compressed);
+                    auto op_end = std::chrono::steady_clock::now();
+                    
+                    if (decompressed != data) {
+                        worker.error = "data integrity check failed";
+                        return;
+                    }
+                    worker.latencies_ns.push_back(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(op_end - op_start).count()));
+                    worker.operations++;
+                    worker.bytes += data.size();
+                } catch (const std::exception& e) {
+                    worker.error = e.what();
+                    return;
+                }
+            }
+        });
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(duration_s));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    result.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void print_run_details(const RunResult& run) {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\nPer-thread results (" << run.threads << " threads, " << run.elapsed_s << " s):\n";
+    std::cout << "  " << std::left << std::setw(8) << "Thread" << std::right << std::setw(12) << "Ops"
+              << std::setw(12) << "Ops/s" << std::setw(12) << "MB/s" << std::setw(12) << "p50 us"
+              << std::setw(12) << "p99 us" << "\n";
+    
+    std::vector<uint64_t> all;
+    for (size_t t = 0; t < run.workers.size(); ++t) {
+        auto sorted = run.workers[t].latencies_ns;
+        std::sort(sorted.begin(), sorted.end());
+        all.insert(all.end(), sorted.begin(), sorted.end());
+        
+        double mb = static_cast<double>(run.workers[t].bytes) / (1024.0 * 1024.0);
+        std::cout << "  " << std::left << std::setw(8) << t << std::right << std::setw(12)
+                  << run.workers[t].operations << std::setw(12)
+                  << static_cast<double>(run.workers[t].operations) / run.elapsed_s << std::setw(12)
+                  << mb / run.elapsed_s << std::setw(12) << to_us(percentile(sorted, 50.0)) << std::setw(12)
+                  << to_us(percentile(sorted, 99.0)) << "\n";
+        if (!run.workers[t].error.empty()) {
+            std::cout << "    Error: " << run.workers[t].error << "\n";
+        }
+    }
+    std::sort(all.begin(), all.end());
+    
+    double mb = static_cast<double>(run.bytes()) / (1024.0 * 1024.0);
+    std::cout << "\nAggregate:\n";
+    std::cout << "  Round trips: " << run.operations() << " (" << static_cast<double>(run.operations()) / run.elapsed_s
+              << " ops/s)\n";
+    std::cout << "  Throughput: " << mb / run.elapsed_s << " MB/s\n";
+    std::cout << "  Latency (compress + decompress):\n";
+    std::cout << "    p50: " << to_us(percentile(all, 50.0)) << " us\n";
+    std::cout << "    p90: " << to_us(percentile(all, 90.0)) << " us\n";
+    std::cout << "    p99: " << to_us(percentile(all, 99.0)) << " us\n";
+    std::cout << "    p99.9: " << to_us(percentile(all, 99.9)) << " us\n";
+    std::cout << "    max: " << to_us(all.empty() ? 0 : all.back()) << " us\n";
+}
+
+bool run_threaded_stress_test(goethe::CompressionManager& manager, const StressConfig& config) {
+    std::cout << "Running threaded stress test: backend " << manager.get_backend_name() << ", up to "
+              << config.threads << " threads, " << config.duration_s << " s per run, sizes";
+    for (size_t size : config.sizes) {
+        std::cout << " " << size;
+    }
+    std::cout << "\n";
+    
+    // Pregenerate inputs so the measured loop does no allocation of its own
+    std::vector<std::vector<uint8_t>> datasets;
+    for (size_t size : config.sizes) {
+        datasets.push_back(generate_test_data(size));
+    }
+    
+    std::vector<int> thread_counts;
+    if (config.scaling) {
+        for (int t = 1; t < config.threads; t *= 2) {
+            thread_counts.push_back(t);
+        }
+    }
+    thread_counts.push_back(config.threads);
+    
+    std::vector<RunResult> runs;
+    for (int threads : thread_counts) {
+        runs.push_back(run_stress_workers(manager, threads, config.duration_s, datasets));
+        for (const auto& worker : runs.back().workers) {
+            if (!worker.error.empty()) {
+                print_run_details(runs.back());
+                std::cout << "Stress test failed.\n";
+                return false;
+            }
+        }
+    }
+    
+    if (runs.size() > 1) {
+        double base = static_cast<double>(runs.front().operations()) / runs.front().elapsed_s;
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "\nScaling curve:\n";
+        std::cout << "  " << std::left << std::setw(8) << "Threads" << std::right << std::setw(12) << "Ops/s"
+                  << std::setw(12) << "MB/s" << std::setw(12) << "Speedup" << std::setw(14) << "Efficiency"
+                  << "\n";
+        for (const auto& run : runs) {
+            double ops = static_cast<double>(run.operations()) / run.elapsed_s;
+            double mb = static_cast<double>(run.bytes()) / (1024.0 * 1024.0) / run.elapsed_s;
+            double speedup = base > 0.0 ? ops / base : 0.0;
+            std::cout << "  " << std::left << std::setw(8) << run.threads << std::right << std::setw(12) << ops
+                      << std::setw(12) << mb << std::setw(11) << speedup << "x" << std::setw(13)
+                      << speedup / run.threads * 100.0 << "%\n";
+        }
+    }
+    
+    print_run_details(runs.back());
+    std::cout << "\nStress test completed successfully!\n";
+    return true;
+}
+
+struct WatchConfig {
+    double interval_s = 1.0;
+    double duration_s = 30.0;
+    int load_threads = 1; // Background load; 0 watches without generating any
+    std::vector<size_t> sizes = {1024, 65536};
+};
+
+void print_windows(double elapsed_s) {
+    static const std::pair<goethe::StatsWindow, const char*> windows[] = {
+        {goethe::StatsWindow::ONE_SECOND, "1s"},
+        {goethe::StatsWindow::TEN_SECONDS, "10s"},
+        {goethe::StatsWindow::ONE_MINUTE, "60s"},
+    };
+    
+    auto& stats_manager = goethe::StatisticsManager::instance();
+    auto names = stats_manager.get_backend_names();
+    std::sort(names.begin(), names.end());
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n[" << std::setw(7) << elapsed_s << " s]\n";
+    std::cout << "  " << std::left << std::setw(10) << "Backend" << std::setw(8) << "Window" << std::right
+              << std::setw(12) << "Ops/s" << std::setw(12) << "Comp MB/s" << std::setw(14) << "Decomp MB/s"
+              << std::setw(8) << "Ratio" << std::setw(10) << "Errors" << "\n";
+    for (const auto& name : names) {
+        for (const auto& [window, label] : windows) {
+            auto stats = stats_manager.get_window_stats(name, window);
+            std::cout << "  " << std::left << std::setw(10) << name << std::setw(8) << label << std::right
+                      << std::setw(12) << stats.operations_per_second() << std::setw(12)
+                      << stats.compression_throughput_mbps() << std::setw(14) << stats.decompression_throughput_mbps()
+                      << std::setw(8) << stats.compression_ratio() << std::setw(9) << stats.error_rate() << "%\n";
+        }
+    }
+    std::cout << std::flush;
+}
+
+// Prints the rolling windows every interval while an optional background
+// load runs through the same per-thread backends as the stress test
+bool run_watch(goethe::CompressionManager& manager, const WatchConfig& config) {
+    std::cout << "Watching rolling statistics every " << config.interval_s << " s for " << config.duration_s << " s";
+    if (config.load_threads > 0) {
+        std::cout << " with " << config.load_threads << " load thread(s)";
+    }
+    std::cout << "\n";
+    
+    std::vector<std::vector<uint8_t>> datasets;
+    for (size_t size : config.sizes) {
+        datasets.push_back(generate_test_data(size));
+    }
+    
+    RunResult load_result;
+    std::thread load;
+    if (config.load_threads > 0) {
+        load = std::thread([&]() {
+            load_result = run_stress_workers(manager, config.load_threads, config.duration_s, datasets);
+        });
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    auto interval = std::chrono::duration<double>(config.interval_s);
+    for (auto next = start + interval;; next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval)) {
+        std::this_thread::sleep_until(next);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        print_windows(elapsed);
+        if (elapsed >= config.duration_s) break;
+    }
+    
+    if (load.joinable()) {
+        load.join();
+    }
+    for (const auto& worker : load_result.workers) {
+        if (!worker.error.empty()) {
+            std::cout << "Background load failed: " << worker.error << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_memory() {
+    static const goethe::MemoryCategory categories[] = {
+        goethe::MemoryCategory::DIALOGUE, goethe::MemoryCategory::COMPRESSION_CONTEXT,
+        goethe::MemoryCategory::DICTIONARY, goethe::MemoryCategory::CACHE, goethe::MemoryCategory::PACKAGE,
+    };
+    
+    auto& stats_manager = goethe::StatisticsManager::instance();
+    std::cout << "Tracked Memory: " << stats_manager.get_total_memory_usage() << " bytes\n";
+    for (auto category : categories) {
+        std::cout << "  " << std::left << std::setw(22) << goethe::memory_category_name(category) << std::right
+                  << std::setw(12) << stats_manager.get_memory_usage(category) << " bytes\n";
+    }
+    
+    auto breakdown = stats_manager.get_memory_breakdown();
+    if (!breakdown.empty()) {
+        std::cout << "\nLargest Objects:\n";
+        for (const auto& usage : breakdown) {
+            std::cout << "  " << std::left << std::setw(22) << goethe::memory_category_name(usage.category)
+                      << std::setw(30) << usage.name << std::right << std::setw(12) << usage.bytes << " bytes\n";
+        }
+    }
+}
+
+// Integers separated by commas, with a-b ranges: "1-5,9,12"
+std::vector<int> parse_int_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        size_t dash = item.find('-', 1);
+        if (dash == std::string::npos) {
+            values.push_back(std::stoi(item));
+        } else {
+            int first = std::stoi(item.substr(0, dash));
+            int last = std::stoi(item.substr(dash + 1));
+            for (int value = first; value <= last; ++value) {
+                values.push_back(value);
+            }
+        }
+    }
+    if (values.empty()) throw std::invalid_argument("empty list: " + text);
+    return values;
+}
+
+struct SweepConfig {
+    std::string directory;
+    std::vector<int> levels = parse_int_list("1-19");
+    std::vector<int> strategies = parse_int_list("0-9"); // 0 = the level's own strategy
+    std::vector<int> window_logs = {0};                  // 0 = the level's own window
+    bool dictionary = true;
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    double min_mbps = 50.0; // Compression speed the recommendation must reach
+};
+
+// Files of one category, plus the dictionary trained for it
+struct SweepCategory {
+    std::string name;
+    std::vector<std::vector<uint8_t>> files; // Measured
+    std::vector<uint8_t> dictionary;         // Empty when not trained
+    std::string dictionary_note;
+};
+
+struct SweepResult {
+    const SweepCategory* category = nullptr;
+    goethe::CompressionOptions options;
+    uint64_t input_bytes = 0;
+    uint64_t compressed_bytes = 0;
+    uint64_t compress_ns = 0;
+    uint64_t decompress_ns = 0;
+    std::string error;
+    
+    double ratio() const {
+        return input_bytes ? static_cast<double>(compressed_bytes) / static_cast<double>(input_bytes) : 0.0;
+    }
+    double compress_mbps() const {
+        return compress_ns ? static_cast<double>(input_bytes) / (1024.0 * 1024.0) / (compress_ns / 1e9) : 0.0;
+    }
+    double decompress_mbps() const {
+        return decompress_ns ? static_cast<double>(input_bytes) / (1024.0 * 1024.0) / (decompress_ns / 1e9) : 0.0;
+    }
+    // No worse on all three axes and better on at least one
+    bool dominates(const SweepResult& other) const {
+        bool no_worse = ratio() <= other.ratio() && compress_mbps() >= other.compress_mbps() &&
+                        decompress_mbps() >= other.decompress_mbps();
+        bool better = ratio() < other.ratio() || compress_mbps() > other.compress_mbps() ||
+                      decompress_mbps() > other.decompress_mbps();
+        return no_worse && better;
+    }
+};
+
+std::string describe_options(const goethe::CompressionOptions& options) {
+    std::ostringstream oss;
+    oss << "level=" << options.level << " strategy=" << options.strategy << " window_log=" << options.window_log
+        << " dictionary=" << (options.dictionary_mode ? "yes" : "no");
+    return oss.str();
+}
+
+// Groups files by extension. When dictionaries are swept, every other file
+// trains the dictionary and only the rest are measured, so no setting is
+// scored on the data its dictionary was built from.
+std::vector<SweepCategory> load_sweep_corpus(const SweepConfig& config) {
+    std::map<std::string, std::vector<std::vector<uint8_t>>> by_extension;
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(config.directory)) {
+        if (entry.is_regular_file()) paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end()); // Stable train/measure split between runs
+    
+    for (const auto& path : paths) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.empty()) continue;
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        by_extension[extension.empty() ? "(none)" : extension.substr(1)].push_back(std::move(data));
+    }
+    
+    constexpr size_t kMinTrainingFiles = 8;
+    std::vector<SweepCategory> categories;
+    for (auto& [name, files] : by_extension) {
+        SweepCategory category;
+        category.name = name;
+        if (!config.dictionary) {
+            category.files = std::move(files);
+        } else if (files.size() < 2 * kMinTrainingFiles) {
+            category.files = std::move(files);
+            category.dictionary_note = "too few files to train a dictionary";
+        } else {
+            std::vector<std::vector<uint8_t>> training;
+            size_t training_bytes = 0;
+            for (size_t i = 0; i < files.size(); ++i) {
+                if (i % 2 == 0) {
+                    training_bytes += files[i].size();
+                    training.push_back(std::move(files[i]));
+                } else {
+                    category.files.push_back(std::move(files[i]));
+                }
+            }
+            try {
+                // ZDICT wants roughly 100x the dictionary size in samples
+                size_t max_size = std::clamp<size_t>(training_bytes / 100, 1024, 112640);
+                category.dictionary = goethe::ZstdCompressionBackend::train_dictionary(training, max_size);
+            } catch (const std::exception& e) {
+                category.dictionary_note = e.what();
+            }
+        }
+        categories.push_back(std::move(category));
+    }
+    return categories;
+}
+
+// Measures one setting on one category with a backend owned by the calling thread
+void measure_sweep_setting(goethe::CompressionBackend& backend, SweepResult& result) {
+    try {
+        backend.set_options(result.options);
+        for (const auto& data : result.category->files) {
+            auto start = std::chrono::steady_clock::now();
+            auto compressed = backend.compress(data.data(), data.size());
+            auto middle = std::chrono::steady_clock::now();
+            auto decompressed = backend.decompress(compressed.data(), compressed.size());
+            auto end = std::chrono::steady_clock::now();
+            if (decompressed != data) {
+                result.error = "data integrity check failed";
+                return;
+            }
+            result.input_bytes += data.size();
+            result.compressed_bytes += compressed.size();
+            result.compress_ns += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count());
+            result.decompress_ns += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count());
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+}
+
+bool run_sweep(const SweepConfig& config) {
+    auto categories = load_sweep_corpus(config);
+    if (categories.empty()) {
+        std::cout << "Error: No files found under " << config.directory << "\n";
+        return false;
+    }
+    
+    std::vector<SweepResult> results;
+    for (const auto& category : categories) {
+        for (int level : config.levels) {
+            for (int strategy : config.strategies) {
+                for (int window_log : config.window_logs) {
+                    for (bool use_dictionary : {false, true}) {
+                        if (use_dictionary && category.dictionary.empty()) continue;
+                        SweepResult result;
+                        result.category = &category;
+                        result.options.level = level;
+                        result.options.strategy = strategy;
+                        result.options.window_log = window_log;
+                        result.options.dictionary_mode = use_dictionary;
+                        if (use_dictionary) result.options.dictionary = category.dictionary;
+                        results.push_back(std::move(result));
+                    }
+                }
+            }
+        }
+    }
+    
+    std::cout << "Sweeping " << results.size() << " settings over " << categories.size() << " categories with "
+              << config.threads << " threads\n";
+    
+    // Settings are handed out one at a time; each thread owns its backend
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < config.threads; ++t) {
+        threads.emplace_back([&, t]() {
+            goethe::TraceManager::instance().set_thread_name("sweep worker " + std::to_string(t));
+            auto backend = goethe::create_compression_backend("zstd");
+            backend->enable_statistics(false);
+            for (size_t i = next++; i < results.size(); i = next++) {
+                measure_sweep_setting(*backend, results[i]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (const auto& result : results) {
+        if (!result.error.empty()) {
+            std::cout << "Error: " << result.category->name << " " << describe_options(result.options) << ": "
+                      << result.error << "\n";
+            return false;
+        }
+    }
+    
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& category : categories) {
+        std::vector<const SweepResult*> frontier;
+        for (const auto& candidate : results) {
+            if (candidate.category != &category) continue;
+            bool dominated = std::any_of(results.begin(), results.end(), [&](const SweepResult& other) {
+                return other.category == &category && other.dominates(candidate);
+            });
+            if (!dominated) frontier.push_back(&candidate);
+        }
+        std::sort(frontier.begin(), frontier.end(),
+                  [](const SweepResult* a, const SweepResult* b) { return a->ratio() < b->ratio(); });
+        
+        size_t total_bytes = 0;
+        for (const auto& file : category.files) {
+            total_bytes += file.size();
+        }
+        std::cout << "\nCategory " << category.name << ": " << category.files.size() << " files, " << total_bytes
+                  << " bytes measured";
+        if (!category.dictionary.empty()) {
+            std::cout << ", " << category.dictionary.size() << " byte dictionary";
+        } else if (!category.dictionary_note.empty()) {
+            std::cout << " (no dictionary: " << category.dictionary_note << ")";
+        }
+        std::cout << "\n";
+        std::cout << "  " << std::left << std::setw(8) << "Level" << std::setw(10) << "Strategy" << std::setw(8)
+                  << "Window" << std::setw(6) << "Dict" << std::right << std::setw(10) << "Ratio" << std::setw(12)
+                  << "Comp MB/s" << std::setw(14) << "Decomp MB/s" << "\n";
+        for (const auto* result : frontier) {
+            std::cout << "  " << std::left << std::setw(8) << result->options.level << std::setw(10)
+                      << result->options.strategy << std::setw(8) << result->options.window_log << std::setw(6)
+                      << (result->options.dictionary_mode ? "yes" : "no") << std::right << std::setw(10)
+                      << result->ratio() << std::setw(12) << result->compress_mbps() << std::setw(14)
+                      << result->decompress_mbps() << "\n";
+        }
+        
+        // Best ratio that still compresses at min_mbps, else the fastest setting
+        const SweepResult* recommended = nullptr;
+        for (const auto* result : frontier) {
+            if (result->compress_mbps() >= config.min_mbps) {
+                recommended = result;
+                break;
+            }
+        }
+        if (!recommended) {
+            recommended = *std::max_element(frontier.begin(), frontier.end(), [](const auto* a, const auto* b) {
+                return a->compress_mbps() < b->compress_mbps();
+            });
+        }
+        std::cout << "  Recommended: " << describe_options(recommended->options) << "\n";
+    }
+    
+    std::cout << "\nThroughput is per thread while " << config.threads
+              << " settings run at once; rerun finalists with --threads 1 for absolute numbers.\n";
+    return true;
+}
+
 int main(int argc, char* argv[]) {
+    // --trace and --metrics apply to every command, so strip them before dispatching
+    std::string trace_file;
+    std::string metrics_file;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else if (std::string(argv[i]) == "--metrics" && i + 1 < argc) {
+            metrics_file = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
     if (argc < 2) {
         print_usage(argv[0]);
         return 1;
     }
     
     std::string command = argv[1];
+    if (!trace_file.empty()) {
+        goethe::TraceManager::instance().set_thread_name("main");
+        goethe::TraceManager::instance().enable_tracing(true);
+    }
     
     try {
         auto& manager = goethe::CompressionManager::instance();
         manager.initialize(); // Auto-select best backend
         manager.enable_statistics(true);
         
+        std::unique_ptr<goethe::OpenMetricsFileSink> metrics_sink;
+        if (!metrics_file.empty()) {
+            metrics_sink = std::make_unique<goethe::OpenMetricsFileSink>(metrics_file, std::chrono::seconds(1));
+            metrics_sink->start();
+        }
+        
         if (command == "help" || command == "--help" || command == "-h") {
             print_usage(argv[0]);
         } else if (command == "info") {
@@ -220,6 +884,23 @@ int main(int argc, char* argv[]) {
                 std::cout << "Error: Could not write to file " << filename << "\n";
                 return 1;
             }
+        } else if (command == "export-openmetrics") {
+            if (argc < 3) {
+                std::cout << "Error: Please specify output file.\n";
+                return 1;
+            }
+            std::string filename = argv[2];
+            std::string metrics_data = manager.export_statistics_openmetrics();
+            
+            std::ofstream file(filename);
+            if (file.is_open()) {
+                file << metrics_data;
+                file.close();
+                std::cout << "Statistics exported to " << filename << "\n";
+            } else {
+                std::cout << "Error: Could not write to file " << filename << "\n";
+                return 1;
+            }
         } else if (command == "benchmark") {
             if (argc < 3) {
                 std::cout << "Error: Please specify data size in bytes.\n";
@@ -229,11 +910,98 @@ int main(int argc, char* argv[]) {
             run_benchmark(manager, data_size);
         } else if (command == "stress-test") {
             if (argc < 3) {
-                std::cout << "Error: Please specify number of operations.\n";
+                std::cout << "Error: Please specify number of operations or --threads.\n";
+                return 1;
+            }
+            if (std::string(argv[2]).rfind("--", 0) != 0) {
+                int count = std::stoi(argv[2]);
+                run_stress_test(manager, count);
+            } else {
+                StressConfig config;
+                for (int i = 2; i < argc; ++i) {
+                    std::string arg = argv[i];
+                    if (arg == "--no-scaling") {
+                        config.scaling = false;
+                    } else if (i + 1 < argc && arg == "--threads") {
+                        config.threads = std::max(1, std::stoi(argv[++i]));
+                    } else if (i + 1 < argc && arg == "--duration") {
+                        config.duration_s = std::stod(argv[++i]);
+                    } else if (i + 1 < argc && arg == "--sizes") {
+                        config.sizes = parse_sizes(argv[++i]);
+                    } else {
+                        std::cout << "Error: Unknown stress-test option " << arg << "\n";
+                        return 1;
+                    }
+                }
+                if (!run_threaded_stress_test(manager, config)) {
+                    return 1;
+                }
+            }
+        } else if (command == "watch") {
+            WatchConfig config;
+            for (int i = 2; i < argc; ++i) {
+                std::string arg = argv[i];
+                if (i + 1 < argc && arg == "--interval") {
+                    config.interval_s = std::max(0.1, std::stod(argv[++i]));
+                } else if (i + 1 < argc && arg == "--duration") {
+                    config.duration_s = std::stod(argv[++i]);
+                } else if (i + 1 < argc && arg == "--threads") {
+                    config.load_threads = std::max(0, std::stoi(argv[++i]));
+                } else if (i + 1 < argc && arg == "--sizes") {
+                    config.sizes = parse_sizes(argv[++i]);
+                } else {
+                    std::cout << "Error: Unknown watch option " << arg << "\n";
+                    return 1;
+                }
+            }
+            if (!run_watch(manager, config)) {
+                return 1;
+            }
+        } else if (command == "memory") {
+            // Keep the dialogues loaded while printing so they are accounted
+            std::vector<std::pair<goethe::Dialogue, goethe::MemoryAccount>> dialogues;
+            for (int i = 2; i < argc; ++i) {
+                std::ifstream file(argv[i]);
+                if (!file.is_open()) {
+                    std::cout << "Error: Could not open file " << argv[i] << "\n";
+                    return 1;
+                }
+                auto dialogue = goethe::read_dialogue(file);
+                goethe::MemoryAccount account(goethe::MemoryCategory::DIALOGUE, dialogue.id,
+                                              goethe::estimate_memory_usage(dialogue));
+                dialogues.emplace_back(std::move(dialogue), std::move(account));
+            }
+            print_memory();
+        } else if (command == "sweep") {
+            if (argc < 3) {
+                std::cout << "Error: Please specify a directory.\n";
+                return 1;
+            }
+            SweepConfig config;
+            config.directory = argv[2];
+            for (int i = 3; i < argc; ++i) {
+                std::string arg = argv[i];
+                if (arg == "--no-dictionary") {
+                    config.dictionary = false;
+                } else if (i + 1 < argc && arg == "--levels") {
+                    config.levels = parse_int_list(argv[++i]);
+                } else if (i + 1 < argc && arg == "--strategies") {
+                    std::string list = argv[++i];
+                    config.strategies = parse_int_list(list == "all" ? "0-9" : list);
+                } else if (i + 1 < argc && arg == "--window-logs") {
+                    config.window_logs = parse_int_list(argv[++i]);
+                } else if (i + 1 < argc && arg == "--threads") {
+                    config.threads = std::max(1, std::stoi(argv[++i]));
+                } else if (i + 1 < argc && arg == "--min-mbps") {
+                    config.min_mbps = std::stod(argv[++i]);
+                } else {
+                    std::cout << "Error: Unknown sweep option " << arg << "\n";
+                    return 1;
+                }
+            }
+            if (!run_sweep(config)) {
                 return 1;
             }
-            int count = std::stoi(argv[2]);
-            run_stress_test(manager, count);
         } else if (command == "switch") {
             if (argc < 3) {
                 std::cout << "Error: Please specify backend name.\n";
@@ -258,5 +1026,8 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (!trace_file.empty() && !write_trace(trace_file)) {
+        return 1;
+    }
     return 0;
 }